@@ -52,8 +52,9 @@ extern "C" {
  */
 #define MIN_TAG_BITS_FOR_RING_ID	(32 + 1)
 
-/* Maximum number of grouped receives */
-#define NCCL_OFI_MAX_RECVS	1
+/* Maximum number of grouped receives. Protocols advertise the number
+ * they support through max_group_receives of the properties. */
+#define NCCL_OFI_MAX_RECVS	8
 
 /*
  * This defines a higher value than maximum inflight requests supported by NCCL
@@ -64,13 +65,12 @@ extern "C" {
 #define NCCL_OFI_MAX_REQUESTS	(128)
 
 /*
- * Number of send requests that can be active at any given time.  In
- * the case of supporting NCCL_OFI_MAX_RECVS grouped receives for each
- * receive request, which means the number of send requests that must
- * be supported is actually larger than the number of receive
- * requests.
+ * Number of send requests of the send/recv protocol that can be active
+ * at any given time. Supporting grouped receives would need more send
+ * requests than receive requests, but the send/recv protocol does not
+ * support them, so it is the number of receive requests.
  */
-#define NCCL_OFI_MAX_SEND_REQUESTS (NCCL_OFI_MAX_REQUESTS * NCCL_OFI_MAX_RECVS)
+#define NCCL_OFI_MAX_SEND_REQUESTS (NCCL_OFI_MAX_REQUESTS)
 
 /* Flush read size (bytes) */
 #define NCCL_OFI_FLUSH_SIZE             (4ULL)
@@ -620,6 +620,34 @@ int nccl_net_ofi_info_properties(nccl_net_ofi_plugin_t *plugin, struct fi_info *
  */
 int nccl_net_ofi_alloc_mr_buffer(size_t size, void **ptr);
 
+/* Size of huge pages used to back memory regions */
+#define NCCL_OFI_HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+/*
+ * @brief	Allocate memory region for memory registration with placement hints
+ *
+ * Same as nccl_net_ofi_alloc_mr_buffer(), but optionally backs the
+ * memory region with huge pages and binds it to a NUMA node.  Huge
+ * pages are only used if size is a multiple of
+ * NCCL_OFI_HUGE_PAGE_SIZE.  If no huge pages are reserved, the memory
+ * region is aligned to NCCL_OFI_HUGE_PAGE_SIZE and transparent huge
+ * pages are requested instead.  The NUMA node is preferred, not
+ * required, and binding failures are ignored.
+ *
+ * To free deallocate the memory region, function
+ * nccl_net_ofi_dealloc_mr_buffer() must be used.
+ *
+ * @param	size
+ *		Size of the memory region. Must be a multiple of system memory page size.
+ * @param	huge_pages
+ *		Back the memory region with huge pages
+ * @param	numa_node
+ *		NUMA node to bind the memory region to, or -1
+ * @return	0, on success
+ *		error, on others
+ */
+int nccl_net_ofi_alloc_mr_buffer_numa(size_t size, bool huge_pages, int numa_node, void **ptr);
+
 /*
  * @brief	Deallocate memory region allocated by function nccl_net_ofi_alloc_mr_buffer()
  *
@@ -6,6 +6,8 @@
 #ifndef NCCL_OFI_CUDA_H_
 #define NCCL_OFI_CUDA_H_
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,6 +27,18 @@ int nccl_net_ofi_cuda_init(void);
  */
 int nccl_net_ofi_get_cuda_device_for_addr(void *data, int *dev_id);
 
+/*
+ * @brief	Gets the CU_POINTER_ATTRIBUTE_BUFFER_ID of the allocation
+ *		containing the buffer. The ID is unique for the lifetime of
+ *		the process, so it changes when the memory is freed and
+ *		reallocated at the same address.
+ *
+ * @return	0 on success
+ *		-EINVAL if the buffer was not allocated by CUDA
+ *		-ENOTSUP if the driver does not provide the attribute
+ */
+int nccl_net_ofi_cuda_get_buffer_id(const void *addr, uint64_t *buffer_id);
+
 /*
  * @brief	wraps cudaFlushGPUDirectRDMAWrites() with default args.
 
@@ -31,6 +31,23 @@ struct nccl_ofi_deque_elem_t {
 };
 typedef struct nccl_ofi_deque_elem_t nccl_ofi_deque_elem_t;
 
+/*
+ * Synchronization of deque operations, selected at initialization time
+ */
+typedef enum nccl_ofi_deque_mode {
+	/* Every operation takes the deque lock */
+	NCCL_OFI_DEQUE_MODE_MUTEX = 0,
+	/* Lock-free multi-producer, single-consumer queue.  Any thread
+	 * may insert at the back.  Only the consumer, i.e. the thread
+	 * between nccl_ofi_deque_consumer_begin() and
+	 * nccl_ofi_deque_consumer_end(), may remove from the front and
+	 * put elements back at the front, e.g. to retry them.
+	 * nccl_ofi_deque_remove(), nccl_ofi_deque_get_front(),
+	 * nccl_ofi_deque_get_next() and NCCL_OFI_DEQUE_FOREACH are not
+	 * supported. */
+	NCCL_OFI_DEQUE_MODE_MPSC,
+} nccl_ofi_deque_mode_t;
+
 /*
  * Deque (doubly-ended queue) structure
  *
@@ -47,8 +64,27 @@ struct nccl_ofi_deque_t {
 	 * locations.
 	 */
 	nccl_ofi_deque_elem_t head;
+	/* Number of elements in the deque */
+	size_t size;
 	/* Lock for deque operations */
 	pthread_mutex_t lock;
+
+	nccl_ofi_deque_mode_t mode;
+
+	/* NCCL_OFI_DEQUE_MODE_MPSC: elements are singly linked through
+	 * their next pointer.  Producers append after mpsc_back and the
+	 * consumer removes at mpsc_front.  mpsc_stub is linked in while
+	 * the queue holds a single element, so that producers never
+	 * touch the front. */
+	nccl_ofi_deque_elem_t *mpsc_back;
+	nccl_ofi_deque_elem_t *mpsc_front;
+	nccl_ofi_deque_elem_t mpsc_stub;
+	/* Elements put back at the front by the consumer, removed
+	 * before the elements of the queue.  Only accessed by the
+	 * consumer. */
+	nccl_ofi_deque_elem_t *retry_front;
+	/* Serializes consumers in NCCL_OFI_DEQUE_MODE_MPSC */
+	pthread_mutex_t consumer_lock;
 };
 typedef struct nccl_ofi_deque_t nccl_ofi_deque_t;
 
@@ -59,6 +95,14 @@ typedef struct nccl_ofi_deque_t nccl_ofi_deque_t;
  */
 int nccl_ofi_deque_init(nccl_ofi_deque_t **deque_p);
 
+/*
+ * Initialize deque structure with the given synchronization mode, see
+ * nccl_ofi_deque_mode_t.
+ *
+ * @return zero on success, non-zero on non-success.
+ */
+int nccl_ofi_deque_init_mode(nccl_ofi_deque_t **deque_p, nccl_ofi_deque_mode_t mode);
+
 /*
  * Finalize a deque
  *
@@ -68,6 +112,64 @@ int nccl_ofi_deque_init(nccl_ofi_deque_t **deque_p);
  */
 int nccl_ofi_deque_finalize(nccl_ofi_deque_t *deque);
 
+/*
+ * Internal: append an element to a NCCL_OFI_DEQUE_MODE_MPSC deque
+ */
+static inline void nccl_ofi_deque_mpsc_push(nccl_ofi_deque_t *deque, nccl_ofi_deque_elem_t *deque_elem)
+{
+	nccl_ofi_deque_elem_t *prev;
+
+	__atomic_store_n(&deque_elem->next, NULL, __ATOMIC_RELAXED);
+	prev = __atomic_exchange_n(&deque->mpsc_back, deque_elem, __ATOMIC_ACQ_REL);
+	/* Until this store, the consumer sees the queue end at prev */
+	__atomic_store_n(&prev->next, deque_elem, __ATOMIC_RELEASE);
+}
+
+/*
+ * Internal: remove the front element of a NCCL_OFI_DEQUE_MODE_MPSC
+ * deque
+ *
+ * Returns NULL if the queue is empty, or if the only remaining
+ * elements are being appended by producers that have not linked them
+ * yet.  The caller is expected to try again later in that case.
+ */
+static inline nccl_ofi_deque_elem_t *nccl_ofi_deque_mpsc_pop(nccl_ofi_deque_t *deque)
+{
+	nccl_ofi_deque_elem_t *front = deque->mpsc_front;
+	nccl_ofi_deque_elem_t *next = __atomic_load_n(&front->next, __ATOMIC_ACQUIRE);
+
+	if (front == &deque->mpsc_stub) {
+		if (next == NULL) {
+			return NULL;
+		}
+		deque->mpsc_front = next;
+		front = next;
+		next = __atomic_load_n(&front->next, __ATOMIC_ACQUIRE);
+	}
+
+	if (next != NULL) {
+		deque->mpsc_front = next;
+		return front;
+	}
+
+	if (front != __atomic_load_n(&deque->mpsc_back, __ATOMIC_ACQUIRE)) {
+		/* A producer is appending after front */
+		return NULL;
+	}
+
+	/* front is the last element; link in the stub behind it so
+	 * that it can be removed */
+	nccl_ofi_deque_mpsc_push(deque, &deque->mpsc_stub);
+
+	next = __atomic_load_n(&front->next, __ATOMIC_ACQUIRE);
+	if (next != NULL) {
+		deque->mpsc_front = next;
+		return front;
+	}
+
+	return NULL;
+}
+
 /*
  * Insert an element to the back of the deque
  *
@@ -79,6 +181,13 @@ static inline int nccl_ofi_deque_insert_back(nccl_ofi_deque_t *deque, nccl_ofi_d
 	assert(deque);
 	assert(deque_elem);
 
+	if (deque->mode == NCCL_OFI_DEQUE_MODE_MPSC) {
+		/* Count the element before the consumer can see it */
+		__atomic_fetch_add(&deque->size, 1, __ATOMIC_RELAXED);
+		nccl_ofi_deque_mpsc_push(deque, deque_elem);
+		return 0;
+	}
+
 	nccl_net_ofi_mutex_lock(&deque->lock);
 
 	deque_elem->next = &deque->head;
@@ -87,6 +196,7 @@ static inline int nccl_ofi_deque_insert_back(nccl_ofi_deque_t *deque, nccl_ofi_d
 	assert(deque->head.prev);
 	deque->head.prev->next = deque_elem;
 	deque->head.prev = deque_elem;
+	__atomic_store_n(&deque->size, deque->size + 1, __ATOMIC_RELAXED);
 
 	nccl_net_ofi_mutex_unlock(&deque->lock);
 
@@ -96,6 +206,9 @@ static inline int nccl_ofi_deque_insert_back(nccl_ofi_deque_t *deque, nccl_ofi_d
 /*
  * Insert an element to the front of the deque
  *
+ * In NCCL_OFI_DEQUE_MODE_MPSC, only the consumer may insert at the
+ * front.
+ *
  * @param deque_elem	user-allocated storage space for list entry
  * @return zero on success, non-zero on error
  */
@@ -104,6 +217,13 @@ static inline int nccl_ofi_deque_insert_front(nccl_ofi_deque_t *deque, nccl_ofi_
 	assert(deque);
 	assert(deque_elem);
 
+	if (deque->mode == NCCL_OFI_DEQUE_MODE_MPSC) {
+		deque_elem->next = deque->retry_front;
+		deque->retry_front = deque_elem;
+		__atomic_fetch_add(&deque->size, 1, __ATOMIC_RELAXED);
+		return 0;
+	}
+
 	nccl_net_ofi_mutex_lock(&deque->lock);
 
 	deque_elem->next = deque->head.next;
@@ -112,6 +232,7 @@ static inline int nccl_ofi_deque_insert_front(nccl_ofi_deque_t *deque, nccl_ofi_
 	assert(deque->head.next);
 	deque->head.next->prev = deque_elem;
 	deque->head.next = deque_elem;
+	__atomic_store_n(&deque->size, deque->size + 1, __ATOMIC_RELAXED);
 
 	nccl_net_ofi_mutex_unlock(&deque->lock);
 
@@ -125,11 +246,28 @@ static inline int nccl_ofi_deque_insert_front(nccl_ofi_deque_t *deque, nccl_ofi_
  */
 static inline bool nccl_ofi_deque_isempty(nccl_ofi_deque_t *deque)
 {
+	if (deque->mode == NCCL_OFI_DEQUE_MODE_MPSC) {
+		return __atomic_load_n(&deque->size, __ATOMIC_RELAXED) == 0;
+	}
 	return deque->head.next == &deque->head;
 }
 
+/*
+ * Return the number of elements in the deque. This call does not take
+ * the mutex, so the result may be stale if the deque is concurrently
+ * modified.
+ */
+static inline size_t nccl_ofi_deque_size(nccl_ofi_deque_t *deque)
+{
+	return __atomic_load_n(&deque->size, __ATOMIC_RELAXED);
+}
+
 /*
  * Remove an element from the front of the deque
+ *
+ * In NCCL_OFI_DEQUE_MODE_MPSC, only the consumer may remove elements,
+ * and elements being inserted concurrently may not be returned yet.
+ *
  * @param deque_elem  returned element; NULL if deque is empty or an error occurred
  * @return zero on success, non-zero on non-success
  */
@@ -138,6 +276,19 @@ static inline int nccl_ofi_deque_remove_front(nccl_ofi_deque_t *deque, nccl_ofi_
 	assert(deque);
 	assert(deque_elem);
 
+	if (deque->mode == NCCL_OFI_DEQUE_MODE_MPSC) {
+		*deque_elem = deque->retry_front;
+		if (*deque_elem != NULL) {
+			deque->retry_front = (*deque_elem)->next;
+		} else {
+			*deque_elem = nccl_ofi_deque_mpsc_pop(deque);
+		}
+		if (*deque_elem != NULL) {
+			__atomic_fetch_sub(&deque->size, 1, __ATOMIC_RELAXED);
+		}
+		return 0;
+	}
+
 	/* Shortcut to avoid taking mutex for empty deque */
 	if (nccl_ofi_deque_isempty(deque)) {
 		*deque_elem = NULL;
@@ -156,6 +307,7 @@ static inline int nccl_ofi_deque_remove_front(nccl_ofi_deque_t *deque, nccl_ofi_
 	*deque_elem = deque->head.next;
 	deque->head.next = (*deque_elem)->next;
 	(*deque_elem)->next->prev = &deque->head;
+	__atomic_store_n(&deque->size, deque->size - 1, __ATOMIC_RELAXED);
 
 unlock:
 	nccl_net_ofi_mutex_unlock(&deque->lock);
@@ -170,6 +322,7 @@ static inline void nccl_ofi_deque_remove(nccl_ofi_deque_t *deque, nccl_ofi_deque
 {
 	assert(deque);
 	assert(deque_elem);
+	assert(deque->mode == NCCL_OFI_DEQUE_MODE_MUTEX);
 
 	nccl_net_ofi_mutex_lock(&deque->lock);
 
@@ -177,6 +330,7 @@ static inline void nccl_ofi_deque_remove(nccl_ofi_deque_t *deque, nccl_ofi_deque
 
 	deque_elem->prev->next = deque_elem->next;
 	deque_elem->next->prev = deque_elem->prev;
+	__atomic_store_n(&deque->size, deque->size - 1, __ATOMIC_RELAXED);
 
 	assert(deque_elem != &deque->head);
 
@@ -193,6 +347,7 @@ static inline void nccl_ofi_deque_remove(nccl_ofi_deque_t *deque, nccl_ofi_deque
 static inline nccl_ofi_deque_elem_t *nccl_ofi_deque_get_front(nccl_ofi_deque_t *deque)
 {
 	assert(deque);
+	assert(deque->mode == NCCL_OFI_DEQUE_MODE_MUTEX);
 
 	nccl_ofi_deque_elem_t *ret_elem = NULL;
 
@@ -215,6 +370,7 @@ static inline nccl_ofi_deque_elem_t *nccl_ofi_deque_get_next(nccl_ofi_deque_t *d
 {
 	assert(deque);
 	assert(deque_elem);
+	assert(deque->mode == NCCL_OFI_DEQUE_MODE_MUTEX);
 
 	nccl_ofi_deque_elem_t *ret_elem = NULL;
 
@@ -230,6 +386,32 @@ static inline nccl_ofi_deque_elem_t *nccl_ofi_deque_get_next(nccl_ofi_deque_t *d
 	return ret_elem;
 }
 
+/*
+ * Start consuming elements of the deque
+ *
+ * In NCCL_OFI_DEQUE_MODE_MPSC, returns false without waiting if
+ * another thread is consuming.  Otherwise, the caller is the consumer
+ * until it calls nccl_ofi_deque_consumer_end().  Always succeeds in
+ * NCCL_OFI_DEQUE_MODE_MUTEX.
+ */
+static inline bool nccl_ofi_deque_consumer_begin(nccl_ofi_deque_t *deque)
+{
+	if (deque->mode != NCCL_OFI_DEQUE_MODE_MPSC) {
+		return true;
+	}
+	return pthread_mutex_trylock(&deque->consumer_lock) == 0;
+}
+
+/*
+ * Stop consuming elements of the deque
+ */
+static inline void nccl_ofi_deque_consumer_end(nccl_ofi_deque_t *deque)
+{
+	if (deque->mode == NCCL_OFI_DEQUE_MODE_MPSC) {
+		nccl_net_ofi_mutex_unlock(&deque->consumer_lock);
+	}
+}
+
 /**
  * Iterate over the deque.
  * 
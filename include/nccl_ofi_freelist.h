@@ -11,6 +11,7 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <pthread.h>
@@ -30,6 +31,23 @@ struct nccl_ofi_freelist_elem_t {
 	struct nccl_ofi_freelist_elem_t *next;
 };
 
+/*
+ * Internal: per-thread cache of freelist elements, used by freelists
+ * in NCCL_OFI_FREELIST_MODE_CACHE.  Only the owning thread accesses
+ * the elements; the freelist pointer is reset when the freelist is
+ * finalized.
+ */
+struct nccl_ofi_freelist_magazine_t {
+	struct nccl_ofi_freelist_t *freelist;
+	struct nccl_ofi_freelist_elem_t *entries;
+	size_t num_entries;
+	/* Linkage in the list of magazines of the freelist */
+	struct nccl_ofi_freelist_magazine_t *fl_prev;
+	struct nccl_ofi_freelist_magazine_t *fl_next;
+	/* Linkage in the list of magazines of the owning thread */
+	struct nccl_ofi_freelist_magazine_t *thread_next;
+};
+
 /*
  * Internal: tracking data for blocks of allocated memory
  */
@@ -101,6 +119,54 @@ static_assert(offsetof(nccl_ofi_freelist_reginfo_t, elem) == 0,
 static_assert(sizeof(nccl_ofi_freelist_reginfo_t) - offsetof(nccl_ofi_freelist_reginfo_t, redzone) == MEMCHECK_REDZONE_SIZE,
 	       "redzone is not the last member of the structure nccl_ofi_freelist_reginfo_t");
 
+/*
+ * Synchronization of freelist allocation and release, selected at
+ * initialization time
+ */
+typedef enum nccl_ofi_freelist_mode {
+	/* Mode selected by the OFI_NCCL_FREELIST_MODE parameter */
+	NCCL_OFI_FREELIST_MODE_DEFAULT = 0,
+	/* Every allocation and release takes the freelist lock */
+	NCCL_OFI_FREELIST_MODE_MUTEX,
+	/* Per-thread magazines in front of the locked list.  Magazines
+	 * are refilled from and flushed to the list in batches, and are
+	 * returned to the list when their thread exits. */
+	NCCL_OFI_FREELIST_MODE_CACHE,
+	/* Lock-free stack with an ABA tag.  The lock is only taken to
+	 * grow the freelist. */
+	NCCL_OFI_FREELIST_MODE_LOCKFREE,
+} nccl_ofi_freelist_mode_t;
+
+/* Internal: number of per-thread magazine slots looked up without a
+ * list walk */
+#define NCCL_OFI_FREELIST_TLS_SLOTS (16)
+
+/*
+ * Internal: the lock-free stack top keeps a tag next to the address of
+ * the top element, which changes on every push and pop, so that a pop
+ * fails if the top element was popped and pushed again after it read
+ * the next element.
+ *
+ * With a 16-byte compare-and-swap, the tag takes the upper 64 bits of
+ * the top and cannot wrap.  Otherwise it takes the 16 bits above the
+ * 48-bit user-space address and wraps after 65536 updates, so a pop
+ * preempted between reading the top and its compare-and-swap for
+ * exactly a multiple of 65536 updates of the stack may still succeed
+ * on a stale next element.
+ */
+#if HAVE_ATOMIC_CAS16
+typedef unsigned __int128 nccl_ofi_freelist_top_t;
+#define NCCL_OFI_FREELIST_TAG_SHIFT (64)
+#define NCCL_OFI_FREELIST_PTR_MASK ((nccl_ofi_freelist_top_t)UINT64_MAX)
+#else
+typedef uint64_t nccl_ofi_freelist_top_t;
+#define NCCL_OFI_FREELIST_TAG_SHIFT (48)
+#define NCCL_OFI_FREELIST_PTR_MASK ((UINT64_C(1) << NCCL_OFI_FREELIST_TAG_SHIFT) - 1)
+#endif
+#define NCCL_OFI_FREELIST_TAG_BITS (sizeof(nccl_ofi_freelist_top_t) * 8 - NCCL_OFI_FREELIST_TAG_SHIFT)
+static_assert(NCCL_OFI_FREELIST_TAG_BITS >= 16, "Lock-free freelist tag is too narrow");
+static_assert(sizeof(void *) <= sizeof(uint64_t), "Lock-free freelist requires 64-bit addresses");
+
 /*
  * Freelist structure
  *
@@ -125,6 +191,28 @@ struct nccl_ofi_freelist_t {
 
 	size_t memcheck_redzone_size;
 
+	/* Placement of block memory */
+	bool huge_pages;
+	int numa_node;
+	size_t page_size;
+
+	nccl_ofi_freelist_mode_t mode;
+
+	/* Tagged top of the stack in NCCL_OFI_FREELIST_MODE_LOCKFREE,
+	 * used instead of entries */
+	nccl_ofi_freelist_top_t lockfree_top;
+
+	/* Magazines in NCCL_OFI_FREELIST_MODE_CACHE */
+	struct nccl_ofi_freelist_magazine_t *magazines;
+	size_t magazine_batch;
+	unsigned int tls_slot;
+
+	/* Freelist the entries are drawn from if this freelist is a
+	 * quota of it (see nccl_ofi_freelist_init_quota()), NULL
+	 * otherwise.  num_allocated_entries then counts the entries in
+	 * use and max_entry_count is the quota. */
+	struct nccl_ofi_freelist_t *parent;
+
 	pthread_mutex_t lock;
 };
 typedef struct nccl_ofi_freelist_t nccl_ofi_freelist_t;
@@ -139,16 +227,25 @@ typedef struct nccl_ofi_freelist_t nccl_ofi_freelist_t;
  *
  * The freelist will allocate initial_entry_count entries in the
  * freelist during initialization.  Any further growth in the freelist
- * will be on-demand in units of increase_entry_count items.
+ * will be on-demand in units of increase_entry_count items.  If
+ * initial_entry_count is 0, no memory is allocated until the first
+ * allocation from the freelist.
  *
  * The freelist will grow until there are at most max_entry_count
  * entries allocated as part of the freelist.  If max_entry_count is
- * 0, the freelist will grow until memory exhaustion.
+ * 0, the freelist will grow until memory exhaustion.  In
+ * NCCL_OFI_FREELIST_MODE_CACHE, entries cached by other threads are
+ * not available for allocation, so allocation may fail before
+ * max_entry_count entries are in use.
+ *
+ * mode selects how allocation and release are synchronized, see
+ * nccl_ofi_freelist_mode_t.
  */
 int nccl_ofi_freelist_init(size_t entry_size,
 			   size_t initial_entry_count,
 			   size_t increase_entry_count,
 			   size_t max_entry_count,
+			   nccl_ofi_freelist_mode_t mode,
 			   nccl_ofi_freelist_t **freelist_p);
 
 /* Initialize "complex" freelist structure
@@ -167,6 +264,12 @@ int nccl_ofi_freelist_init(size_t entry_size,
  * contain the offset (in bytes) from the start of the memory
  * registartion to the start of the returned freelist entry, allowing
  * for use with providers that require 0-based registration accesses.
+ *
+ * If huge_pages is true, blocks are sized in multiples of
+ * NCCL_OFI_HUGE_PAGE_SIZE and backed by huge pages, falling back to
+ * transparent huge pages if none are reserved.  Fewer, larger blocks
+ * also mean fewer memory registrations.  If numa_node is not -1,
+ * block memory is bound to that NUMA node.
  */
 int nccl_ofi_freelist_init_mr(size_t entry_size,
 			      size_t initial_entry_count,
@@ -177,8 +280,24 @@ int nccl_ofi_freelist_init_mr(size_t entry_size,
 			      void *regmr_opaque,
 			      size_t reginfo_offset,
 			      size_t entry_alignment,
+			      bool huge_pages,
+			      int numa_node,
+			      nccl_ofi_freelist_mode_t mode,
 			      nccl_ofi_freelist_t **freelist_p);
 
+/*
+ * Initialize a quota of a freelist
+ *
+ * A quota owns no memory.  Entries are allocated from and released
+ * to the parent freelist, and at most max_entry_count of them can be
+ * in use through the quota at any time, so that users sharing the
+ * parent cannot starve each other.  Entries carry the registration of
+ * the parent, if any.  The parent must outlive the quota.
+ */
+int nccl_ofi_freelist_init_quota(nccl_ofi_freelist_t *parent,
+				 size_t max_entry_count,
+				 nccl_ofi_freelist_t **freelist_p);
+
 /*
  * Finalize (free) a freelist
  *
@@ -194,6 +313,130 @@ int nccl_ofi_freelist_fini(nccl_ofi_freelist_t *freelist);
 int nccl_ofi_freelist_add(nccl_ofi_freelist_t *freelist,
 			  size_t num_entries);
 
+/* Internal: magazine slots of the calling thread */
+extern __thread struct nccl_ofi_freelist_magazine_t *
+	nccl_ofi_freelist_tls_magazines[NCCL_OFI_FREELIST_TLS_SLOTS];
+
+/* Internal function, which finds or creates the magazine of the
+ * calling thread.  Returns NULL if the magazine cannot be allocated. */
+struct nccl_ofi_freelist_magazine_t *nccl_ofi_freelist_magazine_lookup(nccl_ofi_freelist_t *freelist);
+
+/* Internal function, which refills an empty magazine from the freelist
+ * and returns an element for the caller */
+struct nccl_ofi_freelist_elem_t *nccl_ofi_freelist_magazine_refill(nccl_ofi_freelist_t *freelist,
+								   struct nccl_ofi_freelist_magazine_t *magazine);
+
+/* Internal function, which returns a batch of elements of a full
+ * magazine to the freelist */
+void nccl_ofi_freelist_magazine_flush(nccl_ofi_freelist_t *freelist,
+				      struct nccl_ofi_freelist_magazine_t *magazine);
+
+/* Internal function, which grows an empty lock-free freelist and
+ * returns an element for the caller */
+struct nccl_ofi_freelist_elem_t *nccl_ofi_freelist_lockfree_grow(nccl_ofi_freelist_t *freelist);
+
+/*
+ * Internal: read the top of a lock-free freelist.  A 16-byte top is
+ * read with a compare-and-swap that stores the value it read, as
+ * plain 16-byte atomic loads are not lock-free.
+ */
+static inline nccl_ofi_freelist_top_t nccl_ofi_freelist_lockfree_load(nccl_ofi_freelist_t *freelist)
+{
+#if HAVE_ATOMIC_CAS16
+	return __sync_val_compare_and_swap(&freelist->lockfree_top, 0, 0);
+#else
+	return __atomic_load_n(&freelist->lockfree_top, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/*
+ * Internal: replace the top of a lock-free freelist with desired if it
+ * is still *top, or update *top with its current value.  Both cases
+ * have acquire and release semantics.
+ */
+static inline bool nccl_ofi_freelist_lockfree_cas(nccl_ofi_freelist_t *freelist,
+						  nccl_ofi_freelist_top_t *top,
+						  nccl_ofi_freelist_top_t desired)
+{
+#if HAVE_ATOMIC_CAS16
+	nccl_ofi_freelist_top_t prev = __sync_val_compare_and_swap(&freelist->lockfree_top, *top, desired);
+	if (prev == *top) {
+		return true;
+	}
+	*top = prev;
+	return false;
+#else
+	return __atomic_compare_exchange_n(&freelist->lockfree_top, top, desired, true,
+					   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/*
+ * Internal: push the chain of elements from head to tail onto a
+ * lock-free freelist
+ */
+static inline void nccl_ofi_freelist_lockfree_push(nccl_ofi_freelist_t *freelist,
+						   struct nccl_ofi_freelist_elem_t *head,
+						   struct nccl_ofi_freelist_elem_t *tail)
+{
+	nccl_ofi_freelist_top_t top = nccl_ofi_freelist_lockfree_load(freelist);
+	nccl_ofi_freelist_top_t desired;
+
+	assert(((uintptr_t)head & ~NCCL_OFI_FREELIST_PTR_MASK) == 0);
+
+	do {
+		__atomic_store_n(&tail->next,
+				 (struct nccl_ofi_freelist_elem_t *)(uintptr_t)(top & NCCL_OFI_FREELIST_PTR_MASK),
+				 __ATOMIC_RELAXED);
+		desired = (uintptr_t)head |
+			(((top >> NCCL_OFI_FREELIST_TAG_SHIFT) + 1) << NCCL_OFI_FREELIST_TAG_SHIFT);
+	} while (!nccl_ofi_freelist_lockfree_cas(freelist, &top, desired));
+}
+
+/*
+ * Internal: pop an element from a lock-free freelist, or return NULL
+ * if it is empty
+ *
+ * The next pointer of the top element may be read after another
+ * thread popped the element and started writing to it.  Entry memory
+ * is only released at finalization, and the tag makes the
+ * compare-and-swap fail in that case (see NCCL_OFI_FREELIST_TAG_SHIFT).
+ */
+static inline struct nccl_ofi_freelist_elem_t *nccl_ofi_freelist_lockfree_try_pop(nccl_ofi_freelist_t *freelist)
+{
+	nccl_ofi_freelist_top_t top = nccl_ofi_freelist_lockfree_load(freelist);
+	nccl_ofi_freelist_top_t desired;
+	struct nccl_ofi_freelist_elem_t *entry;
+
+	do {
+		entry = (struct nccl_ofi_freelist_elem_t *)(uintptr_t)(top & NCCL_OFI_FREELIST_PTR_MASK);
+		if (!entry) {
+			return NULL;
+		}
+		desired = (uintptr_t)__atomic_load_n(&entry->next, __ATOMIC_RELAXED) |
+			(((top >> NCCL_OFI_FREELIST_TAG_SHIFT) + 1) << NCCL_OFI_FREELIST_TAG_SHIFT);
+	} while (!nccl_ofi_freelist_lockfree_cas(freelist, &top, desired));
+
+	return entry;
+}
+
+/*
+ * Internal: magazine of the calling thread, or NULL if it cannot be
+ * allocated
+ */
+static inline struct nccl_ofi_freelist_magazine_t *nccl_ofi_freelist_get_magazine(nccl_ofi_freelist_t *freelist)
+{
+	struct nccl_ofi_freelist_magazine_t *magazine =
+		nccl_ofi_freelist_tls_magazines[freelist->tls_slot];
+
+	if (OFI_LIKELY(magazine != NULL &&
+		       __atomic_load_n(&magazine->freelist, __ATOMIC_RELAXED) == freelist)) {
+		return magazine;
+	}
+
+	return nccl_ofi_freelist_magazine_lookup(freelist);
+}
+
 /*
  * Set memcheck guards of freelist entry's user data to accessible but undefined
  */
@@ -233,6 +476,71 @@ static inline void nccl_ofi_freelist_entry_set_undefined(nccl_ofi_freelist_t *fr
 	}
 }
 
+/* Internal: allocate an item of a freelist owning its memory */
+static inline void *nccl_ofi_freelist_pool_entry_alloc(nccl_ofi_freelist_t *freelist)
+{
+	int ret;
+	struct nccl_ofi_freelist_elem_t *entry = NULL;
+	struct nccl_ofi_freelist_magazine_t *magazine;
+	void *buf;
+
+	assert(freelist);
+
+	if (freelist->mode == NCCL_OFI_FREELIST_MODE_LOCKFREE) {
+		entry = nccl_ofi_freelist_lockfree_try_pop(freelist);
+		if (OFI_UNLIKELY(!entry)) {
+			entry = nccl_ofi_freelist_lockfree_grow(freelist);
+			if (!entry) {
+				return NULL;
+			}
+		}
+		goto out;
+	}
+
+	if (freelist->mode == NCCL_OFI_FREELIST_MODE_CACHE) {
+		magazine = nccl_ofi_freelist_get_magazine(freelist);
+		if (OFI_LIKELY(magazine != NULL)) {
+			entry = magazine->entries;
+			if (OFI_UNLIKELY(!entry)) {
+				entry = nccl_ofi_freelist_magazine_refill(freelist, magazine);
+				if (!entry) {
+					return NULL;
+				}
+			} else {
+				nccl_net_ofi_mem_defined_unaligned(entry, sizeof(*entry));
+				magazine->entries = entry->next;
+				magazine->num_entries--;
+			}
+			goto out;
+		}
+		/* Fall back to the shared list */
+	}
+
+	nccl_net_ofi_mutex_lock(&freelist->lock);
+
+	if (!freelist->entries) {
+		ret = nccl_ofi_freelist_add(freelist, freelist->increase_entry_count);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Could not extend freelist: %d", ret);
+			nccl_net_ofi_mutex_unlock(&freelist->lock);
+			return NULL;
+		}
+	}
+
+	entry = freelist->entries;
+	nccl_net_ofi_mem_defined_unaligned(entry, sizeof(*entry));
+
+	freelist->entries = entry->next;
+
+	nccl_net_ofi_mutex_unlock(&freelist->lock);
+
+out:
+	buf = entry->ptr;
+	nccl_ofi_freelist_entry_set_undefined(freelist, buf);
+
+	return buf;
+}
+
 /* Allocate a new freelist item
  *
  * Return pointer to memory of size entry_size (provided to init) from
@@ -253,31 +561,24 @@ static inline void nccl_ofi_freelist_entry_set_undefined(nccl_ofi_freelist_t *fr
  */
 static inline void *nccl_ofi_freelist_entry_alloc(nccl_ofi_freelist_t *freelist)
 {
-	int ret;
-	struct nccl_ofi_freelist_elem_t *entry;
-	void *buf = NULL;
+	void *buf;
 
 	assert(freelist);
 
-	nccl_net_ofi_mutex_lock(&freelist->lock);
-
-	if (!freelist->entries) {
-		ret = nccl_ofi_freelist_add(freelist, freelist->increase_entry_count);
-		if (ret != 0) {
-			NCCL_OFI_WARN("Could not extend freelist: %d", ret);
-			goto cleanup;
-		}
+	if (OFI_LIKELY(freelist->parent == NULL)) {
+		return nccl_ofi_freelist_pool_entry_alloc(freelist);
 	}
 
-	entry = freelist->entries;
-	nccl_net_ofi_mem_defined_unaligned(entry, sizeof(*entry));
-
-	freelist->entries = entry->next;
-	buf = entry->ptr;
-	nccl_ofi_freelist_entry_set_undefined(freelist, buf);
+	if (__atomic_fetch_add(&freelist->num_allocated_entries, 1, __ATOMIC_RELAXED) >=
+	    freelist->max_entry_count) {
+		__atomic_fetch_sub(&freelist->num_allocated_entries, 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
 
-cleanup:
-	nccl_net_ofi_mutex_unlock(&freelist->lock);
+	buf = nccl_ofi_freelist_pool_entry_alloc(freelist->parent);
+	if (OFI_UNLIKELY(!buf)) {
+		__atomic_fetch_sub(&freelist->num_allocated_entries, 1, __ATOMIC_RELAXED);
+	}
 
 	return buf;
 }
@@ -292,12 +593,17 @@ cleanup:
 static inline void nccl_ofi_freelist_entry_free(nccl_ofi_freelist_t *freelist, void *entry_p)
 {
 	struct nccl_ofi_freelist_elem_t *entry;
-	size_t user_entry_size = freelist->entry_size - MEMCHECK_REDZONE_SIZE;
+	struct nccl_ofi_freelist_magazine_t *magazine;
+	size_t user_entry_size;
 
 	assert(freelist);
 	assert(entry_p);
 
-	nccl_net_ofi_mutex_lock(&freelist->lock);
+	if (OFI_UNLIKELY(freelist->parent != NULL)) {
+		__atomic_fetch_sub(&freelist->num_allocated_entries, 1, __ATOMIC_RELAXED);
+		freelist = freelist->parent;
+	}
+	user_entry_size = freelist->entry_size - MEMCHECK_REDZONE_SIZE;
 
 	if (freelist->have_reginfo) {
 		entry = (struct nccl_ofi_freelist_elem_t *)((uintptr_t)entry_p + freelist->reginfo_offset);
@@ -307,6 +613,31 @@ static inline void nccl_ofi_freelist_entry_free(nccl_ofi_freelist_t *freelist, v
 		entry->ptr = (void *)entry;
 	}
 
+	if (freelist->mode == NCCL_OFI_FREELIST_MODE_LOCKFREE) {
+		nccl_net_ofi_mem_noaccess(entry_p, user_entry_size);
+		nccl_ofi_freelist_lockfree_push(freelist, entry, entry);
+		return;
+	}
+
+	if (freelist->mode == NCCL_OFI_FREELIST_MODE_CACHE) {
+		magazine = nccl_ofi_freelist_get_magazine(freelist);
+		if (OFI_LIKELY(magazine != NULL)) {
+			entry->next = magazine->entries;
+			magazine->entries = entry;
+			magazine->num_entries++;
+
+			nccl_net_ofi_mem_noaccess(entry_p, user_entry_size);
+
+			if (OFI_UNLIKELY(magazine->num_entries > 2 * freelist->magazine_batch)) {
+				nccl_ofi_freelist_magazine_flush(freelist, magazine);
+			}
+			return;
+		}
+		/* Fall back to the shared list */
+	}
+
+	nccl_net_ofi_mutex_lock(&freelist->lock);
+
 	entry->next = freelist->entries;
 	freelist->entries = entry;
 
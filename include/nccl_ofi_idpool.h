@@ -11,10 +11,42 @@ extern "C" {
 #endif
 
 #include <pthread.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+/*
+ * Maximum number of levels of the ID pool bitmap, enough for 2^36 IDs
+ */
+#define NCCL_OFI_IDPOOL_MAX_LEVELS (6)
+
+/*
+ * Synchronization of ID allocation and release, selected at
+ * initialization time
+ */
+typedef enum nccl_ofi_idpool_mode {
+	/* Mode selected by the OFI_NCCL_IDPOOL_MODE parameter */
+	NCCL_OFI_IDPOOL_MODE_DEFAULT = 0,
+	/* Every allocation and release takes the ID pool lock */
+	NCCL_OFI_IDPOOL_MODE_MUTEX,
+	/* IDs are claimed and returned with atomic operations on the
+	 * bitmap words, without taking the lock */
+	NCCL_OFI_IDPOOL_MODE_LOCKFREE,
+} nccl_ofi_idpool_mode_t;
+
 /*
  * Pool of IDs, used to keep track of communicator IDs and MR keys.
+ *
+ * Available IDs are tracked in a hierarchical bitmap. The bottom level
+ * (`ids') has one bit per ID. Each word of an upper level summarizes
+ * 64 words of the level below, with a bit set if the word below has
+ * any bit set, up to a single word at the top. Allocation walks down
+ * from the top word to the lowest available ID, and release sets the
+ * summary bits of words that were empty, so both take a number of
+ * steps bounded by the number of levels.
+ *
+ * In NCCL_OFI_IDPOOL_MODE_LOCKFREE, the bits of the bottom level are
+ * claimed with compare-and-swap and summary bits are hints that are
+ * repaired when found stale.
  */
 typedef struct nccl_ofi_idpool {
 	/* Size of the id pool (number of IDs) */
@@ -24,6 +56,13 @@ typedef struct nccl_ofi_idpool {
 	   that the ID corresponding to its index is available.*/
 	uint64_t *ids;
 
+	/* Bitmap levels, levels[0] is `ids' and levels[num_levels - 1]
+	   is a single word. All levels share the allocation of `ids'. */
+	uint64_t *levels[NCCL_OFI_IDPOOL_MAX_LEVELS];
+	int num_levels;
+
+	nccl_ofi_idpool_mode_t mode;
+
 	/* Lock for concurrency */
 	pthread_mutex_t lock;
 } nccl_ofi_idpool_t;
@@ -32,7 +71,8 @@ typedef struct nccl_ofi_idpool {
  * @brief	Initialize pool of IDs
  *
  * Allocates and initializes a nccl_ofi_idpool_t object, marking all
- * IDs as available.
+ * IDs as available. Same as nccl_ofi_idpool_init_mode() with
+ * NCCL_OFI_IDPOOL_MODE_DEFAULT.
  *
  * @param	idpool_p
  *		Return value with the ID pool pointer allocated
@@ -43,14 +83,30 @@ typedef struct nccl_ofi_idpool {
  */
 int nccl_ofi_idpool_init(nccl_ofi_idpool_t *idpool, size_t size);
 
+/*
+ * @brief	Initialize pool of IDs with the given synchronization mode
+ *
+ * @param	idpool
+ *		The ID pool
+ * @param	size
+ *		Size of the id pool (number of IDs)
+ * @param	mode
+ *		Synchronization of allocation and release
+ * @return	0 on success
+ *		non-zero on error
+ */
+int nccl_ofi_idpool_init_mode(nccl_ofi_idpool_t *idpool, size_t size,
+			      nccl_ofi_idpool_mode_t mode);
+
 /*
  * @brief	Allocate an ID
  *
  * Extract an available ID from the ID pool, mark the ID as
  * unavailable in the pool, and return extracted ID. No-op in case
- * no ID was available.
+ * no ID was available. The lowest available ID is returned.
  *
- * This operation is locked by the ID pool's internal lock.
+ * This operation is locked by the ID pool's internal lock, except in
+ * NCCL_OFI_IDPOOL_MODE_LOCKFREE.
  *
  * @param	idpool
  *		The ID pool
@@ -64,7 +120,8 @@ int nccl_ofi_idpool_allocate_id(nccl_ofi_idpool_t *idpool);
  *
  * Return input ID into the pool.
  *
- * This operation is locked by the ID pool's internal lock.
+ * This operation is locked by the ID pool's internal lock, except in
+ * NCCL_OFI_IDPOOL_MODE_LOCKFREE.
  *
  * @param	idpool
  *		The ID pool
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#ifndef NCCL_OFI_MEMCPY_H_
+#define NCCL_OFI_MEMCPY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * CPU copy routines for copying received data into host memory.
+ *
+ * Copies of at least a threshold size use non-temporal stores, which
+ * bypass the cache so that a large copy does not evict the working set
+ * of the application. The widest instruction set supported by the CPU
+ * (AVX-512, then AVX2) is selected at runtime. On other CPUs, or if
+ * neither is supported, memcpy() is used.
+ */
+
+/* Instruction sets of non-temporal copies */
+typedef enum nccl_ofi_memcpy_isa {
+	NCCL_OFI_MEMCPY_ISA_NONE = 0,
+	NCCL_OFI_MEMCPY_ISA_AVX2,
+	NCCL_OFI_MEMCPY_ISA_AVX512,
+} nccl_ofi_memcpy_isa_t;
+
+/*
+ * @brief	Return the widest instruction set supported by the CPU for
+ *		non-temporal copies
+ */
+nccl_ofi_memcpy_isa_t nccl_ofi_memcpy_nt_isa(void);
+
+/*
+ * @brief	Copy `len' bytes from `src' to `dst' with non-temporal
+ *		stores of the given instruction set
+ *
+ * Buffers may have any alignment but must not overlap. The instruction
+ * set must be supported by the CPU; NCCL_OFI_MEMCPY_ISA_NONE copies
+ * with memcpy().
+ */
+void nccl_ofi_memcpy_nt_isa_copy(nccl_ofi_memcpy_isa_t isa, void *dst, const void *src, size_t len);
+
+/*
+ * @brief	Copy `len' bytes from `src' to `dst' with non-temporal
+ *		stores of the widest instruction set supported by the CPU
+ */
+void nccl_ofi_memcpy_nt(void *dst, const void *src, size_t len);
+
+/*
+ * @brief	Copy `len' bytes from `src' to `dst', using non-temporal
+ *		stores if `len' is at least `nt_threshold'
+ */
+static inline void nccl_ofi_memcpy(void *dst, const void *src, size_t len, size_t nt_threshold)
+{
+	if (len >= nt_threshold) {
+		nccl_ofi_memcpy_nt(dst, src, len);
+	} else {
+		memcpy(dst, src, len);
+	}
+}
+
+#ifdef __cplusplus
+} // End extern "C"
+#endif
+
+#endif // End NCCL_OFI_MEMCPY_H_
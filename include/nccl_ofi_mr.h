@@ -19,6 +19,7 @@ extern "C" {
 #include <sys/uio.h>
 
 #include <rdma/fi_domain.h>
+#include <uthash/uthash.h>
 
 enum nccl_ofi_mr_ckey_type {
 	NCCL_OFI_MR_CKEY_INVALID = 0,
@@ -137,30 +138,99 @@ static inline void nccl_ofi_mr_ckey_fill_mr_attrs(nccl_ofi_mr_ckey_ref ckey, str
 
 /**
  * A memory registration cache entry
+ *
+ * Entries are nodes of an AVL tree ordered by start address. Each node
+ * is augmented with the largest end address found in its subtree, so
+ * that a registration covering a given range can be found in
+ * logarithmic time even when registrations overlap.
+ *
+ * Entries are never returned to the system while the cache exists, so
+ * lock-free lookups may safely read an entry that is concurrently
+ * removed or reused. The reference count and a generation number
+ * share one 64-bit word; a lookup takes its reference with a
+ * compare-and-swap on that word, which fails if the entry was removed
+ * or reused since the lookup validated it.
  */
 typedef struct nccl_ofi_reg_entry {
 	uintptr_t addr;
 	size_t pages;
-	int refcnt;
+	/* Generation in the upper 32 bits, reference count in the lower 32 bits */
+	uint64_t refs;
 	void *handle;
+	/* Identity of the registered allocation, 0 if it cannot be retained */
+	uint64_t alloc_id;
+
+	/* Interval tree linkage */
+	struct nccl_ofi_reg_entry *left;
+	struct nccl_ofi_reg_entry *right;
+	/* Largest end address (exclusive) of any entry in this subtree */
+	uintptr_t subtree_end;
+	int height;
+
+	/* Reverse index from MR handle to entry */
+	UT_hash_handle hh;
+
+	/* Linkage of retained unused entries, most recently used first */
+	struct nccl_ofi_reg_entry *lru_prev;
+	struct nccl_ofi_reg_entry *lru_next;
 } nccl_ofi_reg_entry_t;
 
+/* Internal: block of preallocated cache entries */
+struct nccl_ofi_reg_entry_block;
+
+/**
+ * Function called to deregister a retained registration evicted from
+ * the cache. It is called with the cache lock held.
+ */
+typedef int (*nccl_ofi_mr_cache_dereg_fn)(void *opaque, void *handle);
+
+/**
+ * Function returning an identifier of the allocation containing addr,
+ * which must change when the memory is freed and another allocation is
+ * placed at the same address, or 0 if the allocation cannot be
+ * identified. It is called with the cache lock held.
+ */
+typedef uint64_t (*nccl_ofi_mr_cache_alloc_id_fn)(void *opaque, uintptr_t addr);
+
 /**
  * Device-specific memory registration cache.
  */
 typedef struct nccl_ofi_mr_cache {
-	nccl_ofi_reg_entry_t **slots;
+	/* Root of the interval tree of registered entries */
+	nccl_ofi_reg_entry_t *root;
+	/* uthash table of entries keyed by MR handle */
+	nccl_ofi_reg_entry_t *handle_index;
+	/* Unused entries, linked through their left pointer */
+	nccl_ofi_reg_entry_t *free_entries;
+	struct nccl_ofi_reg_entry_block *blocks;
 	size_t system_page_size;
 	size_t size;
 	size_t used;
+	/* Updated atomically, as hits do not require the lock */
 	uint32_t hit_count;
 	uint32_t miss_count;
+	uint32_t eviction_count;
+
+	/* Retention of unused registrations, disabled if dereg_fn is NULL */
+	nccl_ofi_mr_cache_dereg_fn dereg_fn;
+	nccl_ofi_mr_cache_alloc_id_fn alloc_id_fn;
+	void *dereg_opaque;
+	/* Limits on retained entries and bytes, 0 if unlimited */
+	size_t max_unused_entries;
+	size_t max_unused_bytes;
+	/* Retained entries with a reference count of zero */
+	nccl_ofi_reg_entry_t *lru;
+	size_t unused_entries;
+	size_t unused_bytes;
+
+	/* Serializes nccl_ofi_mr_cache_lookup_entry, insertion and deletion */
 	pthread_mutex_t lock;
 } nccl_ofi_mr_cache_t;
 
 /**
  * Create a new mr cache. Both then initial number of entries and the system
- * page size must be greater than zero.
+ * page size must be greater than zero. Entries are preallocated in blocks;
+ * once the initial entries are used, the number of entries is doubled.
  * @return a new mr cache, or NULL if an allocation error occurred
  */
 nccl_ofi_mr_cache_t *nccl_ofi_mr_cache_init(size_t init_num_entries,
@@ -168,20 +238,71 @@ nccl_ofi_mr_cache_t *nccl_ofi_mr_cache_init(size_t init_num_entries,
 
 /**
  * Finalize mr cache
+ *
+ * Retained registrations must have been released with
+ * nccl_ofi_mr_cache_flush() before.
  */
 void nccl_ofi_mr_cache_finalize(nccl_ofi_mr_cache_t *cache);
 
+/**
+ * Retain registrations whose reference count drops to zero instead of
+ * deleting them, so that registering the same buffer again is a cache
+ * hit. Retained registrations are evicted in least-recently-used order
+ * once there are more than max_entries of them or they cover more than
+ * max_bytes, and dereg_fn is called on the handle of each evicted
+ * registration. A limit of zero is not enforced.
+ *
+ * Since registrations are looked up by address, alloc_id_fn identifies
+ * the allocation behind a registration when it is inserted and again
+ * before it is revived. A retained registration whose memory was freed
+ * and reallocated is evicted instead of returned, and registrations whose
+ * allocation cannot be identified are not retained. dereg_fn and
+ * alloc_id_fn are both called with dereg_opaque.
+ *
+ * Must be called before the first insertion.
+ */
+void nccl_ofi_mr_cache_set_retention(nccl_ofi_mr_cache_t *cache,
+				     size_t max_entries,
+				     size_t max_bytes,
+				     nccl_ofi_mr_cache_dereg_fn dereg_fn,
+				     nccl_ofi_mr_cache_alloc_id_fn alloc_id_fn,
+				     void *dereg_opaque);
+
+/**
+ * Evict all retained registrations, calling the deregistration function
+ * on each of them. The caller must hold the cache lock.
+ */
+void nccl_ofi_mr_cache_flush(nccl_ofi_mr_cache_t *cache);
+
 /**
  * Lookup a cache entry matching the given address and size
  * Input addr and size are rounded up to enclosing page boundaries.
  * If entry is found, refcnt is increased
+ *
+ * The caller must hold the cache lock.
+ *
  * @return mr handle if found, or NULL if not found
  */
 void *nccl_ofi_mr_cache_lookup_entry(nccl_ofi_mr_cache_t *cache, nccl_ofi_mr_ckey_ref ckey);
 
+/**
+ * Lookup a cache entry matching the given address and size without
+ * taking the cache lock. Concurrent hits do not block each other.
+ * If entry is found, refcnt is increased
+ *
+ * A concurrent insertion or deletion may cause a matching entry to be
+ * missed, so a NULL return is not authoritative: callers must retry
+ * with nccl_ofi_mr_cache_lookup_entry() under the cache lock before
+ * inserting a new entry.
+ *
+ * @return mr handle if found, or NULL if not found
+ */
+void *nccl_ofi_mr_cache_try_lookup_entry(nccl_ofi_mr_cache_t *cache, nccl_ofi_mr_ckey_ref ckey);
+
 /**
  * Insert a new cache entry with the given address and size
  * Input addr and size are rounded up to enclosing page boundaries.
+ * The caller must hold the cache lock.
  * @return 0, on success
  *	   -ENOMEM, on allocation failure
  *	   -EEXIST, if matching entry already exists in cache
@@ -192,6 +313,11 @@ int nccl_ofi_mr_cache_insert_entry(nccl_ofi_mr_cache_t *cache, nccl_ofi_mr_ckey_
  * Decrement refcnt of entry with given handle. If refcnt was reduced to 0,
  * delete entry from cache. Return value indicates whether entry was deleted
  * from cache (in which case, caller should deregister the handle).
+ * The caller must hold the cache lock.
+ *
+ * If retention is enabled, an entry whose refcnt was reduced to 0 is kept
+ * in the cache, unless it alone exceeds the byte limit, and retained
+ * entries evicted to respect the limits are deregistered by the cache.
  *
  * @return 0, on success, and reg was not deleted (refcnt not zero)
  *	   1, on success, and reg was deleted (refcnt was zero)
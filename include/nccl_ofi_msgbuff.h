@@ -182,6 +182,21 @@ nccl_ofi_msgbuff_result_t nccl_ofi_msgbuff_retrieve(nccl_ofi_msgbuff_t *msgbuff,
 nccl_ofi_msgbuff_result_t nccl_ofi_msgbuff_complete(nccl_ofi_msgbuff_t *msgbuff,
 		uint16_t msg_index, nccl_ofi_msgbuff_status_t *msg_idx_status);
 
+/**
+ * Remove the element of an in-progress message that was not started after
+ * all, e.g. because posting it failed after insertion. The message becomes
+ * not started again and its index can be inserted anew.
+ *
+ * @param msg_idx_status, output: message status, if return value is INVALID_IDX
+ *
+ * @return
+ *  NCCL_OFI_MSGBUFF_SUCCESS, success
+ *  NCCL_OFI_MSGBUFF_INVALID_IDX, invalid index. See msg_idx_status.
+ *  NCCL_OFI_MSGBUFF_ERROR, other error
+ */
+nccl_ofi_msgbuff_result_t nccl_ofi_msgbuff_remove(nccl_ofi_msgbuff_t *msgbuff,
+		uint16_t msg_index, nccl_ofi_msgbuff_status_t *msg_idx_status);
+
 #ifdef __cplusplus
 } // End extern "C"
 #endif
@@ -224,12 +224,68 @@ OFI_NCCL_PARAM_INT(mr_cache_disable, "MR_CACHE_DISABLE",
 #endif
 		);
 
+/*
+ * Maximum number of unused registrations kept in the MR cache after their
+ * last user deregistered them, so that re-registering the same buffer does
+ * not go to the device again. Least recently used registrations are
+ * deregistered first when the budget is exceeded. 0 disables the entry
+ * budget. Retention is disabled unless one of the budgets is non-zero, and
+ * is only supported by the RDMA protocol with per-process domains.
+ *
+ * Only CUDA buffers are retained. A retained registration is reused only
+ * if the CUDA buffer ID of the memory is still the one that was
+ * registered, so registrations of freed and reallocated buffers are
+ * deregistered instead of reused. Host buffers have no such identity and
+ * are deregistered as soon as they are unused.
+ */
+OFI_NCCL_PARAM_UINT(mr_cache_max_unused_entries, "MR_CACHE_MAX_UNUSED_ENTRIES", 0);
+
+/*
+ * Maximum number of bytes covered by unused registrations kept in the MR
+ * cache. 0 disables the byte budget. Enables retention as described for
+ * MR_CACHE_MAX_UNUSED_ENTRIES.
+ */
+OFI_NCCL_PARAM_UINT(mr_cache_max_unused_bytes, "MR_CACHE_MAX_UNUSED_BYTES", 0);
+
+/*
+ * Synchronization of freelists that do not request a specific mode.
+ * Valid options are "mutex" (every allocation and release takes the
+ * freelist lock), "cache" (per-thread magazines refilled from and
+ * flushed to the locked freelist in batches) and "lockfree" (lock-free
+ * stack, the lock is only taken to grow the freelist).
+ */
+OFI_NCCL_PARAM_STR(freelist_mode, "FREELIST_MODE", "mutex");
+
+/*
+ * Synchronization of ID pools (communicator IDs and MR keys). Valid
+ * options are "mutex" (every allocation and release takes the pool
+ * lock) and "lockfree" (IDs are claimed and returned with atomic
+ * operations on the pool bitmap).
+ */
+OFI_NCCL_PARAM_STR(idpool_mode, "IDPOOL_MODE", "mutex");
+
 /*
  * Maximum number of cq entries to read in a single call to
  * fi_cq_read.
  */
 OFI_NCCL_PARAM_INT(cq_read_count, "CQ_READ_COUNT", 4);
 
+/*
+ * Upper bound of the number of cq entries read in a single call to
+ * fi_cq_read by the RDMA protocol. The number of entries read grows
+ * from CQ_READ_COUNT up to this bound while the completion queue keeps
+ * returning full batches, and shrinks back when it is found empty.
+ * Setting it to CQ_READ_COUNT disables adaptation.
+ */
+OFI_NCCL_PARAM_INT(cq_read_count_max, "CQ_READ_COUNT_MAX", 64);
+
+/*
+ * Maximum number of completions the RDMA protocol processes from the
+ * completion queue of a rail in one progress call, so that a busy rail
+ * does not delay progress of other rails. 0 disables the limit.
+ */
+OFI_NCCL_PARAM_INT(cq_poll_budget, "CQ_POLL_BUDGET", 256);
+
 /*
  * Protocol to use for send/recv operations.  Valid options are
  * SENDRECV and RDMA, with SENDRECV the default.  Default param is
@@ -287,18 +343,181 @@ OFI_NCCL_PARAM_INT(disable_dmabuf, "DISABLE_DMABUF", 0);
 OFI_NCCL_PARAM_UINT(min_stripe_size, "MIN_STRIPE_SIZE", (128 * 1024));
 
 /*
- * Minimum bounce buffers posted per endpoint. The plugin will attempt to post
- * more bounce buffers if we dip below this threshold, allocating new bounce
- * buffers if needed.
+ * Scheduler used to assign messages to rails. Valid values are
+ * "threshold", which stripes messages larger than MIN_STRIPE_SIZE
+ * evenly across rails, and "adaptive", which sizes stripes by the
+ * outstanding bytes and observed completion latency of each rail.
+ */
+OFI_NCCL_PARAM_STR(scheduler, "SCHEDULER", "threshold");
+
+/*
+ * Minimum eager bounce buffers posted per endpoint, spread over the data
+ * rails. Eager bounce buffers are EAGER_MAX_SIZE bytes and only receive
+ * eager messages. The plugin will attempt to post more bounce buffers if
+ * we dip below this threshold, allocating new bounce buffers if needed.
+ */
+OFI_NCCL_PARAM_INT(rdma_min_posted_bounce_buffers, "RDMA_MIN_POSTED_BOUNCE_BUFFERS", 16);
+
+/*
+ * Maximum eager bounce buffers posted per endpoint, spread over the data
+ * rails. The plugin will not attempt to post more bounce buffers if we
+ * reach this threshold, returning available buffers to the free list if
+ * needed
+ */
+OFI_NCCL_PARAM_INT(rdma_max_posted_bounce_buffers, "RDMA_MAX_POSTED_BOUNCE_BUFFERS", 32);
+
+/*
+ * Minimum control bounce buffers posted per endpoint, spread over the
+ * control rails. Control bounce buffers are sized for the largest of the
+ * connect, control and close messages, which arrive on the control rails.
+ */
+OFI_NCCL_PARAM_INT(rdma_min_posted_control_buffers, "RDMA_MIN_POSTED_CONTROL_BUFFERS", 128);
+
+/*
+ * Maximum control bounce buffers posted per endpoint, spread over the
+ * control rails.
+ */
+OFI_NCCL_PARAM_INT(rdma_max_posted_control_buffers, "RDMA_MAX_POSTED_CONTROL_BUFFERS", 256);
+
+/*
+ * Maximum number of control messages a receive communicator coalesces
+ * into a single message to the sender, up to 16. Control messages of
+ * receives posted back to back are batched until the batch is full or
+ * one of the receives is tested. 1 disables batching.
+ */
+OFI_NCCL_PARAM_INT(ctrl_batch_max, "CTRL_BATCH_MAX", 1);
+
+/*
+ * Microseconds a batch of control messages may wait for more messages
+ * when a receive of the batch is tested. 0 sends the batch at the first
+ * test.
+ */
+OFI_NCCL_PARAM_UINT(ctrl_batch_timeout, "CTRL_BATCH_TIMEOUT", 0);
+
+/*
+ * Number of receive buffer registrations whose MR keys the receiver
+ * caches at the sender. Control messages advertising a buffer of a
+ * cached registration carry a reference to the cache slot instead of
+ * one key per rail, which keeps them within the inline size of
+ * multi-rail configurations. 0 disables the cache. The maximum is 64.
+ */
+OFI_NCCL_PARAM_INT(rdma_rkey_cache_size, "RDMA_RKEY_CACHE_SIZE", 0);
+
+/*
+ * Maximum number of buffers of a grouped receive of the RDMA protocol
+ * (maxRecvs property). Buffers of a group are advertised to the sender
+ * in a single control message and matched to sends by tag. Above 1,
+ * sends wait for the control message of the receiver, so eager sends
+ * and the pull rendezvous are not used. The maximum is 8.
+ */
+OFI_NCCL_PARAM_INT(rdma_max_recvs, "RDMA_MAX_RECVS", 1);
+
+/*
+ * Maximum number of inflight requests of a communicator of the RDMA
+ * protocol. Deeper windows keep more small messages in flight on high
+ * latency paths. The value may not be lower than 128 nor higher than
+ * 2^(RDMA_SEQ_BITS - 3), which is 128 with the default of 10 bits, so
+ * raising it requires configuring with a larger RDMA_SEQ_BITS, e.g. 13
+ * for 1024 requests.
+ */
+OFI_NCCL_PARAM_INT(rdma_max_inflight_reqs, "RDMA_MAX_INFLIGHT_REQS", 128);
+
+/*
+ * Post eager sends and RDMA write stripes of host buffers that fit the
+ * inject size of the provider with fi_injectdata and
+ * fi_inject_writedata. Such sends complete without a send completion.
+ */
+OFI_NCCL_PARAM_INT(rdma_inject, "RDMA_INJECT", 1);
+
+/*
+ * Draw requests and control buffers of RDMA communicators from free
+ * lists shared by all communicators of an endpoint, with a quota per
+ * communicator, instead of allocating and registering free lists per
+ * communicator. Bounds memory and memory registrations of jobs with
+ * many peers.
+ */
+OFI_NCCL_PARAM_INT(rdma_shared_comm_pools, "RDMA_SHARED_COMM_POOLS", 1);
+
+/*
+ * Milliseconds after which the flush buffer of a receive communicator
+ * that issued no flush is deregistered and released, when the
+ * communicator has no inflight requests. The buffer is allocated again
+ * by the next flush. 0 keeps flush buffers until the communicator is
+ * closed.
+ */
+OFI_NCCL_PARAM_UINT(rdma_flush_buff_idle_timeout, "RDMA_FLUSH_BUFF_IDLE_TIMEOUT", 0);
+
+/*
+ * Synchronization of the queue of requests of an RDMA endpoint waiting
+ * to be retried after the provider returned EAGAIN. Valid options are
+ * "mutex" (every insertion and removal takes the queue lock) and
+ * "mpsc" (lock-free insertion; the thread retrying the requests
+ * removes them without locking and puts a request that fails again
+ * back at the front).
+ */
+OFI_NCCL_PARAM_STR(rdma_pending_queue_mode, "RDMA_PENDING_QUEUE_MODE", "mutex");
+
+/*
+ * Post bounce buffers as a few large multi-receive slabs (FI_MULTI_RECV)
+ * instead of one receive per buffer, if the provider supports it. The
+ * provider packs incoming control and eager messages into the slabs, and
+ * a slab is reposted once it is full and all its messages are consumed.
+ * Replaces the control and eager bounce buffer settings above.
+ */
+OFI_NCCL_PARAM_INT(rdma_multi_recv, "RDMA_MULTI_RECV", 0);
+
+/*
+ * Size of multi-receive slabs. Must hold at least two of the largest
+ * messages received into them.
+ */
+OFI_NCCL_PARAM_UINT(rdma_multi_recv_slab_size, "RDMA_MULTI_RECV_SLAB_SIZE", 256 * 1024);
+
+/*
+ * Maximum multi-receive slabs posted per rail. More slabs are posted
+ * once fewer than half of them remain posted, e.g. when the messages of
+ * released slabs are still in use.
  */
-OFI_NCCL_PARAM_INT(rdma_min_posted_bounce_buffers, "RDMA_MIN_POSTED_BOUNCE_BUFFERS", 64);
+OFI_NCCL_PARAM_INT(rdma_multi_recv_slabs, "RDMA_MULTI_RECV_SLABS", 4);
 
 /*
- * Maximum bounce buffers posted per endpoint. The plugin will not attempt to
- * post more bounce buffers if we reach this threshold, returning available
- * buffers to the free list if needed
+ * Back the bounce buffer pool of each endpoint with 2MB huge pages,
+ * reducing TLB misses and the number of memory registrations. Falls
+ * back to transparent huge pages if no huge pages are reserved.
  */
-OFI_NCCL_PARAM_INT(rdma_max_posted_bounce_buffers, "RDMA_MAX_POSTED_BOUNCE_BUFFERS", 128);
+OFI_NCCL_PARAM_INT(rdma_bounce_huge_pages, "RDMA_BOUNCE_HUGE_PAGES", 0);
+
+/*
+ * Bind bounce and control buffer pools to the NUMA node closest to the
+ * NIC, instead of the node of the thread that first touches them. If the
+ * NUMA node of the NIC cannot be determined, pools are left unbound.
+ */
+OFI_NCCL_PARAM_INT(rdma_numa_bind, "RDMA_NUMA_BIND", 0);
+
+/*
+ * Run a background progress thread per RDMA endpoint. The thread
+ * drains the completion queues, reposts bounce buffers and retries
+ * pending requests, so that the network progresses while NCCL does not
+ * call into the plugin. test() then only checks request state.
+ */
+OFI_NCCL_PARAM_INT(progress_thread, "PROGRESS_THREAD", 0);
+
+/*
+ * Number of consecutive polls without completions or pending requests
+ * after which the progress thread starts sleeping between polls.
+ */
+OFI_NCCL_PARAM_UINT(progress_thread_spin_count, "PROGRESS_THREAD_SPIN_COUNT", 1000);
+
+/*
+ * Time in microseconds an idle progress thread sleeps between polls.
+ * 0 makes the progress thread busy-poll.
+ */
+OFI_NCCL_PARAM_UINT(progress_thread_sleep_us, "PROGRESS_THREAD_SLEEP_US", 20);
+
+/*
+ * Pin progress threads to the CPUs local to the NIC of their endpoint.
+ * Threads are left unpinned if those CPUs cannot be determined.
+ */
+OFI_NCCL_PARAM_INT(progress_thread_pin, "PROGRESS_THREAD_PIN", 1);
 
 /*
  * Whether to spread the control message across multiple rails in round robin fashion or
@@ -318,6 +537,49 @@ OFI_NCCL_PARAM_INT(net_latency, "NET_LATENCY", -1);
  */
 OFI_NCCL_PARAM_UINT(eager_max_size, "EAGER_MAX_SIZE", 8192);
 
+/*
+ * Enable the receiver-pull rendezvous of the RDMA protocol. When send()
+ * is called before the receiver's control message arrived, the sender
+ * advertises its buffer and the receiver reads the data with RDMA reads
+ * striped across rails, instead of the sender waiting for the control
+ * message to write it. If the receiver posted first, data is written by
+ * the sender as usual. Host send buffers are registered for remote read
+ * when enabled.
+ */
+OFI_NCCL_PARAM_INT(pull_rendezvous, "PULL_RENDEZVOUS", 0);
+
+/*
+ * Size of the chunks RDMA write stripes of the RDMA protocol are cut
+ * into. Chunks of a stripe are pipelined on its rail, so that large
+ * stripes keep the NIC queue fed and never exceed the provider's
+ * maximum message size. Stripes are also cut at the provider's
+ * maximum message size when 0 (the default) is set.
+ */
+OFI_NCCL_PARAM_UINT(write_chunk_size, "WRITE_CHUNK_SIZE", 0);
+
+/*
+ * Maximum number of chunks of a stripe in flight on its rail. See
+ * OFI_NCCL_WRITE_CHUNK_SIZE.
+ */
+OFI_NCCL_PARAM_INT(write_chunk_window, "WRITE_CHUNK_WINDOW", 8);
+
+/*
+ * Copy eager messages of the RDMA protocol from the bounce buffer into
+ * host-memory receive buffers with the CPU, instead of with a local
+ * RDMA read. The receive completes, and the bounce buffer is reposted,
+ * as soon as the message and the receive buffer are both available.
+ */
+OFI_NCCL_PARAM_INT(eager_cpu_copy, "EAGER_CPU_COPY", 1);
+
+/*
+ * CPU copies of at least this size use non-temporal stores, which do
+ * not pollute the cache. See OFI_NCCL_EAGER_CPU_COPY. Only eager
+ * messages are copied, so this only takes effect if EAGER_MAX_SIZE is
+ * raised to at least this size. Smaller copies are left to regular
+ * stores, since the receiver usually reads the data right away.
+ */
+OFI_NCCL_PARAM_UINT(cpu_copy_nt_threshold, "CPU_COPY_NT_THRESHOLD", (64 * 1024));
+
 /*
  * Decide whether or not mutexes should default to errorcheck mode.
  * Defaults to no, unless debugging is enabled, in which case it
@@ -386,6 +648,26 @@ OFI_NCCL_PARAM_INT(tuner_net_comp_overhead, "TUNER_NET_COMP_OVERHEAD", 3);
  */
 OFI_NCCL_PARAM_INT(use_low_lat_tc, "USE_LOW_LATENCY_TC", 1);
 
+/*
+ * File the statistics counters are appended to when dumped. If unset,
+ * dumps are written to stderr.
+ */
+OFI_NCCL_PARAM_STR(stats_file, "STATS_FILE", NULL);
+
+/*
+ * Signal number which triggers a dump of the statistics counters
+ * (e.g. 12 for SIGUSR2). The dump is written by the next thread
+ * progressing the network. 0 disables the handler.
+ */
+OFI_NCCL_PARAM_INT(stats_signal, "STATS_SIGNAL", 0);
+
+/*
+ * Dump the statistics counters when the plugin is finalized, and
+ * dump the counters of communicators and endpoints as they are
+ * closed.
+ */
+OFI_NCCL_PARAM_INT(stats_dump_at_fini, "STATS_DUMP_AT_FINI", 0);
+
 #ifdef __cplusplus
 } // End extern "C"
 #endif
@@ -22,6 +22,7 @@ extern "C" {
 #include "nccl_ofi_freelist.h"
 #include "nccl_ofi_idpool.h"
 #include "nccl_ofi_ep_addr_list.h"
+#include "nccl_ofi_stats.h"
 #if HAVE_NVTX_TRACING
 #include <nvtx3/nvToolsExt.h>
 #endif
@@ -34,11 +35,6 @@ extern "C" {
 
 #define NCCL_OFI_RDMA_CTRL_TYPE_BITS (4)
 
-/*
- * @brief      Number of bits used for the communicator ID
- */
-#define NCCL_OFI_RDMA_COMM_ID_BITS (18)
-
 /*
  * @brief	Number of bits used for message sequence number
  *
@@ -47,13 +43,41 @@ extern "C" {
  * communicator ID, and the message sequence number (msg_seq_num).
  * The data is encoded as follows:
  *
- * | 4-bit segment count | 18-bit comm ID | 10-bit msg_seq_num |
+ * | 4-bit segment count | (28 - SEQ_BITS)-bit comm ID | SEQ_BITS-bit msg_seq_num |
  *
  * - Segment count: number of RDMA writes that will be delivered as part of this message
  * - Comm ID: the ID for this communicator
  * - Message sequence number: message identifier
+ *
+ * SEQ_BITS is chosen at configure time (see RDMA_SEQ_BITS) and
+ * defaults to 10, leaving 18 bits for the comm ID.
+ */
+#if NCCL_OFI_RDMA_SEQ_BITS < 10 || NCCL_OFI_RDMA_SEQ_BITS > 15
+#error "NCCL_OFI_RDMA_SEQ_BITS must be between 10 and 15"
+#endif
+
+/*
+ * @brief      Number of bits used for the communicator ID
  */
-#define NCCL_OFI_RDMA_SEQ_BITS     (10)
+#define NCCL_OFI_RDMA_COMM_ID_BITS (28 - NCCL_OFI_RDMA_SEQ_BITS)
+
+/*
+ * @brief	Number of bits of the comm ID indexing a page of the comm
+ *		lookup table of a device
+ */
+#define NCCL_OFI_RDMA_COMM_PAGE_BITS (10)
+#define NCCL_OFI_RDMA_COMM_PAGE_SIZE (1 << NCCL_OFI_RDMA_COMM_PAGE_BITS)
+#define NCCL_OFI_RDMA_NUM_COMM_PAGES (1 << (NCCL_OFI_RDMA_COMM_ID_BITS - NCCL_OFI_RDMA_COMM_PAGE_BITS))
+
+/*
+ * @brief	Maximum number of inflight requests of a communicator
+ *
+ * The message buffer of a communicator spans twice the inflight
+ * requests, since the sender also tracks control messages of receives
+ * posted ahead of its own sends, and the message buffer requires the
+ * sequence number space to exceed twice its size.
+ */
+#define NCCL_OFI_RDMA_MAX_INFLIGHT_REQUESTS (1 << (NCCL_OFI_RDMA_SEQ_BITS - 3))
 
 typedef enum nccl_net_ofi_rdma_req_state {
 	NCCL_OFI_RDMA_REQ_CREATED = 0,
@@ -92,6 +116,9 @@ typedef enum nccl_net_ofi_rdma_req_type {
 	NCCL_OFI_RDMA_RECV_CONN_RESP,
 	/* Connect response message send request */
 	NCCL_OFI_RDMA_SEND_CONN_RESP,
+	/* Grouped receive request. Completes with its
+	 * NCCL_OFI_RDMA_RECV subrequests, one per buffer */
+	NCCL_OFI_RDMA_RECV_GROUP,
 	/* Invalid type */
 	NCCL_OFI_RDMA_INVALID_TYPE,
 } nccl_net_ofi_rdma_req_type_t;
@@ -102,6 +129,11 @@ enum nccl_ofi_rdma_msg_type {
 	NCCL_OFI_RDMA_MSG_CTRL,
 	NCCL_OFI_RDMA_MSG_EAGER,
 	NCCL_OFI_RDMA_MSG_CLOSE,
+	NCCL_OFI_RDMA_MSG_RTS,
+	NCCL_OFI_RDMA_MSG_PULL_DONE,
+	NCCL_OFI_RDMA_MSG_CTRL_CACHE,
+	NCCL_OFI_RDMA_MSG_CTRL_COMPACT,
+	NCCL_OFI_RDMA_MSG_CTRL_GROUP,
 	NCCL_OFI_RDMA_MSG_INVALID = 15,
 	NCCL_OFI_RDMA_MSG_MAX = NCCL_OFI_RDMA_MSG_INVALID,
 };
@@ -122,6 +154,9 @@ typedef uint16_t nccl_ofi_rdma_msg_type_t;
  */
 typedef struct nccl_net_ofi_rdma_mr_handle {
 
+	/* Type of registered memory (NCCL_PTR_HOST, ...) */
+	int type;
+
 	int num_rails;
 
 	int num_control_rails;
@@ -134,10 +169,37 @@ typedef struct nccl_net_ofi_rdma_mr_handle {
 
 } nccl_net_ofi_rdma_mr_handle_t;
 
+/* Maximum number of slots of the remote key cache */
+#define NCCL_OFI_RDMA_RKEY_CACHE_MAX (64)
+
+/* Reference to a receive buffer registration in a slot of the remote
+   key cache (see OFI_NCCL_RDMA_RKEY_CACHE_SIZE). The generation tells
+   the registrations cached in the same slot apart. */
+typedef struct nccl_net_ofi_rdma_rkey_ref {
+	uint32_t slot;
+	uint32_t gen;
+} nccl_net_ofi_rdma_rkey_ref_t;
+
 /* Contents of ctrl message sent from receiver to sender to advertise
-   destination buffer */
+   destination buffer.
+
+   The same layout is used by the receiver-pull rendezvous: the sender
+   advertises its source buffer with an NCCL_OFI_RDMA_MSG_RTS message,
+   and the receiver reports the end of its RDMA reads with an
+   NCCL_OFI_RDMA_MSG_PULL_DONE message describing the destination
+   buffer.
+
+   With the remote key cache enabled, the receiver sends an
+   NCCL_OFI_RDMA_MSG_CTRL_CACHE message, followed by the
+   nccl_net_ofi_rdma_rkey_ref_t of the slot its keys are cached in,
+   the first time it advertises a registration. Later buffers of the
+   same registration are advertised with the shorter
+   NCCL_OFI_RDMA_MSG_CTRL_COMPACT message, which carries the reference
+   in place of the keys. */
 typedef struct nccl_net_ofi_rdma_ctrl_msg {
-	/* Message type, must be NCCL_OFI_RDMA_MSG_CTRL */
+	/* Message type, one of NCCL_OFI_RDMA_MSG_CTRL,
+	 * NCCL_OFI_RDMA_MSG_CTRL_CACHE, NCCL_OFI_RDMA_MSG_CTRL_COMPACT,
+	 * NCCL_OFI_RDMA_MSG_RTS or NCCL_OFI_RDMA_MSG_PULL_DONE */
 	uint32_t type:NCCL_OFI_RDMA_CTRL_TYPE_BITS;
 
 	/* Message sequence number */
@@ -154,6 +216,8 @@ typedef struct nccl_net_ofi_rdma_ctrl_msg {
 	union {
 		uint32_t short_buff_mr_key[MAX_NUM_RAILS];
 		uint64_t long_buff_mr_key[MAX_NUM_RAILS];
+		/* NCCL_OFI_RDMA_MSG_CTRL_COMPACT only */
+		nccl_net_ofi_rdma_rkey_ref_t rkey_ref;
 	};
 } nccl_net_ofi_rdma_ctrl_msg_t;
 /* Since this is a message on the wire, check that it has the expected size */
@@ -162,6 +226,9 @@ static_assert(sizeof(nccl_net_ofi_rdma_ctrl_msg_t) == 48,
 static_assert(offsetof(nccl_net_ofi_rdma_ctrl_msg_t, short_buff_mr_key) +
 	       sizeof( ((nccl_net_ofi_rdma_ctrl_msg_t *)0)->short_buff_mr_key) <= 32,
 	       "Short RDMA Control message larger than 32 bytes (EFA inline size)");
+static_assert(offsetof(nccl_net_ofi_rdma_ctrl_msg_t, rkey_ref) +
+	       sizeof(nccl_net_ofi_rdma_rkey_ref_t) <= 32,
+	       "Compact RDMA Control message larger than 32 bytes (EFA inline size)");
 
 #define NCCL_NET_OFI_CTRL_MSG_SHORT_KEY_SIZE (sizeof( ((nccl_net_ofi_rdma_ctrl_msg_t *)0)->short_buff_mr_key[0] ))
 #define NCCL_NET_OFI_CTRL_MSG_LONG_KEY_SIZE (sizeof( ((nccl_net_ofi_rdma_ctrl_msg_t *)0)->long_buff_mr_key[0] ))
@@ -172,6 +239,95 @@ static inline size_t nccl_net_ofi_rdma_ctrl_msg_size(size_t num_rails, bool use_
 	return offsetof(nccl_net_ofi_rdma_ctrl_msg_t, short_buff_mr_key) + num_rails * rkey_len;
 }
 
+/* Size of the longest control message, an NCCL_OFI_RDMA_MSG_CTRL_CACHE
+   message with long keys on all rails */
+#define NCCL_OFI_RDMA_CTRL_MSG_MAX_SIZE \
+	(sizeof(nccl_net_ofi_rdma_ctrl_msg_t) + sizeof(nccl_net_ofi_rdma_rkey_ref_t))
+
+/*
+ * @brief	Return the slot reference following the keys of an
+ *		NCCL_OFI_RDMA_MSG_CTRL_CACHE message
+ */
+static inline nccl_net_ofi_rdma_rkey_ref_t *nccl_net_ofi_rdma_ctrl_msg_cache_ref(
+	nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg, size_t num_rails, bool use_long_rkeys)
+{
+	return (nccl_net_ofi_rdma_rkey_ref_t *)((char *)ctrl_msg +
+		nccl_net_ofi_rdma_ctrl_msg_size(num_rails, use_long_rkeys));
+}
+
+/*
+ * @brief	Return the size of control message `ctrl_msg' on the wire
+ */
+static inline size_t nccl_net_ofi_rdma_ctrl_msg_len(nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg,
+						    size_t num_rails, bool use_long_rkeys)
+{
+	switch (ctrl_msg->type) {
+	case NCCL_OFI_RDMA_MSG_CTRL_CACHE:
+		return nccl_net_ofi_rdma_ctrl_msg_size(num_rails, use_long_rkeys) +
+			sizeof(nccl_net_ofi_rdma_rkey_ref_t);
+	case NCCL_OFI_RDMA_MSG_CTRL_COMPACT:
+		return offsetof(nccl_net_ofi_rdma_ctrl_msg_t, rkey_ref) +
+			sizeof(nccl_net_ofi_rdma_rkey_ref_t);
+	default:
+		return nccl_net_ofi_rdma_ctrl_msg_size(num_rails, use_long_rkeys);
+	}
+}
+
+/* Maximum number of control messages in a batch */
+#define NCCL_OFI_RDMA_CTRL_BATCH_MAX (16)
+
+/*
+ * A batch of control messages (see OFI_NCCL_CTRL_BATCH_MAX) is sent as a
+ * single message of consecutive control messages of any of the
+ * NCCL_OFI_RDMA_MSG_CTRL types, each starting at a multiple of this
+ * stride. The receiver tells a batch from a single control message by
+ * its length, which is longer than the stride.
+ */
+static inline size_t nccl_net_ofi_rdma_ctrl_batch_stride(size_t num_rails, bool use_long_rkeys)
+{
+	return NCCL_OFI_ROUND_UP(nccl_net_ofi_rdma_ctrl_msg_size(num_rails, use_long_rkeys) +
+				 sizeof(nccl_net_ofi_rdma_rkey_ref_t), 8);
+}
+
+/*
+ * Header of the control messages of a grouped receive (see
+ * OFI_NCCL_RDMA_MAX_RECVS). Each buffer of the group is received as a
+ * message of its own sequence number, starting at `msg_seq_num'. The
+ * header is followed by their `num_recvs' control messages, each
+ * starting at a multiple of the batch stride. The sender matches its
+ * sends to the buffers of the group by tag.
+ */
+typedef struct nccl_net_ofi_rdma_ctrl_group_msg {
+	/* Message type, must be NCCL_OFI_RDMA_MSG_CTRL_GROUP */
+	uint32_t type:NCCL_OFI_RDMA_CTRL_TYPE_BITS;
+
+	/* Message sequence number of the first buffer */
+	uint32_t msg_seq_num:NCCL_OFI_RDMA_SEQ_BITS;
+
+	/* A comm identitifer that uniquely identifies the comm
+	 * on the receiver side */
+	uint32_t remote_comm_id:NCCL_OFI_RDMA_COMM_ID_BITS;
+
+	uint32_t num_recvs;
+
+	/* NCCL tags of the buffers */
+	int32_t tags[NCCL_OFI_MAX_RECVS];
+} nccl_net_ofi_rdma_ctrl_group_msg_t;
+
+static_assert(sizeof(nccl_net_ofi_rdma_ctrl_group_msg_t) % 8 == 0,
+	      "Control messages of a group must start 8-byte aligned");
+
+/*
+ * @brief	Return the size of an NCCL_OFI_RDMA_MSG_CTRL_GROUP message
+ *		of `num_recvs' buffers
+ */
+static inline size_t nccl_net_ofi_rdma_ctrl_group_msg_size(size_t num_recvs, size_t num_rails,
+							   bool use_long_rkeys)
+{
+	return sizeof(nccl_net_ofi_rdma_ctrl_group_msg_t) +
+		num_recvs * nccl_net_ofi_rdma_ctrl_batch_stride(num_rails, use_long_rkeys);
+}
+
 /* Message from receiver to sender indicating sender can close resources */
 typedef struct nccl_net_ofi_rdma_close_msg {
 	/* Message type, must be NCCL_OFI_RDMA_MSG_CLOSE */
@@ -214,10 +370,20 @@ typedef struct nccl_net_ofi_ep_rail nccl_net_ofi_ep_rail_t;
 typedef struct {
 	/* Bounce buffer freelist item */
 	nccl_net_ofi_rdma_bounce_fl_item_t *bounce_fl_item;
+	/* Received message, in the buffer of `bounce_fl_item' */
+	void *msg;
 	/* Length of bounce buffer */
 	size_t buff_len;
 	/* Length of received data */
 	size_t recv_len;
+	/* Type of the received message */
+	nccl_ofi_rdma_msg_type_t msg_type;
+	/* (Control messages) Number of buffers of the grouped receive
+	 * the message belongs to, 1 if not grouped */
+	int ctrl_group_size;
+	/* (Control messages of a grouped receive) NCCL tag of the
+	 * buffer */
+	int ctrl_tag;
 
 	/*
 	 * Keeps tracks of Rail ID which is used to post the bounce buffer.
@@ -229,6 +395,27 @@ typedef struct {
 	 * Back-pointer to associated endpoint
 	 */
 	nccl_net_ofi_rdma_ep_t *ep;
+
+	/*
+	 * Slabs, bounce requests holding several messages: multi-receive
+	 * slabs posted with FI_MULTI_RECV, into which the provider packs
+	 * messages, and batches of control messages. Each message is
+	 * handed to the message handlers as a bounce request of its own,
+	 * pointing into the slab through `msg' and `slab_req'. The slab
+	 * is reposted once it is consumed, i.e., released by the
+	 * provider or unpacked, and all its messages are released.
+	 */
+
+	/* Slab the message was received into, NULL unless this is a
+	 * message of a multi-receive slab */
+	nccl_net_ofi_rdma_req_t *slab_req;
+	/* Number of messages of this slab not released yet, plus one
+	 * while a completion of the slab is handled. Protected by the
+	 * rail's bounce_mutex */
+	int slab_refcnt;
+	/* true once this slab is consumed. Protected by the rail's
+	 * bounce_mutex */
+	bool slab_consumed;
 } rdma_req_bounce_data_t;
 
 typedef struct {
@@ -255,17 +442,43 @@ typedef struct {
 typedef struct {
 	/* True for eager messages */
 	bool eager;
+	/* True while the message is offered to the receiver for
+	 * pulling. Cleared if the receiver's ctrl message wins the
+	 * race, in which case the data is written as usual. Protected
+	 * by req_lock. */
+	bool pull;
+	/* True if the RTS message has been posted. Protected by
+	 * req_lock. */
+	bool rts_posted;
+	/* RTS message describing `buff', for pull rendezvous */
+	nccl_net_ofi_rdma_ctrl_fl_item_t *rts_fl_item;
 	/* Remote destination buffer address */
 	uint64_t remote_buff;
 	/* Remote buffer length */
 	uint64_t remote_len;
 	/* Remote MR key */
 	uint64_t remote_mr_key[MAX_NUM_RAILS];
+	/* True while `remote_mr_key' is still to be looked up in the
+	 * remote key cache, from slot `remote_rkey_ref' */
+	bool remote_rkey_pending;
+	nccl_net_ofi_rdma_rkey_ref_t remote_rkey_ref;
+	/* Next request waiting for remote keys on the send communicator */
+	nccl_net_ofi_rdma_req_t *next_rkey_waiter;
 	/* Write immediate data */
 	uint64_t wdata;
-	/* Number of rails where we have successfully posted the network xfer.
-	 * Used mostly when the network xfer is sliced across multiple rails */
-	uint64_t xferred_rail_id;
+	/* Number of bytes of each stripe of the schedule posted as
+	 * chunks, indexed like the schedule's xfer infos. Protected by
+	 * req_lock. */
+	size_t stripe_posted[MAX_NUM_RAILS];
+	/* Number of chunks of each stripe in flight. Protected by
+	 * req_lock. */
+	int stripe_inflight[MAX_NUM_RAILS];
+	/* True once the last chunk of each stripe, which carries the
+	 * immediate data, is posted. Protected by req_lock. */
+	bool stripe_last_posted[MAX_NUM_RAILS];
+	/* True while the request is in the pending requests queue
+	 * waiting to post more chunks. Protected by req_lock. */
+	bool write_pending;
 	/* Application-provided local src/dst buffer */
 	void *buff;
 	/* Length of application-provided buffer */
@@ -275,6 +488,9 @@ typedef struct {
 	/* Schedule used to transfer this request. We save the pointer to
 	 * reference it when transferring the request over network. */
 	nccl_net_ofi_schedule_t *schedule;
+	/* Time the schedule became ready to be posted, reported to the
+	 * scheduler on completion of each stripe */
+	uint64_t xfer_start_ns;
 	/* Total number of completions. Expect one completion for receiving the
 	 * control message and one completion for each send segment. */
 	int total_num_compls;
@@ -296,6 +512,19 @@ typedef struct {
 	nccl_net_ofi_schedule_t *ctrl_schedule;
 	/* Pointer to recv parent request */
 	nccl_net_ofi_rdma_req_t *recv_req;
+	/* Next request whose message is sent in the same batch. Only
+	 * the first request of a batch is posted, with the messages of
+	 * the batch copied into its control buffer */
+	nccl_net_ofi_rdma_req_t *batch_next;
+	/* Number of messages sent by this request */
+	int batch_count;
+	/* True if this request sends the NCCL_OFI_RDMA_MSG_CTRL_GROUP
+	 * message of a grouped receive, with the messages of the
+	 * group linked through batch_next */
+	bool group;
+	/* Slot of the receiver's remote key cache referenced by the
+	 * message, or -1 */
+	int rkey_slot;
 #if HAVE_NVTX_TRACING
 	nvtxRangeId_t trace_id;
 #endif
@@ -326,6 +555,21 @@ typedef struct {
 typedef struct {
 	/* Pointer to recv parent request */
 	nccl_net_ofi_rdma_req_t *recv_req;
+	/* True if the segments are pulled with RDMA reads from the
+	 * sender's buffer instead of being written by the sender */
+	bool pull;
+	/* (Pull) Remote source buffer address */
+	uint64_t remote_buff;
+	/* (Pull) Remote MR keys */
+	uint64_t remote_mr_key[MAX_NUM_RAILS];
+	/* (Pull) Number of bytes to read */
+	size_t pull_len;
+	/* (Pull) Schedule of the reads */
+	nccl_net_ofi_schedule_t *schedule;
+	/* (Pull) Number of reads of the schedule already posted */
+	uint64_t xferred_rail_id;
+	/* (Pull) Time the reads became ready to be posted */
+	uint64_t xfer_start_ns;
 } rdma_req_recv_segms_data_t;
 
 /*
@@ -356,6 +600,16 @@ typedef struct {
 #endif
 } rdma_req_recv_data_t;
 
+/*
+ * @brief	Data of grouped receive request
+ */
+typedef struct {
+	/* Number of buffers */
+	int num_recvs;
+	/* Receive subrequest of each buffer */
+	nccl_net_ofi_rdma_req_t *recv_reqs[NCCL_OFI_MAX_RECVS];
+} rdma_req_recv_group_data_t;
+
 /*
  * @brief	Data of request responsible for flush operatoin
  */
@@ -397,6 +651,7 @@ typedef struct nccl_net_ofi_rdma_req {
 		rdma_req_rma_op_data_t rma_op_data;
 		rdma_req_send_data_t send_data;
 		rdma_req_recv_data_t recv_data;
+		rdma_req_recv_group_data_t recv_group_data;
 		rdma_req_send_ctrl_data_t send_ctrl_data;
 		rdma_req_send_close_data_t send_close_data;
 		rdma_req_eager_copy_data_t eager_copy_data;
@@ -408,6 +663,10 @@ typedef struct nccl_net_ofi_rdma_req {
 	/* Size of completed request */
 	size_t size;
 
+	/* Time the send or receive was posted by NCCL, for the
+	 * communicator latency histogram */
+	uint64_t start_ns;
+
 	/*
 	 * Protect updating critical fields such as size and ncompls when
 	 * network xfer happened over multiple rails
@@ -429,6 +688,61 @@ typedef struct nccl_net_ofi_rdma_req {
 
 } nccl_net_ofi_rdma_req_t;
 
+/*
+ * @brief	Communicator statistics
+ *
+ * Accounting of completed sends (send communicator) or receives
+ * (receive communicator), see nccl_ofi_stats.h.
+ */
+typedef struct nccl_net_ofi_rdma_comm_stats {
+	nccl_ofi_stats_entry_t entry;
+
+	/* Bytes of completed requests */
+	uint64_t bytes;
+
+	/* Messages transferred by receiver-pull rendezvous */
+	uint64_t pulled;
+
+	/* Eager messages copied by the CPU into the receive buffer */
+	uint64_t eager_cpu_copied;
+
+	/* Control messages sent in a batch of several messages */
+	uint64_t ctrl_batched;
+
+	/* Control messages sent as NCCL_OFI_RDMA_MSG_CTRL_COMPACT */
+	uint64_t ctrl_compact;
+
+	/* Nanoseconds between isend()/irecv() and test() reporting
+	 * completion */
+	nccl_ofi_stats_hist_t latency;
+} nccl_net_ofi_rdma_comm_stats_t;
+
+/*
+ * @brief	Endpoint rail statistics
+ */
+typedef struct nccl_net_ofi_rdma_rail_stats {
+	/* Bytes successfully posted by RDMA write, RDMA read and send
+	 * operations */
+	uint64_t bytes_written;
+	uint64_t bytes_read;
+	uint64_t bytes_sent;
+
+	/* Number of posts which returned FI_EAGAIN */
+	uint64_t eagain;
+
+	/* Completions processed per ofi_process_cq_rail() call */
+	nccl_ofi_stats_hist_t cq_batch;
+	/* Entries returned per non-empty fi_cq_read() call */
+	nccl_ofi_stats_hist_t cq_read;
+	/* Number of ofi_process_cq_rail() calls which stopped at the
+	 * poll budget */
+	uint64_t cq_budget_exhausted;
+
+	/* Lowest number of posted bounce buffers seen after a bounce
+	 * buffer was consumed. Protected by the rail bounce_mutex. */
+	uint64_t bounce_low_water;
+} nccl_net_ofi_rdma_rail_stats_t;
+
 /*
  * Rdma endpoint name
  *
@@ -489,6 +803,31 @@ typedef struct nccl_net_ofi_rdma_send_comm_rail {
 	struct fid_ep *local_ep;
 } nccl_net_ofi_rdma_send_comm_rail_t;
 
+/*
+ * @brief	Slot of the remote key cache of a receive communicator
+ */
+typedef struct nccl_net_ofi_rdma_rkey_cache_entry {
+	/* Registration cached in the slot, or NULL */
+	nccl_net_ofi_rdma_mr_handle_t *mr_handle;
+	/* Generation the registration was cached with */
+	uint32_t gen;
+	/* Number of receives whose control message references the
+	 * slot. The slot is only reused once the sender is done with
+	 * all of them. */
+	int refcnt;
+} nccl_net_ofi_rdma_rkey_cache_entry_t;
+
+/*
+ * @brief	Keys of a registration in a slot of the remote key cache
+ *		of the peer receive communicator
+ */
+typedef struct nccl_net_ofi_rdma_remote_rkey {
+	bool valid;
+	/* Generation the registration was cached with */
+	uint32_t gen;
+	uint64_t mr_key[MAX_NUM_RAILS];
+} nccl_net_ofi_rdma_remote_rkey_t;
+
 /*
  * @brief	RDMA send communicator
  *
@@ -504,6 +843,10 @@ typedef struct nccl_net_ofi_rdma_send_comm {
 	uint64_t num_inflight_reqs;
 	nccl_ofi_freelist_t *nccl_ofi_reqs_fl;
 
+	/* Free list of RTS messages of the pull rendezvous. NULL if
+	 * the pull rendezvous is disabled. */
+	nccl_ofi_freelist_t *ctrl_buff_fl;
+
 	/* Comm ID provided by the local endpoint */
 	uint32_t local_comm_id;
 
@@ -520,6 +863,12 @@ typedef struct nccl_net_ofi_rdma_send_comm {
 
 	uint16_t next_msg_seq_num;
 
+	/* Number of buffers of the grouped receive starting at
+	 * next_msg_seq_num, or 0 before the first send to it, and mask
+	 * of the buffers already matched by a send */
+	int group_size;
+	uint32_t group_sent_mask;
+
 	nccl_ofi_msgbuff_t *msgbuff;
 
 	/* Number of rails */
@@ -548,8 +897,18 @@ typedef struct nccl_net_ofi_rdma_send_comm {
 	uint64_t n_ctrl_received;
 	uint64_t n_ctrl_expected;
 
+	/* Keys of the receiver's registrations, indexed by slot of its
+	 * remote key cache. Protected by ctrl_recv_lock */
+	nccl_net_ofi_rdma_remote_rkey_t remote_rkeys[NCCL_OFI_RDMA_RKEY_CACHE_MAX];
+	/* Send requests whose keys are not cached yet, resumed when the
+	 * keys arrive. Kept off the endpoint's pending requests queue so
+	 * that they do not block it. Protected by ctrl_recv_lock */
+	nccl_net_ofi_rdma_req_t *rkey_waiters;
+
 	bool comm_active;
 
+	nccl_net_ofi_rdma_comm_stats_t stats;
+
 	/* Array of `num_rails` communicator rails */
 	nccl_net_ofi_rdma_send_comm_rail_t *rails;
 	/* Array of `num_control_rails` communicator rails */
@@ -577,10 +936,14 @@ typedef struct nccl_net_ofi_rdma_recv_comm_rail {
 
 /* Metadata about dummy flush buffer */
 typedef struct nccl_net_ofi_rdma_flush_buffer {
+	/* Allocated by the first flush of the communicator, NULL
+	 * before */
 	void *host_buffer;
 	size_t size;
 	/* Memory registration handle of the local buffer */
 	nccl_net_ofi_rdma_mr_handle_t *mr_handle;
+	/* Time of the last flush (see OFI_NCCL_RDMA_FLUSH_BUFF_IDLE_TIMEOUT) */
+	uint64_t last_used_ns;
 } nccl_net_ofi_rdma_flush_buffer_t;
 
 /*
@@ -626,6 +989,29 @@ typedef struct nccl_net_ofi_rdma_recv_comm {
 	uint64_t n_ctrl_sent;
 	uint64_t n_ctrl_delivered;
 
+	/* Send ctrl requests waiting to be sent as a batch (see
+	 * OFI_NCCL_CTRL_BATCH_MAX), linked through their batch_next
+	 * member. Protected by ctrl_batch_lock */
+	pthread_mutex_t ctrl_batch_lock;
+	nccl_net_ofi_rdma_req_t *ctrl_batch_head;
+	nccl_net_ofi_rdma_req_t *ctrl_batch_tail;
+	int ctrl_batch_count;
+	/* Time the first request of the batch was added */
+	uint64_t ctrl_batch_start_ns;
+
+	/* Remote key cache of registrations advertised to the sender
+	 * (see OFI_NCCL_RDMA_RKEY_CACHE_SIZE), with `rkey_cache_size'
+	 * slots. Zero if disabled. The slots, clock and generation are
+	 * protected by rkey_cache_lock, as receives acquire slots while
+	 * completions on the progress thread release them. */
+	pthread_mutex_t rkey_cache_lock;
+	nccl_net_ofi_rdma_rkey_cache_entry_t rkey_cache[NCCL_OFI_RDMA_RKEY_CACHE_MAX];
+	int rkey_cache_size;
+	/* Next slot to consider for eviction */
+	int rkey_cache_clock;
+	/* Generation of the last cached registration */
+	uint32_t rkey_cache_gen;
+
 	/* Number of rails */
 	int num_rails;
 	/* Number of control rails */
@@ -633,6 +1019,8 @@ typedef struct nccl_net_ofi_rdma_recv_comm {
 
 	bool comm_active;
 
+	nccl_net_ofi_rdma_comm_stats_t stats;
+
 	/* Array of `num_rails` communicator rails */
 	nccl_net_ofi_rdma_recv_comm_rail_t *rails;
 	/* Array of `num_control_rails` communicator rails */
@@ -685,6 +1073,9 @@ struct nccl_net_ofi_ep_rail {
 
 	/* Completion Queue handle */
 	struct fid_cq *cq;
+	/* Number of entries to read per fi_cq_read() call, adapted
+	 * between `cq_read_count' and OFI_NCCL_CQ_READ_COUNT_MAX */
+	size_t cq_read_batch;
 
 	/* Access domain handles */
 	struct fid_domain *domain;
@@ -699,8 +1090,16 @@ struct nccl_net_ofi_ep_rail {
 	size_t min_bounce_posted;
 	/* Maximum posted bounce buffers (see RDMA_MAX_POSTED_BOUNCE_BUFFERS) */
 	size_t max_bounce_posted;
+	/* Free list of the bounce buffers posted on this rail, the
+	 * endpoint's control bounce buffers on control rails and its
+	 * eager bounce buffers on data rails */
+	nccl_ofi_freelist_t *bounce_buff_fl;
+	/* Size of the bounce buffers posted on this rail */
+	size_t bounce_buff_size;
 	/* Mutex for bounce buffer operations */
 	pthread_mutex_t bounce_mutex;
+
+	nccl_net_ofi_rdma_rail_stats_t stats;
 };
 
 /*
@@ -738,13 +1137,49 @@ struct nccl_net_ofi_rdma_ep {
 
 	/* Pending requests queue */
 	nccl_ofi_deque_t *pending_reqs_queue;
-
-	/* Free list of bounce buffers */
-	nccl_ofi_freelist_t *bounce_buff_fl;
+	/* Largest observed depth of the pending requests queue */
+	uint64_t pending_max_depth;
+
+	nccl_ofi_stats_entry_t stats_entry;
+
+	/* Background progress thread (see OFI_NCCL_PROGRESS_THREAD).
+	 * While it runs, other threads do not process completions of
+	 * the endpoint. */
+	bool progress_thread_running;
+	pthread_t progress_thread;
+	/* Set to request the progress thread to exit */
+	int progress_thread_stop;
+	/* Error encountered by the progress thread, reported to callers
+	 * of the plugin */
+	int progress_thread_error;
+
+	/* Free list of control bounce buffers, posted on control rails
+	 * to receive connect, control and close messages */
+	nccl_ofi_freelist_t *ctrl_bounce_buff_fl;
+	/* Free list of eager bounce buffers, posted on data rails */
+	nccl_ofi_freelist_t *eager_bounce_buff_fl;
 	/* Free list of bounce buffer requests */
 	nccl_ofi_freelist_t *bounce_buff_reqs_fl;
-	/* Size of bounce buffers */
-	size_t bounce_buff_size;
+	/* Size of control bounce buffers */
+	size_t ctrl_bounce_buff_size;
+	/* Size of eager bounce buffers */
+	size_t eager_bounce_buff_size;
+	/* true if bounce buffers are posted as multi-receive slabs
+	 * (see OFI_NCCL_RDMA_MULTI_RECV), in which case the slabs
+	 * replace the control and eager bounce buffers on all rails */
+	bool use_multi_recv;
+	/* Free list of multi-receive slabs */
+	nccl_ofi_freelist_t *slab_bounce_buff_fl;
+	/* Size of multi-receive slabs */
+	size_t slab_bounce_buff_size;
+
+	/* Free lists of requests and of registered control and RTS
+	 * buffers of the communicators of this endpoint, which draw
+	 * from them with a quota each (see
+	 * OFI_NCCL_RDMA_SHARED_COMM_POOLS). NULL if communicators
+	 * allocate their own free lists. */
+	nccl_ofi_freelist_t *comm_reqs_fl;
+	nccl_ofi_freelist_t *comm_ctrl_buff_fl;
 
 	/* true if the current endpoint is a endpoint_per_communicator
 	   receive communicator */
@@ -817,12 +1252,22 @@ typedef struct nccl_net_ofi_rdma_device {
 	/* ID pool */
 	nccl_ofi_idpool_t *comm_idpool;
 
-	/* Array of open comms associated with this endpoint. This is needed for fast
-	   lookup of comms in the RDMA protocol. */
-	nccl_net_ofi_comm_t **comms;
+	/* Two-level table of open comms associated with this device,
+	   indexed by comm ID. This is needed for fast lookup of comms in
+	   the RDMA protocol. Pages are allocated when an ID of their
+	   range is first used; the others point to a shared empty page,
+	   so that lookups need no branch. */
+	nccl_net_ofi_comm_t **comm_pages[NCCL_OFI_RDMA_NUM_COMM_PAGES];
 
 	bool use_long_rkeys;
 
+	/* NUMA node that registered buffer pools are bound to, or -1 */
+	int numa_node;
+
+	/* CPUs local to the leader NIC that progress threads are pinned
+	 * to. Empty if progress threads are not pinned. */
+	cpu_set_t progress_cpuset;
+
 	/* List of endpoints and set of addresses they have connections to */
 	nccl_ofi_ep_addr_list_t *ep_addr_list;
 
@@ -72,6 +72,27 @@ typedef struct nccl_net_ofi_scheduler {
 	nccl_net_ofi_schedule_t *(*get_schedule)(nccl_net_ofi_scheduler_t *scheduler,
 						 size_t size, int num_rails);
 
+	/*
+	 * @brief	Optional function pointer notifying the scheduler that a
+	 *		stripe of a schedule has been posted to its rail. May be
+	 *		NULL.
+	 */
+	void (*xfer_posted)(nccl_net_ofi_scheduler_t *scheduler,
+			    const nccl_net_ofi_xfer_info_t *xfer);
+
+	/*
+	 * @brief	Optional function pointer notifying the scheduler that a
+	 *		posted stripe has completed. May be NULL.
+	 *
+	 * @param	start_ns
+	 *		Time the stripe became ready to be posted
+	 * @param	end_ns
+	 *		Time the completion of the stripe was processed
+	 */
+	void (*xfer_completed)(nccl_net_ofi_scheduler_t *scheduler,
+			       const nccl_net_ofi_xfer_info_t *xfer,
+			       uint64_t start_ns, uint64_t end_ns);
+
 	/*
 	 * brief	Function pointer stored in scheduler to finalize (free) scheduler
 	 *
@@ -81,6 +102,10 @@ typedef struct nccl_net_ofi_scheduler {
 	int (*fini)(nccl_net_ofi_scheduler_t *scheduler);
 } nccl_net_ofi_scheduler_t;
 
+/* Number of power-of-two message sizes, 2^0 to 2^31 bytes, for which
+ * the threshold scheduler precomputes a schedule template */
+#define NCCL_OFI_SCHEDULER_NUM_SIZE_CLASSES (32)
+
 /*
  * @brief 	The threshold scheduler
  *
@@ -89,15 +114,85 @@ typedef struct nccl_net_ofi_scheduler {
  */
 typedef struct nccl_net_ofi_threshold_scheduler {
 	nccl_net_ofi_scheduler_t base;
-	/* Round robin counter */
+	/* Round robin counter, advanced with atomic fetch-add. The
+	 * first rail of a schedule is the counter modulo the number of
+	 * rails. */
 	unsigned int rr_counter;
-	/* Lock for round robin counter */
-	pthread_mutex_t rr_lock;
 	/* Minimum size of the message in bytes before message is
 	 * multiplexed */
 	size_t min_stripe_size;
+	/* Number of rails the templates are computed for */
+	int num_rails;
+	/* Schedule templates of power-of-two message sizes, indexed
+	 * by log2 of the message size. Rail ids of a template are
+	 * relative to the first rail of the schedule. */
+	nccl_net_ofi_schedule_t *templates[NCCL_OFI_SCHEDULER_NUM_SIZE_CLASSES];
+	/* Memory backing the templates */
+	void *template_buf;
 } nccl_net_ofi_threshold_scheduler_t;
 
+/*
+ * @brief	Per-rail state of the adaptive scheduler
+ *
+ * Fields are updated with relaxed atomics from the posting and
+ * completing threads. Padded to a cache line to avoid false sharing
+ * between rails.
+ */
+typedef struct nccl_net_ofi_adaptive_rail {
+	/* Bytes posted to the rail which have not completed yet */
+	uint64_t outstanding_bytes;
+	/* Time the last completion of the rail was processed */
+	uint64_t last_completion_ns;
+	/* Moving average of the transfer cost of the rail, in
+	 * femtoseconds per byte */
+	uint64_t cost_fs_per_byte;
+	char pad[64 - 3 * sizeof(uint64_t)];
+} nccl_net_ofi_adaptive_rail_t;
+
+/*
+ * @brief	The adaptive scheduler
+ *
+ * Tracks outstanding bytes and the transfer cost observed from
+ * completion latency of each rail, and splits messages into unequal
+ * stripes so that all rails used for a message are expected to finish
+ * at the same time. Messages smaller or equal to `min_stripe_size'
+ * bytes are assigned to the rail expected to finish them first.
+ */
+typedef struct nccl_net_ofi_adaptive_scheduler {
+	nccl_net_ofi_scheduler_t base;
+	/* Number of rails */
+	int num_rails;
+	/* Rotation counter used to break ties between equal rails */
+	unsigned int rr_counter;
+	/* Minimum size of a stripe in bytes */
+	size_t min_stripe_size;
+	/* Array of `num_rails' rails */
+	nccl_net_ofi_adaptive_rail_t *rails;
+} nccl_net_ofi_adaptive_scheduler_t;
+
+/*
+ * @brief	Notify scheduler that a stripe was posted
+ */
+static inline void nccl_net_ofi_scheduler_xfer_posted(nccl_net_ofi_scheduler_t *scheduler,
+						      const nccl_net_ofi_xfer_info_t *xfer)
+{
+	if (scheduler->xfer_posted) {
+		scheduler->xfer_posted(scheduler, xfer);
+	}
+}
+
+/*
+ * @brief	Notify scheduler that a posted stripe completed
+ */
+static inline void nccl_net_ofi_scheduler_xfer_completed(nccl_net_ofi_scheduler_t *scheduler,
+							 const nccl_net_ofi_xfer_info_t *xfer,
+							 uint64_t start_ns, uint64_t end_ns)
+{
+	if (scheduler->xfer_completed) {
+		scheduler->xfer_completed(scheduler, xfer, start_ns, end_ns);
+	}
+}
+
 /*
  * @brief	Release schedule by returning it back to the scheduler
  */
@@ -118,6 +213,19 @@ void nccl_net_ofi_release_schedule(nccl_net_ofi_scheduler_t *scheduler,
  */
 int nccl_net_ofi_threshold_scheduler_init(int num_rails, size_t min_stripe_size, nccl_net_ofi_scheduler_t **scheduler);
 
+/*
+ * brief	Initialize an adaptive scheduler
+ *
+ * @param	num_rails
+ *		Number of rails
+ * @param	min_stripe_size
+ *		Minimum size of a stripe in bytes. Messages up to this
+ *		size are not multiplexed.
+ * @return	0, on success
+ *		non-zero, on error
+ */
+int nccl_net_ofi_adaptive_scheduler_init(int num_rails, size_t min_stripe_size, nccl_net_ofi_scheduler_t **scheduler);
+
 #ifdef __cplusplus
 } // End extern "C"
 #endif
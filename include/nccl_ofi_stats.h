@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#ifndef NCCL_OFI_STATS_H_
+#define NCCL_OFI_STATS_H_
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "nccl_ofi_config_bottom.h"
+
+/*
+ * Always-on statistics counters.
+ *
+ * Counters are plain uint64_t fields embedded in the structure they
+ * describe (endpoint rail, communicator, ...) and are updated with
+ * relaxed atomics, so the data path never takes a lock to account an
+ * event. Owners of counters register a stats entry with a dump
+ * callback; the registry is only walked when a dump is requested,
+ * either by the signal configured with OFI_NCCL_STATS_SIGNAL or at
+ * plugin finalization when OFI_NCCL_STATS_DUMP_AT_FINI is set.
+ * Output goes to OFI_NCCL_STATS_FILE, or stderr if unset.
+ */
+
+/* Histogram buckets: bucket 0 counts zero values, bucket i > 0 counts
+ * values v with 2^(i-1) <= v < 2^i */
+#define NCCL_OFI_STATS_HIST_BUCKETS (65)
+
+/* Maximum length of a stats entry name, including terminator */
+#define NCCL_OFI_STATS_NAME_LEN (64)
+
+/*
+ * Log2 histogram
+ */
+typedef struct nccl_ofi_stats_hist {
+	/* Number of recorded values */
+	uint64_t count;
+	/* Sum of recorded values */
+	uint64_t sum;
+	/* Largest recorded value */
+	uint64_t max;
+	uint64_t buckets[NCCL_OFI_STATS_HIST_BUCKETS];
+} nccl_ofi_stats_hist_t;
+
+struct nccl_ofi_stats_entry;
+typedef struct nccl_ofi_stats_entry nccl_ofi_stats_entry_t;
+
+/*
+ * Dump callback of a stats entry. Called with the registry lock
+ * held, so the entry cannot be unregistered while it is dumped.
+ */
+typedef void (*nccl_ofi_stats_dump_fn_t)(FILE *out, nccl_ofi_stats_entry_t *entry);
+
+/*
+ * Registered source of statistics. Embedded in the structure owning
+ * the counters; the dump callback recovers the owner with
+ * container_of().
+ */
+struct nccl_ofi_stats_entry {
+	char name[NCCL_OFI_STATS_NAME_LEN];
+	nccl_ofi_stats_dump_fn_t dump_fn;
+
+	/* Registry list links */
+	nccl_ofi_stats_entry_t *prev;
+	nccl_ofi_stats_entry_t *next;
+};
+
+/* Set from signal context when a dump was requested */
+extern int nccl_ofi_stats_dump_requested;
+
+/*
+ * @brief	Add to a counter
+ */
+static inline void nccl_ofi_stats_add(uint64_t *counter, uint64_t value)
+{
+	__atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+/*
+ * @brief	Read a counter
+ */
+static inline uint64_t nccl_ofi_stats_read(const uint64_t *counter)
+{
+	return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/*
+ * @brief	Raise a high-watermark counter to value if it is lower
+ */
+static inline void nccl_ofi_stats_max(uint64_t *counter, uint64_t value)
+{
+	uint64_t cur = __atomic_load_n(counter, __ATOMIC_RELAXED);
+	while (cur < value &&
+	       !__atomic_compare_exchange_n(counter, &cur, value, true,
+					    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+	}
+}
+
+/*
+ * @brief	Return histogram bucket of value
+ */
+static inline int nccl_ofi_stats_hist_bucket(uint64_t value)
+{
+	return (value == 0) ? 0 : 64 - __builtin_clzll(value);
+}
+
+/*
+ * @brief	Record value in histogram
+ */
+static inline void nccl_ofi_stats_hist_add(nccl_ofi_stats_hist_t *hist, uint64_t value)
+{
+	nccl_ofi_stats_add(&hist->buckets[nccl_ofi_stats_hist_bucket(value)], 1);
+	nccl_ofi_stats_add(&hist->count, 1);
+	nccl_ofi_stats_add(&hist->sum, value);
+	nccl_ofi_stats_max(&hist->max, value);
+}
+
+/*
+ * @brief	Monotonic timestamp in nanoseconds, for latency histograms
+ */
+static inline uint64_t nccl_ofi_stats_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * @brief	Return an upper bound of the given percentile of histogram
+ *		values
+ *
+ * @param	pct
+ *		Percentile, in [0, 100]
+ * @return	Exclusive upper bound of the bucket holding the
+ *		percentile, capped at the largest recorded value. Zero
+ *		if the histogram is empty.
+ */
+uint64_t nccl_ofi_stats_hist_percentile(const nccl_ofi_stats_hist_t *hist, double pct);
+
+/*
+ * @brief	Print histogram summary and non-empty buckets on one line
+ */
+void nccl_ofi_stats_hist_print(FILE *out, const char *label, const nccl_ofi_stats_hist_t *hist);
+
+/*
+ * @brief	Register a stats entry
+ *
+ * @param	entry
+ *		Caller-owned entry, must stay valid until unregistered
+ * @param	dump_fn
+ *		Callback printing the counters of the entry
+ * @param	fmt
+ *		printf-style format of the entry name
+ */
+void nccl_ofi_stats_register(nccl_ofi_stats_entry_t *entry,
+			     nccl_ofi_stats_dump_fn_t dump_fn,
+			     const char *fmt, ...)
+	__attribute__((format(printf, 3, 4)));
+
+/*
+ * @brief	Unregister a stats entry
+ *
+ * When dumping at finalization is enabled, the entry is dumped before
+ * being removed so that counters of closed communicators and
+ * endpoints are not lost. Unregistering an entry which was never
+ * registered is a no-op.
+ */
+void nccl_ofi_stats_unregister(nccl_ofi_stats_entry_t *entry);
+
+/*
+ * @brief	Dump all registered entries
+ *
+ * @param	reason
+ *		Short description of the dump trigger, printed in the
+ *		dump header
+ */
+void nccl_ofi_stats_dump(const char *reason);
+
+/*
+ * @brief	Dump all registered entries if a dump was requested by signal
+ *
+ * Signal handlers cannot safely walk the registry or do stdio, so the
+ * handler only raises a flag which is polled from the progress path.
+ */
+static inline void nccl_ofi_stats_poll(void)
+{
+	if (OFI_UNLIKELY(__atomic_load_n(&nccl_ofi_stats_dump_requested, __ATOMIC_RELAXED)) &&
+	    __atomic_exchange_n(&nccl_ofi_stats_dump_requested, 0, __ATOMIC_RELAXED)) {
+		nccl_ofi_stats_dump("signal");
+	}
+}
+
+/*
+ * @brief	Initialize the stats subsystem
+ *
+ * Installs the dump signal handler if OFI_NCCL_STATS_SIGNAL is set.
+ *
+ * @return	0 on success, negative errno on failure
+ */
+int nccl_ofi_stats_init(void);
+
+/*
+ * @brief	Finalize the stats subsystem
+ *
+ * Dumps all registered entries if OFI_NCCL_STATS_DUMP_AT_FINI is
+ * set. Entries unregistered afterwards are not dumped again.
+ */
+void nccl_ofi_stats_fini(void);
+
+#ifdef __cplusplus
+} // End extern "C"
+#endif
+
+#endif // End NCCL_OFI_STATS_H_
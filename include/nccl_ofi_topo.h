@@ -9,6 +9,7 @@
 extern "C" {
 #endif
 
+#include <sched.h>
 #include <stdbool.h>
 #include <hwloc.h>
 #include <rdma/fabric.h>
@@ -303,6 +304,37 @@ int nccl_ofi_topo_num_info_lists(nccl_ofi_topo_t *topo, int *num_lists);
  */
 struct fi_info *nccl_ofi_topo_next_info_list(nccl_ofi_topo_data_iterator_t *iter);
 
+/*
+ * @brief	Return the NUMA node closest to a libfabric NIC
+ *
+ * @param	topo
+ *		NCCL OFI topology
+ * @param	info
+ *		Libfabric NIC info struct
+ * @param	numa_node
+ *		Output, OS index of the NUMA node closest to the NIC, or
+ *		-1 if the NIC is not found in the topology or is not
+ *		local to a single NUMA node
+ * @return	0, on success
+ *		non-zero, on error
+ */
+int nccl_ofi_topo_get_numa_node(nccl_ofi_topo_t *topo, struct fi_info *info, int *numa_node);
+
+/*
+ * @brief	Return the CPUs local to a libfabric NIC
+ *
+ * @param	topo
+ *		NCCL OFI topology
+ * @param	info
+ *		Libfabric NIC info struct
+ * @param	cpuset
+ *		Output, CPUs local to the NIC. Empty if the NIC is not
+ *		found in the topology.
+ * @return	0, on success
+ *		non-zero, on error
+ */
+int nccl_ofi_topo_get_cpuset(nccl_ofi_topo_t *topo, struct fi_info *info, cpu_set_t *cpuset);
+
 /*
  * @brief	Dump NCCL topology into file
  *
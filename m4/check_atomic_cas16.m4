@@ -0,0 +1,39 @@
+# -*- autoconf -*-
+#
+# Copyright (c) 2024      Amazon.com, Inc. or its affiliates. All rights reserved.
+#
+# See LICENSE.txt for license information
+#
+
+m4_define([CHECK_ATOMIC_CAS16_PROGRAM], [AC_LANG_PROGRAM([[
+typedef unsigned __int128 u128;
+static u128 word __attribute__((aligned(16)));
+]], [[
+u128 expected = word;
+return !__sync_bool_compare_and_swap(&word, expected, expected + 1);
+]])])
+
+AC_DEFUN([CHECK_ATOMIC_CAS16], [
+  have_atomic_cas16=0
+  AC_MSG_CHECKING([for lock-free 16-byte compare-and-swap])
+  AC_LINK_IFELSE([CHECK_ATOMIC_CAS16_PROGRAM],
+                 [have_atomic_cas16=1
+                  AC_MSG_RESULT([yes])],
+                 [AC_MSG_RESULT([no])])
+
+  dnl x86-64 compilers only inline cmpxchg16b with -mcx16, and
+  dnl otherwise call a function that is not provided
+  AS_IF([test "${have_atomic_cas16}" = "0"],
+        [check_atomic_cas16_save_CFLAGS="${CFLAGS}"
+         CFLAGS="${CFLAGS} -mcx16"
+         AC_MSG_CHECKING([for lock-free 16-byte compare-and-swap with -mcx16])
+         AC_LINK_IFELSE([CHECK_ATOMIC_CAS16_PROGRAM],
+                        [have_atomic_cas16=1
+                         CXXFLAGS="${CXXFLAGS} -mcx16"
+                         AC_MSG_RESULT([yes])],
+                        [CFLAGS="${check_atomic_cas16_save_CFLAGS}"
+                         AC_MSG_RESULT([no])])])
+
+  AC_DEFINE_UNQUOTED([HAVE_ATOMIC_CAS16], [${have_atomic_cas16}],
+                     [Defined to 1 if a lock-free 16-byte compare-and-swap is available])
+])
@@ -0,0 +1,18 @@
+# -*- autoconf -*-
+#
+# Copyright (c) 2024      Amazon.com, Inc. or its affiliates. All rights reserved.
+#
+# See LICENSE.txt for license information
+#
+
+AC_DEFUN([CHECK_VAR_RDMA_SEQ_BITS], [
+  AC_MSG_CHECKING([for RDMA_SEQ_BITS])
+  AC_ARG_VAR(RDMA_SEQ_BITS,
+             AS_HELP_STRING([Number of bits of message sequence numbers of the RDMA protocol. Each additional bit doubles the maximum number of inflight requests per communicator and halves the maximum number of communicators. Must be between 10 and 15. @<:@default=10@:>@]))
+  RDMA_SEQ_BITS=${RDMA_SEQ_BITS:=10}
+  AC_MSG_RESULT(${RDMA_SEQ_BITS})
+  AS_IF([test "${RDMA_SEQ_BITS}" -lt 10 -o "${RDMA_SEQ_BITS}" -gt 15],
+        [AC_MSG_ERROR([RDMA_SEQ_BITS=${RDMA_SEQ_BITS} is not between 10 and 15])])
+
+  AC_DEFINE_UNQUOTED([NCCL_OFI_RDMA_SEQ_BITS], [${RDMA_SEQ_BITS}], [Defines the number of bits of message sequence numbers of the RDMA protocol.])
+])
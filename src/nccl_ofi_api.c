@@ -10,6 +10,7 @@
 #include "nccl_ofi.h"
 #include "nccl_ofi_api.h"
 #include "nccl_ofi_param.h"
+#include "nccl_ofi_stats.h"
 
 
 static_assert(sizeof(nccl_net_ofi_conn_handle_t) <= NCCL_NET_HANDLE_MAXSIZE,
@@ -112,6 +113,8 @@ static ncclResult_t nccl_net_ofi_retval_translate_impl(int retval)
 
 static void nccl_net_ofi_fini(void)
 {
+	nccl_ofi_stats_fini();
+
 	if (plugin != NULL) {
 		int ret = plugin->release_plugin(plugin);
 		if (ret != 0) {
@@ -135,6 +138,12 @@ ncclResult_t nccl_net_ofi_init(ncclDebugLogger_t logFunction)
 		return nccl_net_ofi_retval_translate(ret);
 	}
 
+	ret = nccl_ofi_stats_init();
+	if (OFI_UNLIKELY(ret != 0)) {
+		NCCL_OFI_WARN("Initializing statistics failed");
+		return nccl_net_ofi_retval_translate(ret);
+	}
+
 	ret = atexit(nccl_net_ofi_fini);
 	if (ret != 0) {
 		NCCL_OFI_WARN("Adding cleanup function failed");
@@ -39,6 +39,7 @@
 
 DECLARE_CUDA_FUNCTION(cuCtxGetDevice);
 DECLARE_CUDA_FUNCTION(cuDeviceGetAttribute);
+DECLARE_CUDA_FUNCTION(cuPointerGetAttribute);
 
 int nccl_net_ofi_cuda_init(void)
 {
@@ -68,6 +69,7 @@ int nccl_net_ofi_cuda_init(void)
 
 	RESOLVE_CUDA_FUNCTION(cuCtxGetDevice);
 	RESOLVE_CUDA_FUNCTION(cuDeviceGetAttribute);
+	RESOLVE_CUDA_FUNCTION(cuPointerGetAttribute);
 
 	if (HAVE_CUDA_GDRFLUSH_SUPPORT && nccl_net_ofi_cuda_have_gdr_support_attr() && ofi_nccl_cuda_flush_enable()) {
 		NCCL_OFI_WARN("CUDA flush enabled");
@@ -129,6 +131,23 @@ int nccl_net_ofi_get_cuda_device_for_addr(void *data, int *dev_id)
 	};
 }
 
+int nccl_net_ofi_cuda_get_buffer_id(const void *addr, uint64_t *buffer_id)
+{
+	unsigned long long id = 0;
+
+	if (pfn_cuPointerGetAttribute == NULL) {
+		return -ENOTSUP;
+	}
+
+	CUresult result = pfn_cuPointerGetAttribute(&id, CU_POINTER_ATTRIBUTE_BUFFER_ID, (CUdeviceptr)addr);
+	if (result != CUDA_SUCCESS) {
+		return -EINVAL;
+	}
+
+	*buffer_id = (uint64_t)id;
+	return 0;
+}
+
 bool nccl_net_ofi_cuda_have_gdr_support_attr(void)
 {
 #if HAVE_CUDA_GDRFLUSH_SUPPORT
@@ -12,6 +12,11 @@
 #include "nccl_ofi_log.h"
 
 int nccl_ofi_deque_init(nccl_ofi_deque_t **deque_p)
+{
+	return nccl_ofi_deque_init_mode(deque_p, NCCL_OFI_DEQUE_MODE_MUTEX);
+}
+
+int nccl_ofi_deque_init_mode(nccl_ofi_deque_t **deque_p, nccl_ofi_deque_mode_t mode)
 {
 	nccl_ofi_deque_t *deque = (nccl_ofi_deque_t *)malloc(sizeof(nccl_ofi_deque_t));
 
@@ -22,6 +27,14 @@ int nccl_ofi_deque_init(nccl_ofi_deque_t **deque_p)
 
 	deque->head.prev = &deque->head;
 	deque->head.next = &deque->head;
+	deque->size = 0;
+
+	deque->mode = mode;
+	deque->mpsc_stub.prev = NULL;
+	deque->mpsc_stub.next = NULL;
+	deque->mpsc_back = &deque->mpsc_stub;
+	deque->mpsc_front = &deque->mpsc_stub;
+	deque->retry_front = NULL;
 
 	int ret = pthread_mutex_init(&deque->lock, NULL);
 	if (ret != 0) {
@@ -30,6 +43,14 @@ int nccl_ofi_deque_init(nccl_ofi_deque_t **deque_p)
 		return -ret;
 	}
 
+	ret = pthread_mutex_init(&deque->consumer_lock, NULL);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to initialize deque consumer mutex.");
+		pthread_mutex_destroy(&deque->lock);
+		free(deque);
+		return -ret;
+	}
+
 	assert(deque_p);
 	*deque_p = deque;
 
@@ -48,6 +69,12 @@ int nccl_ofi_deque_finalize(nccl_ofi_deque_t *deque)
 		return -ret;
 	}
 
+	ret = pthread_mutex_destroy(&deque->consumer_lock);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to destroy deque consumer mutex.");
+		return -ret;
+	}
+
 	free(deque);
 	return 0;
 }
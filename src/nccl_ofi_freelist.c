@@ -8,11 +8,120 @@
 #include <errno.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <strings.h>
+
+#include <uthash/utlist.h>
 
 #include "nccl_ofi.h"
 #include "nccl_ofi_freelist.h"
 #include "nccl_ofi_log.h"
 #include "nccl_ofi_math.h"
+#include "nccl_ofi_param.h"
+
+/* Entries moved between a magazine and the shared list at once */
+#define FREELIST_MAGAZINE_BATCH (16)
+
+__thread struct nccl_ofi_freelist_magazine_t *
+	nccl_ofi_freelist_tls_magazines[NCCL_OFI_FREELIST_TLS_SLOTS];
+
+/* All magazines of the calling thread */
+static __thread struct nccl_ofi_freelist_magazine_t *thread_magazines = NULL;
+
+/* Protects the magazine lists of freelists and the freelist pointer
+ * of magazines */
+static pthread_mutex_t magazine_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t magazine_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t magazine_key;
+static int magazine_key_ret = 0;
+static unsigned int next_tls_slot = 0;
+
+/*
+ * @brief	Return the magazines of an exiting thread to their freelists
+ */
+static void magazine_thread_exit(void *arg)
+{
+	struct nccl_ofi_freelist_magazine_t *magazine =
+		(struct nccl_ofi_freelist_magazine_t *)arg;
+
+	nccl_net_ofi_mutex_lock(&magazine_lock);
+
+	while (magazine) {
+		struct nccl_ofi_freelist_magazine_t *next = magazine->thread_next;
+		nccl_ofi_freelist_t *freelist = magazine->freelist;
+
+		if (freelist) {
+			nccl_net_ofi_mutex_lock(&freelist->lock);
+			while (magazine->entries) {
+				struct nccl_ofi_freelist_elem_t *entry = magazine->entries;
+				nccl_net_ofi_mem_defined_unaligned(entry, sizeof(*entry));
+				magazine->entries = entry->next;
+				entry->next = freelist->entries;
+				nccl_net_ofi_mem_noaccess_unaligned(entry, sizeof(*entry));
+				freelist->entries = entry;
+			}
+			DL_DELETE2(freelist->magazines, magazine, fl_prev, fl_next);
+			nccl_net_ofi_mutex_unlock(&freelist->lock);
+		}
+
+		free(magazine);
+		magazine = next;
+	}
+
+	thread_magazines = NULL;
+	for (int i = 0; i < NCCL_OFI_FREELIST_TLS_SLOTS; i++) {
+		nccl_ofi_freelist_tls_magazines[i] = NULL;
+	}
+
+	nccl_net_ofi_mutex_unlock(&magazine_lock);
+}
+
+static void magazine_key_init(void)
+{
+	magazine_key_ret = -pthread_key_create(&magazine_key, magazine_thread_exit);
+}
+
+/*
+ * @brief	Resolve NCCL_OFI_FREELIST_MODE_DEFAULT and unsupported modes
+ */
+static int freelist_resolve_mode(nccl_ofi_freelist_mode_t *mode)
+{
+	if (*mode == NCCL_OFI_FREELIST_MODE_DEFAULT) {
+		const char *mode_str = ofi_nccl_freelist_mode();
+		if (0 == strcasecmp(mode_str, "mutex")) {
+			*mode = NCCL_OFI_FREELIST_MODE_MUTEX;
+		} else if (0 == strcasecmp(mode_str, "cache")) {
+			*mode = NCCL_OFI_FREELIST_MODE_CACHE;
+		} else if (0 == strcasecmp(mode_str, "lockfree")) {
+			*mode = NCCL_OFI_FREELIST_MODE_LOCKFREE;
+		} else {
+			NCCL_OFI_WARN("Invalid value for OFI_NCCL_FREELIST_MODE: %s", mode_str);
+			return -EINVAL;
+		}
+	}
+
+#if ENABLE_VALGRIND || ENABLE_ASAN
+	/* Lock-free pops read elements owned by other threads, which
+	 * memory checkers report as invalid accesses */
+	if (*mode == NCCL_OFI_FREELIST_MODE_LOCKFREE) {
+		*mode = NCCL_OFI_FREELIST_MODE_MUTEX;
+	}
+#endif
+
+	if (*mode == NCCL_OFI_FREELIST_MODE_CACHE) {
+		int ret = pthread_once(&magazine_key_once, magazine_key_init);
+		if (ret != 0) {
+			NCCL_OFI_WARN("pthread_once failed: %s", strerror(ret));
+			return -ret;
+		}
+		if (magazine_key_ret != 0) {
+			NCCL_OFI_WARN("Creating freelist thread key failed: %s",
+				      strerror(-magazine_key_ret));
+			return magazine_key_ret;
+		}
+	}
+
+	return 0;
+}
 
 /*
  * @brief	Returns size of block memory
@@ -20,13 +129,15 @@
  * The block memory stores entry_count entries as well as a
  * nccl_ofi_freelist_block_t structure. Since the block memory needs
  * to cover full memory pages, the size assessed by the structures is
- * rounded up to page size.
+ * rounded up to page size, which is the huge page size if the
+ * freelist is backed by huge pages.
  */
-static inline size_t freelist_block_mem_size_full_pages(size_t entry_size, size_t entry_count)
+static inline size_t freelist_block_mem_size_full_pages(size_t entry_size, size_t entry_count,
+							size_t page_size)
 {
 	size_t block_mem_size =
 		(entry_size * entry_count) + sizeof(struct nccl_ofi_freelist_block_t);
-	return NCCL_OFI_ROUND_UP(block_mem_size, system_page_size);
+	return NCCL_OFI_ROUND_UP(block_mem_size, page_size);
 }
 
 /*
@@ -37,12 +148,16 @@ static inline size_t freelist_block_mem_size_full_pages(size_t entry_size, size_
  *		Memory footprint in bytes of a single entry. Must be larger than 0.
  * @brief	entry_count
  *		Number of requested entries
+ * @brief	page_size
+ *		Page size backing the block memory
  *
  * @return	Maximum number of entries
  */
-static inline size_t freelist_page_padded_entry_count(size_t entry_size, size_t entry_count) {
+static inline size_t freelist_page_padded_entry_count(size_t entry_size, size_t entry_count,
+						      size_t page_size) {
 	assert(entry_size > 0);
-	size_t covered_pages_size = freelist_block_mem_size_full_pages(entry_size, entry_count);
+	size_t covered_pages_size = freelist_block_mem_size_full_pages(entry_size, entry_count,
+								       page_size);
 	return (covered_pages_size - sizeof(struct nccl_ofi_freelist_block_t)) / entry_size;
 }
 
@@ -56,11 +171,19 @@ static int freelist_init_internal(size_t entry_size,
 				  void *regmr_opaque,
 				  size_t reginfo_offset,
 				  size_t entry_alignment,
+				  bool huge_pages,
+				  int numa_node,
+				  nccl_ofi_freelist_mode_t mode,
 				  nccl_ofi_freelist_t **freelist_p)
 {
 	int ret;
 	nccl_ofi_freelist_t *freelist = NULL;
 
+	ret = freelist_resolve_mode(&mode);
+	if (ret != 0) {
+		return ret;
+	}
+
 	freelist = (nccl_ofi_freelist_t *)malloc(sizeof(nccl_ofi_freelist_t));
 	if (!freelist) {
 		NCCL_OFI_WARN("Allocating freelist failed");
@@ -79,10 +202,18 @@ static int freelist_init_internal(size_t entry_size,
 	 * bounds and increase values such that allocations that cover
 	 * full system memory pages do not have unused space for
 	 * additional entries. */
-	initial_entry_count = freelist_page_padded_entry_count(freelist->entry_size,
-							       initial_entry_count);
+	freelist->huge_pages = huge_pages;
+	freelist->numa_node = numa_node;
+	freelist->page_size = huge_pages ? NCCL_OFI_HUGE_PAGE_SIZE : system_page_size;
+
+	if (initial_entry_count > 0) {
+		initial_entry_count = freelist_page_padded_entry_count(freelist->entry_size,
+								       initial_entry_count,
+								       freelist->page_size);
+	}
 	increase_entry_count = freelist_page_padded_entry_count(freelist->entry_size,
-								increase_entry_count);
+								increase_entry_count,
+								freelist->page_size);
 
 	freelist->num_allocated_entries = 0;
 	freelist->max_entry_count = max_entry_count;
@@ -96,6 +227,20 @@ static int freelist_init_internal(size_t entry_size,
 	freelist->regmr_opaque = regmr_opaque;
 	freelist->reginfo_offset = reginfo_offset;
 
+	freelist->mode = mode;
+	freelist->lockfree_top = 0;
+	freelist->magazines = NULL;
+	/* Bound the entries a thread can hold back from other threads */
+	freelist->magazine_batch = FREELIST_MAGAZINE_BATCH;
+	if (max_entry_count > 0) {
+		freelist->magazine_batch = NCCL_OFI_MAX(NCCL_OFI_MIN(freelist->magazine_batch,
+								     max_entry_count / 8),
+						       1);
+	}
+	freelist->tls_slot = __atomic_fetch_add(&next_tls_slot, 1, __ATOMIC_RELAXED) %
+		NCCL_OFI_FREELIST_TLS_SLOTS;
+	freelist->parent = NULL;
+
 	ret = pthread_mutex_init(&freelist->lock, NULL);
 	if (ret != 0) {
 		NCCL_OFI_WARN("Mutex initialization failed: %s", strerror(ret));
@@ -103,13 +248,14 @@ static int freelist_init_internal(size_t entry_size,
 		return -ret;
 	}
 
-	ret = nccl_ofi_freelist_add(freelist, initial_entry_count);
-	if (ret != 0) {
-		NCCL_OFI_WARN("Allocating initial freelist entries failed: %d", ret);
-		pthread_mutex_destroy(&freelist->lock);
-		free(freelist);
-		return ret;
-
+	if (initial_entry_count > 0) {
+		ret = nccl_ofi_freelist_add(freelist, initial_entry_count);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Allocating initial freelist entries failed: %d", ret);
+			pthread_mutex_destroy(&freelist->lock);
+			free(freelist);
+			return ret;
+		}
 	}
 
 	*freelist_p = freelist;
@@ -120,6 +266,7 @@ int nccl_ofi_freelist_init(size_t entry_size,
 			   size_t initial_entry_count,
 			   size_t increase_entry_count,
 			   size_t max_entry_count,
+			   nccl_ofi_freelist_mode_t mode,
 			   nccl_ofi_freelist_t **freelist_p)
 {
 	return freelist_init_internal(entry_size,
@@ -132,6 +279,9 @@ int nccl_ofi_freelist_init(size_t entry_size,
 				      NULL,
 				      0,
 				      1,
+				      false,
+				      -1,
+				      mode,
 				      freelist_p);
 }
 
@@ -144,6 +294,9 @@ int nccl_ofi_freelist_init_mr(size_t entry_size,
 			      void *regmr_opaque,
 			      size_t reginfo_offset,
 			      size_t entry_alignment,
+			      bool huge_pages,
+			      int numa_node,
+			      nccl_ofi_freelist_mode_t mode,
 			      nccl_ofi_freelist_t **freelist_p)
 {
 	return freelist_init_internal(entry_size,
@@ -156,15 +309,71 @@ int nccl_ofi_freelist_init_mr(size_t entry_size,
 				      regmr_opaque,
 				      reginfo_offset,
 				      entry_alignment,
+				      huge_pages,
+				      numa_node,
+				      mode,
 				      freelist_p);
 }
 
+int nccl_ofi_freelist_init_quota(nccl_ofi_freelist_t *parent,
+				 size_t max_entry_count,
+				 nccl_ofi_freelist_t **freelist_p)
+{
+	nccl_ofi_freelist_t *freelist = NULL;
+
+	assert(parent);
+	assert(parent->parent == NULL);
+
+	if (max_entry_count == 0) {
+		NCCL_OFI_WARN("Quota of freelist %p must not be empty", parent);
+		return -EINVAL;
+	}
+
+	freelist = (nccl_ofi_freelist_t *)calloc(1, sizeof(nccl_ofi_freelist_t));
+	if (!freelist) {
+		NCCL_OFI_WARN("Allocating freelist failed");
+		return -ENOMEM;
+	}
+
+	/* Entry layout of the parent, allocation and release use the
+	 * parent */
+	freelist->entry_size = parent->entry_size;
+	freelist->have_reginfo = parent->have_reginfo;
+	freelist->reginfo_offset = parent->reginfo_offset;
+	freelist->mode = parent->mode;
+	freelist->max_entry_count = max_entry_count;
+	freelist->num_allocated_entries = 0;
+	freelist->parent = parent;
+
+	*freelist_p = freelist;
+	return 0;
+}
+
 int nccl_ofi_freelist_fini(nccl_ofi_freelist_t *freelist)
 {
 	int ret;
 
 	assert(freelist);
 
+	if (freelist->parent) {
+		/* Entries still in use stay allocated in the parent
+		 * until it is finalized */
+		free(freelist);
+		return 0;
+	}
+
+	if (freelist->mode == NCCL_OFI_FREELIST_MODE_CACHE) {
+		/* Magazines are released by their threads. Entries
+		 * still cached in them go away with the blocks. */
+		struct nccl_ofi_freelist_magazine_t *magazine, *tmp;
+		nccl_net_ofi_mutex_lock(&magazine_lock);
+		DL_FOREACH_SAFE2(freelist->magazines, magazine, tmp, fl_next) {
+			__atomic_store_n(&magazine->freelist, NULL, __ATOMIC_RELAXED);
+		}
+		freelist->magazines = NULL;
+		nccl_net_ofi_mutex_unlock(&magazine_lock);
+	}
+
 	while (freelist->blocks) {
 		struct nccl_ofi_freelist_block_t *block = freelist->blocks;
 		nccl_net_ofi_mem_defined(block, sizeof(struct nccl_ofi_freelist_block_t));
@@ -197,6 +406,7 @@ int nccl_ofi_freelist_fini(nccl_ofi_freelist_t *freelist)
 
 	freelist->entry_size = 0;
 	freelist->entries = NULL;
+	freelist->lockfree_top = 0;
 
 	pthread_mutex_destroy(&freelist->lock);
 
@@ -215,6 +425,8 @@ int nccl_ofi_freelist_add(nccl_ofi_freelist_t *freelist,
 	size_t block_mem_size = 0;
 	char *buffer;
 	struct nccl_ofi_freelist_block_t *block;
+	struct nccl_ofi_freelist_elem_t *entries = NULL;
+	struct nccl_ofi_freelist_elem_t *last_entry = NULL;
 
 	if (freelist->max_entry_count > 0 &&
 	    freelist->max_entry_count - freelist->num_allocated_entries < allocation_count) {
@@ -232,13 +444,26 @@ int nccl_ofi_freelist_add(nccl_ofi_freelist_t *freelist,
 	   structure at the end of the allocation so that large
 	   buffers are more likely to be page aligned (or aligned to
 	   their size, as the case may be). */
-	block_mem_size = freelist_block_mem_size_full_pages(freelist->entry_size, allocation_count);
-	ret = nccl_net_ofi_alloc_mr_buffer(block_mem_size, (void **)&buffer);
+	block_mem_size = freelist_block_mem_size_full_pages(freelist->entry_size, allocation_count,
+							    freelist->page_size);
+	ret = nccl_net_ofi_alloc_mr_buffer_numa(block_mem_size, freelist->huge_pages,
+						freelist->numa_node, (void **)&buffer);
 	if (OFI_UNLIKELY(ret != 0)) {
 		NCCL_OFI_WARN("freelist extension allocation failed (%d)", ret);
 		return ret;
 	}
 
+	if (freelist->mode == NCCL_OFI_FREELIST_MODE_LOCKFREE &&
+	    (((uintptr_t)buffer + block_mem_size) & ~NCCL_OFI_FREELIST_PTR_MASK) != 0) {
+		NCCL_OFI_WARN("freelist extension %p does not leave room for the lock-free tag",
+			      buffer);
+		ret = nccl_net_ofi_dealloc_mr_buffer(buffer, block_mem_size);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Unable to deallocate MR buffer(%d)", ret);
+		}
+		return -ENOTSUP;
+	}
+
 	block = (struct nccl_ofi_freelist_block_t *)((uintptr_t)buffer + (freelist->entry_size * allocation_count));
 	block->memory = buffer;
 	block->memory_size = block_mem_size;
@@ -283,6 +508,11 @@ int nccl_ofi_freelist_add(nccl_ofi_freelist_t *freelist,
 
 	freelist->blocks = block;
 
+	/* Lock-free freelists are updated once all entries are linked */
+	if (freelist->mode != NCCL_OFI_FREELIST_MODE_LOCKFREE) {
+		entries = freelist->entries;
+	}
+
 	for (size_t i = 0 ; i < allocation_count ; ++i) {
 		struct nccl_ofi_freelist_elem_t *entry;
 		size_t user_entry_size = freelist->entry_size - freelist->memcheck_redzone_size;
@@ -301,9 +531,12 @@ int nccl_ofi_freelist_add(nccl_ofi_freelist_t *freelist,
 			entry = (struct nccl_ofi_freelist_elem_t *)(uintptr_t)buffer;
 		}
 		entry->ptr = buffer;
-		entry->next = freelist->entries;
+		entry->next = entries;
 
-		freelist->entries = entry;
+		entries = entry;
+		if (!last_entry) {
+			last_entry = entry;
+		}
 		freelist->num_allocated_entries++;
 
 		nccl_net_ofi_mem_noaccess(entry->ptr, user_entry_size);
@@ -314,5 +547,182 @@ int nccl_ofi_freelist_add(nccl_ofi_freelist_t *freelist,
 	/* Block structure will not be accessed until freelist is destroyed */
 	nccl_net_ofi_mem_noaccess(block, sizeof(struct nccl_ofi_freelist_block_t));
 
+	if (freelist->mode == NCCL_OFI_FREELIST_MODE_LOCKFREE) {
+		nccl_ofi_freelist_lockfree_push(freelist, entries, last_entry);
+	} else {
+		freelist->entries = entries;
+	}
+
 	return 0;
 }
+
+struct nccl_ofi_freelist_magazine_t *nccl_ofi_freelist_magazine_lookup(nccl_ofi_freelist_t *freelist)
+{
+	struct nccl_ofi_freelist_magazine_t **prev = &thread_magazines;
+	struct nccl_ofi_freelist_magazine_t *magazine = NULL;
+	struct nccl_ofi_freelist_magazine_t *iter;
+	int ret;
+
+	assert(freelist->mode == NCCL_OFI_FREELIST_MODE_CACHE);
+
+	/* The magazine list of the thread is only modified by the
+	 * thread itself, so it can be searched without the lock */
+	for (iter = thread_magazines; iter; iter = iter->thread_next) {
+		if (__atomic_load_n(&iter->freelist, __ATOMIC_RELAXED) == freelist) {
+			nccl_ofi_freelist_tls_magazines[freelist->tls_slot] = iter;
+			return iter;
+		}
+	}
+
+	nccl_net_ofi_mutex_lock(&magazine_lock);
+
+	/* Find the magazine of this freelist, releasing the magazines
+	 * of finalized freelists on the way */
+	while ((iter = *prev) != NULL) {
+		if (iter->freelist == NULL) {
+			*prev = iter->thread_next;
+			for (int i = 0; i < NCCL_OFI_FREELIST_TLS_SLOTS; i++) {
+				if (nccl_ofi_freelist_tls_magazines[i] == iter) {
+					nccl_ofi_freelist_tls_magazines[i] = NULL;
+				}
+			}
+			free(iter);
+			continue;
+		}
+		if (iter->freelist == freelist) {
+			magazine = iter;
+		}
+		prev = &iter->thread_next;
+	}
+
+	if (!magazine) {
+		magazine = (struct nccl_ofi_freelist_magazine_t *)calloc(1, sizeof(*magazine));
+		if (!magazine) {
+			NCCL_OFI_WARN("Allocating freelist magazine failed");
+			goto unlock;
+		}
+		magazine->freelist = freelist;
+		DL_APPEND2(freelist->magazines, magazine, fl_prev, fl_next);
+		magazine->thread_next = thread_magazines;
+		thread_magazines = magazine;
+	}
+
+	/* The key value is handed to the thread exit destructor */
+	ret = pthread_setspecific(magazine_key, thread_magazines);
+	if (ret != 0) {
+		NCCL_OFI_WARN("pthread_setspecific failed: %s", strerror(ret));
+	}
+
+	nccl_ofi_freelist_tls_magazines[freelist->tls_slot] = magazine;
+
+unlock:
+	nccl_net_ofi_mutex_unlock(&magazine_lock);
+
+	return magazine;
+}
+
+struct nccl_ofi_freelist_elem_t *nccl_ofi_freelist_magazine_refill(nccl_ofi_freelist_t *freelist,
+								   struct nccl_ofi_freelist_magazine_t *magazine)
+{
+	int ret;
+	struct nccl_ofi_freelist_elem_t *entry = NULL;
+
+	assert(magazine->entries == NULL);
+
+	nccl_net_ofi_mutex_lock(&freelist->lock);
+
+	if (!freelist->entries) {
+		ret = nccl_ofi_freelist_add(freelist, freelist->increase_entry_count);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Could not extend freelist: %d", ret);
+			goto unlock;
+		}
+	}
+
+	entry = freelist->entries;
+	if (OFI_UNLIKELY(!entry)) {
+		goto unlock;
+	}
+	nccl_net_ofi_mem_defined_unaligned(entry, sizeof(*entry));
+	freelist->entries = entry->next;
+
+	/* The remaining entries of the batch stay linked and inaccessible */
+	if (freelist->entries) {
+		struct nccl_ofi_freelist_elem_t *last = freelist->entries;
+		size_t count = 1;
+
+		nccl_net_ofi_mem_defined_unaligned(last, sizeof(*last));
+		while (count < freelist->magazine_batch - 1 && last->next) {
+			struct nccl_ofi_freelist_elem_t *next = last->next;
+			nccl_net_ofi_mem_noaccess_unaligned(last, sizeof(*last));
+			last = next;
+			nccl_net_ofi_mem_defined_unaligned(last, sizeof(*last));
+			count++;
+		}
+
+		if (freelist->magazine_batch > 1) {
+			magazine->entries = freelist->entries;
+			magazine->num_entries = count;
+			freelist->entries = last->next;
+			last->next = NULL;
+		}
+		nccl_net_ofi_mem_noaccess_unaligned(last, sizeof(*last));
+	}
+
+unlock:
+	nccl_net_ofi_mutex_unlock(&freelist->lock);
+
+	return entry;
+}
+
+void nccl_ofi_freelist_magazine_flush(nccl_ofi_freelist_t *freelist,
+				      struct nccl_ofi_freelist_magazine_t *magazine)
+{
+	struct nccl_ofi_freelist_elem_t *first = magazine->entries;
+	struct nccl_ofi_freelist_elem_t *last = first;
+	size_t count = 1;
+
+	assert(magazine->num_entries > freelist->magazine_batch);
+
+	/* Walk the batch outside of the lock, the magazine is private
+	 * to this thread */
+	nccl_net_ofi_mem_defined_unaligned(last, sizeof(*last));
+	while (count < freelist->magazine_batch) {
+		struct nccl_ofi_freelist_elem_t *next = last->next;
+		nccl_net_ofi_mem_noaccess_unaligned(last, sizeof(*last));
+		last = next;
+		nccl_net_ofi_mem_defined_unaligned(last, sizeof(*last));
+		count++;
+	}
+	magazine->entries = last->next;
+	magazine->num_entries -= count;
+
+	nccl_net_ofi_mutex_lock(&freelist->lock);
+	last->next = freelist->entries;
+	freelist->entries = first;
+	nccl_net_ofi_mutex_unlock(&freelist->lock);
+
+	nccl_net_ofi_mem_noaccess_unaligned(last, sizeof(*last));
+}
+
+struct nccl_ofi_freelist_elem_t *nccl_ofi_freelist_lockfree_grow(nccl_ofi_freelist_t *freelist)
+{
+	int ret;
+	struct nccl_ofi_freelist_elem_t *entry;
+
+	nccl_net_ofi_mutex_lock(&freelist->lock);
+
+	/* Other threads may have grown the freelist or returned
+	 * entries in the meantime */
+	while ((entry = nccl_ofi_freelist_lockfree_try_pop(freelist)) == NULL) {
+		ret = nccl_ofi_freelist_add(freelist, freelist->increase_entry_count);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Could not extend freelist: %d", ret);
+			break;
+		}
+	}
+
+	nccl_net_ofi_mutex_unlock(&freelist->lock);
+
+	return entry;
+}
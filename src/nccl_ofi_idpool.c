@@ -7,11 +7,184 @@
 #include <errno.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 
 #include "nccl_ofi_idpool.h"
 #include "nccl_ofi_math.h"
+#include "nccl_ofi_param.h"
 #include "nccl_ofi_pthread.h"
 
+/* Number of bits of a bitmap word */
+#define IDPOOL_WORD_BITS (sizeof(uint64_t) * 8)
+
+/*
+ * @brief	Number of words of a bitmap level with `num_bits' bits
+ */
+static inline size_t idpool_num_words(size_t num_bits)
+{
+	return NCCL_OFI_ROUND_UP(num_bits, IDPOOL_WORD_BITS) / IDPOOL_WORD_BITS;
+}
+
+/*
+ * @brief	Set the summary bits of word `w' of level `level' up the
+ *		bitmap, after bits were set in the word
+ *
+ * Stops at the first level whose word had bits set already, since
+ * the summary bits above are set, or will be restored by the
+ * concurrent allocation that cleared them (see idpool_clear_up()).
+ */
+static inline void idpool_set_up(nccl_ofi_idpool_t *idpool, int level, size_t w)
+{
+	for (level++; level < idpool->num_levels; level++) {
+		uint64_t bit = 1ULL << (w % IDPOOL_WORD_BITS);
+		w /= IDPOOL_WORD_BITS;
+		uint64_t old = __atomic_fetch_or(&idpool->levels[level][w], bit, __ATOMIC_SEQ_CST);
+		if (old != 0) {
+			return;
+		}
+	}
+}
+
+/*
+ * @brief	Clear the summary bits of word `w' of level `level' up the
+ *		bitmap, after the word was found empty
+ *
+ * Each summary bit is cleared before the word below is checked
+ * again. If a concurrent release refilled the word in the meantime,
+ * the summary bit is set again, so a word with available IDs never
+ * stays hidden.
+ */
+static inline void idpool_clear_up(nccl_ofi_idpool_t *idpool, int level, size_t w)
+{
+	for (; level + 1 < idpool->num_levels; level++) {
+		uint64_t bit = 1ULL << (w % IDPOOL_WORD_BITS);
+		size_t parent = w / IDPOOL_WORD_BITS;
+		uint64_t old = __atomic_fetch_and(&idpool->levels[level + 1][parent], ~bit,
+						  __ATOMIC_SEQ_CST);
+
+		if (__atomic_load_n(&idpool->levels[level][w], __ATOMIC_SEQ_CST) != 0) {
+			idpool_set_up(idpool, level, w);
+			return;
+		}
+		if ((old & ~bit) != 0) {
+			return;
+		}
+		w = parent;
+	}
+}
+
+/*
+ * @brief	Claim the lowest available ID of word `w' of the bottom
+ *		level
+ *
+ * @return	the claimed ID, or -1 if the word has no available IDs
+ */
+static inline long idpool_claim_word(nccl_ofi_idpool_t *idpool, size_t w)
+{
+	uint64_t word = __atomic_load_n(&idpool->ids[w], __ATOMIC_SEQ_CST);
+
+	while (word != 0) {
+		uint64_t bit = word & (~word + 1);
+		if (__atomic_compare_exchange_n(&idpool->ids[w], &word, word & ~bit, false,
+						__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+			if ((word & ~bit) == 0) {
+				idpool_clear_up(idpool, 0, w);
+			}
+			return (long)(w * IDPOOL_WORD_BITS + (size_t)__builtin_ctzll(bit));
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * @brief	Claim an available ID by scanning the bottom level of the
+ *		bitmap, without relying on the summary levels
+ *
+ * @return	the claimed ID, or -1 if no word had available IDs
+ */
+static long idpool_claim_scan(nccl_ofi_idpool_t *idpool)
+{
+	size_t num_words = idpool_num_words(idpool->size);
+
+	for (size_t w = 0; w < num_words; w++) {
+		long id = idpool_claim_word(idpool, w);
+		if (id >= 0) {
+			return id;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * @brief	Claim the lowest available ID of the bitmap
+ *
+ * @return	the claimed ID, or -1 if the pool is exhausted
+ */
+static long idpool_claim(nccl_ofi_idpool_t *idpool)
+{
+	const int top = idpool->num_levels - 1;
+
+ retry:
+	{
+		size_t w = 0;
+
+		/* Walk down the summary levels */
+		for (int level = top; level > 0; level--) {
+			uint64_t word = __atomic_load_n(&idpool->levels[level][w], __ATOMIC_SEQ_CST);
+			if (word == 0) {
+				if (level == top) {
+					/* The summary bits of a word being
+					 * refilled or found empty are
+					 * missing for a moment. Scan before
+					 * reporting exhaustion. */
+					return idpool_claim_scan(idpool);
+				}
+				/* Stale summary bit */
+				idpool_clear_up(idpool, level, w);
+				goto retry;
+			}
+			w = w * IDPOOL_WORD_BITS + (size_t)__builtin_ctzll(word);
+		}
+
+		/* Claim a bit of the bottom level */
+		long id = idpool_claim_word(idpool, w);
+		if (id >= 0) {
+			return id;
+		}
+
+		if (top == 0) {
+			return -1;
+		}
+
+		/* Emptied concurrently, or stale summary bit */
+		idpool_clear_up(idpool, 0, w);
+		goto retry;
+	}
+}
+
+/*
+ * @brief	Resolve NCCL_OFI_IDPOOL_MODE_DEFAULT
+ */
+static int idpool_resolve_mode(nccl_ofi_idpool_mode_t *mode)
+{
+	if (*mode == NCCL_OFI_IDPOOL_MODE_DEFAULT) {
+		const char *mode_str = ofi_nccl_idpool_mode();
+		if (0 == strcasecmp(mode_str, "mutex")) {
+			*mode = NCCL_OFI_IDPOOL_MODE_MUTEX;
+		} else if (0 == strcasecmp(mode_str, "lockfree")) {
+			*mode = NCCL_OFI_IDPOOL_MODE_LOCKFREE;
+		} else {
+			NCCL_OFI_WARN("Invalid value for OFI_NCCL_IDPOOL_MODE: %s", mode_str);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
 /*
  * @brief	Initialize pool of IDs
  *
@@ -26,8 +199,20 @@
  *		non-zero on error
  */
 int nccl_ofi_idpool_init(nccl_ofi_idpool_t *idpool, size_t size)
+{
+	return nccl_ofi_idpool_init_mode(idpool, size, NCCL_OFI_IDPOOL_MODE_DEFAULT);
+}
+
+/*
+ * @brief	Initialize pool of IDs with the given synchronization mode
+ */
+int nccl_ofi_idpool_init_mode(nccl_ofi_idpool_t *idpool, size_t size,
+			      nccl_ofi_idpool_mode_t mode)
 {
 	int ret = 0;
+	size_t level_words[NCCL_OFI_IDPOOL_MAX_LEVELS];
+	size_t total_words = 0;
+	int num_levels = 0;
 
 	assert(NULL != idpool);
 
@@ -35,14 +220,31 @@ int nccl_ofi_idpool_init(nccl_ofi_idpool_t *idpool, size_t size)
 		/* Empty or unused pool */
 		idpool->ids = NULL;
 		idpool->size = 0;
+		idpool->num_levels = 0;
 		return ret;
 	}
 
-	/* Scale pool size to number of 64-bit uints (rounded up) */
-	size_t num_long_elements = NCCL_OFI_ROUND_UP(size, sizeof(uint64_t) * 8) / (sizeof(uint64_t) * 8);
+	ret = idpool_resolve_mode(&mode);
+	if (OFI_UNLIKELY(ret != 0)) {
+		return ret;
+	}
+
+	/* Size the levels, each one summarizing the words of the
+	   level below, up to a single word */
+	size_t num_bits = size;
+	do {
+		if (num_levels == NCCL_OFI_IDPOOL_MAX_LEVELS) {
+			NCCL_OFI_WARN("ID pool size %zu too large", size);
+			return -EINVAL;
+		}
+		level_words[num_levels] = idpool_num_words(num_bits);
+		total_words += level_words[num_levels];
+		num_bits = level_words[num_levels];
+		num_levels++;
+	} while (num_bits > 1);
 
 	/* Allocate memory for the pool */
-	idpool->ids = (uint64_t *)malloc(sizeof(uint64_t) * num_long_elements);
+	idpool->ids = (uint64_t *)malloc(sizeof(uint64_t) * total_words);
 
 	/* Return in case of allocation error */
 	if (NULL == idpool->ids) {
@@ -50,11 +252,24 @@ int nccl_ofi_idpool_init(nccl_ofi_idpool_t *idpool, size_t size)
 		return -ENOMEM;
 	}
 
-	/* Set all IDs to be available */
-	memset(idpool->ids, 0xff, size / 8);
-	if (size % 8) {
-		idpool->ids[num_long_elements - 1] = (1ULL << (size % (sizeof(uint64_t) * 8))) - 1;
+	/* Set all IDs to be available, and all summary bits of the
+	   words below */
+	num_bits = size;
+	uint64_t *level_ids = idpool->ids;
+	for (int level = 0; level < num_levels; level++) {
+		size_t num_words = level_words[level];
+
+		memset(level_ids, 0xff, sizeof(uint64_t) * num_words);
+		if (num_bits % IDPOOL_WORD_BITS) {
+			level_ids[num_words - 1] = (1ULL << (num_bits % IDPOOL_WORD_BITS)) - 1;
+		}
+		idpool->levels[level] = level_ids;
+
+		level_ids += num_words;
+		num_bits = num_words;
 	}
+	idpool->num_levels = num_levels;
+	idpool->mode = mode;
 
 	/* Initialize mutex */
 	ret = nccl_net_ofi_mutex_init(&idpool->lock, NULL);
@@ -75,9 +290,10 @@ int nccl_ofi_idpool_init(nccl_ofi_idpool_t *idpool, size_t size)
  *
  * Extract an available ID from the ID pool, mark the ID as
  * unavailable in the pool, and return extracted ID. No-op in case
- * no ID was available.
+ * no ID was available. The lowest available ID is returned.
  *
- * This operation is locked by the ID pool's internal lock.
+ * This operation is locked by the ID pool's internal lock, except in
+ * NCCL_OFI_IDPOOL_MODE_LOCKFREE.
  *
  * @param	idpool
  *		The ID pool
@@ -98,38 +314,21 @@ int nccl_ofi_idpool_allocate_id(nccl_ofi_idpool_t *idpool)
 		return -EINVAL;
 	}
 
-	/* Scale pool size to number of 64-bit uints (rounded up) */
-	size_t num_long_elements = NCCL_OFI_ROUND_UP(idpool->size, sizeof(uint64_t) * 8) / (sizeof(uint64_t) * 8);
-
-	nccl_net_ofi_mutex_lock(&idpool->lock);
-
-	int entry_index = 0;
-
-	bool found = false;
-	size_t id = 0;
-	for (size_t i = 0; i < num_long_elements; i++) {
-		entry_index = __builtin_ffsll(idpool->ids[i]);
-		if (0 != entry_index) {
-			/* Found one available ID */
-
-			/* Set to 0 bit at entry_index - 1 */
-			idpool->ids[i] &= ~(1ULL << (entry_index - 1));
-
-			/* Store the ID we found */
-			id = (size_t)((i * sizeof(uint64_t) * 8) + entry_index - 1);
-			found = true;
-			break;
-		}
+	long id;
+	if (idpool->mode == NCCL_OFI_IDPOOL_MODE_LOCKFREE) {
+		id = idpool_claim(idpool);
+	} else {
+		nccl_net_ofi_mutex_lock(&idpool->lock);
+		id = idpool_claim(idpool);
+		nccl_net_ofi_mutex_unlock(&idpool->lock);
 	}
 
-	nccl_net_ofi_mutex_unlock(&idpool->lock);
-
-	if (!found || id >= idpool->size) {
+	if (id < 0) {
 		NCCL_OFI_WARN("No IDs available (max: %lu)", idpool->size);
 		return -ENOMEM;
 	}
 
-	return id;
+	return (int)id;
 }
 
 /*
@@ -137,7 +336,8 @@ int nccl_ofi_idpool_allocate_id(nccl_ofi_idpool_t *idpool)
  *
  * Return input ID into the pool.
  *
- * This operation is locked by the ID pool's internal lock.
+ * This operation is locked by the ID pool's internal lock, except in
+ * NCCL_OFI_IDPOOL_MODE_LOCKFREE.
  *
  * @param	idpool
  *		The ID pool
@@ -165,23 +365,32 @@ int nccl_ofi_idpool_free_id(nccl_ofi_idpool_t *idpool, size_t id)
 		return -EINVAL;
 	}
 
-	nccl_net_ofi_mutex_lock(&idpool->lock);
+	bool locked = idpool->mode != NCCL_OFI_IDPOOL_MODE_LOCKFREE;
+	if (locked) {
+		nccl_net_ofi_mutex_lock(&idpool->lock);
+	}
 
-	size_t i = id / (sizeof(uint64_t) * 8);
-	size_t entry_index = id % (sizeof(uint64_t) * 8);
+	size_t i = id / IDPOOL_WORD_BITS;
+	uint64_t bit = 1ULL << (id % IDPOOL_WORD_BITS);
 
-	/* Check if bit is 1 already */
-	if (idpool->ids[i] & (1ULL << entry_index)) {
+	/* Set bit to 1, making the ID available */
+	uint64_t old = __atomic_fetch_or(&idpool->ids[i], bit, __ATOMIC_SEQ_CST);
+	if (old & bit) {
+		/* Bit was 1 already */
+		if (locked) {
+			nccl_net_ofi_mutex_unlock(&idpool->lock);
+		}
 		NCCL_OFI_WARN("Attempted to free an ID that's not in use (%lu)", id);
-
-		nccl_net_ofi_mutex_unlock(&idpool->lock);
 		return -ENOTSUP;
 	}
 
-	/* Set bit to 1, making the ID available */
-	idpool->ids[i] |= 1ULL << (entry_index);
+	if (old == 0) {
+		idpool_set_up(idpool, 0, i);
+	}
 
-	nccl_net_ofi_mutex_unlock(&idpool->lock);
+	if (locked) {
+		nccl_net_ofi_mutex_unlock(&idpool->lock);
+	}
 
 	return 0;
 }
@@ -216,6 +425,7 @@ int nccl_ofi_idpool_fini(nccl_ofi_idpool_t *idpool)
 	free(idpool->ids);
 	idpool->ids = NULL;
 	idpool->size = 0;
+	idpool->num_levels = 0;
 
 	return ret;
 }
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#include "config.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "nccl_ofi_memcpy.h"
+
+#if defined(__x86_64__)
+
+/*
+ * @brief	Copy the bytes of `dst' up to the next `align'-byte
+ *		boundary, so that stores of the main loop are aligned
+ *
+ * @return	Number of bytes copied
+ */
+static inline size_t copy_head(void *dst, const void *src, size_t len, size_t align)
+{
+	size_t head = (align - ((uintptr_t)dst & (align - 1))) & (align - 1);
+	if (head > len) {
+		head = len;
+	}
+	memcpy(dst, src, head);
+	return head;
+}
+
+__attribute__((target("avx2")))
+static void memcpy_nt_avx2(void *dst, const void *src, size_t len)
+{
+	size_t done = copy_head(dst, src, len, 32);
+	char *d = (char *)dst + done;
+	const char *s = (const char *)src + done;
+	len -= done;
+
+	for (; len >= 128; len -= 128, d += 128, s += 128) {
+		__m256i v0 = _mm256_loadu_si256((const __m256i *)(s + 0));
+		__m256i v1 = _mm256_loadu_si256((const __m256i *)(s + 32));
+		__m256i v2 = _mm256_loadu_si256((const __m256i *)(s + 64));
+		__m256i v3 = _mm256_loadu_si256((const __m256i *)(s + 96));
+		_mm256_stream_si256((__m256i *)(d + 0), v0);
+		_mm256_stream_si256((__m256i *)(d + 32), v1);
+		_mm256_stream_si256((__m256i *)(d + 64), v2);
+		_mm256_stream_si256((__m256i *)(d + 96), v3);
+	}
+	for (; len >= 32; len -= 32, d += 32, s += 32) {
+		_mm256_stream_si256((__m256i *)d, _mm256_loadu_si256((const __m256i *)s));
+	}
+
+	/* Order the non-temporal stores before subsequent stores,
+	   e.g. the ones marking the request completed */
+	_mm_sfence();
+	memcpy(d, s, len);
+}
+
+__attribute__((target("avx512f")))
+static void memcpy_nt_avx512(void *dst, const void *src, size_t len)
+{
+	size_t done = copy_head(dst, src, len, 64);
+	char *d = (char *)dst + done;
+	const char *s = (const char *)src + done;
+	len -= done;
+
+	for (; len >= 256; len -= 256, d += 256, s += 256) {
+		__m512i v0 = _mm512_loadu_si512((const void *)(s + 0));
+		__m512i v1 = _mm512_loadu_si512((const void *)(s + 64));
+		__m512i v2 = _mm512_loadu_si512((const void *)(s + 128));
+		__m512i v3 = _mm512_loadu_si512((const void *)(s + 192));
+		_mm512_stream_si512((__m512i *)(d + 0), v0);
+		_mm512_stream_si512((__m512i *)(d + 64), v1);
+		_mm512_stream_si512((__m512i *)(d + 128), v2);
+		_mm512_stream_si512((__m512i *)(d + 192), v3);
+	}
+	for (; len >= 64; len -= 64, d += 64, s += 64) {
+		_mm512_stream_si512((__m512i *)d, _mm512_loadu_si512((const void *)s));
+	}
+
+	_mm_sfence();
+	memcpy(d, s, len);
+}
+
+#endif
+
+nccl_ofi_memcpy_isa_t nccl_ofi_memcpy_nt_isa(void)
+{
+	/* Resolved once; concurrent first calls store the same value */
+	static int isa = -1;
+	int cur = __atomic_load_n(&isa, __ATOMIC_RELAXED);
+
+	if (cur >= 0) {
+		return (nccl_ofi_memcpy_isa_t)cur;
+	}
+
+	cur = NCCL_OFI_MEMCPY_ISA_NONE;
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		cur = NCCL_OFI_MEMCPY_ISA_AVX512;
+	} else if (__builtin_cpu_supports("avx2")) {
+		cur = NCCL_OFI_MEMCPY_ISA_AVX2;
+	}
+#endif
+	__atomic_store_n(&isa, cur, __ATOMIC_RELAXED);
+
+	return (nccl_ofi_memcpy_isa_t)cur;
+}
+
+void nccl_ofi_memcpy_nt_isa_copy(nccl_ofi_memcpy_isa_t isa, void *dst, const void *src, size_t len)
+{
+	switch (isa) {
+#if defined(__x86_64__)
+	case NCCL_OFI_MEMCPY_ISA_AVX512:
+		memcpy_nt_avx512(dst, src, len);
+		return;
+	case NCCL_OFI_MEMCPY_ISA_AVX2:
+		memcpy_nt_avx2(dst, src, len);
+		return;
+#endif
+	case NCCL_OFI_MEMCPY_ISA_NONE:
+	default:
+		memcpy(dst, src, len);
+		return;
+	}
+}
+
+void nccl_ofi_memcpy_nt(void *dst, const void *src, size_t len)
+{
+	nccl_ofi_memcpy_nt_isa_copy(nccl_ofi_memcpy_nt_isa(), dst, src, len);
+}
@@ -7,9 +7,72 @@
 #include <errno.h>
 #include <stdlib.h>
 
+#include <uthash/utlist.h>
+
 #include "nccl_ofi_mr.h"
+#include "nccl_ofi_math.h"
 #include "nccl_ofi_pthread.h"
 
+/*
+ * Entry fields and tree linkage are read by lock-free lookups while the
+ * lock holder modifies them, so such writes use relaxed atomic stores
+ * and lock-free reads use relaxed atomic loads. Consistency of what a
+ * lookup read is established by the compare-and-swap on the entry's
+ * refs word, see mr_entry_try_get().
+ */
+#define MR_LOAD(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+#define MR_STORE(field, val) __atomic_store_n(&(field), (val), __ATOMIC_RELAXED)
+
+#define MR_ENTRY_REFCNT(refs) ((uint32_t)((refs) & 0xffffffffULL))
+#define MR_ENTRY_GEN_SHIFT (32)
+
+/*
+ * Upper bound on the number of nodes visited by a tree walk. A search
+ * visits at most two root-to-leaf paths, and AVL trees are less than
+ * 1.45 * log2(n + 2) deep. A lock-free walk racing with rotations may
+ * follow a transient cycle; the bound turns that into a miss.
+ */
+#define MR_TREE_MAX_STEPS (256)
+
+/*
+ * Internal: tracking data for blocks of preallocated cache entries
+ */
+struct nccl_ofi_reg_entry_block {
+	struct nccl_ofi_reg_entry_block *next;
+	nccl_ofi_reg_entry_t *entries;
+};
+
+/**
+ * Add a block of num_entries entries to the cache's free entries
+ */
+static int nccl_ofi_mr_cache_add_entries(nccl_ofi_mr_cache_t *cache, size_t num_entries)
+{
+	struct nccl_ofi_reg_entry_block *block =
+		(struct nccl_ofi_reg_entry_block *)calloc(1, sizeof(*block));
+	if (!block) {
+		NCCL_OFI_WARN("Could not allocate memory for cache entry block");
+		return -ENOMEM;
+	}
+
+	block->entries = (nccl_ofi_reg_entry_t *)calloc(num_entries, sizeof(*block->entries));
+	if (!block->entries) {
+		NCCL_OFI_WARN("Could not allocate memory for cache entries");
+		free(block);
+		return -ENOMEM;
+	}
+
+	for (size_t i = 0; i < num_entries; i++) {
+		block->entries[i].left = cache->free_entries;
+		cache->free_entries = &block->entries[i];
+	}
+
+	block->next = cache->blocks;
+	cache->blocks = block;
+	cache->size += num_entries;
+
+	return 0;
+}
+
 nccl_ofi_mr_cache_t *nccl_ofi_mr_cache_init(size_t init_num_entries,
 					    size_t system_page_size)
 {
@@ -31,9 +94,7 @@ nccl_ofi_mr_cache_t *nccl_ofi_mr_cache_init(size_t init_num_entries,
 		goto error;
 	}
 
-	ret_cache->slots = (nccl_ofi_reg_entry_t **)calloc(init_num_entries, sizeof(*ret_cache->slots));
-	if (!ret_cache->slots) {
-		NCCL_OFI_WARN("Could not allocate memory for cache slots");
+	if (nccl_ofi_mr_cache_add_entries(ret_cache, init_num_entries)) {
 		goto error;
 	}
 
@@ -41,8 +102,9 @@ nccl_ofi_mr_cache_t *nccl_ofi_mr_cache_init(size_t init_num_entries,
 		goto error;
 	}
 
+	ret_cache->root = NULL;
+	ret_cache->handle_index = NULL;
 	ret_cache->system_page_size = system_page_size;
-	ret_cache->size = init_num_entries;
 	ret_cache->used = 0;
 	ret_cache->hit_count = 0;
 	ret_cache->miss_count = 0;
@@ -51,8 +113,9 @@ nccl_ofi_mr_cache_t *nccl_ofi_mr_cache_init(size_t init_num_entries,
 
 error:
 	if (ret_cache) {
-		if (ret_cache->slots) {
-			free(ret_cache->slots);
+		if (ret_cache->blocks) {
+			free(ret_cache->blocks->entries);
+			free(ret_cache->blocks);
 		}
 		free(ret_cache);
 	}
@@ -64,13 +127,26 @@ void nccl_ofi_mr_cache_finalize(nccl_ofi_mr_cache_t *cache)
 	assert(cache);
 
 	NCCL_OFI_INFO(NCCL_NET,
-		      "MR cache %d hits %d misses",
+		      "MR cache %u hits %u misses %u evictions",
 		      cache->hit_count,
-		      cache->miss_count);
+		      cache->miss_count,
+		      cache->eviction_count);
+
+	if (cache->unused_entries) {
+		NCCL_OFI_WARN("MR cache finalized with %zu retained registrations",
+			      cache->unused_entries);
+	}
 
 	nccl_net_ofi_mutex_destroy(&cache->lock);
 
-	free(cache->slots);
+	HASH_CLEAR(hh, cache->handle_index);
+
+	while (cache->blocks) {
+		struct nccl_ofi_reg_entry_block *block = cache->blocks;
+		cache->blocks = block->next;
+		free(block->entries);
+		free(block);
+	}
 
 	free(cache);
 }
@@ -80,19 +156,13 @@ void nccl_ofi_mr_cache_finalize(nccl_ofi_mr_cache_t *cache)
  */
 static int nccl_ofi_mr_cache_grow(nccl_ofi_mr_cache_t *cache)
 {
-	void *ptr;
 	int ret = 0;
-	cache->size *= 2;
-	NCCL_OFI_TRACE(NCCL_NET, "Growing cache to size %zu", cache->size);
-	ptr = realloc(cache->slots, cache->size * sizeof(*cache->slots));
-	if (!ptr) {
+	NCCL_OFI_TRACE(NCCL_NET, "Growing cache to size %zu", 2 * cache->size);
+	ret = nccl_ofi_mr_cache_add_entries(cache, cache->size);
+	if (ret != 0) {
 		NCCL_OFI_WARN("Unable to grow cache");
-		ret = -ENOMEM;
-		goto out;
 	}
-	cache->slots = (nccl_ofi_reg_entry_t **)ptr;
 
-out:
 	return ret;
 }
 
@@ -106,11 +176,377 @@ static inline void compute_page_address(uintptr_t addr,
 	*pages = (addr + size - (*page_addr) + system_page_size - 1) / system_page_size; /* Number of pages in buffer */
 }
 
+/*
+ * Interval tree helpers
+ *
+ * The tree is an AVL tree ordered by (addr, entry address). Ordering by
+ * entry address as a tiebreaker keeps keys unique when several
+ * registrations start on the same page.
+ */
+
+static inline uintptr_t mr_entry_end(const nccl_ofi_mr_cache_t *cache,
+				     nccl_ofi_reg_entry_t *entry)
+{
+	return MR_LOAD(entry->addr) + MR_LOAD(entry->pages) * cache->system_page_size;
+}
+
+static inline int mr_tree_height(const nccl_ofi_reg_entry_t *node)
+{
+	return node ? node->height : 0;
+}
+
+static inline bool mr_entry_less(const nccl_ofi_reg_entry_t *a,
+				 const nccl_ofi_reg_entry_t *b)
+{
+	return a->addr < b->addr || (a->addr == b->addr && (uintptr_t)a < (uintptr_t)b);
+}
+
+/**
+ * Recompute height and subtree end of node from its children
+ */
+static inline void mr_tree_update(const nccl_ofi_mr_cache_t *cache,
+				  nccl_ofi_reg_entry_t *node)
+{
+	uintptr_t end = mr_entry_end(cache, node);
+
+	if (node->left) {
+		end = NCCL_OFI_MAX(end, node->left->subtree_end);
+	}
+	if (node->right) {
+		end = NCCL_OFI_MAX(end, node->right->subtree_end);
+	}
+
+	MR_STORE(node->subtree_end, end);
+	node->height = 1 + NCCL_OFI_MAX(mr_tree_height(node->left),
+					mr_tree_height(node->right));
+}
+
+static nccl_ofi_reg_entry_t *mr_tree_rotate_right(const nccl_ofi_mr_cache_t *cache,
+						  nccl_ofi_reg_entry_t *node)
+{
+	nccl_ofi_reg_entry_t *pivot = node->left;
+
+	MR_STORE(node->left, pivot->right);
+	MR_STORE(pivot->right, node);
+	mr_tree_update(cache, node);
+	mr_tree_update(cache, pivot);
+
+	return pivot;
+}
+
+static nccl_ofi_reg_entry_t *mr_tree_rotate_left(const nccl_ofi_mr_cache_t *cache,
+						 nccl_ofi_reg_entry_t *node)
+{
+	nccl_ofi_reg_entry_t *pivot = node->right;
+
+	MR_STORE(node->right, pivot->left);
+	MR_STORE(pivot->left, node);
+	mr_tree_update(cache, node);
+	mr_tree_update(cache, pivot);
+
+	return pivot;
+}
+
+/**
+ * Restore the AVL property at node after one of its subtrees changed
+ *
+ * @return new root of the subtree
+ */
+static nccl_ofi_reg_entry_t *mr_tree_balance(const nccl_ofi_mr_cache_t *cache,
+					     nccl_ofi_reg_entry_t *node)
+{
+	int balance;
+
+	mr_tree_update(cache, node);
+	balance = mr_tree_height(node->left) - mr_tree_height(node->right);
+
+	if (balance > 1) {
+		if (mr_tree_height(node->left->left) < mr_tree_height(node->left->right)) {
+			MR_STORE(node->left, mr_tree_rotate_left(cache, node->left));
+		}
+		return mr_tree_rotate_right(cache, node);
+	} else if (balance < -1) {
+		if (mr_tree_height(node->right->right) < mr_tree_height(node->right->left)) {
+			MR_STORE(node->right, mr_tree_rotate_right(cache, node->right));
+		}
+		return mr_tree_rotate_left(cache, node);
+	}
+
+	return node;
+}
+
+static nccl_ofi_reg_entry_t *mr_tree_insert(const nccl_ofi_mr_cache_t *cache,
+					    nccl_ofi_reg_entry_t *node,
+					    nccl_ofi_reg_entry_t *entry)
+{
+	if (!node) {
+		MR_STORE(entry->left, (nccl_ofi_reg_entry_t *)NULL);
+		MR_STORE(entry->right, (nccl_ofi_reg_entry_t *)NULL);
+		mr_tree_update(cache, entry);
+		return entry;
+	}
+
+	if (mr_entry_less(entry, node)) {
+		MR_STORE(node->left, mr_tree_insert(cache, node->left, entry));
+	} else {
+		MR_STORE(node->right, mr_tree_insert(cache, node->right, entry));
+	}
+
+	return mr_tree_balance(cache, node);
+}
+
+/**
+ * Unlink the leftmost entry of the subtree rooted at node
+ *
+ * @return new root of the subtree
+ */
+static nccl_ofi_reg_entry_t *mr_tree_remove_min(const nccl_ofi_mr_cache_t *cache,
+						nccl_ofi_reg_entry_t *node,
+						nccl_ofi_reg_entry_t **min)
+{
+	if (!node->left) {
+		*min = node;
+		return node->right;
+	}
+
+	MR_STORE(node->left, mr_tree_remove_min(cache, node->left, min));
+	return mr_tree_balance(cache, node);
+}
+
+static nccl_ofi_reg_entry_t *mr_tree_remove(const nccl_ofi_mr_cache_t *cache,
+					    nccl_ofi_reg_entry_t *node,
+					    nccl_ofi_reg_entry_t *entry)
+{
+	nccl_ofi_reg_entry_t *successor = NULL;
+	nccl_ofi_reg_entry_t *right = NULL;
+
+	assert(node);
+
+	if (node != entry) {
+		if (mr_entry_less(entry, node)) {
+			MR_STORE(node->left, mr_tree_remove(cache, node->left, entry));
+		} else {
+			MR_STORE(node->right, mr_tree_remove(cache, node->right, entry));
+		}
+		return mr_tree_balance(cache, node);
+	}
+
+	if (!node->left) {
+		return node->right;
+	} else if (!node->right) {
+		return node->left;
+	}
+
+	right = mr_tree_remove_min(cache, node->right, &successor);
+	MR_STORE(successor->left, node->left);
+	MR_STORE(successor->right, right);
+
+	return mr_tree_balance(cache, successor);
+}
+
+/**
+ * Find an entry covering [page_addr, page_addr + pages pages)
+ *
+ * Walks towards the entries starting at or before page_addr and uses
+ * the subtree end addresses to descend only into a subtree known to
+ * hold a covering entry, so at most two root-to-leaf paths are visited.
+ *
+ * Without the cache lock, the result is only a candidate, which must be
+ * validated with mr_entry_try_get().
+ */
+static nccl_ofi_reg_entry_t *mr_tree_find_covering(nccl_ofi_mr_cache_t *cache,
+						   uintptr_t page_addr,
+						   size_t pages)
+{
+	uintptr_t end = page_addr + pages * cache->system_page_size;
+	nccl_ofi_reg_entry_t *node = MR_LOAD(cache->root);
+	nccl_ofi_reg_entry_t *left;
+	bool descending = false;
+
+	for (int steps = 0; node && steps < MR_TREE_MAX_STEPS; steps++) {
+		if (mr_entry_end(cache, node) >= end && (descending || MR_LOAD(node->addr) <= page_addr)) {
+			return node;
+		}
+
+		left = MR_LOAD(node->left);
+		if (descending) {
+			/* Every entry below the subtree we descended into
+			 * starts at or before page_addr, so any entry ending
+			 * late enough covers the range */
+			node = (left && MR_LOAD(left->subtree_end) >= end) ? left : MR_LOAD(node->right);
+		} else if (MR_LOAD(node->addr) > page_addr) {
+			node = left;
+		} else if (left && MR_LOAD(left->subtree_end) >= end) {
+			descending = true;
+			node = left;
+		} else {
+			node = MR_LOAD(node->right);
+		}
+	}
+
+	return NULL;
+}
+
+static inline bool mr_entry_covers(const nccl_ofi_mr_cache_t *cache,
+				   nccl_ofi_reg_entry_t *entry,
+				   uintptr_t page_addr,
+				   size_t pages)
+{
+	return MR_LOAD(entry->addr) <= page_addr &&
+		page_addr + pages * cache->system_page_size <= mr_entry_end(cache, entry);
+}
+
+/**
+ * Take a reference on entry if it is live and covers the range
+ *
+ * The entry fields are read after observing a non-zero reference count
+ * and before incrementing it with a compare-and-swap. Entries are only
+ * rewritten after their reference count dropped to zero and are then
+ * published with a new generation, so a successful compare-and-swap
+ * proves that the fields read belong to the live registration the
+ * reference was taken on.
+ */
+static bool mr_entry_try_get(const nccl_ofi_mr_cache_t *cache,
+			     nccl_ofi_reg_entry_t *entry,
+			     uintptr_t page_addr,
+			     size_t pages)
+{
+	uint64_t refs = __atomic_load_n(&entry->refs, __ATOMIC_ACQUIRE);
+
+	do {
+		if (MR_ENTRY_REFCNT(refs) == 0 ||
+		    !mr_entry_covers(cache, entry, page_addr, pages)) {
+			return false;
+		}
+	} while (!__atomic_compare_exchange_n(&entry->refs, &refs, refs + 1, false,
+					      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+	return true;
+}
+
+/**
+ * Account for a cache hit on entry
+ */
+static inline void *mr_cache_hit(nccl_ofi_mr_cache_t *cache,
+				 nccl_ofi_reg_entry_t *entry,
+				 nccl_ofi_mr_ckey_ref ckey)
+{
+	void *handle = MR_LOAD(entry->handle);
+
+	__atomic_fetch_add(&cache->hit_count, 1, __ATOMIC_RELAXED);
+	NCCL_OFI_TRACE(NCCL_NET,
+		       "Found MR handle %p for %ld(%s) in cache entry %p",
+		       handle,
+		       nccl_ofi_mr_ckey_baseaddr(ckey),
+		       nccl_ofi_mr_ckey_type_str(ckey),
+		       entry);
+
+	return handle;
+}
+
+/**
+ * Unlink entry from the cache and return it to the free entries. The
+ * entry memory stays valid for lock-free lookups still reading it.
+ */
+static void mr_cache_remove_entry(nccl_ofi_mr_cache_t *cache,
+				  nccl_ofi_reg_entry_t *entry)
+{
+	MR_STORE(cache->root, mr_tree_remove(cache, cache->root, entry));
+	HASH_DEL(cache->handle_index, entry);
+	MR_STORE(entry->left, cache->free_entries);
+	cache->free_entries = entry;
+	--cache->used;
+}
+
+/**
+ * Remove a retained entry from the LRU list
+ */
+static inline void mr_cache_unretain(nccl_ofi_mr_cache_t *cache,
+				     nccl_ofi_reg_entry_t *entry)
+{
+	DL_DELETE2(cache->lru, entry, lru_prev, lru_next);
+	cache->unused_entries--;
+	cache->unused_bytes -= entry->pages * cache->system_page_size;
+}
+
+/**
+ * Evict a retained entry and deregister its handle
+ */
+static void mr_cache_evict(nccl_ofi_mr_cache_t *cache,
+			   nccl_ofi_reg_entry_t *entry)
+{
+	void *handle = entry->handle;
+
+	mr_cache_unretain(cache, entry);
+	mr_cache_remove_entry(cache, entry);
+	cache->eviction_count++;
+
+	NCCL_OFI_TRACE(NCCL_NET, "Evicted MR handle %p from cache", handle);
+
+	if (cache->dereg_fn(cache->dereg_opaque, handle) != 0) {
+		NCCL_OFI_WARN("Failed to deregister evicted MR handle %p", handle);
+	}
+}
+
+/**
+ * Identify the allocation containing the range of the key, or return 0
+ * if the range does not lie within a single identifiable allocation
+ */
+static uint64_t mr_cache_alloc_id(nccl_ofi_mr_cache_t *cache,
+				  nccl_ofi_mr_ckey_ref ckey)
+{
+	uintptr_t base = nccl_ofi_mr_ckey_baseaddr(ckey);
+	uintptr_t len = nccl_ofi_mr_ckey_len(ckey);
+	uint64_t id = cache->alloc_id_fn(cache->dereg_opaque, base);
+
+	if (len > 1 && cache->alloc_id_fn(cache->dereg_opaque, base + len - 1) != id) {
+		return 0;
+	}
+
+	return id;
+}
+
+static inline bool mr_cache_over_budget(const nccl_ofi_mr_cache_t *cache)
+{
+	return (cache->max_unused_entries && cache->unused_entries > cache->max_unused_entries) ||
+		(cache->max_unused_bytes && cache->unused_bytes > cache->max_unused_bytes);
+}
+
+void nccl_ofi_mr_cache_set_retention(nccl_ofi_mr_cache_t *cache,
+				     size_t max_entries,
+				     size_t max_bytes,
+				     nccl_ofi_mr_cache_dereg_fn dereg_fn,
+				     nccl_ofi_mr_cache_alloc_id_fn alloc_id_fn,
+				     void *dereg_opaque)
+{
+	assert(cache->used == 0);
+	assert(!dereg_fn == !alloc_id_fn);
+
+	cache->max_unused_entries = max_entries;
+	cache->max_unused_bytes = max_bytes;
+	cache->dereg_fn = dereg_fn;
+	cache->alloc_id_fn = alloc_id_fn;
+	cache->dereg_opaque = dereg_opaque;
+
+	NCCL_OFI_INFO(NCCL_INIT | NCCL_NET,
+		      "MR cache retains up to %zu unused registrations and %zu bytes (0 is unlimited)",
+		      max_entries, max_bytes);
+}
+
+void nccl_ofi_mr_cache_flush(nccl_ofi_mr_cache_t *cache)
+{
+	while (cache->lru) {
+		mr_cache_evict(cache, cache->lru);
+	}
+}
+
 void *nccl_ofi_mr_cache_lookup_entry(nccl_ofi_mr_cache_t *cache,
 				     nccl_ofi_mr_ckey_ref ckey)
 {
 	uintptr_t page_addr;
 	size_t pages;
+	nccl_ofi_reg_entry_t *entry;
+	uint64_t refs = 0;
 
 	compute_page_address(nccl_ofi_mr_ckey_baseaddr(ckey),
 			     nccl_ofi_mr_ckey_len(ckey),
@@ -118,30 +554,56 @@ void *nccl_ofi_mr_cache_lookup_entry(nccl_ofi_mr_cache_t *cache,
 			     &page_addr,
 			     &pages);
 
-	for (size_t slot = 0;; slot++) {
-		assert(slot <= cache->used && slot <= cache->size);
-
-		if (slot == cache->used ||
-		    page_addr < cache->slots[slot]->addr) {
-			/* cache missed */
+	entry = mr_tree_find_covering(cache, page_addr, pages);
+	if (entry) {
+		refs = __atomic_load_n(&entry->refs, __ATOMIC_ACQUIRE);
+	}
+	if (entry && MR_ENTRY_REFCNT(refs) == 0) {
+		/* The memory of a retained registration may have been
+		 * freed and reallocated since; its pages are then no
+		 * longer the ones that were registered. */
+		if (mr_cache_alloc_id(cache, ckey) != entry->alloc_id) {
+			mr_cache_evict(cache, entry);
 			cache->miss_count++;
 			return NULL;
-		} else if ((page_addr >= cache->slots[slot]->addr) &&
-			   ((page_addr - cache->slots[slot]->addr) /
-				    cache->system_page_size +
-			    pages) <= cache->slots[slot]->pages) {
-			/* cache hit */
-			cache->hit_count++;
-			NCCL_OFI_TRACE(NCCL_NET,
-			               "Found MR handle %p for %ld(%s) in cache slot %zu",
-			               cache->slots[slot]->handle,
-			               nccl_ofi_mr_ckey_baseaddr(ckey),
-			               nccl_ofi_mr_ckey_type_str(ckey),
-			               slot);
-			cache->slots[slot]->refcnt++;
-			return cache->slots[slot]->handle;
 		}
+
+		/* Revive a retained registration. Its fields are
+		 * unchanged, so the generation is kept. Lock-free
+		 * lookups do not take references of unreferenced
+		 * entries, so refs cannot change concurrently. */
+		mr_cache_unretain(cache, entry);
+		__atomic_store_n(&entry->refs, refs + 1, __ATOMIC_RELEASE);
+	} else if (!entry || !mr_entry_try_get(cache, entry, page_addr, pages)) {
+		/* cache missed */
+		cache->miss_count++;
+		return NULL;
+	}
+
+	return mr_cache_hit(cache, entry, ckey);
+}
+
+void *nccl_ofi_mr_cache_try_lookup_entry(nccl_ofi_mr_cache_t *cache,
+					 nccl_ofi_mr_ckey_ref ckey)
+{
+	uintptr_t page_addr;
+	size_t pages;
+	nccl_ofi_reg_entry_t *entry;
+
+	compute_page_address(nccl_ofi_mr_ckey_baseaddr(ckey),
+			     nccl_ofi_mr_ckey_len(ckey),
+			     (uintptr_t)cache->system_page_size,
+			     &page_addr,
+			     &pages);
+
+	/* Misses, including hits on retained entries, are accounted
+	 * for by the locked retry */
+	entry = mr_tree_find_covering(cache, page_addr, pages);
+	if (!entry || !mr_entry_try_get(cache, entry, page_addr, pages)) {
+		return NULL;
 	}
+
+	return mr_cache_hit(cache, entry, ckey);
 }
 
 int nccl_ofi_mr_cache_insert_entry(nccl_ofi_mr_cache_t *cache,
@@ -150,6 +612,8 @@ int nccl_ofi_mr_cache_insert_entry(nccl_ofi_mr_cache_t *cache,
 {
 	uintptr_t page_addr;
 	size_t pages;
+	nccl_ofi_reg_entry_t *entry;
+	uint64_t refs;
 	int ret = 0;
 
 	compute_page_address((uintptr_t)nccl_ofi_mr_ckey_baseaddr(ckey),
@@ -158,113 +622,103 @@ int nccl_ofi_mr_cache_insert_entry(nccl_ofi_mr_cache_t *cache,
 	                     &page_addr,
 	                     &pages);
 
-	for (size_t slot = 0;; slot++) {
-		assert(slot <= cache->used && slot <= cache->size);
-
-		if (slot == cache->used ||
-		    page_addr < cache->slots[slot]->addr) {
-			/* cache missed */
-
-			/* grow the cache if needed */
-			if (cache->used == cache->size) {
-				ret = nccl_ofi_mr_cache_grow(cache);
-				if (ret != 0) {
-					goto out;
-				}
-			}
-
-			assert(cache->slots);
-			memmove(cache->slots + slot + 1,
-				cache->slots + slot,
-				(cache->used - slot) *
-					sizeof(nccl_ofi_reg_entry_t *));
-			cache->slots[slot] = (nccl_ofi_reg_entry_t *)calloc(
-				1,
-				sizeof(nccl_ofi_reg_entry_t));
-			if (!cache->slots[slot]) {
-				NCCL_OFI_WARN("Failed to allocate new slot");
-				ret = -ENOMEM;
-				goto out;
-			}
-
-			nccl_ofi_reg_entry_t *entry = cache->slots[slot];
-
-			entry->addr = page_addr;
-			entry->pages = pages;
-			entry->refcnt = 1;
-			entry->handle = handle;
-
-			cache->used++;
-			NCCL_OFI_TRACE(NCCL_NET,
-			               "Inserted MR handle %p for %ld(%s) in cache slot %zu",
-			               handle,
-			               nccl_ofi_mr_ckey_baseaddr(ckey),
-			               nccl_ofi_mr_ckey_type_str(ckey),
-			               slot);
-			goto out;
-		} else if ((page_addr >= cache->slots[slot]->addr) &&
-			   ((page_addr - cache->slots[slot]->addr) /
-				    cache->system_page_size +
-			    pages) <= cache->slots[slot]->pages) {
-			/* cache hit */
-			NCCL_OFI_WARN("Entry already exists for input (%s) base %lu size %zu",
-			              nccl_ofi_mr_ckey_type_str(ckey),
-			              nccl_ofi_mr_ckey_baseaddr(ckey),
-			              nccl_ofi_mr_ckey_len(ckey));
-			ret = -EEXIST;
+	if (mr_tree_find_covering(cache, page_addr, pages)) {
+		/* cache hit */
+		NCCL_OFI_WARN("Entry already exists for input (%s) base %lu size %zu",
+		              nccl_ofi_mr_ckey_type_str(ckey),
+		              nccl_ofi_mr_ckey_baseaddr(ckey),
+		              nccl_ofi_mr_ckey_len(ckey));
+		ret = -EEXIST;
+		goto out;
+	}
+
+	/* grow the cache if needed */
+	if (!cache->free_entries) {
+		ret = nccl_ofi_mr_cache_grow(cache);
+		if (ret != 0) {
 			goto out;
 		}
 	}
 
+	entry = cache->free_entries;
+	cache->free_entries = entry->left;
+
+	MR_STORE(entry->addr, page_addr);
+	MR_STORE(entry->pages, pages);
+	MR_STORE(entry->handle, handle);
+	/* Identify the allocation now, while the registered memory is
+	 * known to be live, so that retention can detect its reuse */
+	entry->alloc_id = cache->alloc_id_fn ? mr_cache_alloc_id(cache, ckey) : 0;
+	/* Publish the entry with a new generation and a single reference */
+	refs = __atomic_load_n(&entry->refs, __ATOMIC_ACQUIRE);
+	__atomic_store_n(&entry->refs,
+			 (((refs >> MR_ENTRY_GEN_SHIFT) + 1) << MR_ENTRY_GEN_SHIFT) | 1,
+			 __ATOMIC_RELEASE);
+
+	MR_STORE(cache->root, mr_tree_insert(cache, cache->root, entry));
+	HASH_ADD_PTR(cache->handle_index, handle, entry);
+
+	cache->used++;
+	NCCL_OFI_TRACE(NCCL_NET,
+	               "Inserted MR handle %p for %ld(%s) in cache entry %p",
+	               handle,
+	               nccl_ofi_mr_ckey_baseaddr(ckey),
+	               nccl_ofi_mr_ckey_type_str(ckey),
+	               entry);
+
 out:
 	return ret;
 }
 
-__attribute__((pure))
-static int nccl_ofi_mr_cache_lookup_handle(nccl_ofi_mr_cache_t *cache,
-					   void *handle)
-{
-	for (size_t i = 0; i < cache->used; i++) {
-		if (handle == cache->slots[i]->handle) {
-			return i;
-		}
-	}
-	return -1;
-}
-
 int nccl_ofi_mr_cache_del_entry(nccl_ofi_mr_cache_t *cache, void *handle)
 {
-	int slot = -1;
+	nccl_ofi_reg_entry_t *entry = NULL;
+	size_t bytes;
 	int ret = 0;
 
-	slot = nccl_ofi_mr_cache_lookup_handle(cache, handle);
-	if (slot < 0) {
+	HASH_FIND_PTR(cache->handle_index, &handle, entry);
+	if (!entry || MR_ENTRY_REFCNT(__atomic_load_n(&entry->refs, __ATOMIC_ACQUIRE)) == 0) {
 		NCCL_OFI_WARN("Did not find entry to delete");
 		ret = -ENOENT;
 		goto out;
 	}
 
-	/* Keep entry alive for other users */
-	if (--cache->slots[slot]->refcnt) {
+	/* Keep entry alive for other users. Lock-free lookups never revive
+	 * an entry whose reference count reached zero. */
+	if (MR_ENTRY_REFCNT(__atomic_sub_fetch(&entry->refs, 1, __ATOMIC_ACQ_REL))) {
 		NCCL_OFI_TRACE(
 			NCCL_NET,
-			"Decremented refcnt for MR handle %p in cache slot %d",
+			"Decremented refcnt for MR handle %p in cache entry %p",
 			handle,
-			slot);
+			entry);
 		goto out;
 	}
 
-	/* Free this entry and defrag cache */
-	free(cache->slots[slot]);
-	memmove(cache->slots + slot,
-		cache->slots + slot + 1,
-		(cache->used - slot - 1) * sizeof(nccl_ofi_reg_entry_t *));
-	--cache->used;
+	bytes = entry->pages * cache->system_page_size;
+	if (cache->dereg_fn && entry->alloc_id != 0 &&
+	    (!cache->max_unused_bytes || bytes <= cache->max_unused_bytes)) {
+		/* Retain the registration, making room for it by evicting
+		 * the least recently used ones */
+		DL_PREPEND2(cache->lru, entry, lru_prev, lru_next);
+		cache->unused_entries++;
+		cache->unused_bytes += bytes;
+		while (mr_cache_over_budget(cache)) {
+			mr_cache_evict(cache, cache->lru->lru_prev);
+		}
+
+		NCCL_OFI_TRACE(NCCL_NET,
+			       "Retained unused MR handle %p in cache entry %p",
+			       handle,
+			       entry);
+		goto out;
+	}
+
+	mr_cache_remove_entry(cache, entry);
 
 	NCCL_OFI_TRACE(NCCL_NET,
-		       "Removed MR handle %p in cache slot %d",
+		       "Removed MR handle %p in cache entry %p",
 		       handle,
-		       slot);
+		       entry);
 
 	/* Signal to caller to deregister handle */
 	ret = 1;
@@ -247,3 +247,31 @@ nccl_ofi_msgbuff_result_t nccl_ofi_msgbuff_complete(nccl_ofi_msgbuff_t *msgbuff,
 	nccl_net_ofi_mutex_unlock(&msgbuff->lock);
 	return ret;
 }
+
+nccl_ofi_msgbuff_result_t nccl_ofi_msgbuff_remove(nccl_ofi_msgbuff_t *msgbuff,
+		uint16_t msg_index, nccl_ofi_msgbuff_status_t *msg_idx_status)
+{
+	assert(msgbuff);
+
+	nccl_net_ofi_mutex_lock(&msgbuff->lock);
+
+	*msg_idx_status = nccl_ofi_msgbuff_get_idx_status(msgbuff, msg_index);
+	nccl_ofi_msgbuff_result_t ret = NCCL_OFI_MSGBUFF_ERROR;
+
+	if (*msg_idx_status == NCCL_OFI_MSGBUFF_INPROGRESS) {
+		/* Within the in-flight section, a NOTSTARTED element is a
+		 * hole that can be inserted again, and it keeps
+		 * msg_last_incomplete from moving past it */
+		buff_idx(msgbuff, msg_index)->stat = NCCL_OFI_MSGBUFF_NOTSTARTED;
+		buff_idx(msgbuff, msg_index)->elem = NULL;
+		ret = NCCL_OFI_MSGBUFF_SUCCESS;
+	} else {
+		if (*msg_idx_status == NCCL_OFI_MSGBUFF_UNAVAILABLE) {
+			// UNAVAILABLE really only applies to insert, so return NOTSTARTED here
+			*msg_idx_status = NCCL_OFI_MSGBUFF_NOTSTARTED;
+		}
+		ret = NCCL_OFI_MSGBUFF_INVALID_IDX;
+	}
+	nccl_net_ofi_mutex_unlock(&msgbuff->lock);
+	return ret;
+}
@@ -12,6 +12,7 @@
 #include <unistd.h>
 #include <inttypes.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <ctype.h>
 
 #include "nccl_ofi.h"
@@ -87,18 +88,98 @@ size_t system_page_size = 0;
  */
 int nccl_net_ofi_alloc_mr_buffer(size_t size, void **ptr)
 {
+	return nccl_net_ofi_alloc_mr_buffer_numa(size, false, -1, ptr);
+}
+
+/* Memory policy of mbind(2) that prefers the given node but falls
+ * back to other nodes when it runs out of memory */
+#define NCCL_OFI_MPOL_PREFERRED (1)
+
+/*
+ * @brief	Map a huge page aligned region of regular pages, which
+ *		transparent huge pages can back
+ */
+static void *map_huge_page_aligned(size_t size)
+{
+	size_t map_size = size + NCCL_OFI_HUGE_PAGE_SIZE;
+	char *buf = (char *)mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+				 MAP_PRIVATE | MAP_ANON, -1, 0);
+	if (buf == MAP_FAILED) {
+		return MAP_FAILED;
+	}
+
+	char *aligned = (char *)NCCL_OFI_ROUND_UP((uintptr_t)buf, (uintptr_t)NCCL_OFI_HUGE_PAGE_SIZE);
+	if (aligned != buf) {
+		munmap(buf, aligned - buf);
+	}
+	if (aligned + size != buf + map_size) {
+		munmap(aligned + size, (buf + map_size) - (aligned + size));
+	}
+
+#ifdef MADV_HUGEPAGE
+	if (madvise(aligned, size, MADV_HUGEPAGE) != 0) {
+		NCCL_OFI_TRACE(NCCL_INIT | NCCL_NET, "madvise(MADV_HUGEPAGE) failed (%d %s)",
+			       errno, strerror(errno));
+	}
+#endif
+
+	return aligned;
+}
+
+int nccl_net_ofi_alloc_mr_buffer_numa(size_t size, bool huge_pages, int numa_node, void **ptr)
+{
+	int ret;
+	void *buf = MAP_FAILED;
+
 	assert(system_page_size > 0);
 	assert(NCCL_OFI_IS_ALIGNED(size, system_page_size));
 
-	*ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
-		    MAP_PRIVATE | MAP_ANON, -1, 0);
-	if (OFI_UNLIKELY(*ptr == MAP_FAILED)) {
+	huge_pages = huge_pages && NCCL_OFI_IS_ALIGNED(size, NCCL_OFI_HUGE_PAGE_SIZE);
+
+	if (huge_pages) {
+#ifdef MAP_HUGETLB
+		buf = mmap(NULL, size, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANON | MAP_HUGETLB, -1, 0);
+		if (buf == MAP_FAILED) {
+			NCCL_OFI_TRACE(NCCL_INIT | NCCL_NET,
+				       "Unable to map MR buffer with huge pages (%d %s), falling back to transparent huge pages",
+				       errno, strerror(errno));
+		}
+#endif
+		if (buf == MAP_FAILED) {
+			buf = map_huge_page_aligned(size);
+		}
+	} else {
+		buf = mmap(NULL, size, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANON, -1, 0);
+	}
+	if (OFI_UNLIKELY(buf == MAP_FAILED)) {
+		ret = -errno;
 		NCCL_OFI_WARN("Unable to map MR buffer (%d %s)",
-			      errno, strerror(errno));
+			      -ret, strerror(-ret));
 		*ptr = NULL;
-		return -errno;
+		return ret;
+	}
+
+	/* Pages are not touched yet, so the policy applies to all of
+	 * them. Failing to bind is not fatal. */
+	if (numa_node >= 0) {
+		unsigned long nodemask[16] = { 0 };
+		const size_t bits = 8 * sizeof(nodemask[0]);
+
+		if ((size_t)numa_node < bits * (sizeof(nodemask) / sizeof(nodemask[0]))) {
+			nodemask[numa_node / bits] = 1UL << (numa_node % bits);
+			if (syscall(SYS_mbind, buf, size, NCCL_OFI_MPOL_PREFERRED, nodemask,
+				    bits * (sizeof(nodemask) / sizeof(nodemask[0])), 0) != 0) {
+				NCCL_OFI_TRACE(NCCL_INIT | NCCL_NET,
+					       "Unable to bind MR buffer to NUMA node %d (%d %s)",
+					       numa_node, errno, strerror(errno));
+			}
+		}
 	}
-	assert(NCCL_OFI_IS_PTR_ALIGNED(*ptr, system_page_size));
+
+	assert(NCCL_OFI_IS_PTR_ALIGNED(buf, system_page_size));
+	*ptr = buf;
 	return 0;
 }
 
@@ -390,8 +471,9 @@ static int set_nic_props_default(int dev_id, struct fi_info *nic_prov,
 	props->latency = net_latency >= .0 ? net_latency : .0;
 
 	/*
-	 * Maximum number of grouped receives. Currently, we set it to 1 to
+	 * Maximum number of grouped receives. By default, we set it to 1 to
 	 * maintain single send/recv semantics (similar to NCCL versions < v2.12).
+	 * Protocols supporting grouped receives raise it.
 	 *
 	 * Grouped receives are useful for alltoall collectives where one
 	 * receiver is expected to receive from multiple remote GPUs using
@@ -399,7 +481,7 @@ static int set_nic_props_default(int dev_id, struct fi_info *nic_prov,
 	 * impacted with this feature as NCCL doesn't aggregate receives from
 	 * same source.
 	 */
-	props->max_group_receives = NCCL_OFI_MAX_RECVS;
+	props->max_group_receives = 1;
 
 	if (support_gdr == GDR_SUPPORTED) {
 		props->hmem_support = true;
@@ -6,6 +6,8 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
+#include <strings.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <pthread.h>
@@ -19,6 +21,7 @@
 #include "nccl_ofi_param.h"
 #include "nccl_ofi_rdma.h"
 #include "nccl_ofi_math.h"
+#include "nccl_ofi_memcpy.h"
 #include "nccl_ofi_tracepoint.h"
 #include "nccl_ofi_scheduler.h"
 #include "nccl_ofi_topo.h"
@@ -28,9 +31,6 @@
 #include "nccl_ofi_dmabuf.h"
 #include "nccl_ofi_mr.h"
 
-/* Message buffer size -- maximum span of simultaneous inflight messages */
-#define NCCL_OFI_RDMA_MSGBUFF_SIZE 256
-
 /* Maximum number of comms open simultaneously. Eventually this will be
    runtime-expandable */
 #define NCCL_OFI_RDMA_MAX_COMMS    (1 << NCCL_OFI_RDMA_COMM_ID_BITS)
@@ -95,6 +95,76 @@
 /* Maximum size of an eager message (see OFI_NCCL_EAGER_MAX_SIZE) */
 static size_t eager_max_size = 0;
 
+/* Maximum number of completion queue entries read per fi_cq_read
+ * call (see OFI_NCCL_CQ_READ_COUNT_MAX) */
+static size_t cq_read_count_max = 0;
+
+/* Maximum number of completions processed per rail and progress call
+ * (see OFI_NCCL_CQ_POLL_BUDGET) */
+static size_t cq_poll_budget = 0;
+
+/* Whether the receiver-pull rendezvous is enabled (see
+ * OFI_NCCL_PULL_RENDEZVOUS) */
+static bool pull_rendezvous = false;
+
+/* Maximum size of a chunk of an RDMA write stripe, SIZE_MAX if
+ * stripes are not cut (see OFI_NCCL_WRITE_CHUNK_SIZE) */
+static size_t write_chunk_size = SIZE_MAX;
+
+/* Maximum number of chunks of a stripe in flight (see
+ * OFI_NCCL_WRITE_CHUNK_WINDOW) */
+static int write_chunk_window = 1;
+
+/* Whether eager messages are copied into host receive buffers by the
+ * CPU (see OFI_NCCL_EAGER_CPU_COPY) */
+static bool eager_cpu_copy = false;
+
+/* Minimum size of CPU copies using non-temporal stores (see
+ * OFI_NCCL_CPU_COPY_NT_THRESHOLD) */
+static size_t cpu_copy_nt_threshold = 0;
+
+/* Whether bounce buffers are posted as multi-receive slabs (see
+ * OFI_NCCL_RDMA_MULTI_RECV) */
+static bool multi_recv = false;
+
+/* Size of multi-receive slabs (see OFI_NCCL_RDMA_MULTI_RECV_SLAB_SIZE) */
+static size_t multi_recv_slab_size = 0;
+
+/* Maximum number of control messages sent in a batch (see
+ * OFI_NCCL_CTRL_BATCH_MAX) */
+static int ctrl_batch_max = 1;
+
+/* Nanoseconds a batch of control messages may wait to be completed
+ * (see OFI_NCCL_CTRL_BATCH_TIMEOUT) */
+static uint64_t ctrl_batch_timeout_ns = 0;
+
+/* Number of slots of the remote key cache of receive communicators (see
+ * OFI_NCCL_RDMA_RKEY_CACHE_SIZE) */
+static int rkey_cache_size = 0;
+
+/* Maximum number of buffers of a grouped receive (see
+ * OFI_NCCL_RDMA_MAX_RECVS) */
+static int max_recvs = 1;
+
+/* Maximum number of inflight requests of a communicator (see
+ * OFI_NCCL_RDMA_MAX_INFLIGHT_REQS) */
+static uint64_t max_inflight_reqs = NCCL_OFI_MAX_REQUESTS;
+
+/*
+ * @brief	Return the size of the longest message of a send ctrl
+ *		request, a batch or a grouped receive
+ */
+static inline size_t ctrl_send_max_size(void)
+{
+	size_t size = ctrl_batch_max * NCCL_OFI_RDMA_CTRL_MSG_MAX_SIZE;
+
+	if (max_recvs > 1) {
+		size = NCCL_OFI_MAX(size, sizeof(nccl_net_ofi_rdma_ctrl_group_msg_t) +
+				   max_recvs * NCCL_OFI_RDMA_CTRL_MSG_MAX_SIZE);
+	}
+	return size;
+}
+
 /* List of comms undergoing deferred cleanup */
 static nccl_ofi_deque_t *s_comm_cleanup_list = NULL;
 static nccl_ofi_deque_t *r_comm_cleanup_list = NULL;
@@ -106,6 +176,25 @@ static int num_open_comms = 0;
 static size_t max_write_inline_size = 0;
 static bool is_max_write_inline_size_initialized = false;
 
+/* Maximum size of inject send operations */
+static size_t max_send_inject_size = 0;
+
+/* Post small host payloads of send requests with inject operations
+ * (see OFI_NCCL_RDMA_INJECT) */
+static bool rdma_inject = true;
+
+/* Draw communicator requests and control buffers from free lists of
+ * the endpoint (see OFI_NCCL_RDMA_SHARED_COMM_POOLS) */
+static bool shared_comm_pools = true;
+
+/* Idle time after which flush buffers are released (see
+ * OFI_NCCL_RDMA_FLUSH_BUFF_IDLE_TIMEOUT), 0 if never */
+static uint64_t flush_buff_idle_timeout_ns = 0;
+
+/* Synchronization of pending request queues of endpoints (see
+ * OFI_NCCL_RDMA_PENDING_QUEUE_MODE) */
+static nccl_ofi_deque_mode_t pending_queue_mode = NCCL_OFI_DEQUE_MODE_MUTEX;
+
 /* CPU cache line size */
 static ssize_t cpu_cache_line_size;
 
@@ -125,6 +214,8 @@ static int post_bounce_buffer(nccl_net_ofi_rdma_req_t *req,
 
 static nccl_net_ofi_rdma_req_t *allocate_req(nccl_ofi_freelist_t *fl);
 
+static int release_idle_flush_buff(nccl_net_ofi_rdma_recv_comm_t *r_comm);
+
 static inline int free_base_req(uint64_t *num_inflight_reqs,
 				nccl_ofi_freelist_t *nccl_ofi_reqs_fl,
 				nccl_net_ofi_rdma_req_t *req,
@@ -132,6 +223,13 @@ static inline int free_base_req(uint64_t *num_inflight_reqs,
 
 static inline int check_post_bounce_req(nccl_net_ofi_rdma_req_t *bounce_req);
 
+static int handle_slab_recv(nccl_net_ofi_rdma_device_t *device, int rail_id,
+			    struct fi_cq_data_entry *cq_entry,
+			    nccl_net_ofi_rdma_req_t *slab_req, bool eager);
+
+static inline nccl_net_ofi_rdma_req_t *alloc_slab_msg_req(nccl_net_ofi_rdma_req_t *slab_req,
+							  void *msg);
+
 
 static nccl_net_ofi_rdma_device_t *rdma_endpoint_get_device(nccl_net_ofi_rdma_ep_t *ep)
 {
@@ -162,6 +260,10 @@ static nccl_net_ofi_rdma_device_t *rdma_req_get_device(nccl_net_ofi_rdma_req_t *
 	return (nccl_net_ofi_rdma_device_t *)rdma_req_get_ep(req)->base.device;
 }
 
+/* Page of the comm lookup tables of devices for ID ranges without
+ * comms. Never written. */
+static nccl_net_ofi_comm_t *rdma_comm_empty_page[NCCL_OFI_RDMA_COMM_PAGE_SIZE];
+
 /*
  * @brief	Get endpoint communicator with given ID
  */
@@ -169,19 +271,52 @@ static inline nccl_net_ofi_comm_t *rdma_device_get_comm(nccl_net_ofi_rdma_device
 {
 	assert(local_comm_id < NCCL_OFI_RDMA_MAX_COMMS);
 	assert(local_comm_id < device->num_comm_ids);
-	return device->comms[local_comm_id];
+	nccl_net_ofi_comm_t **page =
+		__atomic_load_n(&device->comm_pages[local_comm_id >> NCCL_OFI_RDMA_COMM_PAGE_BITS],
+				__ATOMIC_ACQUIRE);
+	return page[local_comm_id & (NCCL_OFI_RDMA_COMM_PAGE_SIZE - 1)];
 }
 
 /*
  * @brief	Set endpoint communicator with given ID
+ *
+ * Allocates the page of the lookup table holding the ID if needed.
+ *
+ * @return	0, on success
+ *		-ENOMEM, if the page could not be allocated
  */
-static inline void rdma_device_set_comm(nccl_net_ofi_rdma_device_t *device,
+static inline int rdma_device_set_comm(nccl_net_ofi_rdma_device_t *device,
 			    uint32_t local_comm_id,
 			    nccl_net_ofi_comm_t *comm)
 {
 	assert(local_comm_id < NCCL_OFI_RDMA_MAX_COMMS);
 	assert(local_comm_id < device->num_comm_ids);
-	device->comms[local_comm_id] = comm;
+	nccl_net_ofi_comm_t ***slot = &device->comm_pages[local_comm_id >> NCCL_OFI_RDMA_COMM_PAGE_BITS];
+	nccl_net_ofi_comm_t **page = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+
+	if (page == rdma_comm_empty_page) {
+		if (comm == NULL) {
+			return 0;
+		}
+
+		nccl_net_ofi_comm_t **new_page = (nccl_net_ofi_comm_t **)
+			calloc(NCCL_OFI_RDMA_COMM_PAGE_SIZE, sizeof(nccl_net_ofi_comm_t *));
+		if (OFI_UNLIKELY(new_page == NULL)) {
+			NCCL_OFI_WARN("Failed to alloc page of comms array");
+			return -ENOMEM;
+		}
+
+		/* Comms of the same page may be created concurrently */
+		if (__atomic_compare_exchange_n(slot, &page, new_page, false,
+						__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			page = new_page;
+		} else {
+			free(new_page);
+		}
+	}
+
+	page[local_comm_id & (NCCL_OFI_RDMA_COMM_PAGE_SIZE - 1)] = comm;
+	return 0;
 }
 
 /*
@@ -221,28 +356,28 @@ static inline nccl_net_ofi_rdma_recv_comm_t *rdma_device_get_recv_comm(nccl_net_
  * Get connection message from bounce buffer
  */
 static inline nccl_ofi_rdma_connection_info_t *get_bounce_connection_msg(
-	nccl_net_ofi_rdma_bounce_fl_item_t *bounce_fl_item)
+	rdma_req_bounce_data_t *bounce_data)
 {
-	return (nccl_ofi_rdma_connection_info_t *)&bounce_fl_item->bounce_msg;
+	return (nccl_ofi_rdma_connection_info_t *)bounce_data->msg;
 }
 
 /*
  * Get ctrl message from bounce buffer
  */
 static inline nccl_net_ofi_rdma_ctrl_msg_t *get_bounce_ctrl_msg
-	(nccl_net_ofi_rdma_bounce_fl_item_t *bounce_fl_item)
+	(rdma_req_bounce_data_t *bounce_data)
 {
-	return (nccl_net_ofi_rdma_ctrl_msg_t *)&bounce_fl_item->bounce_msg;
+	return (nccl_net_ofi_rdma_ctrl_msg_t *)bounce_data->msg;
 }
 
 /*
  * Get close message from bounce buffer
  */
 static inline nccl_net_ofi_rdma_close_msg_t *bounce_get_close_msg
-	(nccl_net_ofi_rdma_bounce_fl_item_t *bounce_fl_item)
+	(rdma_req_bounce_data_t *bounce_data)
 {
 	nccl_net_ofi_rdma_close_msg_t *close_msg =
-		(nccl_net_ofi_rdma_close_msg_t *)&bounce_fl_item->bounce_msg;
+		(nccl_net_ofi_rdma_close_msg_t *)bounce_data->msg;
 	assert(close_msg->type == NCCL_OFI_RDMA_MSG_CLOSE);
 	return close_msg;
 }
@@ -479,6 +614,11 @@ static int set_mr_req_attr(nccl_ofi_idpool_t *key_pool, int dev_id,
 	switch (type) {
 	case NCCL_PTR_HOST:
 		mr_attr->access |= FI_READ;
+		/* Host send buffers are the source of the receiver's
+		   reads in the pull rendezvous */
+		if (pull_rendezvous) {
+			mr_attr->access |= FI_REMOTE_READ;
+		}
 		mr_attr->iface = FI_HMEM_SYSTEM;
 		break;
 #if HAVE_CUDA
@@ -590,6 +730,7 @@ static inline int get_properties(nccl_net_ofi_device_t *base_dev,
 	}
 
 	props->rma_supported = 1;
+	props->max_group_receives = max_recvs;
 	assert(is_max_write_inline_size_initialized);
 	props->max_write_inline_size = max_write_inline_size;
 
@@ -629,6 +770,14 @@ static inline rdma_req_recv_data_t *get_recv_data(nccl_net_ofi_rdma_req_t *req)
 	return &req->recv_data;
 }
 
+/*
+ * @brief	Return grouped receive data struct of grouped receive request
+ */
+static inline rdma_req_recv_group_data_t *get_recv_group_data(nccl_net_ofi_rdma_req_t *req) {
+	assert(req->type == NCCL_OFI_RDMA_RECV_GROUP);
+	return &req->recv_group_data;
+}
+
 /*
  * @brief	Return send control data struct of send control request
  */
@@ -681,14 +830,44 @@ static inline void set_request_state_to_error(nccl_net_ofi_rdma_req_t *req)
 
 	/* Set state of parent requests to error as well */
 	if (req->type == NCCL_OFI_RDMA_SEND_CTRL) {
-		rdma_req_send_ctrl_data_t *send_ctrl_data = get_send_ctrl_data(req);
-		send_ctrl_data->recv_req->state = NCCL_OFI_RDMA_REQ_ERROR;
+		/* Including the requests batched with this one */
+		for (; req != NULL; req = get_send_ctrl_data(req)->batch_next) {
+			req->state = NCCL_OFI_RDMA_REQ_ERROR;
+			get_send_ctrl_data(req)->recv_req->state = NCCL_OFI_RDMA_REQ_ERROR;
+		}
 	} else if (req->type == NCCL_OFI_RDMA_RECV_SEGMS) {
 		rdma_req_recv_segms_data_t *recv_segms_data = get_recv_segms_data(req);
 		recv_segms_data->recv_req->state = NCCL_OFI_RDMA_REQ_ERROR;
 	}
 }
 
+/*
+ * @brief	Report completion of the stripe of `schedule' posted to rail
+ *		`rail_id' to the scheduler
+ *
+ * Must be called before the completion is accounted in the request,
+ * since the request may be released afterwards.
+ */
+static inline void schedule_xfer_completed(nccl_net_ofi_rdma_device_t *device,
+					   int rail_id,
+					   nccl_net_ofi_schedule_t *schedule,
+					   uint64_t xfer_start_ns)
+{
+	if (device->scheduler->xfer_completed == NULL || schedule == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < schedule->num_xfer_infos; i++) {
+		if (schedule->rail_xfer_infos[i].rail_id == rail_id) {
+			nccl_net_ofi_scheduler_xfer_completed(device->scheduler,
+							      &schedule->rail_xfer_infos[i],
+							      xfer_start_ns,
+							      nccl_ofi_stats_now_ns());
+			return;
+		}
+	}
+}
+
 /*
  * @brief 	Increment request completions of main requests and set request
  *		state to completed if total number of completions is reached
@@ -829,6 +1008,28 @@ static inline int set_send_ctrl_completed(nccl_net_ofi_rdma_req_t *req)
 	return inc_req_completion(recv_req, 0, recv_data->total_num_compls);
 }
 
+/*
+ * @brief	Set a send ctrl request and the requests whose messages
+ *		were sent in its batch completed
+ */
+static inline int set_send_ctrl_batch_completed(nccl_net_ofi_rdma_req_t *req)
+{
+	int ret = 0;
+
+	while (req != NULL) {
+		/* The request may be released once completed */
+		nccl_net_ofi_rdma_req_t *next = get_send_ctrl_data(req)->batch_next;
+
+		ret = set_send_ctrl_completed(req);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+		req = next;
+	}
+
+	return ret;
+}
+
 /*
  * @brief	Increment segment completions of receive segment request
  *
@@ -891,6 +1092,181 @@ static inline int inc_recv_seg_completion(nccl_net_ofi_rdma_req_t *req,
 	return ret;
 }
 
+/*
+ * @brief	Complete the reads of a pulled receive segments request
+ *
+ * Post the PULL_DONE message telling the sender that its buffer can be
+ * released, and add a completion to the parent request (receive
+ * request).
+ *
+ * @param	req
+ *		Receive segments request
+ * @return	0, on success
+ *		non-zero, on error
+ */
+static inline int set_pull_reads_completed(nccl_net_ofi_rdma_req_t *req)
+{
+	assert(req->type == NCCL_OFI_RDMA_RECV_SEGMS);
+	int ret;
+	rdma_req_recv_segms_data_t *recv_segms_data = get_recv_segms_data(req);
+	nccl_net_ofi_rdma_req_t *recv_req = recv_segms_data->recv_req;
+	rdma_req_recv_data_t *recv_data = get_recv_data(recv_req);
+	nccl_net_ofi_rdma_recv_comm_t *r_comm =
+		(nccl_net_ofi_rdma_recv_comm_t *)req->comm;
+
+	nccl_net_ofi_mutex_lock(&req->req_lock);
+	req->state = NCCL_OFI_RDMA_REQ_COMPLETED;
+	nccl_net_ofi_mutex_unlock(&req->req_lock);
+
+	nccl_net_ofi_mutex_lock(&r_comm->ctrl_counter_lock);
+	r_comm->n_ctrl_sent += 1;
+	nccl_net_ofi_mutex_unlock(&r_comm->ctrl_counter_lock);
+
+	ret = receive_progress(recv_data->send_ctrl_req, true);
+	if (OFI_UNLIKELY(ret != 0)) {
+		NCCL_OFI_WARN("Failed to post pull done message");
+		return ret;
+	}
+
+	nccl_ofi_stats_add(&r_comm->stats.pulled, 1);
+
+	/* Add completion to parent request */
+	return inc_req_completion(recv_req, req->size, recv_data->total_num_compls);
+}
+
+/*
+ * @brief	Increment read completions of a pulled receive segments
+ *		request
+ *
+ * Once all reads of the schedule completed, the request is completed
+ * with set_pull_reads_completed().
+ *
+ * @param	req
+ *		Receive segments request
+ * @return	0, on success
+ *		non-zero, on error
+ */
+static inline int inc_pull_read_completion(nccl_net_ofi_rdma_req_t *req)
+{
+	assert(req->type == NCCL_OFI_RDMA_RECV_SEGMS);
+	rdma_req_recv_segms_data_t *recv_segms_data = get_recv_segms_data(req);
+	bool reads_completed;
+
+	assert(recv_segms_data->pull);
+
+	nccl_net_ofi_mutex_lock(&req->req_lock);
+	req->ncompls++;
+	reads_completed = req->ncompls == (int)recv_segms_data->schedule->num_xfer_infos;
+	nccl_net_ofi_mutex_unlock(&req->req_lock);
+
+	if (!reads_completed) {
+		return 0;
+	}
+
+	return set_pull_reads_completed(req);
+}
+
+/*
+ * @brief	Store the keys of an NCCL_OFI_RDMA_MSG_CTRL_CACHE message in
+ *		the remote key cache of send communicator, and resume the
+ *		send requests that were waiting for them
+ */
+static int cache_remote_rkeys(nccl_net_ofi_rdma_send_comm_t *s_comm,
+			      nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg)
+{
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep;
+	nccl_net_ofi_rdma_rkey_ref_t *ref =
+		nccl_net_ofi_rdma_ctrl_msg_cache_ref(ctrl_msg, ep->num_rails, ep->use_long_rkeys);
+	nccl_net_ofi_rdma_req_t *resumed = NULL;
+	int ret = 0;
+
+	if (OFI_UNLIKELY(ref->slot >= NCCL_OFI_RDMA_RKEY_CACHE_MAX)) {
+		NCCL_OFI_WARN("Invalid remote key cache slot %u", ref->slot);
+		return -EINVAL;
+	}
+
+	nccl_net_ofi_mutex_lock(&s_comm->ctrl_recv_lock);
+	nccl_net_ofi_rdma_remote_rkey_t *entry = &s_comm->remote_rkeys[ref->slot];
+	/* Control messages are not ordered; a registration cached
+	 * before the current one of the slot may arrive late */
+	if (!entry->valid || (int32_t)(ref->gen - entry->gen) > 0) {
+		entry->valid = true;
+		entry->gen = ref->gen;
+		for (int rail_id = 0; rail_id != ep->num_rails; ++rail_id) {
+			entry->mr_key[rail_id] = ep->use_long_rkeys ? ctrl_msg->long_buff_mr_key[rail_id]
+								    : ctrl_msg->short_buff_mr_key[rail_id];
+		}
+	}
+
+	/* Take the requests waiting for this registration */
+	nccl_net_ofi_rdma_req_t **link = &s_comm->rkey_waiters;
+	while (*link != NULL) {
+		rdma_req_send_data_t *send_data = get_send_data(*link);
+		if (send_data->remote_rkey_ref.slot == ref->slot && send_data->remote_rkey_ref.gen == entry->gen) {
+			nccl_net_ofi_rdma_req_t *req = *link;
+			*link = send_data->next_rkey_waiter;
+			send_data->next_rkey_waiter = resumed;
+			resumed = req;
+		} else {
+			link = &send_data->next_rkey_waiter;
+		}
+	}
+	nccl_net_ofi_mutex_unlock(&s_comm->ctrl_recv_lock);
+
+	while (resumed != NULL) {
+		nccl_net_ofi_rdma_req_t *req = resumed;
+		resumed = get_send_data(req)->next_rkey_waiter;
+
+		ret = send_progress(req);
+		if (ret == -FI_EAGAIN) {
+			ret = nccl_ofi_deque_insert_back(ep->pending_reqs_queue, &req->pending_reqs_elem);
+			if (OFI_UNLIKELY(ret != 0)) {
+				NCCL_OFI_WARN("Failed to nccl_ofi_deque_insert_back: %d", ret);
+				return ret;
+			}
+			NCCL_OFI_TRACE_PENDING_INSERT(req);
+		} else if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * @brief	Look up the keys of the receive buffer of a send request
+ *		advertised by an NCCL_OFI_RDMA_MSG_CTRL_COMPACT message. If
+ *		the registration is not cached yet, the request waits on
+ *		the send communicator until cache_remote_rkeys() resumes it.
+ *
+ * @return	true, if the keys of the request are known
+ *		false, if the request waits for the keys
+ */
+static bool resolve_remote_rkeys(nccl_net_ofi_rdma_send_comm_t *s_comm,
+				 nccl_net_ofi_rdma_req_t *req)
+{
+	rdma_req_send_data_t *send_data = get_send_data(req);
+
+	if (!send_data->remote_rkey_pending) {
+		return true;
+	}
+
+	nccl_net_ofi_mutex_lock(&s_comm->ctrl_recv_lock);
+	nccl_net_ofi_rdma_remote_rkey_t *entry = &s_comm->remote_rkeys[send_data->remote_rkey_ref.slot];
+	/* The receiver does not reuse the slot before this request is
+	 * done, so a newer generation cannot be cached yet */
+	if (entry->valid && entry->gen == send_data->remote_rkey_ref.gen) {
+		memcpy(send_data->remote_mr_key, entry->mr_key, sizeof(send_data->remote_mr_key));
+		send_data->remote_rkey_pending = false;
+	} else {
+		send_data->next_rkey_waiter = s_comm->rkey_waiters;
+		s_comm->rkey_waiters = req;
+	}
+	nccl_net_ofi_mutex_unlock(&s_comm->ctrl_recv_lock);
+
+	return !send_data->remote_rkey_pending;
+}
+
 static inline int update_send_data_from_remote(nccl_net_ofi_rdma_send_comm_t *s_comm, nccl_net_ofi_rdma_req_t *bounce_req,
 				 nccl_net_ofi_rdma_req_t *req)
 {
@@ -902,14 +1278,26 @@ static inline int update_send_data_from_remote(nccl_net_ofi_rdma_send_comm_t *s_
 
 	rdma_req_send_data_t *send_data = get_send_data(req);
 	rdma_req_bounce_data_t *bounce_data = get_bounce_data(bounce_req);
-	nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg = get_bounce_ctrl_msg(bounce_data->bounce_fl_item);
+	nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg = get_bounce_ctrl_msg(bounce_data);
 
-	for (int rail_id = 0; rail_id != ep->num_rails; ++rail_id) {
-		if (ep->use_long_rkeys) {
-			send_data->remote_mr_key[rail_id] = ctrl_msg->long_buff_mr_key[rail_id];
-		} else {
-			send_data->remote_mr_key[rail_id] = ctrl_msg->short_buff_mr_key[rail_id];
+	if (ctrl_msg->type == NCCL_OFI_RDMA_MSG_CTRL_COMPACT) {
+		if (OFI_UNLIKELY(ctrl_msg->rkey_ref.slot >= NCCL_OFI_RDMA_RKEY_CACHE_MAX)) {
+			NCCL_OFI_WARN("Invalid remote key cache slot %u", ctrl_msg->rkey_ref.slot);
+			return -EINVAL;
+		}
+		/* Keys are looked up when the writes are posted, as the
+		 * message caching them may still be on its way */
+		send_data->remote_rkey_ref = ctrl_msg->rkey_ref;
+		send_data->remote_rkey_pending = true;
+	} else {
+		for (int rail_id = 0; rail_id != ep->num_rails; ++rail_id) {
+			if (ep->use_long_rkeys) {
+				send_data->remote_mr_key[rail_id] = ctrl_msg->long_buff_mr_key[rail_id];
+			} else {
+				send_data->remote_mr_key[rail_id] = ctrl_msg->short_buff_mr_key[rail_id];
+			}
 		}
+		send_data->remote_rkey_pending = false;
 	}
 
 	send_data->remote_buff = ctrl_msg->buff_addr;
@@ -929,9 +1317,13 @@ static inline int update_send_data_from_remote(nccl_net_ofi_rdma_send_comm_t *s_
 	if (OFI_UNLIKELY(send_data->schedule == NULL)) {
 		return -EINVAL;
 	}
+	send_data->xfer_start_ns = nccl_ofi_stats_now_ns();
 
-	/* Set expected number of completions */
-	send_data->total_num_compls = send_data->schedule->num_xfer_infos;
+	/* Set expected number of completions. If an RTS message was
+	   posted before the ctrl message arrived, also expect its send
+	   completion. */
+	send_data->total_num_compls = send_data->schedule->num_xfer_infos +
+		(send_data->rts_posted ? 1 : 0);
 
 	send_data->wdata =
 		GET_RDMA_WRITE_IMM_DATA(s_comm->remote_comm_id, req->msg_seq_num, send_data->schedule->num_xfer_infos);
@@ -954,6 +1346,52 @@ static inline int check_post_bounce_buffers_rail(nccl_net_ofi_rdma_ep_t *ep,
 	return 0;
 }
 
+/*
+ * @brief	Drop a reference to a multi-receive slab. Once the provider
+ *		released the slab and all its messages are released, the
+ *		slab is reposted, or freed if the rail has enough slabs
+ *		posted.
+ */
+static int put_slab(nccl_net_ofi_rdma_req_t *slab_req)
+{
+	rdma_req_bounce_data_t *slab_data = get_bounce_data(slab_req);
+	nccl_net_ofi_ep_rail_t *rail = slab_data->rail;
+	bool reuse;
+
+	nccl_net_ofi_mutex_lock(&rail->bounce_mutex);
+
+	assert(slab_data->slab_refcnt > 0);
+	slab_data->slab_refcnt--;
+	reuse = (slab_data->slab_refcnt == 0) && slab_data->slab_consumed;
+	if (reuse) {
+		slab_data->slab_consumed = false;
+	}
+
+	nccl_net_ofi_mutex_unlock(&rail->bounce_mutex);
+
+	if (!reuse) {
+		return 0;
+	}
+
+	return check_post_bounce_req(slab_req);
+}
+
+/*
+ * @brief	Release a message received into a multi-receive slab
+ */
+static int release_slab_msg(nccl_net_ofi_rdma_req_t *msg_req)
+{
+	nccl_net_ofi_rdma_req_t *slab_req = get_bounce_data(msg_req)->slab_req;
+
+	int ret = msg_req->free(msg_req, false);
+	if (OFI_UNLIKELY(ret != 0)) {
+		NCCL_OFI_WARN("Failed to free slab message req");
+		return ret;
+	}
+
+	return put_slab(slab_req);
+}
+
 /**
  * @brief	Re-post a bounce buffer that has not yet been removed from active
  * 		count
@@ -963,6 +1401,11 @@ static inline int repost_bounce_buff(nccl_net_ofi_rdma_ep_t *ep,
 {
 	int ret = 0;
 
+	/* Messages of a slab are not posted on their own */
+	if (get_bounce_data(bounce_req)->slab_req != NULL) {
+		return release_slab_msg(bounce_req);
+	}
+
 	/* First, repost this bounce buffer */
 	ret = send_progress(bounce_req);
 	if (ret == -FI_EAGAIN) {
@@ -996,12 +1439,35 @@ static inline int decrease_bounce_buff_cnt(nccl_net_ofi_rdma_ep_t *ep,
 
 	assert(rail->num_bounce_posted > 0);
 	rail->num_bounce_posted--;
+	if (rail->num_bounce_posted < rail->stats.bounce_low_water) {
+		__atomic_store_n(&rail->stats.bounce_low_water, rail->num_bounce_posted,
+				 __ATOMIC_RELAXED);
+	}
 
 	nccl_net_ofi_mutex_unlock(&rail->bounce_mutex);
 
 	return check_post_bounce_buffers_rail(ep, rail);
 }
 
+/*
+ * @brief	Account a bounce buffer kept by a message handler until
+ *		the message is consumed and the buffer released with
+ *		check_post_bounce_req()
+ */
+static inline int retain_bounce_buff(nccl_net_ofi_rdma_ep_t *ep,
+				     nccl_net_ofi_rdma_req_t *bounce_req)
+{
+	rdma_req_bounce_data_t *bounce_data = get_bounce_data(bounce_req);
+
+	/* Keeping a message of a slab does not take the slab off the
+	   rail, this happens once the provider released the slab */
+	if (bounce_data->slab_req != NULL) {
+		return 0;
+	}
+
+	return decrease_bounce_buff_cnt(ep, bounce_data->rail);
+}
+
 /**
  * @brief	Handle receiving an RDMA control message. These are control messages
  *       	containing information about the remote buffer location which will be
@@ -1015,13 +1481,25 @@ static inline int handle_ctrl_recv(nccl_net_ofi_rdma_send_comm_t *s_comm,
 
 	nccl_ofi_msgbuff_status_t stat;
 	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep;
+	rdma_req_bounce_data_t *bounce_data = get_bounce_data(bounce_req);
+	nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg = get_bounce_ctrl_msg(bounce_data);
+
+	/* Cache the keys even if the send is eager and does not use
+	 * them, later messages may reference them */
+	if (ctrl_msg->type == NCCL_OFI_RDMA_MSG_CTRL_CACHE) {
+		ret = cache_remote_rkeys(s_comm, ctrl_msg);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+	}
+
 	nccl_ofi_msgbuff_result_t mb_res = nccl_ofi_msgbuff_insert(s_comm->msgbuff, msg_seq_num,
 		bounce_req, NCCL_OFI_MSGBUFF_BUFF, &stat);
 
 	if (mb_res == NCCL_OFI_MSGBUFF_SUCCESS) {
 		/* Inserted! In this case sender has not yet called send() for this message, so
 		   return success and initiate RDMA write when sender calls send(). */
-		return decrease_bounce_buff_cnt(ep, get_bounce_data(bounce_req)->rail);
+		return retain_bounce_buff(ep, bounce_req);
 	}
 
 	if (OFI_UNLIKELY(mb_res != NCCL_OFI_MSGBUFF_INVALID_IDX || stat != NCCL_OFI_MSGBUFF_INPROGRESS)) {
@@ -1040,10 +1518,15 @@ static inline int handle_ctrl_recv(nccl_net_ofi_rdma_send_comm_t *s_comm,
 
 	nccl_net_ofi_rdma_req_t *req = (nccl_net_ofi_rdma_req_t *)elem;
 	rdma_req_send_data_t *send_data = get_send_data(req);
-	rdma_req_bounce_data_t *bounce_data = get_bounce_data(bounce_req);
-	nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg = get_bounce_ctrl_msg(bounce_data->bounce_fl_item);
 
 	if (!send_data->eager) {
+		/* The receiver posted its buffer before it saw an RTS
+		   message for this request, so it will not pull the
+		   data. Write it as usual. */
+		nccl_net_ofi_mutex_lock(&req->req_lock);
+		send_data->pull = false;
+		nccl_net_ofi_mutex_unlock(&req->req_lock);
+
 		ret = update_send_data_from_remote(s_comm, bounce_req, req);
 		if (OFI_UNLIKELY(ret != 0)) {
 			NCCL_OFI_WARN("Failed to copy ctrl data");
@@ -1132,31 +1615,80 @@ static inline int alloc_eager_copy_req(nccl_net_ofi_rdma_req_t *recv_req, nccl_n
 	return 0;
 }
 
-/**
- * @brief	Handle receiving an RDMA eager message.
+/*
+ * @brief	Return true if the eager message of a receive request is
+ *		copied into the receive buffer by the CPU
  */
-static inline int handle_eager_recv(nccl_net_ofi_rdma_recv_comm_t *r_comm,
-					     uint16_t msg_seq_num,
-					     nccl_net_ofi_rdma_req_t *bounce_req)
+static inline bool use_eager_cpu_copy(nccl_net_ofi_rdma_req_t *recv_req)
 {
-	int ret;
-	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
-
-	/* Decrease bounce buffer count. It will be incremented again when reposting */
-	ret = decrease_bounce_buff_cnt(ep, get_bounce_data(bounce_req)->rail);
-	if (ret != 0) {
-		return ret;
-	}
+	nccl_net_ofi_rdma_mr_handle_t *dest_mr_handle = get_recv_data(recv_req)->dest_mr_handle;
 
-	nccl_ofi_msgbuff_status_t stat;
-	nccl_ofi_msgbuff_result_t mb_res = nccl_ofi_msgbuff_insert(r_comm->msgbuff, msg_seq_num,
-		bounce_req, NCCL_OFI_MSGBUFF_BUFF, &stat);
+	return eager_cpu_copy && dest_mr_handle != NULL && dest_mr_handle->type == NCCL_PTR_HOST;
+}
 
-	if (mb_res == NCCL_OFI_MSGBUFF_SUCCESS) {
-		/* Inserted! In this case receiver has not yet called recv() for this message, so
-		   return success and initiate eager read when receiver calls recv(). */
-		return 0;
-	}
+/*
+ * @brief	Copy eager data from the bounce buffer into the host
+ *		receive buffer with the CPU, and repost the bounce buffer
+ *
+ * Replaces the local RDMA read of the eager copy request, so no eager
+ * copy request is allocated. The caller accounts the completion of
+ * the data to the receive request.
+ *
+ * @param	size
+ *		Output, number of bytes copied
+ * @return	0, on success
+ *		error, on others
+ */
+static int eager_copy_cpu(nccl_net_ofi_rdma_req_t *recv_req,
+			  nccl_net_ofi_rdma_req_t *bounce_req,
+			  size_t *size)
+{
+	nccl_net_ofi_rdma_recv_comm_t *r_comm = (nccl_net_ofi_rdma_recv_comm_t *)recv_req->comm;
+	rdma_req_recv_data_t *recv_data = get_recv_data(recv_req);
+	rdma_req_bounce_data_t *bounce_data = get_bounce_data(bounce_req);
+	size_t len = bounce_data->recv_len;
+
+	if (recv_data->dst_len < len) {
+		NCCL_OFI_TRACE(NCCL_NET, "Recv buffer (%zu) smaller than eager send size (%zu)",
+			       recv_data->dst_len, len);
+		len = recv_data->dst_len;
+	}
+
+	nccl_ofi_memcpy(recv_data->dst_buff, bounce_data->msg,
+			len, cpu_copy_nt_threshold);
+	nccl_ofi_stats_add(&r_comm->stats.eager_cpu_copied, 1);
+
+	*size = len;
+
+	/* The bounce buffer is no longer needed */
+	return check_post_bounce_req(bounce_req);
+}
+
+/**
+ * @brief	Handle receiving an RDMA eager message.
+ */
+static inline int handle_eager_recv(nccl_net_ofi_rdma_recv_comm_t *r_comm,
+					     uint16_t msg_seq_num,
+					     nccl_net_ofi_rdma_req_t *bounce_req)
+{
+	int ret;
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+
+	/* Decrease bounce buffer count. It will be incremented again when reposting */
+	ret = retain_bounce_buff(ep, bounce_req);
+	if (ret != 0) {
+		return ret;
+	}
+
+	nccl_ofi_msgbuff_status_t stat;
+	nccl_ofi_msgbuff_result_t mb_res = nccl_ofi_msgbuff_insert(r_comm->msgbuff, msg_seq_num,
+		bounce_req, NCCL_OFI_MSGBUFF_BUFF, &stat);
+
+	if (mb_res == NCCL_OFI_MSGBUFF_SUCCESS) {
+		/* Inserted! In this case receiver has not yet called recv() for this message, so
+		   return success and initiate eager read when receiver calls recv(). */
+		return 0;
+	}
 	if (OFI_UNLIKELY(mb_res != NCCL_OFI_MSGBUFF_INVALID_IDX)) {
 		NCCL_OFI_WARN("Unexpected message insert result (%d) (eager recv)", (int)mb_res);
 		return -EINVAL;
@@ -1191,6 +1723,16 @@ static inline int handle_eager_recv(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 		return ret;
 	}
 
+	if (use_eager_cpu_copy(recv_req)) {
+		size_t size;
+		ret = eager_copy_cpu(recv_req, bounce_req, &size);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed CPU copy of eager message");
+			return ret;
+		}
+		return inc_req_completion(recv_req, size, recv_data->total_num_compls);
+	}
+
 	ret = alloc_eager_copy_req(recv_req, r_comm, bounce_req);
 	if (ret != 0) {
 		NCCL_OFI_WARN("Failed call to alloc_eager_copy_req");
@@ -1206,6 +1748,94 @@ static inline int handle_eager_recv(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 	return 0;
 }
 
+/**
+ * @brief	Handle receiving an RTS message of the pull rendezvous. The
+ *		message describes the sender's buffer, which the receiver
+ *		reads once recv() is called for this message.
+ */
+static inline int handle_rts_recv(nccl_net_ofi_rdma_recv_comm_t *r_comm,
+				  uint16_t msg_seq_num,
+				  nccl_net_ofi_rdma_req_t *bounce_req)
+{
+	nccl_ofi_msgbuff_status_t stat;
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+	nccl_ofi_msgbuff_result_t mb_res = nccl_ofi_msgbuff_insert(r_comm->msgbuff, msg_seq_num,
+		bounce_req, NCCL_OFI_MSGBUFF_BUFF, &stat);
+
+	if (mb_res == NCCL_OFI_MSGBUFF_SUCCESS) {
+		/* Inserted! In this case receiver has not yet called recv() for this message, so
+		   return success and initiate RDMA reads when receiver calls recv(). */
+		return retain_bounce_buff(ep, bounce_req);
+	}
+
+	if (OFI_UNLIKELY(mb_res != NCCL_OFI_MSGBUFF_INVALID_IDX)) {
+		NCCL_OFI_WARN("Unexpected message insert result (%d) (rts recv)", (int)mb_res);
+		return -EINVAL;
+	}
+
+	/* The receiver already posted its buffer and sent a ctrl
+	   message for it, so the sender writes the data. The RTS
+	   message travels on a control rail, so it may arrive while the
+	   receive is in progress, after it completed, or after the
+	   completed section moved past the message. Drop it in all
+	   cases. The sender does not complete the send, and so does not
+	   reuse the sequence number, before the send of the RTS message
+	   completed. */
+	NCCL_OFI_TRACE(NCCL_NET, "Ignoring RTS message for msg %hu of posted receive (status %d)",
+		       msg_seq_num, (int)stat);
+
+	return repost_bounce_buff(ep, bounce_req);
+}
+
+/**
+ * @brief	Handle receiving a PULL_DONE message. The receiver read
+ *		the data of a pulled send request, which is now complete.
+ */
+static inline int handle_pull_done_recv(nccl_net_ofi_rdma_send_comm_t *s_comm,
+					uint16_t msg_seq_num,
+					nccl_net_ofi_rdma_req_t *bounce_req)
+{
+	int ret;
+	void *elem;
+	nccl_ofi_msgbuff_elemtype_t type;
+	nccl_ofi_msgbuff_status_t stat;
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep;
+
+	nccl_ofi_msgbuff_result_t mb_res = nccl_ofi_msgbuff_retrieve(s_comm->msgbuff, msg_seq_num,
+								     &elem, &type, &stat);
+	if (OFI_UNLIKELY(mb_res != NCCL_OFI_MSGBUFF_SUCCESS || type != NCCL_OFI_MSGBUFF_REQ)) {
+		NCCL_OFI_WARN("Invalid message retrieval result for msg %hu", msg_seq_num);
+		return -EINVAL;
+	}
+
+	nccl_net_ofi_rdma_req_t *req = (nccl_net_ofi_rdma_req_t *)elem;
+	rdma_req_send_data_t *send_data = get_send_data(req);
+	nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg =
+		get_bounce_ctrl_msg(get_bounce_data(bounce_req));
+
+	assert(send_data->pull && send_data->rts_posted);
+
+	/* The receiver reads at most the size of its buffer */
+	send_data->remote_len = ctrl_msg->buff_len;
+	nccl_net_ofi_mutex_lock(&req->req_lock);
+	if (send_data->remote_len < send_data->buff_len) {
+		NCCL_OFI_TRACE(NCCL_NET,
+			       "Remote recv buffer (%zu) smaller than send buffer (%zu) in pull rendezvous",
+			       send_data->remote_len, send_data->buff_len);
+		req->size = send_data->remote_len;
+		send_data->buff_len = send_data->remote_len;
+	}
+	nccl_net_ofi_mutex_unlock(&req->req_lock);
+
+	ret = inc_req_completion(req, 0, send_data->total_num_compls);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to increase completion count");
+		return ret;
+	}
+
+	return repost_bounce_buff(ep, bounce_req);
+}
+
 static int finish_connect(nccl_net_ofi_rdma_send_comm_t *s_comm);
 
 static int handle_close_msg_recv(nccl_net_ofi_rdma_req_t *bounce_req)
@@ -1218,7 +1848,7 @@ static int handle_close_msg_recv(nccl_net_ofi_rdma_req_t *bounce_req)
 	nccl_net_ofi_rdma_device_t *device = rdma_endpoint_get_device(ep);
 
 	nccl_net_ofi_rdma_close_msg_t *close_msg =
-		bounce_get_close_msg(bounce_data->bounce_fl_item);
+		bounce_get_close_msg(bounce_data);
 
 	nccl_net_ofi_rdma_send_comm_t *s_comm = rdma_device_get_send_comm(device, close_msg->send_comm_id);
 	assert(s_comm);
@@ -1234,20 +1864,96 @@ static int handle_close_msg_recv(nccl_net_ofi_rdma_req_t *bounce_req)
 	return repost_bounce_buff(ep, bounce_req);
 }
 
+/**
+ * @brief	Handle receiving a batch of control messages, or the
+ *		control messages of a grouped receive. Each message is
+ *		handled like a single control message, with the bounce
+ *		buffer of the batch held until all of them are released.
+ *
+ * @param	off
+ *		Offset of the first control message in the bounce buffer
+ * @param	group_msg
+ *		Header of the grouped receive, or NULL for a batch
+ */
+static int handle_ctrl_batch_recv(nccl_net_ofi_rdma_device_t *device, int rail_id,
+				  size_t off, size_t len, nccl_net_ofi_rdma_req_t *batch_req,
+				  nccl_net_ofi_rdma_ctrl_group_msg_t *group_msg)
+{
+	int ret = 0;
+	rdma_req_bounce_data_t *batch_data = get_bounce_data(batch_req);
+	nccl_net_ofi_rdma_ep_t *ep = batch_data->ep;
+	nccl_net_ofi_ep_rail_t *rail = batch_data->rail;
+	size_t stride = nccl_net_ofi_rdma_ctrl_batch_stride(ep->num_rails, ep->use_long_rkeys);
+	int index = 0;
+
+	if (OFI_UNLIKELY((len - off) % stride != 0)) {
+		NCCL_OFI_WARN("Invalid length %zu of control message batch", len);
+		return -EINVAL;
+	}
+
+	ret = retain_bounce_buff(ep, batch_req);
+	if (OFI_UNLIKELY(ret != 0)) {
+		return ret;
+	}
+
+	/* Reference the batch while unpacking it */
+	batch_data->slab_refcnt = 1;
+	batch_data->slab_consumed = true;
+
+	for (; off < len; off += stride, index++) {
+		nccl_net_ofi_rdma_req_t *msg_req =
+			alloc_slab_msg_req(batch_req, (char *)batch_data->msg + off);
+		if (OFI_UNLIKELY(msg_req == NULL)) {
+			NCCL_OFI_WARN("Failed to allocate control message req");
+			return -ENOMEM;
+		}
+		rdma_req_bounce_data_t *msg_data = get_bounce_data(msg_req);
+		nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg = get_bounce_ctrl_msg(msg_data);
+		assert(ctrl_msg->type == NCCL_OFI_RDMA_MSG_CTRL ||
+		       ctrl_msg->type == NCCL_OFI_RDMA_MSG_CTRL_CACHE ||
+		       ctrl_msg->type == NCCL_OFI_RDMA_MSG_CTRL_COMPACT);
+		msg_data->recv_len = nccl_net_ofi_rdma_ctrl_msg_len(ctrl_msg, ep->num_rails, ep->use_long_rkeys);
+		msg_data->msg_type = ctrl_msg->type;
+		msg_data->ctrl_group_size = (group_msg != NULL) ? (int)group_msg->num_recvs : 1;
+		msg_data->ctrl_tag = (group_msg != NULL) ? group_msg->tags[index] : 0;
+
+		nccl_net_ofi_mutex_lock(&rail->bounce_mutex);
+		batch_data->slab_refcnt++;
+		nccl_net_ofi_mutex_unlock(&rail->bounce_mutex);
+
+		nccl_net_ofi_rdma_send_comm_t *s_comm =
+			rdma_device_get_send_comm(device, ctrl_msg->remote_comm_id);
+
+		NCCL_OFI_TRACE_SEND_CTRL_RECV(s_comm->base.base.dev_id, rail_id, s_comm, ctrl_msg->msg_seq_num);
+
+		ret = handle_ctrl_recv(s_comm, ctrl_msg->msg_seq_num, msg_req);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+
+		nccl_net_ofi_mutex_lock(&s_comm->ctrl_recv_lock);
+		s_comm->n_ctrl_received += 1;
+		nccl_net_ofi_mutex_unlock(&s_comm->ctrl_recv_lock);
+	}
+
+	return put_slab(batch_req);
+}
+
 /**
  * @brief	Handle receiving a bounce buffer message. These are:
  * 		connect messages (l_comm), connect response messages (s_comm),
- * 		RDMA control messages (s_comm), eager messages (r_comm).
+ * 		RDMA control messages (s_comm), eager messages (r_comm),
+ * 		RTS messages (r_comm), pull done messages (s_comm).
  */
 static inline int handle_bounce_recv(nccl_net_ofi_rdma_device_t *device, int rail_id, struct fi_cq_data_entry *cq_entry,
 				     nccl_net_ofi_rdma_req_t *bounce_req, bool eager)
 {
 	int ret = 0;
 	rdma_req_bounce_data_t *bounce_data = NULL;
-	nccl_net_ofi_rdma_bounce_fl_item_t *bounce_fl_item = NULL;
 	nccl_ofi_rdma_connection_info_t *conn_msg = NULL;
 	nccl_ofi_rdma_connection_info_t *conn_resp_msg = NULL;
 	nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg = NULL;
+	nccl_net_ofi_rdma_ctrl_group_msg_t *group_msg = NULL;
 	nccl_net_ofi_rdma_listen_comm_t *l_comm = NULL;
 	nccl_net_ofi_rdma_send_comm_t *s_comm = NULL;
 	nccl_net_ofi_rdma_recv_comm_t *r_comm = NULL;
@@ -1262,8 +1968,10 @@ static inline int handle_bounce_recv(nccl_net_ofi_rdma_device_t *device, int rai
 	}
 
 	bounce_data = get_bounce_data(bounce_req);
+	if (bounce_data->ep->use_multi_recv && bounce_data->slab_req == NULL) {
+		return handle_slab_recv(device, rail_id, cq_entry, bounce_req, eager);
+	}
 	bounce_data->recv_len = cq_entry->len;
-	bounce_fl_item = bounce_data->bounce_fl_item;
 
 	nccl_net_ofi_rdma_ep_t *ep = bounce_data->ep;
 
@@ -1271,14 +1979,15 @@ static inline int handle_bounce_recv(nccl_net_ofi_rdma_device_t *device, int rai
 	 * header type.  So cast to a control message and lookup the
 	 * type from there. */
 	nccl_ofi_rdma_msg_type_t msg_type = eager ? (nccl_ofi_rdma_msg_type_t)NCCL_OFI_RDMA_MSG_EAGER
-	                                          : ((nccl_net_ofi_rdma_ctrl_msg_t *)&bounce_fl_item->bounce_msg)->type;
+	                                          : ((nccl_net_ofi_rdma_ctrl_msg_t *)bounce_data->msg)->type;
+	bounce_data->msg_type = msg_type;
 
 	switch (msg_type) {
 	case NCCL_OFI_RDMA_MSG_CONN:
 		/* CONN receive completion */
 		assert(sizeof(nccl_ofi_rdma_connection_info_t) == cq_entry->len);
 
-		conn_msg = get_bounce_connection_msg(bounce_fl_item);
+		conn_msg = get_bounce_connection_msg(bounce_data);
 		l_comm = rdma_device_get_listen_comm(device, conn_msg->remote_comm_id);
 
 		assert(l_comm->req.comm->type == NCCL_NET_OFI_LISTEN_COMM);
@@ -1303,7 +2012,7 @@ static inline int handle_bounce_recv(nccl_net_ofi_rdma_device_t *device, int rai
 		/* CONN_RESP receive completion */
 		assert(sizeof(nccl_ofi_rdma_connection_info_t) == cq_entry->len);
 
-		conn_resp_msg = get_bounce_connection_msg(bounce_fl_item);
+		conn_resp_msg = get_bounce_connection_msg(bounce_data);
 		s_comm = rdma_device_get_send_comm(device, conn_resp_msg->remote_comm_id);
 
 		assert(NULL != s_comm->conn_resp_req);
@@ -1326,10 +2035,18 @@ static inline int handle_bounce_recv(nccl_net_ofi_rdma_device_t *device, int rai
 		}
 		break;
 	case NCCL_OFI_RDMA_MSG_CTRL:
+	case NCCL_OFI_RDMA_MSG_CTRL_CACHE:
+	case NCCL_OFI_RDMA_MSG_CTRL_COMPACT:
+		if (cq_entry->len > nccl_net_ofi_rdma_ctrl_batch_stride(ep->num_rails, ep->use_long_rkeys)) {
+			/* Batch of CTRL messages */
+			ret = handle_ctrl_batch_recv(device, rail_id, 0, cq_entry->len, bounce_req, NULL);
+			break;
+		}
+
 		/* CTRL receive completion */
-		assert(cq_entry->len == nccl_net_ofi_rdma_ctrl_msg_size(ep->num_rails, ep->use_long_rkeys));
 
-		ctrl_msg = get_bounce_ctrl_msg(bounce_fl_item);
+		bounce_data->ctrl_group_size = 1;
+		ctrl_msg = get_bounce_ctrl_msg(bounce_data);
 		s_comm = rdma_device_get_send_comm(device, ctrl_msg->remote_comm_id);
 
 		NCCL_OFI_TRACE_SEND_CTRL_RECV(s_comm->base.base.dev_id, rail_id, s_comm, ctrl_msg->msg_seq_num);
@@ -1344,11 +2061,55 @@ static inline int handle_bounce_recv(nccl_net_ofi_rdma_device_t *device, int rai
 		nccl_net_ofi_mutex_unlock(&s_comm->ctrl_recv_lock);
 
 		break;
+	case NCCL_OFI_RDMA_MSG_CTRL_GROUP:
+		/* Control messages of a grouped receive */
+		group_msg = (nccl_net_ofi_rdma_ctrl_group_msg_t *)bounce_data->msg;
+		if (OFI_UNLIKELY(group_msg->num_recvs < 1 || group_msg->num_recvs > NCCL_OFI_MAX_RECVS ||
+				 cq_entry->len != nccl_net_ofi_rdma_ctrl_group_msg_size(group_msg->num_recvs,
+										       ep->num_rails,
+										       ep->use_long_rkeys))) {
+			NCCL_OFI_WARN("Invalid grouped receive control message of length %zu",
+				      cq_entry->len);
+			ret = -EINVAL;
+			goto exit;
+		}
+
+		ret = handle_ctrl_batch_recv(device, rail_id, sizeof(nccl_net_ofi_rdma_ctrl_group_msg_t),
+					     cq_entry->len, bounce_req, group_msg);
+		break;
 	case NCCL_OFI_RDMA_MSG_CLOSE:
 		assert(cq_entry->len == sizeof(nccl_net_ofi_rdma_close_msg_t));
 
 		ret = handle_close_msg_recv(bounce_req);
 
+		break;
+	case NCCL_OFI_RDMA_MSG_RTS:
+		/* RTS receive completion */
+		assert(cq_entry->len == nccl_net_ofi_rdma_ctrl_msg_size(ep->num_rails, ep->use_long_rkeys));
+
+		ctrl_msg = get_bounce_ctrl_msg(bounce_data);
+		r_comm = rdma_device_get_recv_comm(device, ctrl_msg->remote_comm_id);
+
+		ret = handle_rts_recv(r_comm, ctrl_msg->msg_seq_num, bounce_req);
+
+		break;
+	case NCCL_OFI_RDMA_MSG_PULL_DONE:
+		/* PULL_DONE receive completion */
+		assert(cq_entry->len == nccl_net_ofi_rdma_ctrl_msg_size(ep->num_rails, ep->use_long_rkeys));
+
+		ctrl_msg = get_bounce_ctrl_msg(bounce_data);
+		s_comm = rdma_device_get_send_comm(device, ctrl_msg->remote_comm_id);
+
+		ret = handle_pull_done_recv(s_comm, ctrl_msg->msg_seq_num, bounce_req);
+		if (OFI_UNLIKELY(ret != 0)) {
+			goto exit;
+		}
+
+		/* Accounted like ctrl messages by the close protocol */
+		nccl_net_ofi_mutex_lock(&s_comm->ctrl_recv_lock);
+		s_comm->n_ctrl_received += 1;
+		nccl_net_ofi_mutex_unlock(&s_comm->ctrl_recv_lock);
+
 		break;
 	case NCCL_OFI_RDMA_MSG_EAGER:
 		/* Eager message receive completion */
@@ -1483,6 +2244,8 @@ static const char *req_type_str(nccl_net_ofi_rdma_req_type_t type)
 		return "SEND";
 	case NCCL_OFI_RDMA_RECV:
 		return "RECV";
+	case NCCL_OFI_RDMA_RECV_GROUP:
+		return "RECV_GROUP";
 	case NCCL_OFI_RDMA_SEND_CTRL:
 		return "SEND_CTRL";
 	case NCCL_OFI_RDMA_SEND_CLOSE:
@@ -1526,6 +2289,83 @@ static int post_flush_req(nccl_net_ofi_rdma_req_t *req);
 
 static int post_eager_copy(nccl_net_ofi_rdma_req_t *req);
 
+static int post_rdma_write_chunks(nccl_net_ofi_rdma_req_t *req, size_t stripe, bool *injected);
+
+/*
+ * @brief	Handle completion of a chunk written by a send request
+ *
+ * Posts the next chunks of the stripe. Once its last chunk has
+ * completed, the stripe is accounted as a completion of the request.
+ * If the network is busy, the request is queued in the pending
+ * requests queue, unless it is already queued.
+ *
+ * @return	0, on success
+ *		error, on others
+ */
+static int handle_write_chunk_comp(nccl_net_ofi_rdma_req_t *req,
+				   nccl_net_ofi_rdma_device_t *device,
+				   int rail_id)
+{
+	rdma_req_send_data_t *send_data = get_send_data(req);
+	nccl_net_ofi_schedule_t *schedule = send_data->schedule;
+	nccl_net_ofi_rdma_ep_t *ep = rdma_req_get_ep(req);
+	bool stripe_done = false;
+	bool queue = false;
+	size_t stripe;
+	int ret = 0;
+
+	/* A schedule has at most one stripe per rail */
+	for (stripe = 0; stripe < schedule->num_xfer_infos; stripe++) {
+		if (schedule->rail_xfer_infos[stripe].rail_id == rail_id) {
+			break;
+		}
+	}
+	if (OFI_UNLIKELY(stripe == schedule->num_xfer_infos)) {
+		NCCL_OFI_WARN("Write completion on rail %d without stripe", rail_id);
+		return -EINVAL;
+	}
+
+	nccl_net_ofi_mutex_lock(&req->req_lock);
+
+	assert(send_data->stripe_inflight[stripe] > 0);
+	send_data->stripe_inflight[stripe]--;
+
+	if (send_data->stripe_last_posted[stripe]) {
+		stripe_done = (send_data->stripe_inflight[stripe] == 0);
+	} else if (!send_data->write_pending) {
+		ret = post_rdma_write_chunks(req, stripe, NULL);
+		if (ret == -FI_EAGAIN) {
+			send_data->write_pending = true;
+			queue = true;
+			ret = 0;
+		}
+	}
+
+	nccl_net_ofi_mutex_unlock(&req->req_lock);
+
+	if (OFI_UNLIKELY(ret != 0)) {
+		return ret;
+	}
+
+	if (queue) {
+		ret = nccl_ofi_deque_insert_back(ep->pending_reqs_queue, &req->pending_reqs_elem);
+		if (OFI_UNLIKELY(ret != 0)) {
+			NCCL_OFI_WARN("Failed to nccl_ofi_deque_insert_back: %d", ret);
+			return ret;
+		}
+		NCCL_OFI_TRACE_PENDING_INSERT(req);
+	}
+
+	if (stripe_done) {
+		NCCL_OFI_TRACE_SEND_WRITE_SEG_COMPLETE(req->dev_id, rail_id, req->comm, req->msg_seq_num,
+						       req);
+		schedule_xfer_completed(device, rail_id, schedule, send_data->xfer_start_ns);
+		ret = inc_req_completion(req, 0, send_data->total_num_compls);
+	}
+
+	return ret;
+}
+
 /*
  * @brief	Processes completion entries from CQ
  *
@@ -1556,7 +2396,7 @@ static inline int process_completions(struct fi_cq_data_entry *cq_entry, uint64_
 		 * 3. RECV w/ immediate data: eager message
 		 * 4. Remote-initiated write
 		 * 5. Local-initiated write: send operation, RMA write, or RMA write inline
-		 * 6. READ: flush, eager copy, or RMA read
+		 * 6. READ: flush, eager copy, RMA read, or pulled segment
 		 */
 		if (comp_flags & FI_SEND) {
 			/* Send completions */
@@ -1568,13 +2408,19 @@ static inline int process_completions(struct fi_cq_data_entry *cq_entry, uint64_
 			} else if (req->type == NCCL_OFI_RDMA_SEND_CTRL) {
 				/* CTRL message send completion */
 				NCCL_OFI_TRACE_SEND_CTRL_END(req->dev_id, rail_id, req->comm, req, req->msg_seq_num);
-				ret = set_send_ctrl_completed(req);
+				ret = set_send_ctrl_batch_completed(req);
 
 			} else if (req->type == NCCL_OFI_RDMA_SEND) {
-				/* Eager message send completion */
-				NCCL_OFI_TRACE_EAGER_SEND_COMPLETE(req->dev_id, rail_id, req->comm, req->msg_seq_num, req);
 				send_data = get_send_data(req);
-				assert(send_data->eager);
+				if (send_data->eager) {
+					/* Eager message send completion */
+					NCCL_OFI_TRACE_EAGER_SEND_COMPLETE(req->dev_id, rail_id, req->comm, req->msg_seq_num, req);
+					schedule_xfer_completed(device, rail_id, send_data->schedule,
+								send_data->xfer_start_ns);
+				} else {
+					/* RTS message send completion */
+					assert(send_data->rts_posted);
+				}
 				ret = inc_req_completion(req, 0, send_data->total_num_compls);
 			} else if (req->type == NCCL_OFI_RDMA_SEND_CLOSE) {
 				ret = inc_req_completion(req, sizeof(nccl_net_ofi_rdma_close_msg_t), 1);
@@ -1582,8 +2428,9 @@ static inline int process_completions(struct fi_cq_data_entry *cq_entry, uint64_
 				NCCL_OFI_WARN("Send completion from unexpected request type");
 				ret = -EINVAL;
 			}
-		} else if (comp_flags & FI_RECV) {
-			/* Receive completions */
+		} else if (comp_flags & (FI_RECV | FI_MULTI_RECV)) {
+			/* Receive completions, and releases of multi-receive
+			 * slabs */
 			ret = handle_bounce_recv(device, rail_id, &cq_entry[comp_idx], req,
 						 comp_flags & FI_REMOTE_CQ_DATA);
 
@@ -1594,12 +2441,8 @@ static inline int process_completions(struct fi_cq_data_entry *cq_entry, uint64_
 		} else if (comp_flags & FI_WRITE) {
 			switch (req->type) {
 			case NCCL_OFI_RDMA_SEND: {
-				/* Local-initiated write of send operation is complete */
-				NCCL_OFI_TRACE_SEND_WRITE_SEG_COMPLETE(req->dev_id, rail_id, req->comm, req->msg_seq_num,
-								       req);
-
-				send_data = get_send_data(req);
-				ret = inc_req_completion(req, 0, send_data->total_num_compls);
+				/* Local-initiated write of a chunk of send operation is complete */
+				ret = handle_write_chunk_comp(req, device, rail_id);
 				break;
 			}
 			case NCCL_OFI_RDMA_WRITE: {
@@ -1644,12 +2487,19 @@ static inline int process_completions(struct fi_cq_data_entry *cq_entry, uint64_
 				ret = inc_req_completion(req, 0, rma_op_data->total_num_compls);
 				break;
 			}
+			case NCCL_OFI_RDMA_RECV_SEGMS: {
+				/* Read of a pulled segment is complete */
+				rdma_req_recv_segms_data_t *recv_segms_data = get_recv_segms_data(req);
+				schedule_xfer_completed(device, rail_id, recv_segms_data->schedule,
+							recv_segms_data->xfer_start_ns);
+				ret = inc_pull_read_completion(req);
+				break;
+			}
 			case NCCL_OFI_RDMA_SEND:
 			case NCCL_OFI_RDMA_WRITE:
 			case NCCL_OFI_RDMA_RECV:
 			case NCCL_OFI_RDMA_SEND_CTRL:
 			case NCCL_OFI_RDMA_SEND_CLOSE:
-			case NCCL_OFI_RDMA_RECV_SEGMS:
 			case NCCL_OFI_RDMA_BOUNCE:
 			case NCCL_OFI_RDMA_SEND_CONN:
 			case NCCL_OFI_RDMA_RECV_CONN:
@@ -1753,11 +2603,32 @@ exit:
 	return ret;
 }
 
+/*
+ * @brief	Account the outcome of posting a libfabric operation on a rail
+ *
+ * @param	bytes
+ *		Byte counter of the rail increased by len if the post
+ *		succeeded, may be NULL
+ */
+static inline void rail_stats_post(nccl_net_ofi_ep_rail_t *rail, uint64_t *bytes,
+				   size_t len, ssize_t rc)
+{
+	if (OFI_LIKELY(rc == 0)) {
+		if (bytes != NULL) {
+			nccl_ofi_stats_add(bytes, len);
+		}
+	} else if (rc == -FI_EAGAIN) {
+		nccl_ofi_stats_add(&rail->stats.eagain, 1);
+	}
+}
+
 static int post_rma_read(nccl_net_ofi_rdma_req_t *req)
 {
 	rdma_req_rma_op_data_t *rma_op_data = req_get_rma_op_data(req, NCCL_OFI_RDMA_READ);
 	nccl_net_ofi_rdma_recv_comm_t *r_comm = (nccl_net_ofi_rdma_recv_comm_t *)req->comm;
-	nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail = rdma_recv_comm_get_rail(r_comm, 0);
+	/* RMA operations are posted to the first rail */
+	int rail_id = 0;
+	nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail = rdma_recv_comm_get_rail(r_comm, rail_id);
 
 	ssize_t rc;
 	/* Post RMA read */
@@ -1767,6 +2638,9 @@ static int post_rma_read(nccl_net_ofi_rdma_req_t *req)
 		      rma_op_data->remote_buff,
 		      rma_op_data->remote_mr_key, req);
 
+	nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_rail(rdma_recv_comm_get_ep(r_comm), rail_id);
+	rail_stats_post(rail, &rail->stats.bytes_read, rma_op_data->buff_len, rc);
+
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
 		NCCL_OFI_WARN("fi_read failed; RC: %zd, Error: %s",
 			      rc, fi_strerror(-rc));
@@ -1775,6 +2649,56 @@ static int post_rma_read(nccl_net_ofi_rdma_req_t *req)
 	return rc;
 }
 
+/*
+ * @brief	Post the RDMA reads of a pulled receive segments request
+ *
+ * Reads are striped across rails following the schedule of the
+ * request. On FI_EAGAIN, the remaining reads are posted when the
+ * request is progressed again.
+ */
+static int post_pull_reads(nccl_net_ofi_rdma_req_t *req)
+{
+	rdma_req_recv_segms_data_t *recv_segms_data = get_recv_segms_data(req);
+	rdma_req_recv_data_t *recv_data = get_recv_data(recv_segms_data->recv_req);
+	nccl_net_ofi_rdma_recv_comm_t *r_comm = (nccl_net_ofi_rdma_recv_comm_t *)req->comm;
+	nccl_net_ofi_rdma_ep_t *ep = rdma_recv_comm_get_ep(r_comm);
+	nccl_net_ofi_schedule_t *schedule = recv_segms_data->schedule;
+	ssize_t rc = 0;
+
+	assert(recv_segms_data->pull && schedule != NULL);
+
+	for (size_t rail_it = recv_segms_data->xferred_rail_id; rail_it < schedule->num_xfer_infos; rail_it++) {
+		nccl_net_ofi_xfer_info_t *xfer_info = &schedule->rail_xfer_infos[rail_it];
+		int rail_id = xfer_info->rail_id;
+		nccl_net_ofi_rdma_recv_comm_rail_t *comm_rail = rdma_recv_comm_get_rail(r_comm, rail_id);
+
+		assert(rail_id < recv_data->dest_mr_handle->num_rails);
+		void *desc = fi_mr_desc(recv_data->dest_mr_handle->mr[rail_id]);
+
+		rc = fi_read(comm_rail->local_ep,
+			     (void *)((uintptr_t)recv_data->dst_buff + xfer_info->offset),
+			     xfer_info->msg_size, desc, comm_rail->remote_addr,
+			     recv_segms_data->remote_buff + xfer_info->offset,
+			     recv_segms_data->remote_mr_key[rail_id], req);
+
+		nccl_net_ofi_ep_rail_t *ep_rail = rdma_endpoint_get_rail(ep, rail_id);
+		rail_stats_post(ep_rail, &ep_rail->stats.bytes_read, xfer_info->msg_size, rc);
+
+		if (rc != 0) {
+			if (rc != -FI_EAGAIN) {
+				NCCL_OFI_WARN("fi_read of pulled segment failed; RC: %zd, Error: %s",
+					      rc, fi_strerror(-rc));
+			}
+			break;
+		}
+
+		nccl_net_ofi_scheduler_xfer_posted(rdma_endpoint_get_device(ep)->scheduler, xfer_info);
+		recv_segms_data->xferred_rail_id++;
+	}
+
+	return (int)rc;
+}
+
 /*
  * Progress a request associated with recv
  *
@@ -1805,10 +2729,12 @@ static int receive_progress(nccl_net_ofi_rdma_req_t *req, bool add_to_pending)
 		case NCCL_OFI_RDMA_READ: // Post RMA read
 			rc = post_rma_read(req);
 			break;
+		case NCCL_OFI_RDMA_RECV_SEGMS: // Post reads of pull rendezvous
+			rc = post_pull_reads(req);
+			break;
 		case NCCL_OFI_RDMA_WRITE:
 		case NCCL_OFI_RDMA_RECV:
 		case NCCL_OFI_RDMA_SEND:
-		case NCCL_OFI_RDMA_RECV_SEGMS:
 		case NCCL_OFI_RDMA_BOUNCE:
 		case NCCL_OFI_RDMA_SEND_CONN:
 		case NCCL_OFI_RDMA_RECV_CONN:
@@ -1853,11 +2779,18 @@ static int process_pending_reqs(nccl_net_ofi_rdma_ep_t *ep)
 	nccl_ofi_deque_elem_t *deque_elem;
 	nccl_ofi_deque_t *pending_reqs_queue = ep->pending_reqs_queue;
 
+	nccl_ofi_stats_max(&ep->pending_max_depth, nccl_ofi_deque_size(pending_reqs_queue));
+
+	/* Another thread is retrying the pending requests */
+	if (!nccl_ofi_deque_consumer_begin(pending_reqs_queue)) {
+		return 0;
+	}
+
 	while (true) {
 		rc = nccl_ofi_deque_remove_front(pending_reqs_queue, &deque_elem);
 		if (OFI_UNLIKELY(rc != 0)) {
 			NCCL_OFI_WARN("Failed to nccl_ofi_deque_remove_front: %d", rc);
-			return rc;
+			break;
 		}
 
 		if (deque_elem == NULL) {
@@ -1876,10 +2809,10 @@ static int process_pending_reqs(nccl_net_ofi_rdma_ep_t *ep)
 			case NCCL_OFI_RDMA_EAGER_COPY:
 			case NCCL_OFI_RDMA_SEND_CTRL:
 			case NCCL_OFI_RDMA_FLUSH:
+			case NCCL_OFI_RDMA_RECV_SEGMS:
 				rc = receive_progress(req, false);
 				break;
 			case NCCL_OFI_RDMA_RECV:
-			case NCCL_OFI_RDMA_RECV_SEGMS:
 			case NCCL_OFI_RDMA_SEND_CONN:
 			case NCCL_OFI_RDMA_SEND_CLOSE:
 			case NCCL_OFI_RDMA_RECV_CONN:
@@ -1888,7 +2821,8 @@ static int process_pending_reqs(nccl_net_ofi_rdma_ep_t *ep)
 			case NCCL_OFI_RDMA_INVALID_TYPE:
 			default:
 				NCCL_OFI_WARN("Unexpected type: %d", req->type);
-				return -EINVAL;
+				rc = -EINVAL;
+				goto exit;
 		}
 
 		if ((rc != 0) && (rc != -FI_EAGAIN)) {
@@ -1899,25 +2833,49 @@ static int process_pending_reqs(nccl_net_ofi_rdma_ep_t *ep)
 			rc = nccl_ofi_deque_insert_front(pending_reqs_queue, &req->pending_reqs_elem);
 			if (rc != 0) {
 				NCCL_OFI_WARN("Failed to insert_front pending request");
-				return rc;
 			}
 			break;
 		}
 		NCCL_OFI_TRACE_PENDING_REMOVE(req);
 	}
+
+ exit:
+	nccl_ofi_deque_consumer_end(pending_reqs_queue);
 	return rc;
 }
 
-static int ofi_process_cq_rail(nccl_net_ofi_rdma_ep_t *ep, nccl_net_ofi_ep_rail_t *rail)
+/*
+ * @brief	Process completion entries of the completion queue of a rail
+ *
+ * The number of entries read per fi_cq_read() call doubles while the
+ * completion queue returns full batches and halves when the queue is
+ * found empty. At most `cq_poll_budget' completions are processed per
+ * call.
+ *
+ * @param	num_processed
+ *		Incremented by the number of processed completions
+ */
+static int ofi_process_cq_rail(nccl_net_ofi_rdma_ep_t *ep, nccl_net_ofi_ep_rail_t *rail,
+			       uint64_t *num_processed)
 {
-	struct fi_cq_data_entry cqe_buffers[cq_read_count];
+	struct fi_cq_data_entry cqe_buffers[cq_read_count_max];
 	ssize_t rc = 0;
 	int ret = 0;
+	uint64_t num_completions = 0;
+	/* Several threads may progress the endpoint; a lost update of
+	 * the batch size is harmless */
+	size_t batch = __atomic_load_n(&rail->cq_read_batch, __ATOMIC_RELAXED);
 
-	while (true) {
+	while (num_completions < cq_poll_budget) {
 		/* Receive completions for the given endpoint */
-		rc = fi_cq_read(rail->cq, cqe_buffers, cq_read_count);
+		rc = fi_cq_read(rail->cq, cqe_buffers,
+				NCCL_OFI_MIN(batch, cq_poll_budget - num_completions));
 		if (rc > 0) {
+			nccl_ofi_stats_hist_add(&rail->stats.cq_read, rc);
+			if ((size_t)rc == batch) {
+				batch = NCCL_OFI_MIN(batch * 2, cq_read_count_max);
+			}
+			num_completions += rc;
 			ret = process_completions(cqe_buffers, rc, rdma_endpoint_get_device(ep), rail->rail_id);
 			if (OFI_UNLIKELY(ret != 0))
 				goto exit;
@@ -1936,6 +2894,9 @@ static int ofi_process_cq_rail(nccl_net_ofi_rdma_ep_t *ep, nccl_net_ofi_ep_rail_
 			}
 		} else if (rc == -FI_EAGAIN) {
 			/* No completions to process */
+			if (num_completions == 0) {
+				batch = NCCL_OFI_MAX(batch / 2, cq_read_count);
+			}
 			break;
 		} else {
 			NCCL_OFI_WARN("Unable to retrieve completion queue entries. RC: %zd, ERROR: %s",
@@ -1945,25 +2906,36 @@ static int ofi_process_cq_rail(nccl_net_ofi_rdma_ep_t *ep, nccl_net_ofi_ep_rail_
 		}
 	}
 
+	if (num_completions >= cq_poll_budget) {
+		nccl_ofi_stats_add(&rail->stats.cq_budget_exhausted, 1);
+	}
+
 exit:
+	__atomic_store_n(&rail->cq_read_batch, batch, __ATOMIC_RELAXED);
+	nccl_ofi_stats_hist_add(&rail->stats.cq_batch, num_completions);
+	*num_processed += num_completions;
 	return ret;
 }
 
 /*
- * @brief	Process completion entries for the given completion queue.
- *		This also updates several request fileds like size, status, etc
+ * @brief	Process completion entries for the completion queues of
+ *		all rails and retry pending requests
  *
+ * @param	num_processed
+ *		Incremented by the number of processed completions
  * @return	0, on success
  *		error, on others
  */
-static int ofi_process_cq(nccl_net_ofi_rdma_ep_t *ep)
+static int ofi_process_cq_rails(nccl_net_ofi_rdma_ep_t *ep, uint64_t *num_processed)
 {
 	int ret;
 
+	nccl_ofi_stats_poll();
+
 	for (int rail_id = 0; rail_id != ep->num_rails; ++rail_id) {
 		nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_rail(ep, rail_id);
 
-		ret = ofi_process_cq_rail(ep, rail);
+		ret = ofi_process_cq_rail(ep, rail, num_processed);
 		if (ret != 0) {
 			goto exit;
 		}
@@ -1979,6 +2951,113 @@ static int ofi_process_cq(nccl_net_ofi_rdma_ep_t *ep)
 	return ret;
 }
 
+/*
+ * @brief	Process completion entries for the given completion queue.
+ *		This also updates several request fileds like size, status, etc
+ *
+ * If the endpoint runs a progress thread, completions are only
+ * processed by the progress thread, and this function reports errors
+ * the progress thread encountered.
+ *
+ * @return	0, on success
+ *		error, on others
+ */
+static int ofi_process_cq(nccl_net_ofi_rdma_ep_t *ep)
+{
+	uint64_t num_processed = 0;
+
+	if (ep->progress_thread_running) {
+		return __atomic_load_n(&ep->progress_thread_error, __ATOMIC_ACQUIRE);
+	}
+
+	return ofi_process_cq_rails(ep, &num_processed);
+}
+
+/*
+ * @brief	Main function of the endpoint progress thread
+ *
+ * Polls the endpoint until asked to stop. After
+ * OFI_NCCL_PROGRESS_THREAD_SPIN_COUNT consecutive polls without
+ * completions or pending requests, the thread sleeps
+ * OFI_NCCL_PROGRESS_THREAD_SLEEP_US between polls.
+ */
+static void *progress_thread_main(void *arg)
+{
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)arg;
+	nccl_net_ofi_rdma_device_t *device = rdma_endpoint_get_device(ep);
+	uint64_t spin_count = ofi_nccl_progress_thread_spin_count();
+	uint64_t sleep_us = ofi_nccl_progress_thread_sleep_us();
+	uint64_t idle_polls = 0;
+	int ret;
+
+	if (CPU_COUNT(&device->progress_cpuset) != 0) {
+		ret = pthread_setaffinity_np(pthread_self(), sizeof(device->progress_cpuset),
+					     &device->progress_cpuset);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Unable to pin progress thread of endpoint %p: %s",
+				      ep, strerror(ret));
+		}
+	}
+
+	while (!__atomic_load_n(&ep->progress_thread_stop, __ATOMIC_ACQUIRE)) {
+		uint64_t num_processed = 0;
+
+		ret = ofi_process_cq_rails(ep, &num_processed);
+		if (OFI_UNLIKELY(ret != 0)) {
+			NCCL_OFI_WARN("Progress thread of endpoint %p failed: %d", ep, ret);
+			__atomic_store_n(&ep->progress_thread_error, ret, __ATOMIC_RELEASE);
+			break;
+		}
+
+		if (num_processed != 0 || !nccl_ofi_deque_isempty(ep->pending_reqs_queue)) {
+			idle_polls = 0;
+		} else if (sleep_us != 0 && ++idle_polls > spin_count) {
+			usleep(sleep_us);
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * @brief	Start the progress thread of the endpoint, if enabled
+ */
+static int progress_thread_start(nccl_net_ofi_rdma_ep_t *ep)
+{
+	int ret;
+
+	if (!ofi_nccl_progress_thread()) {
+		return 0;
+	}
+
+	ep->progress_thread_stop = 0;
+	ep->progress_thread_error = 0;
+	ret = pthread_create(&ep->progress_thread, NULL, progress_thread_main, ep);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Unable to create progress thread: %s", strerror(ret));
+		return -ret;
+	}
+	ep->progress_thread_running = true;
+
+	NCCL_OFI_TRACE(NCCL_NET, "Started progress thread of endpoint %p", ep);
+
+	return 0;
+}
+
+/*
+ * @brief	Stop the progress thread of the endpoint, if running
+ */
+static void progress_thread_stop(nccl_net_ofi_rdma_ep_t *ep)
+{
+	if (!ep->progress_thread_running) {
+		return;
+	}
+
+	__atomic_store_n(&ep->progress_thread_stop, 1, __ATOMIC_RELEASE);
+	pthread_join(ep->progress_thread, NULL);
+	ep->progress_thread_running = false;
+}
+
 /*
  * @brief	Zero out rdma request
  */
@@ -2081,6 +3160,11 @@ static inline int free_send_req(nccl_net_ofi_rdma_req_t *req,
 		send_data->schedule = NULL;
 	}
 
+	if (send_data->rts_fl_item) {
+		nccl_ofi_freelist_entry_free(s_comm->ctrl_buff_fl, send_data->rts_fl_item);
+		send_data->rts_fl_item = NULL;
+	}
+
 	return free_base_req(&s_comm->num_inflight_reqs, s_comm->nccl_ofi_reqs_fl,
 			req, dec_inflight_reqs);
 }
@@ -2128,6 +3212,34 @@ static inline int free_recv_req(nccl_net_ofi_rdma_req_t *req,
 			     req, dec_inflight_reqs);
 }
 
+/*
+ * @brief	Free grouped receive request and its receive subrequests
+ *		not freed yet
+ */
+static inline int free_recv_group_req(nccl_net_ofi_rdma_req_t *req,
+				      bool dec_inflight_reqs)
+{
+	int ret = 0;
+	nccl_net_ofi_rdma_recv_comm_t *r_comm =
+		(nccl_net_ofi_rdma_recv_comm_t *)req->comm;
+	rdma_req_recv_group_data_t *group_data = get_recv_group_data(req);
+
+	for (int i = 0; i < group_data->num_recvs; i++) {
+		nccl_net_ofi_rdma_req_t *recv_req = group_data->recv_reqs[i];
+		if (recv_req) {
+			ret = recv_req->free(recv_req, dec_inflight_reqs);
+			if (ret) {
+				NCCL_OFI_WARN("Failed to free receive request");
+				return ret;
+			}
+			group_data->recv_reqs[i] = NULL;
+		}
+	}
+
+	/* Only the receive subrequests are accounted as inflight */
+	return free_base_req(NULL, r_comm->nccl_ofi_reqs_fl, req, false);
+}
+
 /*
  * @brief	Free receive segments request
  */
@@ -2137,6 +3249,13 @@ static inline int free_recv_segms_req(nccl_net_ofi_rdma_req_t *req,
 	assert(req->type == NCCL_OFI_RDMA_RECV_SEGMS);
 	nccl_net_ofi_rdma_recv_comm_t *r_comm =
 		(nccl_net_ofi_rdma_recv_comm_t *)req->comm;
+	rdma_req_recv_segms_data_t *recv_segms_data = get_recv_segms_data(req);
+
+	if (recv_segms_data->schedule) {
+		nccl_net_ofi_rdma_device_t *device = rdma_req_get_device(req);
+		nccl_net_ofi_release_schedule(device->scheduler, recv_segms_data->schedule);
+		recv_segms_data->schedule = NULL;
+	}
 
 	return free_base_req(&r_comm->num_inflight_reqs, r_comm->nccl_ofi_reqs_fl,
 			     req, dec_inflight_reqs);
@@ -2164,6 +3283,13 @@ static inline int free_send_ctrl_req(nccl_net_ofi_rdma_req_t *req,
 		send_ctrl_data->ctrl_fl_item = NULL;
 	}
 
+	if (send_ctrl_data->rkey_slot >= 0) {
+		nccl_net_ofi_mutex_lock(&r_comm->rkey_cache_lock);
+		r_comm->rkey_cache[send_ctrl_data->rkey_slot].refcnt--;
+		nccl_net_ofi_mutex_unlock(&r_comm->rkey_cache_lock);
+		send_ctrl_data->rkey_slot = -1;
+	}
+
 	return free_base_req(&r_comm->num_inflight_reqs, r_comm->nccl_ofi_reqs_fl,
 			     req, dec_inflight_reqs);
 }
@@ -2240,9 +3366,9 @@ static inline int free_bounce_req(nccl_net_ofi_rdma_req_t *req,
 	assert(!dec_inflight_reqs);
 	rdma_req_bounce_data_t *bounce_data = get_bounce_data(req);
 	nccl_net_ofi_rdma_ep_t *ep = bounce_data->ep;
-	/* Free buffer */
-	if (bounce_data->bounce_fl_item) {
-		nccl_ofi_freelist_entry_free(ep->bounce_buff_fl, bounce_data->bounce_fl_item);
+	/* Free buffer, unless owned by the slab of this message */
+	if (bounce_data->bounce_fl_item && bounce_data->slab_req == NULL) {
+		nccl_ofi_freelist_entry_free(bounce_data->rail->bounce_buff_fl, bounce_data->bounce_fl_item);
 	}
 	return free_base_req(NULL, ep->bounce_buff_reqs_fl, req, false);
 }
@@ -2262,7 +3388,7 @@ static inline nccl_net_ofi_rdma_req_t *alloc_bounce_req(nccl_net_ofi_rdma_ep_t *
 
 	nccl_net_ofi_rdma_bounce_fl_item_t *bounce_fl_item =
 		(nccl_net_ofi_rdma_bounce_fl_item_t *)nccl_ofi_freelist_entry_alloc(
-			ep->bounce_buff_fl);
+			rail->bounce_buff_fl);
 	if (!bounce_fl_item) {
 		NCCL_OFI_WARN("Failed to allocate bounce_fl_item");
 		req->free(req, false);
@@ -2271,12 +3397,99 @@ static inline nccl_net_ofi_rdma_req_t *alloc_bounce_req(nccl_net_ofi_rdma_ep_t *
 	assert(NCCL_OFI_IS_PTR_ALIGNED(&bounce_fl_item->bounce_msg, BOUNCE_BUFFER_ALIGNMENT));
 
 	bounce_data->bounce_fl_item = bounce_fl_item;
-	bounce_data->buff_len = ep->bounce_buff_size;
+	bounce_data->msg = &bounce_fl_item->bounce_msg;
+	bounce_data->buff_len = rail->bounce_buff_size;
 	bounce_data->rail = rail;
 	bounce_data->ep = ep;
+	bounce_data->slab_req = NULL;
+	bounce_data->slab_refcnt = 0;
+	bounce_data->slab_consumed = false;
 	return req;
 }
 
+/*
+ * @brief	Allocate a bounce request for a message received into a
+ *		multi-receive slab at `msg'
+ */
+static inline nccl_net_ofi_rdma_req_t *alloc_slab_msg_req(nccl_net_ofi_rdma_req_t *slab_req,
+							  void *msg)
+{
+	rdma_req_bounce_data_t *slab_data = get_bounce_data(slab_req);
+	nccl_net_ofi_rdma_ep_t *ep = slab_data->ep;
+	nccl_net_ofi_rdma_req_t *req = allocate_req(ep->bounce_buff_reqs_fl);
+	if (!req) return NULL;
+
+	req->comm = NULL;
+	req->type = NCCL_OFI_RDMA_BOUNCE;
+	req->dev_id = slab_req->dev_id;
+	req->free = free_bounce_req;
+
+	rdma_req_bounce_data_t *bounce_data = get_bounce_data(req);
+	/* The slab's freelist item provides the memory registration */
+	bounce_data->bounce_fl_item = slab_data->bounce_fl_item;
+	bounce_data->msg = msg;
+	bounce_data->buff_len = 0;
+	bounce_data->rail = slab_data->rail;
+	bounce_data->ep = ep;
+	bounce_data->slab_req = slab_req;
+	bounce_data->slab_refcnt = 0;
+	bounce_data->slab_consumed = false;
+	return req;
+}
+
+/**
+ * @brief	Handle a completion of a multi-receive slab. The completion
+ *		reports a message received into the slab, the release of
+ *		the slab by the provider, or both.
+ */
+static int handle_slab_recv(nccl_net_ofi_rdma_device_t *device, int rail_id,
+			    struct fi_cq_data_entry *cq_entry,
+			    nccl_net_ofi_rdma_req_t *slab_req, bool eager)
+{
+	int ret = 0;
+	rdma_req_bounce_data_t *slab_data = get_bounce_data(slab_req);
+	nccl_net_ofi_ep_rail_t *rail = slab_data->rail;
+	/* Eager messages may be empty, other messages are not */
+	bool has_msg = (cq_entry->len > 0) || eager;
+	bool consumed = (cq_entry->flags & FI_MULTI_RECV) != 0;
+	nccl_net_ofi_rdma_req_t *msg_req = NULL;
+
+	if (has_msg) {
+		msg_req = alloc_slab_msg_req(slab_req, cq_entry->buf);
+		if (OFI_UNLIKELY(msg_req == NULL)) {
+			NCCL_OFI_WARN("Failed to allocate slab message req");
+			return -ENOMEM;
+		}
+	}
+
+	/* Reference the slab for the message, and for the duration of
+	   this function such that releasing the message right away
+	   does not repost the slab before it is marked consumed */
+	nccl_net_ofi_mutex_lock(&rail->bounce_mutex);
+	slab_data->slab_refcnt += has_msg ? 2 : 1;
+	if (consumed) {
+		slab_data->slab_consumed = true;
+	}
+	nccl_net_ofi_mutex_unlock(&rail->bounce_mutex);
+
+	if (consumed) {
+		/* The slab is no longer posted */
+		ret = decrease_bounce_buff_cnt(slab_data->ep, rail);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+	}
+
+	if (has_msg) {
+		ret = handle_bounce_recv(device, rail_id, cq_entry, msg_req, eager);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+	}
+
+	return put_slab(slab_req);
+}
+
 static inline int handle_bounce_eagain(nccl_net_ofi_rdma_ep_t *ep,
 				       nccl_net_ofi_ep_rail_t *rail,
 				       nccl_net_ofi_rdma_req_t *req, size_t num_buffs_failed)
@@ -2530,26 +3743,255 @@ static int finish_connect(nccl_net_ofi_rdma_send_comm_t *s_comm)
 		return -EINVAL;
 	}
 
-	/* Set remote comm ID to remote recv comm ID */
-	s_comm->remote_comm_id = conn_resp->local_comm_id;
+	/* Set remote comm ID to remote recv comm ID */
+	s_comm->remote_comm_id = conn_resp->local_comm_id;
+
+	/* Initialize rails `1...num_rails-1' */
+	ret = init_send_comm_rails(s_comm, ep, dev_id,
+				   conn_resp->ep_names,
+				   conn_resp->num_rails,
+				   conn_resp->control_ep_names,
+				   conn_resp->num_control_rails);
+	if (ret != 0) {
+		return ret;
+	}
+
+	s_comm->conn_resp_req->free(s_comm->conn_resp_req, false);
+	s_comm->conn_resp_req = NULL;
+
+	return ret;
+}
+
+#define __compiler_barrier() do { asm volatile ("" : : : "memory"); } while(0)
+
+/*
+ * @brief	Send the batch of control messages of receive communicator
+ *
+ * The messages of the batch are copied behind the message of its
+ * first request, which is posted. Must be called with the
+ * ctrl_batch_lock of the communicator held.
+ */
+static int flush_ctrl_batch(nccl_net_ofi_rdma_recv_comm_t *r_comm)
+{
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+	nccl_net_ofi_rdma_req_t *req = r_comm->ctrl_batch_head;
+	rdma_req_send_ctrl_data_t *send_ctrl_data = get_send_ctrl_data(req);
+	size_t stride = nccl_net_ofi_rdma_ctrl_batch_stride(ep->num_rails, ep->use_long_rkeys);
+	char *batch = (char *)&send_ctrl_data->ctrl_fl_item->ctrl_msg;
+	int count = 1;
+
+	for (nccl_net_ofi_rdma_req_t *next = send_ctrl_data->batch_next; next != NULL;
+	     next = get_send_ctrl_data(next)->batch_next) {
+		nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg = &get_send_ctrl_data(next)->ctrl_fl_item->ctrl_msg;
+		memcpy(batch + count * stride, ctrl_msg,
+		       nccl_net_ofi_rdma_ctrl_msg_len(ctrl_msg, ep->num_rails, ep->use_long_rkeys));
+		count++;
+	}
+	assert(count == r_comm->ctrl_batch_count);
+	send_ctrl_data->batch_count = count;
+	if (count > 1) {
+		nccl_ofi_stats_add(&r_comm->stats.ctrl_batched, count);
+	}
+
+	r_comm->ctrl_batch_head = NULL;
+	r_comm->ctrl_batch_tail = NULL;
+	r_comm->ctrl_batch_count = 0;
+
+	return receive_progress(req, true);
+}
+
+/*
+ * @brief	Add a send ctrl request to the batch of control messages
+ *		of receive communicator, sending the batch once full
+ */
+static int batch_send_ctrl_req(nccl_net_ofi_rdma_recv_comm_t *r_comm,
+			       nccl_net_ofi_rdma_req_t *req)
+{
+	int ret = 0;
+
+	nccl_net_ofi_mutex_lock(&r_comm->ctrl_batch_lock);
+
+	if (r_comm->ctrl_batch_head == NULL) {
+		r_comm->ctrl_batch_head = req;
+		r_comm->ctrl_batch_start_ns = nccl_ofi_stats_now_ns();
+	} else {
+		get_send_ctrl_data(r_comm->ctrl_batch_tail)->batch_next = req;
+	}
+	r_comm->ctrl_batch_tail = req;
+	r_comm->ctrl_batch_count++;
+
+	if (r_comm->ctrl_batch_count == ctrl_batch_max) {
+		ret = flush_ctrl_batch(r_comm);
+	}
+
+	nccl_net_ofi_mutex_unlock(&r_comm->ctrl_batch_lock);
+
+	return ret;
+}
+
+/*
+ * @brief	Send the batch of control messages of receive communicator
+ *		if it waited for at least the batch timeout
+ */
+static int flush_ctrl_batch_if_due(nccl_net_ofi_rdma_recv_comm_t *r_comm)
+{
+	int ret = 0;
+
+	nccl_net_ofi_mutex_lock(&r_comm->ctrl_batch_lock);
+
+	if (r_comm->ctrl_batch_head != NULL &&
+	    (ctrl_batch_timeout_ns == 0 ||
+	     nccl_ofi_stats_now_ns() - r_comm->ctrl_batch_start_ns >= ctrl_batch_timeout_ns)) {
+		ret = flush_ctrl_batch(r_comm);
+	}
+
+	nccl_net_ofi_mutex_unlock(&r_comm->ctrl_batch_lock);
+
+	return ret;
+}
+
+/*
+ * @brief	Send the control messages of the receive subrequests of a
+ *		grouped receive as one NCCL_OFI_RDMA_MSG_CTRL_GROUP message
+ *
+ * The message is built in the control buffer of the first
+ * subrequest, which is posted.
+ */
+static int send_ctrl_group(nccl_net_ofi_rdma_recv_comm_t *r_comm,
+			   nccl_net_ofi_rdma_req_t *group_req, int *tags)
+{
+	int ret = 0;
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+	rdma_req_recv_group_data_t *group_data = get_recv_group_data(group_req);
+	int n = group_data->num_recvs;
+	nccl_net_ofi_rdma_req_t *req = get_recv_data(group_data->recv_reqs[0])->send_ctrl_req;
+	rdma_req_send_ctrl_data_t *send_ctrl_data = get_send_ctrl_data(req);
+	size_t stride = nccl_net_ofi_rdma_ctrl_batch_stride(ep->num_rails, ep->use_long_rkeys);
+	char *msg = (char *)&send_ctrl_data->ctrl_fl_item->ctrl_msg;
+	nccl_net_ofi_rdma_ctrl_group_msg_t group_msg;
+
+	/* Send batched control messages first */
+	if (ctrl_batch_max > 1) {
+		nccl_net_ofi_mutex_lock(&r_comm->ctrl_batch_lock);
+		if (r_comm->ctrl_batch_head != NULL) {
+			ret = flush_ctrl_batch(r_comm);
+		}
+		nccl_net_ofi_mutex_unlock(&r_comm->ctrl_batch_lock);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+	}
+
+	memset(&group_msg, 0, sizeof(group_msg));
+	group_msg.type = NCCL_OFI_RDMA_MSG_CTRL_GROUP;
+	group_msg.msg_seq_num = group_req->msg_seq_num;
+	group_msg.remote_comm_id = r_comm->remote_comm_id;
+	group_msg.num_recvs = n;
+
+	/* The message of the first subrequest moves behind the header */
+	memmove(msg + sizeof(group_msg), msg,
+		nccl_net_ofi_rdma_ctrl_msg_len(&send_ctrl_data->ctrl_fl_item->ctrl_msg,
+					       ep->num_rails, ep->use_long_rkeys));
+	group_msg.tags[0] = tags[0];
+
+	nccl_net_ofi_rdma_req_t *prev = req;
+	for (int i = 1; i < n; i++) {
+		nccl_net_ofi_rdma_req_t *next = get_recv_data(group_data->recv_reqs[i])->send_ctrl_req;
+		nccl_net_ofi_rdma_ctrl_msg_t *ctrl_msg = &get_send_ctrl_data(next)->ctrl_fl_item->ctrl_msg;
+
+		memcpy(msg + sizeof(group_msg) + i * stride, ctrl_msg,
+		       nccl_net_ofi_rdma_ctrl_msg_len(ctrl_msg, ep->num_rails, ep->use_long_rkeys));
+		group_msg.tags[i] = tags[i];
+		get_send_ctrl_data(prev)->batch_next = next;
+		prev = next;
+	}
+	memcpy(msg, &group_msg, sizeof(group_msg));
+
+	send_ctrl_data->batch_count = n;
+	send_ctrl_data->group = true;
+	nccl_ofi_stats_add(&r_comm->stats.ctrl_batched, n);
+
+	nccl_net_ofi_mutex_lock(&r_comm->ctrl_counter_lock);
+	r_comm->n_ctrl_sent += n;
+	nccl_net_ofi_mutex_unlock(&r_comm->ctrl_counter_lock);
+
+	return receive_progress(req, true);
+}
+
+/*
+ * @brief	Test grouped receive request, which is done once all its
+ *		receive subrequests completed
+ *
+ * @param	sizes
+ *		Array of the received size of each buffer, or NULL
+ */
+static int test_recv_group(nccl_net_ofi_rdma_ep_t *ep, nccl_net_ofi_rdma_req_t *req,
+			   int *done, int *sizes)
+{
+	int ret = 0;
+	nccl_net_ofi_rdma_recv_comm_t *r_comm = (nccl_net_ofi_rdma_recv_comm_t *)req->comm;
+	rdma_req_recv_group_data_t *group_data = get_recv_group_data(req);
+	int num_completed = 0;
+
+	for (int pass = 0; pass < 2; pass++) {
+		num_completed = 0;
+		for (int i = 0; i < group_data->num_recvs; i++) {
+			nccl_net_ofi_rdma_req_state_t state = group_data->recv_reqs[i]->state;
+			if (OFI_UNLIKELY(state == NCCL_OFI_RDMA_REQ_ERROR)) {
+				return -EINVAL;
+			} else if (state == NCCL_OFI_RDMA_REQ_COMPLETED) {
+				num_completed++;
+			}
+		}
+
+		/* Process more completions unless all receives are
+		 * completed */
+		if (pass > 0 || num_completed == group_data->num_recvs) {
+			break;
+		}
+		ret = ofi_process_cq(ep);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+	}
+
+	if (num_completed < group_data->num_recvs) {
+		return 0;
+	}
+
+	for (int i = 0; i < group_data->num_recvs; i++) {
+		nccl_net_ofi_rdma_req_t *recv_req = group_data->recv_reqs[i];
+		size_t req_size;
 
-	/* Initialize rails `1...num_rails-1' */
-	ret = init_send_comm_rails(s_comm, ep, dev_id,
-				   conn_resp->ep_names,
-				   conn_resp->num_rails,
-				   conn_resp->control_ep_names,
-				   conn_resp->num_control_rails);
-	if (ret != 0) {
-		return ret;
-	}
+		nccl_net_ofi_mutex_lock(&recv_req->req_lock);
+		req_size = recv_req->size;
+		nccl_net_ofi_mutex_unlock(&recv_req->req_lock);
+		if (sizes) {
+			sizes[i] = (int)req_size;
+		}
 
-	s_comm->conn_resp_req->free(s_comm->conn_resp_req, false);
-	s_comm->conn_resp_req = NULL;
+		nccl_ofi_msgbuff_status_t stat;
+		nccl_ofi_msgbuff_result_t mb_res =
+			nccl_ofi_msgbuff_complete(r_comm->msgbuff, recv_req->msg_seq_num, &stat);
+		if (OFI_UNLIKELY(mb_res != NCCL_OFI_MSGBUFF_SUCCESS)) {
+			NCCL_OFI_WARN("Invalid result of msgbuff_complete for msg %hu", recv_req->msg_seq_num);
+			return -EINVAL;
+		}
 
-	return ret;
-}
+		nccl_ofi_stats_add(&r_comm->stats.bytes, req_size);
+		nccl_ofi_stats_hist_add(&r_comm->stats.latency, nccl_ofi_stats_now_ns() - recv_req->start_ns);
+		NCCL_OFI_TRACE_RECV_END(recv_req);
 
-#define __compiler_barrier() do { asm volatile ("" : : : "memory"); } while(0)
+		ret = recv_req->free(recv_req, true);
+		if (OFI_UNLIKELY(ret != 0)) {
+			return ret;
+		}
+		group_data->recv_reqs[i] = NULL;
+	}
+
+	*done = 1;
+	return req->free(req, true);
+}
 
 static int test(nccl_net_ofi_req_t *base_req, int *done, int *size)
 {
@@ -2560,6 +4002,7 @@ static int test(nccl_net_ofi_req_t *base_req, int *done, int *size)
 	       req->type == NCCL_OFI_RDMA_READ ||
 	       req->type == NCCL_OFI_RDMA_SEND ||
 	       req->type == NCCL_OFI_RDMA_RECV ||
+	       req->type == NCCL_OFI_RDMA_RECV_GROUP ||
 	       req->type == NCCL_OFI_RDMA_FLUSH);
 
 	/* Retrieve and validate comm */
@@ -2570,6 +4013,20 @@ static int test(nccl_net_ofi_req_t *base_req, int *done, int *size)
 	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)base_comm->ep;
 	assert(ep != NULL);
 
+	if (req->type == NCCL_OFI_RDMA_RECV_GROUP) {
+		/* NCCL passes an array of the sizes of the grouped
+		 * receive */
+		ret = test_recv_group(ep, req, done, size);
+		goto exit;
+	}
+
+	/* Send the batched control messages the receive may wait for */
+	if (req->type == NCCL_OFI_RDMA_RECV && ctrl_batch_max > 1) {
+		ret = flush_ctrl_batch_if_due((nccl_net_ofi_rdma_recv_comm_t *)base_comm);
+		if (OFI_UNLIKELY(ret != 0))
+			goto exit;
+	}
+
 	/* Process more completions unless the current request is
 	 * completed */
 	if (req->state != NCCL_OFI_RDMA_REQ_COMPLETED
@@ -2597,10 +4054,13 @@ static int test(nccl_net_ofi_req_t *base_req, int *done, int *size)
 		if (req->type == NCCL_OFI_RDMA_SEND || req->type == NCCL_OFI_RDMA_RECV) {
 			/* Mark as complete in message buffer */
 			nccl_ofi_msgbuff_t *msgbuff;
+			nccl_net_ofi_rdma_comm_stats_t *stats;
 			if (req->type == NCCL_OFI_RDMA_SEND) {
 				msgbuff = ((nccl_net_ofi_rdma_send_comm_t *)base_comm)->msgbuff;
+				stats = &((nccl_net_ofi_rdma_send_comm_t *)base_comm)->stats;
 			} else if (req->type ==  NCCL_OFI_RDMA_RECV) {
 				msgbuff = ((nccl_net_ofi_rdma_recv_comm_t *)base_comm)->msgbuff;
+				stats = &((nccl_net_ofi_rdma_recv_comm_t *)base_comm)->stats;
 			} else {
 				NCCL_OFI_WARN("Unexpected request type: %d", req->type);
 				ret = -EINVAL;
@@ -2614,6 +4074,9 @@ static int test(nccl_net_ofi_req_t *base_req, int *done, int *size)
 				ret = -EINVAL;
 				goto exit;
 			}
+
+			nccl_ofi_stats_add(&stats->bytes, req_size);
+			nccl_ofi_stats_hist_add(&stats->latency, nccl_ofi_stats_now_ns() - req->start_ns);
 		}
 
 		if (req->type == NCCL_OFI_RDMA_SEND) {
@@ -2879,6 +4342,7 @@ static inline int reg_mr_on_device(nccl_net_ofi_rdma_ep_t *ep,
 	}
 
 	/* Register memory on each rail */
+	ret_handle->type = type;
 	ret_handle->num_rails = num_rails;
 	for (int rail_id = 0; rail_id != num_rails; ++rail_id) {
 		nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_rail(ep, rail_id);
@@ -2952,6 +4416,14 @@ static int reg_mr_ep(nccl_net_ofi_rdma_ep_t *ep,
 
 	nccl_ofi_idpool_t *key_pool = &device->base.mr_rkey_pool;
 	if (mr_cache) {
+		/* Cache hits do not need the MR cache lock */
+		ret_handle = (nccl_net_ofi_rdma_mr_handle_t *)
+			nccl_ofi_mr_cache_try_lookup_entry(mr_cache, ckey);
+		if (ret_handle) {
+			*mhandle = ret_handle;
+			return 0;
+		}
+
 		/*
 		 * MR cache is locked between lookup and insert, to be sure we
 		 * insert a missing entry
@@ -3148,6 +4620,71 @@ static int freelist_deregmr_host_fn(void *handle)
 	return 0;
 }
 
+/*
+ * @brief	Return the size of control buffers of communicators,
+ *		holding the control messages of receive communicators
+ *		and the RTS messages of send communicators
+ */
+static inline size_t comm_ctrl_buff_size(void)
+{
+	return NCCL_OFI_MAX(sizeof(nccl_net_ofi_rdma_ctrl_fl_item_t),
+			    offsetof(nccl_net_ofi_rdma_ctrl_fl_item_t, ctrl_msg) +
+			    ctrl_send_max_size());
+}
+
+/*
+ * @brief	Initialize the request free list of a communicator
+ *
+ * The free list is a quota of the shared free list of the endpoint,
+ * if any, or a free list of its own otherwise.
+ *
+ * @param	max_entry_count
+ *		Maximum number of requests in use
+ * @return	0, on success
+ *		non-zero, on error
+ */
+static int comm_reqs_fl_init(nccl_net_ofi_rdma_ep_t *ep, size_t max_entry_count,
+			     nccl_ofi_freelist_t **fl)
+{
+	if (ep->comm_reqs_fl) {
+		return nccl_ofi_freelist_init_quota(ep->comm_reqs_fl, max_entry_count, fl);
+	}
+
+	/* Grown by the first transfer of the communicator */
+	return nccl_ofi_freelist_init(sizeof(nccl_net_ofi_rdma_req_t), 0, 16,
+				      max_entry_count, NCCL_OFI_FREELIST_MODE_DEFAULT, fl);
+}
+
+/*
+ * @brief	Initialize the registered control buffer free list of a
+ *		communicator
+ *
+ * The free list is a quota of the shared free list of the endpoint,
+ * if any, or a free list of its own otherwise.
+ *
+ * @param	entry_size
+ *		Size of the control buffers of the communicator, at most
+ *		comm_ctrl_buff_size()
+ * @param	max_entry_count
+ *		Maximum number of control buffers in use
+ * @return	0, on success
+ *		non-zero, on error
+ */
+static int comm_ctrl_buff_fl_init(nccl_net_ofi_rdma_ep_t *ep, size_t entry_size,
+				  size_t max_entry_count, nccl_ofi_freelist_t **fl)
+{
+	assert(entry_size <= comm_ctrl_buff_size());
+
+	if (ep->comm_ctrl_buff_fl) {
+		return nccl_ofi_freelist_init_quota(ep->comm_ctrl_buff_fl, max_entry_count, fl);
+	}
+
+	return nccl_ofi_freelist_init_mr(entry_size, 0, 8, max_entry_count,
+					 freelist_regmr_host_fn, freelist_deregmr_host_fn,
+					 ep, 0, 1, false, rdma_endpoint_get_device(ep)->numa_node,
+					 NCCL_OFI_FREELIST_MODE_DEFAULT, fl);
+}
+
 static int dereg_mr_recv_comm(nccl_net_ofi_recv_comm_t *recv_comm,
 						nccl_net_ofi_mr_handle_t *mhandle)
 {
@@ -3160,6 +4697,17 @@ static int dereg_mr_recv_comm(nccl_net_ofi_recv_comm_t *recv_comm,
 	assert(device != NULL);
 
 	nccl_net_ofi_rdma_mr_handle_t *mr_handle = (nccl_net_ofi_rdma_mr_handle_t *)mhandle;
+
+	/* A later registration may reuse the handle with other keys */
+	nccl_net_ofi_rdma_recv_comm_t *r_comm = (nccl_net_ofi_rdma_recv_comm_t *)recv_comm;
+	nccl_net_ofi_mutex_lock(&r_comm->rkey_cache_lock);
+	for (int slot = 0; slot < r_comm->rkey_cache_size; slot++) {
+		if (r_comm->rkey_cache[slot].mr_handle == mr_handle) {
+			r_comm->rkey_cache[slot].mr_handle = NULL;
+		}
+	}
+	nccl_net_ofi_mutex_unlock(&r_comm->rkey_cache_lock);
+
 	return dereg_mr_ep(mr_handle, &device->base.mr_rkey_pool, device->base.mr_cache);
 }
 
@@ -3192,6 +4740,61 @@ cleanup:
 	return NULL;
 }
 
+/*
+ * @brief	Return the slot of the remote key cache of receive
+ *		communicator caching `mr_handle', caching it in an
+ *		unreferenced slot if needed, and reference the slot
+ *
+ * @param	ref
+ *		Set to the slot and generation of the registration
+ * @param	cached
+ *		Set if the registration was already cached
+ * @return	Slot, or -1 if all slots are referenced
+ */
+static int rkey_cache_acquire(nccl_net_ofi_rdma_recv_comm_t *r_comm,
+			      nccl_net_ofi_rdma_mr_handle_t *mr_handle,
+			      nccl_net_ofi_rdma_rkey_ref_t *ref, bool *cached)
+{
+	nccl_net_ofi_rdma_rkey_cache_entry_t *entry = NULL;
+	int ret = -1;
+
+	nccl_net_ofi_mutex_lock(&r_comm->rkey_cache_lock);
+
+	for (int slot = 0; slot < r_comm->rkey_cache_size; slot++) {
+		entry = &r_comm->rkey_cache[slot];
+		if (entry->mr_handle == mr_handle) {
+			entry->refcnt++;
+			*cached = true;
+			ret = slot;
+			goto out;
+		}
+	}
+
+	/* Evict slots in round-robin order. Referenced slots are
+	 * skipped, as the sender may still look them up. */
+	for (int i = 0; i < r_comm->rkey_cache_size; i++) {
+		int slot = (r_comm->rkey_cache_clock + i) % r_comm->rkey_cache_size;
+		entry = &r_comm->rkey_cache[slot];
+		if (entry->refcnt == 0) {
+			entry->mr_handle = mr_handle;
+			entry->gen = ++r_comm->rkey_cache_gen;
+			entry->refcnt = 1;
+			r_comm->rkey_cache_clock = (slot + 1) % r_comm->rkey_cache_size;
+			*cached = false;
+			ret = slot;
+			goto out;
+		}
+	}
+
+out:
+	if (ret >= 0) {
+		ref->slot = (uint32_t)ret;
+		ref->gen = entry->gen;
+	}
+	nccl_net_ofi_mutex_unlock(&r_comm->rkey_cache_lock);
+	return ret;
+}
+
 /**
  * @brief	Allocate a new control message that the receiver will
  *		send to the sender describing the recv buffer.
@@ -3241,6 +4844,10 @@ static inline int insert_send_ctrl_req(
 
 	send_ctrl_data->recv_req = recv_req;
 	send_ctrl_data->ctrl_fl_item = NULL;
+	send_ctrl_data->batch_next = NULL;
+	send_ctrl_data->batch_count = 1;
+	send_ctrl_data->group = false;
+	send_ctrl_data->rkey_slot = -1;
 
 	/*
 	 * Allocate RDMA control buffer which transfers the RDMA write buffer
@@ -3290,6 +4897,24 @@ static inline int insert_send_ctrl_req(
 		}
 	}
 
+	if (r_comm->rkey_cache_size > 0) {
+		bool cached = false;
+		nccl_net_ofi_rdma_rkey_ref_t ref;
+		int slot = rkey_cache_acquire(r_comm, buff_mr_handle, &ref, &cached);
+		if (slot >= 0) {
+			send_ctrl_data->rkey_slot = slot;
+			if (cached) {
+				ctrl_fl_item->ctrl_msg.type = NCCL_OFI_RDMA_MSG_CTRL_COMPACT;
+				ctrl_fl_item->ctrl_msg.rkey_ref = ref;
+				nccl_ofi_stats_add(&r_comm->stats.ctrl_compact, 1);
+			} else {
+				ctrl_fl_item->ctrl_msg.type = NCCL_OFI_RDMA_MSG_CTRL_CACHE;
+				*nccl_net_ofi_rdma_ctrl_msg_cache_ref(&ctrl_fl_item->ctrl_msg, ep->num_rails,
+								      ep->use_long_rkeys) = ref;
+			}
+		}
+	}
+
 	send_ctrl_data->ctrl_fl_item = ctrl_fl_item;
 
 	rdma_req_recv_data_t *recv_data = get_recv_data(recv_req);
@@ -3325,6 +4950,8 @@ static inline int insert_recv_segms_req(
 
 	rdma_req_recv_segms_data_t *recv_segms_data = get_recv_segms_data(recv_segms_req);
 	recv_segms_data->recv_req = recv_req;
+	recv_segms_data->pull = false;
+	recv_segms_data->schedule = NULL;
 
 	rdma_req_recv_data_t *recv_data = get_recv_data(recv_req);
 	recv_data->recv_segms_req = recv_segms_req;
@@ -3386,6 +5013,76 @@ static inline int allocate_rdma_recv_req(
 	return 0;
 }
 
+/**
+ * @brief	Set up the receive segments request of a receive request to
+ *		pull the data advertised by an RTS message, and release the
+ *		bounce buffer holding the RTS message
+ *
+ * The ctrl message of the receive request is turned into the PULL_DONE
+ * message, which is sent once all reads completed.
+ */
+static inline int prepare_pull_recv(nccl_net_ofi_rdma_recv_comm_t *r_comm,
+				    nccl_net_ofi_rdma_device_t *device,
+				    nccl_net_ofi_rdma_req_t *recv_req,
+				    nccl_net_ofi_rdma_req_t *bounce_req)
+{
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+	nccl_net_ofi_scheduler_t *scheduler = device->scheduler;
+	rdma_req_recv_data_t *recv_data = get_recv_data(recv_req);
+	nccl_net_ofi_rdma_req_t *recv_segms_req = recv_data->recv_segms_req;
+	rdma_req_recv_segms_data_t *recv_segms_data = get_recv_segms_data(recv_segms_req);
+	nccl_net_ofi_rdma_ctrl_msg_t *rts_msg =
+		get_bounce_ctrl_msg(get_bounce_data(bounce_req));
+	nccl_net_ofi_rdma_ctrl_msg_t *done_msg =
+		&get_send_ctrl_data(recv_data->send_ctrl_req)->ctrl_fl_item->ctrl_msg;
+
+	recv_segms_data->pull = true;
+	recv_segms_data->remote_buff = rts_msg->buff_addr;
+	for (int rail_id = 0; rail_id != ep->num_rails; ++rail_id) {
+		if (ep->use_long_rkeys) {
+			recv_segms_data->remote_mr_key[rail_id] = rts_msg->long_buff_mr_key[rail_id];
+		} else {
+			recv_segms_data->remote_mr_key[rail_id] = rts_msg->short_buff_mr_key[rail_id];
+		}
+	}
+
+	/* Read at most the size of the destination buffer */
+	recv_segms_data->pull_len = NCCL_OFI_MIN((size_t)rts_msg->buff_len, recv_data->dst_len);
+	recv_segms_data->xferred_rail_id = 0;
+	recv_segms_req->size = recv_segms_data->pull_len;
+
+	if (recv_segms_data->pull_len > 0) {
+		recv_segms_data->schedule = scheduler->get_schedule(scheduler, recv_segms_data->pull_len,
+								     device->num_rails);
+		if (OFI_UNLIKELY(recv_segms_data->schedule == NULL)) {
+			return -EINVAL;
+		}
+		recv_segms_data->xfer_start_ns = nccl_ofi_stats_now_ns();
+	}
+
+	/* The PULL_DONE message does not carry the keys of the receive
+	   buffer, so the sender does not cache them. Release the remote
+	   key cache slot, and forget the registration if it was only
+	   about to be cached by this message. */
+	rdma_req_send_ctrl_data_t *send_ctrl_data = get_send_ctrl_data(recv_data->send_ctrl_req);
+	if (send_ctrl_data->rkey_slot >= 0) {
+		nccl_net_ofi_rdma_rkey_cache_entry_t *entry =
+			&r_comm->rkey_cache[send_ctrl_data->rkey_slot];
+		nccl_net_ofi_mutex_lock(&r_comm->rkey_cache_lock);
+		if (done_msg->type == NCCL_OFI_RDMA_MSG_CTRL_CACHE) {
+			entry->mr_handle = NULL;
+		}
+		entry->refcnt--;
+		nccl_net_ofi_mutex_unlock(&r_comm->rkey_cache_lock);
+		send_ctrl_data->rkey_slot = -1;
+	}
+
+	done_msg->type = NCCL_OFI_RDMA_MSG_PULL_DONE;
+	done_msg->buff_len = recv_segms_data->pull_len;
+
+	return check_post_bounce_req(bounce_req);
+}
+
 static inline int insert_rdma_recv_req_into_msgbuff(nccl_net_ofi_rdma_recv_comm_t *r_comm,
 	bool eager, nccl_net_ofi_rdma_req_t **ret_req)
 {
@@ -3451,6 +5148,128 @@ static int process_cq_if_pending(nccl_net_ofi_rdma_ep_t *ep)
 	return 0;
 }
 
+/*
+ * @brief	Post a grouped receive of `n' buffers
+ *
+ * Each buffer is received by a receive subrequest of its own message
+ * sequence number. The control messages of the subrequests are sent
+ * together, see send_ctrl_group().
+ */
+static int recv_group(nccl_net_ofi_rdma_recv_comm_t *r_comm, int n, void **buffers,
+		      int *sizes, int *tags, nccl_net_ofi_rdma_mr_handle_t **mr_handles,
+		      nccl_net_ofi_req_t **base_req)
+{
+	int ret = 0;
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+	nccl_net_ofi_rdma_device_t *device = rdma_endpoint_get_device(ep);
+	int dev_id = r_comm->base.base.dev_id;
+	nccl_net_ofi_rdma_req_t *req = NULL;
+	rdma_req_recv_group_data_t *group_data = NULL;
+
+	*base_req = NULL;
+
+	if (OFI_UNLIKELY(n > max_recvs)) {
+		NCCL_OFI_WARN("Grouped receive of %d buffers, more than the maximum of %d",
+			      n, max_recvs);
+		return -EINVAL;
+	}
+
+	/* Wait for room for all receives of the group. Return NULL
+	 * to NCCL. */
+	if (r_comm->num_inflight_reqs + n > max_inflight_reqs) {
+		return 0;
+	}
+
+	ret = process_cq_if_pending(ep);
+	if (ret == -EAGAIN) {
+		/* Network is still busy. Return NULL to NCCL. */
+		return 0;
+	}
+	if (ret != 0) {
+		return ret;
+	}
+
+	req = allocate_req(r_comm->nccl_ofi_reqs_fl);
+	if (OFI_UNLIKELY(req == NULL)) {
+		NCCL_OFI_WARN("Unable to get NCCL OFI grouped receive request for device %d", dev_id);
+		return -ENOMEM;
+	}
+	req->comm = &r_comm->base.base;
+	req->dev_id = dev_id;
+	req->type = NCCL_OFI_RDMA_RECV_GROUP;
+	req->free = free_recv_group_req;
+	req->msg_seq_num = r_comm->next_msg_seq_num;
+	group_data = get_recv_group_data(req);
+	group_data->num_recvs = 0;
+
+	for (int i = 0; i < n; i++) {
+		uint16_t msg_seq_num = (r_comm->next_msg_seq_num + i) & MSG_SEQ_NUM_MASK;
+		nccl_net_ofi_rdma_req_t *recv_req = NULL;
+		void *elem;
+		nccl_ofi_msgbuff_elemtype_t type;
+		nccl_ofi_msgbuff_status_t msg_stat;
+		nccl_ofi_msgbuff_result_t mb_res;
+
+		/* Senders wait for the control messages when grouped
+		 * receives are enabled, nothing arrived yet */
+		mb_res = nccl_ofi_msgbuff_retrieve(r_comm->msgbuff, msg_seq_num, &elem,
+						   &type, &msg_stat);
+		if (OFI_UNLIKELY(mb_res != NCCL_OFI_MSGBUFF_INVALID_IDX ||
+				 msg_stat != NCCL_OFI_MSGBUFF_NOTSTARTED)) {
+			NCCL_OFI_WARN("Message %hu of grouped receive has invalid status", msg_seq_num);
+			ret = -EINVAL;
+			goto error;
+		}
+
+		ret = allocate_rdma_recv_req(r_comm, device, dev_id, msg_seq_num,
+					     buffers[i], sizes[i], mr_handles[i], &recv_req);
+		if (ret != 0) {
+			goto error;
+		}
+
+		ret = insert_rdma_recv_req_into_msgbuff(r_comm, false, &recv_req);
+		if (ret != 0 || recv_req == NULL) {
+			if (recv_req) {
+				recv_req->free(recv_req, false);
+			}
+			ret = -EINVAL;
+			goto error;
+		}
+
+		(r_comm->num_inflight_reqs)++;
+		recv_req->start_ns = nccl_ofi_stats_now_ns();
+		NCCL_OFI_TRACE_RECV(dev_id, r_comm->local_comm_id, sizes[i], recv_req, base_req);
+
+		group_data->recv_reqs[i] = recv_req;
+		group_data->num_recvs++;
+	}
+
+	ret = send_ctrl_group(r_comm, req, tags);
+	if (OFI_UNLIKELY(ret != 0)) {
+		goto error;
+	}
+
+	/* Return request to NCCL */
+	*base_req = &req->base;
+	r_comm->next_msg_seq_num = (r_comm->next_msg_seq_num + n) & MSG_SEQ_NUM_MASK;
+
+	return 0;
+
+ error:
+	/* Remove the inserted subrequests, so that the messages can be
+	   received again from next_msg_seq_num */
+	for (int i = 0; i < group_data->num_recvs; i++) {
+		nccl_ofi_msgbuff_status_t msg_stat;
+		uint16_t msg_seq_num = group_data->recv_reqs[i]->msg_seq_num;
+		if (nccl_ofi_msgbuff_remove(r_comm->msgbuff, msg_seq_num, &msg_stat) !=
+		    NCCL_OFI_MSGBUFF_SUCCESS) {
+			NCCL_OFI_WARN("Failed to remove msg %hu from message buffer", msg_seq_num);
+		}
+	}
+	req->free(req, true);
+	return ret;
+}
+
 static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 			 int *sizes, int *tags, nccl_net_ofi_mr_handle_t **mhandles,
 			 nccl_net_ofi_req_t **base_req)
@@ -3465,6 +5284,9 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 	nccl_net_ofi_rdma_mr_handle_t **mr_handles = (nccl_net_ofi_rdma_mr_handle_t **)mhandles;
 	uint16_t msg_seq_num = 0;
 	bool eager = false;
+	bool pull = false;
+	/* Size of eager data already in the receive buffer */
+	size_t eager_len = 0;
 
 	assert(r_comm != NULL);
 
@@ -3474,10 +5296,21 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 		goto error;
 	}
 
-	if (OFI_UNLIKELY(r_comm->num_inflight_reqs == NCCL_OFI_MAX_REQUESTS)) {
+	if (OFI_UNLIKELY(flush_buff_idle_timeout_ns != 0 && r_comm->flush_buff.host_buffer != NULL)) {
+		ret = release_idle_flush_buff(r_comm);
+		if (ret != 0) {
+			goto error;
+		}
+	}
+
+	if (n > 1) {
+		return recv_group(r_comm, n, buffers, sizes, tags, mr_handles, base_req);
+	}
+
+	if (OFI_UNLIKELY(r_comm->num_inflight_reqs == max_inflight_reqs)) {
 		ret = -ENOSPC;
-		NCCL_OFI_WARN("Can not support more than %d inflight requests",
-			      NCCL_OFI_MAX_REQUESTS);
+		NCCL_OFI_WARN("Can not support more than %" PRIu64 " inflight requests",
+			      max_inflight_reqs);
 		goto error;
 	}
 
@@ -3518,8 +5351,14 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 			ret = -EINVAL;
 			goto error;
 		} else if (OFI_LIKELY(type == NCCL_OFI_MSGBUFF_BUFF)) {
-			/* This is an eager message */
-			eager = true;
+			nccl_net_ofi_rdma_req_t *bounce_req = (nccl_net_ofi_rdma_req_t *)elem;
+			if (get_bounce_data(bounce_req)->msg_type == NCCL_OFI_RDMA_MSG_RTS) {
+				/* The sender advertised its buffer, pull the data */
+				pull = true;
+			} else {
+				/* This is an eager message */
+				eager = true;
+			}
 		} else {
 			NCCL_OFI_WARN("Invalid type in msg buff");
 			ret = -EINVAL;
@@ -3554,15 +5393,28 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 				return ret;
 			}
 			recv_data->eager_copy_req = NULL;
+		} else if (use_eager_cpu_copy(req)) {
+			ret = eager_copy_cpu(req, bounce_req, &eager_len);
+			if (ret != 0) {
+				NCCL_OFI_WARN("Failed CPU copy of eager message");
+				goto error;
+			}
+			recv_data->eager_copy_req = NULL;
 		} else {
 			ret = alloc_eager_copy_req(req, r_comm, bounce_req);
 			if (ret != 0) {
 				goto error;
 			}
 		}
+	} else if (pull) {
+		nccl_net_ofi_rdma_req_t *bounce_req = (nccl_net_ofi_rdma_req_t *)elem;
+		ret = prepare_pull_recv(r_comm, device, req, bounce_req);
+		if (ret != 0) {
+			goto error;
+		}
 	}
 
-	ret = insert_rdma_recv_req_into_msgbuff(r_comm, eager, &req);
+	ret = insert_rdma_recv_req_into_msgbuff(r_comm, eager || pull, &req);
 	if (ret != 0) {
 		goto free_req;
 	} else if (req == NULL) {
@@ -3573,22 +5425,42 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 	/* At this point, we've successfully inserted a new request, so update the num inflight. */
 	(r_comm->num_inflight_reqs)++;
 
+	req->start_ns = nccl_ofi_stats_now_ns();
 	NCCL_OFI_TRACE_RECV(dev_id, r_comm->local_comm_id, sizes[0], req, base_req);
 
-	/* Send ctrl msg */
-	nccl_net_ofi_mutex_lock(&r_comm->ctrl_counter_lock);
-	r_comm->n_ctrl_sent += 1;
-	nccl_net_ofi_mutex_unlock(&r_comm->ctrl_counter_lock);
-	ret = receive_progress(recv_data->send_ctrl_req, true);
-	if (OFI_UNLIKELY(ret != 0)) {
-		/* TODO: Remove req from message buffer */
-		goto error;
+	if (pull) {
+		/* Read the data. The ctrl msg is sent as PULL_DONE
+		   message once the reads completed. */
+		nccl_net_ofi_rdma_req_t *recv_segms_req = recv_data->recv_segms_req;
+		if (get_recv_segms_data(recv_segms_req)->pull_len == 0) {
+			ret = set_pull_reads_completed(recv_segms_req);
+		} else {
+			ret = receive_progress(recv_segms_req, true);
+		}
+		if (OFI_UNLIKELY(ret != 0)) {
+			NCCL_OFI_WARN("Failed to post pull reads");
+			goto remove_req;
+		}
+	} else {
+		/* Send ctrl msg */
+		nccl_net_ofi_mutex_lock(&r_comm->ctrl_counter_lock);
+		r_comm->n_ctrl_sent += 1;
+		nccl_net_ofi_mutex_unlock(&r_comm->ctrl_counter_lock);
+		if (ctrl_batch_max > 1) {
+			ret = batch_send_ctrl_req(r_comm, recv_data->send_ctrl_req);
+		} else {
+			ret = receive_progress(recv_data->send_ctrl_req, true);
+		}
+		if (OFI_UNLIKELY(ret != 0)) {
+			/* TODO: Remove req from message buffer */
+			goto error;
+		}
 	}
 
 	if (eager) {
 		if (recv_data->eager_copy_req == NULL) {
 			/* If we don't need to do eager copy, this recv is already complete */
-			ret = inc_req_completion(req, 0, recv_data->total_num_compls);
+			ret = inc_req_completion(req, eager_len, recv_data->total_num_compls);
 			if (ret != 0) {
 				goto error;
 			}
@@ -3610,6 +5482,14 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 
 	goto exit;
 
+ remove_req:
+	/* The RTS message was released, so the message is received
+	   with a ctrl message if recv() is called again */
+	if (nccl_ofi_msgbuff_remove(r_comm->msgbuff, msg_seq_num, &msg_stat) !=
+	    NCCL_OFI_MSGBUFF_SUCCESS) {
+		NCCL_OFI_WARN("Failed to remove msg %hu from message buffer", msg_seq_num);
+	}
+	(r_comm->num_inflight_reqs)--;
  free_req:
  error:
 	if (req)
@@ -3619,11 +5499,6 @@ static int recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 	return ret;
 }
 
-static inline bool is_flush_buff_enabled(void)
-{
-	return !ofi_nccl_gdr_flush_disable() && support_gdr == GDR_SUPPORTED && !cuda_flush;
-}
-
 /*
  * @brief	Deregister flush buffer if flush buffer was registered. Deallocate flush buffer.
  *
@@ -3648,13 +5523,14 @@ static inline int dealloc_and_dereg_flush_buff(nccl_net_ofi_rdma_recv_comm_t *r_
 		NCCL_OFI_WARN("Failed to deregister flush buffer");
 		goto exit;
 	}
+	r_comm->flush_buff.mr_handle = NULL;
 	ret = nccl_net_ofi_dealloc_mr_buffer(r_comm->flush_buff.host_buffer,
 					    system_page_size);
 	if (OFI_UNLIKELY(ret != 0)) {
 		NCCL_OFI_WARN("Unable to deallocate flush buffer (%d)", ret);
 		goto exit;
 	}
-	r_comm->flush_buff.host_buffer = MAP_FAILED;
+	r_comm->flush_buff.host_buffer = NULL;
 
  exit:
 	return ret;
@@ -3688,6 +5564,7 @@ static int alloc_and_reg_flush_buff(nccl_net_ofi_rdma_recv_comm_t *r_comm, int d
 	ret = nccl_net_ofi_alloc_mr_buffer(system_page_size, &(flush_buff->host_buffer));
 	if (OFI_UNLIKELY(ret != 0)) {
 		NCCL_OFI_WARN("Unable to allocate flush buffer (%d)", ret);
+		flush_buff->host_buffer = NULL;
 		return ret;
 	}
 
@@ -3708,7 +5585,7 @@ static int alloc_and_reg_flush_buff(nccl_net_ofi_rdma_recv_comm_t *r_comm, int d
 				NCCL_OFI_WARN("Unable to deallocate flush buffer (%d)",
 					      rc);
 			}
-			flush_buff->host_buffer = MAP_FAILED;
+			flush_buff->host_buffer = NULL;
 		}
 	} else {
 		NCCL_OFI_TRACE(NCCL_NET,
@@ -3720,8 +5597,31 @@ static int alloc_and_reg_flush_buff(nccl_net_ofi_rdma_recv_comm_t *r_comm, int d
 	return ret;
 }
 
+/*
+ * @brief	Release the flush buffer of a receive communicator if it
+ *		was not used for flush_buff_idle_timeout_ns and no request
+ *		of the communicator is inflight
+ *
+ * @return	0, on success
+ * 		error, on others
+ */
+static int release_idle_flush_buff(nccl_net_ofi_rdma_recv_comm_t *r_comm)
+{
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
+
+	if (r_comm->num_inflight_reqs != 0 ||
+	    nccl_ofi_stats_now_ns() - r_comm->flush_buff.last_used_ns < flush_buff_idle_timeout_ns) {
+		return 0;
+	}
+
+	NCCL_OFI_TRACE(NCCL_NET, "Releasing idle flush buffer of comm %p", r_comm);
+
+	return dealloc_and_dereg_flush_buff(r_comm, rdma_endpoint_get_device(ep));
+}
+
 static inline void free_rdma_recv_comm(nccl_net_ofi_rdma_recv_comm_t *r_comm) {
     if (r_comm) {
+        nccl_ofi_stats_unregister(&r_comm->stats.entry);
         if (r_comm->control_rails) {
             free(r_comm->control_rails);
         }
@@ -3755,7 +5655,7 @@ static int recv_comm_destroy(nccl_net_ofi_rdma_recv_comm_t *r_comm)
 		}
 	}
 
-	if (is_flush_buff_enabled()) {
+	if (r_comm->flush_buff.host_buffer != NULL) {
 		ret = dealloc_and_dereg_flush_buff(r_comm, device);
 		if (ret != 0) {
 			NCCL_OFI_WARN("Failed to deregister ctrl buffer pool");
@@ -3802,6 +5702,16 @@ static int recv_comm_destroy(nccl_net_ofi_rdma_recv_comm_t *r_comm)
 		return ret;
 	}
 
+	ret = nccl_net_ofi_mutex_destroy(&r_comm->ctrl_batch_lock);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = nccl_net_ofi_mutex_destroy(&r_comm->rkey_cache_lock);
+	if (ret != 0) {
+		return ret;
+	}
+
 	free_rdma_recv_comm(r_comm);
 
 	ret = ep->base.release_ep(&ep->base);
@@ -3939,6 +5849,7 @@ exit:
 
 static inline void free_rdma_send_comm(nccl_net_ofi_rdma_send_comm_t *s_comm) {
     if (s_comm) {
+        nccl_ofi_stats_unregister(&s_comm->stats.entry);
         if (s_comm->control_rails) {
             free(s_comm->control_rails);
         }
@@ -3966,6 +5877,14 @@ static int send_comm_destroy(nccl_net_ofi_rdma_send_comm_t *s_comm)
 		return ret;
 	}
 
+	if (s_comm->ctrl_buff_fl) {
+		ret = nccl_ofi_freelist_fini(s_comm->ctrl_buff_fl);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Call to nccl_ofi_freelist_fini failed: %d", ret);
+			return ret;
+		}
+	}
+
 	if (!nccl_ofi_msgbuff_destroy(s_comm->msgbuff)) {
 		NCCL_OFI_WARN("Failed to destroy msgbuff (s_comm)");
 		ret = -EINVAL;
@@ -4173,10 +6092,10 @@ static int flush(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 	ssize_t rc = 0;
 	nccl_net_ofi_rdma_mr_handle_t **mr_handles = (nccl_net_ofi_rdma_mr_handle_t **)mhandles;
 
-	if (OFI_UNLIKELY(r_comm->num_inflight_reqs == NCCL_OFI_MAX_REQUESTS)) {
+	if (OFI_UNLIKELY(r_comm->num_inflight_reqs == max_inflight_reqs)) {
 		ret = -ENOSPC;
-		NCCL_OFI_WARN("Can not support more than %d inflight requests",
-			      NCCL_OFI_MAX_REQUESTS);
+		NCCL_OFI_WARN("Can not support more than %" PRIu64 " inflight requests",
+			      max_inflight_reqs);
 		goto error;
 	}
 
@@ -4205,10 +6124,7 @@ static int flush(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 		}
 		goto exit;
 	}
-#endif
-
-	assert(r_comm->flush_buff.host_buffer);
-	assert(r_comm->flush_buff.mr_handle);
+#endif
 
 	/*
 	 * Find the non-zero request for which we will issue flush.
@@ -4231,6 +6147,19 @@ static int flush(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 		goto exit;
 	}
 
+	if (OFI_UNLIKELY(r_comm->flush_buff.host_buffer == NULL)) {
+		ret = alloc_and_reg_flush_buff(r_comm, r_comm->base.base.dev_id);
+		if (OFI_UNLIKELY(ret != 0)) {
+			goto error;
+		}
+	}
+	if (flush_buff_idle_timeout_ns != 0) {
+		r_comm->flush_buff.last_used_ns = nccl_ofi_stats_now_ns();
+	}
+
+	assert(r_comm->flush_buff.host_buffer);
+	assert(r_comm->flush_buff.mr_handle);
+
 	ret = rdma_comm_alloc_flush_req(r_comm, buffers[flush_n], mr_handles[flush_n], &req);
 	if (OFI_UNLIKELY(ret != 0)) {
 		goto error;
@@ -4269,6 +6198,75 @@ static int flush(nccl_net_ofi_recv_comm_t *recv_comm, int n, void **buffers,
 	return ret;
 }
 
+/*
+ * @brief	Print send or receive communicator statistics
+ */
+static void rdma_comm_stats_dump(FILE *out, nccl_ofi_stats_entry_t *entry)
+{
+	nccl_net_ofi_rdma_comm_stats_t *stats =
+		container_of(entry, nccl_net_ofi_rdma_comm_stats_t, entry);
+
+	fprintf(out, "    completed %" PRIu64 " bytes %" PRIu64 " pulled %" PRIu64 " eager_cpu_copied %" PRIu64
+		" ctrl_batched %" PRIu64 " ctrl_compact %" PRIu64 "\n",
+		nccl_ofi_stats_read(&stats->latency.count),
+		nccl_ofi_stats_read(&stats->bytes),
+		nccl_ofi_stats_read(&stats->pulled),
+		nccl_ofi_stats_read(&stats->eager_cpu_copied),
+		nccl_ofi_stats_read(&stats->ctrl_batched),
+		nccl_ofi_stats_read(&stats->ctrl_compact));
+	nccl_ofi_stats_hist_print(out, "latency_ns", &stats->latency);
+}
+
+/*
+ * @brief	Print statistics of an endpoint rail
+ */
+static void rdma_rail_stats_dump(FILE *out, const char *kind, nccl_net_ofi_ep_rail_t *rail)
+{
+	nccl_net_ofi_rdma_rail_stats_t *stats = &rail->stats;
+
+	nccl_net_ofi_mutex_lock(&rail->bounce_mutex);
+	size_t num_bounce_posted = rail->num_bounce_posted;
+	nccl_net_ofi_mutex_unlock(&rail->bounce_mutex);
+
+	fprintf(out, "    %s %d: written %" PRIu64 " read %" PRIu64 " sent %" PRIu64 " eagain %" PRIu64
+		" bounce_posted %zu/%zu low %" PRIu64 "\n",
+		kind, rail->rail_id,
+		nccl_ofi_stats_read(&stats->bytes_written),
+		nccl_ofi_stats_read(&stats->bytes_read),
+		nccl_ofi_stats_read(&stats->bytes_sent),
+		nccl_ofi_stats_read(&stats->eagain),
+		num_bounce_posted, rail->max_bounce_posted,
+		nccl_ofi_stats_read(&stats->bounce_low_water));
+
+	/* Control rails share the completion queue of data rails */
+	if (nccl_ofi_stats_read(&stats->cq_batch.count) != 0) {
+		fprintf(out, "    cq_read_batch %zu budget_exhausted %" PRIu64 "\n",
+			__atomic_load_n(&rail->cq_read_batch, __ATOMIC_RELAXED),
+			nccl_ofi_stats_read(&stats->cq_budget_exhausted));
+		nccl_ofi_stats_hist_print(out, "cq_batch", &stats->cq_batch);
+		nccl_ofi_stats_hist_print(out, "cq_read", &stats->cq_read);
+	}
+}
+
+/*
+ * @brief	Print endpoint statistics
+ */
+static void rdma_ep_stats_dump(FILE *out, nccl_ofi_stats_entry_t *entry)
+{
+	nccl_net_ofi_rdma_ep_t *ep = container_of(entry, nccl_net_ofi_rdma_ep_t, stats_entry);
+
+	fprintf(out, "    pending: depth %zu max %" PRIu64 "\n",
+		nccl_ofi_deque_size(ep->pending_reqs_queue),
+		nccl_ofi_stats_read(&ep->pending_max_depth));
+
+	for (int rail_id = 0; rail_id != ep->num_rails; ++rail_id) {
+		rdma_rail_stats_dump(out, "rail", rdma_endpoint_get_rail(ep, rail_id));
+	}
+	for (int rail_id = 0; rail_id != ep->num_control_rails; ++rail_id) {
+		rdma_rail_stats_dump(out, "control_rail", rdma_endpoint_get_control_rail(ep, rail_id));
+	}
+}
+
 /*
  * @brief	Allocate a RDMA receive communicator with `num_rails' rails using `calloc()'
  *
@@ -4378,11 +6376,11 @@ static int rma_read(nccl_net_ofi_recv_comm_t *recv_comm, void* dest, size_t size
 	nccl_net_ofi_rdma_ep_t *ep = NULL;
 
 	assert(r_comm != NULL);
-	/* Support only NCCL_OFI_MAX_REQUESTS inflight requests. */
-	if (OFI_UNLIKELY(r_comm->num_inflight_reqs == NCCL_OFI_MAX_REQUESTS)) {
+	/* Support only max_inflight_reqs inflight requests. */
+	if (OFI_UNLIKELY(r_comm->num_inflight_reqs == max_inflight_reqs)) {
 		ret = -EINVAL;
-		NCCL_OFI_WARN("Can not support more than %d inflight requests",
-			      NCCL_OFI_MAX_REQUESTS);
+		NCCL_OFI_WARN("Can not support more than %" PRIu64 " inflight requests",
+			      max_inflight_reqs);
 		goto error;
 	}
 
@@ -4487,6 +6485,21 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_device
 		return NULL;
 	}
 
+	ret = nccl_net_ofi_mutex_init(&r_comm->ctrl_batch_lock, NULL);
+	if (ret != 0) {
+		nccl_net_ofi_mutex_destroy(&r_comm->ctrl_counter_lock);
+		free_rdma_recv_comm(r_comm);
+		return NULL;
+	}
+
+	ret = nccl_net_ofi_mutex_init(&r_comm->rkey_cache_lock, NULL);
+	if (ret != 0) {
+		nccl_net_ofi_mutex_destroy(&r_comm->ctrl_counter_lock);
+		nccl_net_ofi_mutex_destroy(&r_comm->ctrl_batch_lock);
+		free_rdma_recv_comm(r_comm);
+		return NULL;
+	}
+
 	r_comm->base.base.type = NCCL_NET_OFI_RECV_COMM;
 	r_comm->base.base.dev_id = dev_id;
 	r_comm->base.regMr = reg_mr_recv_comm;
@@ -4501,6 +6514,20 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_device
 	memset(&r_comm->cleanup_list_elem, 0, sizeof(r_comm->cleanup_list_elem));
 	r_comm->n_ctrl_sent = 0;
 	r_comm->n_ctrl_delivered = 0;
+	r_comm->ctrl_batch_head = NULL;
+	r_comm->ctrl_batch_tail = NULL;
+	r_comm->ctrl_batch_count = 0;
+	r_comm->ctrl_batch_start_ns = 0;
+
+	/* The cache only pays off if compact control messages are
+	 * shorter than the ones carrying the keys */
+	memset(r_comm->rkey_cache, 0, sizeof(r_comm->rkey_cache));
+	r_comm->rkey_cache_size =
+		(nccl_net_ofi_rdma_ctrl_msg_size(num_rails, l_comm_ep->use_long_rkeys) >
+		 offsetof(nccl_net_ofi_rdma_ctrl_msg_t, rkey_ref) + sizeof(nccl_net_ofi_rdma_rkey_ref_t)) ?
+		rkey_cache_size : 0;
+	r_comm->rkey_cache_clock = 0;
+	r_comm->rkey_cache_gen = 0;
 
 	/* Allocate recv communicator ID */
 	comm_id = nccl_ofi_idpool_allocate_id(device->comm_idpool);
@@ -4560,7 +6587,10 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_device
 	ep = (nccl_net_ofi_rdma_ep_t *)r_comm->base.base.ep;
 
 	/* Add ourselves to ep's lookup array */
-	rdma_device_set_comm(device, r_comm->local_comm_id, &r_comm->base.base);
+	ret = rdma_device_set_comm(device, r_comm->local_comm_id, &r_comm->base.base);
+	if (OFI_UNLIKELY(ret != 0)) {
+		goto error;
+	}
 
 	/* Allocate array of control communicator rails */
 	r_comm->num_control_rails = num_control_rails;
@@ -4625,39 +6655,29 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_device
 	}
 
 	/* Allocate request freelist */
-	/* Maximum freelist entries is 4*NCCL_OFI_MAX_REQUESTS because each receive request
+	/* Maximum freelist entries is 4*max_inflight_reqs because each receive request
 	   can have associated reqs for send_ctrl, recv_segms, and eager_copy */
-	ret = nccl_ofi_freelist_init(sizeof(nccl_net_ofi_rdma_req_t), 16, 16,
-				     4 * NCCL_OFI_MAX_REQUESTS, &r_comm->nccl_ofi_reqs_fl);
+	ret = comm_reqs_fl_init(ep, 4 * max_inflight_reqs, &r_comm->nccl_ofi_reqs_fl);
 	if (OFI_UNLIKELY(ret != 0)) {
 		NCCL_OFI_WARN("Could not allocate NCCL OFI requests free list for dev %d",
 				  dev_id);
 		goto error;
 	}
 
-	/*
-	 * Setup flush resources if using GPUDirect RDMA unless user disables
-	 * flush operations
-	 */
-	if (is_flush_buff_enabled()) {
-		ret = alloc_and_reg_flush_buff(r_comm, dev_id);
-		if (OFI_UNLIKELY(ret != 0)) {
-			goto error;
-		}
-	}
+	/* The flush buffer is allocated by the first flush, as many
+	 * communicators never flush */
 
 	/* Allocate message buffer */
-	r_comm->msgbuff = nccl_ofi_msgbuff_init(NCCL_OFI_RDMA_MSGBUFF_SIZE, NCCL_OFI_RDMA_SEQ_BITS);
+	r_comm->msgbuff = nccl_ofi_msgbuff_init((uint16_t)(2 * max_inflight_reqs), NCCL_OFI_RDMA_SEQ_BITS);
 	if (!r_comm->msgbuff) {
 		NCCL_OFI_WARN("Failed to allocate and initialize message buffer");
 		free_rdma_recv_comm(r_comm);
 		return NULL;
 	}
 
-	ret = nccl_ofi_freelist_init_mr(sizeof(nccl_net_ofi_rdma_ctrl_fl_item_t), 8, 8,
-					NCCL_OFI_MAX_REQUESTS, freelist_regmr_host_fn,
-					freelist_deregmr_host_fn, ep, 0, 1,
-					&r_comm->ctrl_buff_fl);
+	/* Control buffers hold the messages of a whole batch */
+	ret = comm_ctrl_buff_fl_init(ep, comm_ctrl_buff_size(), max_inflight_reqs,
+				     &r_comm->ctrl_buff_fl);
 	if (ret != 0) {
 		NCCL_OFI_WARN("Call to freelist_init_mr failed: %d", ret);
 		return NULL;
@@ -4673,6 +6693,9 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_device
 	}
 #endif
 
+	nccl_ofi_stats_register(&r_comm->stats.entry, rdma_comm_stats_dump,
+				"recv_comm %u dev %d ep %p", r_comm->local_comm_id, dev_id, ep);
+
 	return r_comm;
 
  error:
@@ -4683,12 +6706,15 @@ static nccl_net_ofi_rdma_recv_comm_t *prepare_recv_comm(nccl_net_ofi_rdma_device
 		if (r_comm->msgbuff)
 			nccl_ofi_msgbuff_destroy(r_comm->msgbuff);
 		if (COMM_ID_INVALID != r_comm->local_comm_id) {
+			rdma_device_set_comm(device, r_comm->local_comm_id, NULL);
 			ret = nccl_ofi_idpool_free_id(device->comm_idpool, r_comm->local_comm_id);
 			if (ret != 0) {
 				NCCL_OFI_WARN("Error freeing communicator ID %" PRIu32, r_comm->local_comm_id);
 			}
 		}
 		nccl_net_ofi_mutex_destroy(&r_comm->ctrl_counter_lock);
+		nccl_net_ofi_mutex_destroy(&r_comm->ctrl_batch_lock);
+		nccl_net_ofi_mutex_destroy(&r_comm->rkey_cache_lock);
 		free_rdma_recv_comm(r_comm);
 	}
 
@@ -5136,7 +7162,10 @@ static int listen(nccl_net_ofi_ep_t *base_ep,
 	handle->comm_id = l_comm->comm_id;
 
 	/*  Add listen comm to ep's lookup array */
-	rdma_device_set_comm(device, l_comm->comm_id, &l_comm->base.base);
+	ret = rdma_device_set_comm(device, l_comm->comm_id, &l_comm->base.base);
+	if (OFI_UNLIKELY(ret != 0)) {
+		goto error;
+	}
 
 	/* Prepare receive request to accept connections */
 	ret = prepare_recv_conn_req(l_comm);
@@ -5149,6 +7178,7 @@ static int listen(nccl_net_ofi_ep_t *base_ep,
 
 error:
 	if (l_comm && COMM_ID_INVALID != l_comm->comm_id) {
+		rdma_device_set_comm(device, l_comm->comm_id, NULL);
 		if (0 != nccl_ofi_idpool_free_id(device->comm_idpool, l_comm->comm_id)) {
 			NCCL_OFI_WARN("Error freeing communicator ID %" PRIu32, l_comm->comm_id);
 		}
@@ -5200,11 +7230,58 @@ static int alloc_rdma_write_req(nccl_net_ofi_rdma_send_comm_t *s_comm,
 	return 0;
 }
 
+/**
+ * @brief	Allocate the RTS message of a pulled send request,
+ *		advertising the send buffer to the receiver
+ */
+static int alloc_rdma_rts_msg(nccl_net_ofi_rdma_send_comm_t *s_comm,
+			      nccl_net_ofi_rdma_req_t *req)
+{
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep;
+	rdma_req_send_data_t *send_data = get_send_data(req);
+
+	nccl_net_ofi_rdma_ctrl_fl_item_t *rts_fl_item =
+		(nccl_net_ofi_rdma_ctrl_fl_item_t *)nccl_ofi_freelist_entry_alloc(s_comm->ctrl_buff_fl);
+	if (OFI_UNLIKELY(rts_fl_item == NULL)) {
+		NCCL_OFI_WARN("Call to nccl_ofi_freelist_entry_alloc failed");
+		return -ENOMEM;
+	}
+	send_data->rts_fl_item = rts_fl_item;
+
+	rts_fl_item->ctrl_msg.type = NCCL_OFI_RDMA_MSG_RTS;
+	rts_fl_item->ctrl_msg.remote_comm_id = s_comm->remote_comm_id;
+	rts_fl_item->ctrl_msg.msg_seq_num = req->msg_seq_num;
+	rts_fl_item->ctrl_msg.buff_addr = (uint64_t)send_data->buff;
+	rts_fl_item->ctrl_msg.buff_len = send_data->buff_len;
+
+	for (int rail_id = 0; rail_id < s_comm->num_rails; rail_id++) {
+		uint64_t rkey = fi_mr_key(send_data->buff_mr_handle->mr[rail_id]);
+
+		if (rkey == FI_KEY_NOTAVAIL) {
+			NCCL_OFI_WARN("RDMA send buffers should be pre-registered");
+			return -ENOENT;
+		}
+
+		if (ep->use_long_rkeys) {
+			rts_fl_item->ctrl_msg.long_buff_mr_key[rail_id] = rkey;
+		} else {
+			if (rkey > (1ULL << (NCCL_NET_OFI_CTRL_MSG_SHORT_KEY_SIZE * 8)) - 1) {
+				NCCL_OFI_WARN("Libfabric returned rkey larger than declared rkey size: %" PRIu64,
+					      rkey);
+				return -ENOTSUP;
+			}
+			rts_fl_item->ctrl_msg.short_buff_mr_key[rail_id] = rkey;
+		}
+	}
+
+	return 0;
+}
+
 static int alloc_rdma_send_req(nccl_net_ofi_rdma_send_comm_t *s_comm,
 					uint16_t msg_seq_num,
 					void *buff, size_t size,
 					nccl_net_ofi_rdma_mr_handle_t *buff_mr_handle,
-					bool eager,
+					bool eager, bool pull,
 					nccl_net_ofi_rdma_req_t **ret_req)
 {
 	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep;
@@ -5226,10 +7303,19 @@ static int alloc_rdma_send_req(nccl_net_ofi_rdma_send_comm_t *s_comm,
 	req->size = size;
 
 	rdma_req_send_data_t *send_data = get_send_data(req);
-	send_data->xferred_rail_id = 0;
+	memset(send_data->stripe_posted, 0, sizeof(send_data->stripe_posted));
+	memset(send_data->stripe_inflight, 0, sizeof(send_data->stripe_inflight));
+	memset(send_data->stripe_last_posted, 0, sizeof(send_data->stripe_last_posted));
+	send_data->write_pending = false;
 	send_data->buff = buff;
 	send_data->buff_len = size;
 	send_data->buff_mr_handle = buff_mr_handle;
+	send_data->schedule = NULL;
+	send_data->pull = false;
+	send_data->rts_posted = false;
+	send_data->remote_rkey_pending = false;
+	send_data->next_rkey_waiter = NULL;
+	send_data->rts_fl_item = NULL;
 
 	/* If this is not an eager send, the schedule is created after knowing the
 	   remote length received in the control message.
@@ -5239,6 +7325,7 @@ static int alloc_rdma_send_req(nccl_net_ofi_rdma_send_comm_t *s_comm,
 		if (OFI_UNLIKELY(send_data->schedule == NULL)) {
 			return -EINVAL;
 		}
+		send_data->xfer_start_ns = nccl_ofi_stats_now_ns();
 
 		/* Set expected number of completions. Since this is an eager send, the ctrl msg
 		   has not arrived, so we expect one extra completion for the ctrl msg recv. */
@@ -5250,6 +7337,22 @@ static int alloc_rdma_send_req(nccl_net_ofi_rdma_send_comm_t *s_comm,
 	send_data->eager = eager;
 	assert((!eager) || (send_data->schedule->num_xfer_infos == 1));
 
+	if (pull) {
+		assert(!eager);
+		int ret = alloc_rdma_rts_msg(s_comm, req);
+		if (OFI_UNLIKELY(ret != 0)) {
+			req->free(req, false);
+			return ret;
+		}
+		send_data->pull = true;
+
+		/* Expect the send completion of the RTS message and the
+		   PULL_DONE message of the receiver. If the ctrl message
+		   arrives first, this is updated to the number of writes
+		   instead. */
+		send_data->total_num_compls = 2;
+	}
+
 	*ret_req = req;
 
 	return 0;
@@ -5301,7 +7404,9 @@ static int insert_rdma_send_req_into_msgbuff(nccl_net_ofi_rdma_send_comm_t *s_co
 static int post_rma_write(nccl_net_ofi_rdma_req_t *req)
 {
 	nccl_net_ofi_rdma_send_comm_t *s_comm = (nccl_net_ofi_rdma_send_comm_t *)req->comm;
-	nccl_net_ofi_rdma_send_comm_rail_t *comm_rail = rdma_send_comm_get_rail(s_comm, 0);
+	/* RMA operations are posted to the first rail */
+	int rail_id = 0;
+	nccl_net_ofi_rdma_send_comm_rail_t *comm_rail = rdma_send_comm_get_rail(s_comm, rail_id);
 	rdma_req_rma_op_data_t *rma_op_data = req_get_rma_op_data(req, NCCL_OFI_RDMA_WRITE);
 	ssize_t rc;
 
@@ -5331,6 +7436,9 @@ static int post_rma_write(nccl_net_ofi_rdma_req_t *req)
 	/* Post the message using fi_writemsg with FI_INJECT */
 	rc = fi_writemsg(comm_rail->local_ep, &msg, rma_op_data->flags);
 
+	nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_rail(rdma_req_get_ep(req), rail_id);
+	rail_stats_post(rail, &rail->stats.bytes_written, rma_op_data->buff_len, rc);
+
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
 		NCCL_OFI_WARN("fi_write_inline failed; RC: %zd, Error: %s",
 			      rc, fi_strerror(-rc));
@@ -5339,34 +7447,186 @@ static int post_rma_write(nccl_net_ofi_rdma_req_t *req)
 	return rc;
 }
 
+/*
+ * @brief	Return true if `len' bytes of the buffer of a send request
+ *		may be posted with an inject operation of at most
+ *		`inject_size' bytes
+ *
+ * Inject operations copy the payload with the CPU, so only host
+ * buffers qualify.
+ */
+static inline bool send_can_inject(rdma_req_send_data_t *send_data, size_t len,
+				   size_t inject_size)
+{
+	return rdma_inject && len <= inject_size &&
+		send_data->buff_mr_handle->type == NCCL_PTR_HOST;
+}
+
+/*
+ * @brief	Post a chunk of a stripe of a send request
+ *
+ * The last chunk of a stripe carries the immediate data that notifies
+ * the receiver of the stripe's arrival. Other chunks are posted
+ * without immediate data and with delivery-complete semantics, so
+ * that the last chunk can be held back until they have landed.
+ *
+ * @param	offset
+ *		Offset of the chunk in the stripe
+ * @param	len
+ *		Length of the chunk
+ * @param	last
+ *		True if this is the last chunk of the stripe
+ * @param	inject
+ *		True to post the chunk with fi_inject_writedata, which
+ *		generates no completion
+ */
 static int post_rdma_write(nccl_net_ofi_rdma_req_t *req,
 			   nccl_net_ofi_rdma_send_comm_rail_t *comm_rail,
-			   nccl_net_ofi_xfer_info_t *xfer_info)
+			   nccl_net_ofi_xfer_info_t *xfer_info,
+			   size_t offset, size_t len, bool last, bool inject)
 {
 	rdma_req_send_data_t *send_data = get_send_data(req);
 	assert(xfer_info->rail_id < send_data->buff_mr_handle->num_rails);
 	int rail_id = xfer_info->rail_id;
-	struct fid_mr *rail_mr_handle = send_data->buff_mr_handle->mr[rail_id];
-	void *desc = fi_mr_desc(rail_mr_handle);
+	void *src = (void *)((uintptr_t)send_data->buff + xfer_info->offset + offset);
+	uint64_t dest = send_data->remote_buff + xfer_info->offset + offset;
+	void *desc = NULL;
+
+	assert(!inject || last);
 
 	ssize_t rc;
-	/* Post RDMA write */
-	rc = fi_writedata(comm_rail->local_ep, (void*)((uintptr_t)send_data->buff + xfer_info->offset),
-				xfer_info->msg_size, desc, send_data->wdata,
-				comm_rail->remote_addr,
-				send_data->remote_buff + xfer_info->offset,
-				send_data->remote_mr_key[rail_id], req);
+	if (inject) {
+		/* Payload is copied out by the provider, no descriptor
+		   needed */
+		rc = fi_inject_writedata(comm_rail->local_ep, src, len, send_data->wdata,
+					 comm_rail->remote_addr, dest,
+					 send_data->remote_mr_key[rail_id]);
+		goto posted;
+	}
+
+	desc = fi_mr_desc(send_data->buff_mr_handle->mr[rail_id]);
+	if (last) {
+		/* Post RDMA write with immediate data */
+		rc = fi_writedata(comm_rail->local_ep, src, len, desc, send_data->wdata,
+				  comm_rail->remote_addr, dest,
+				  send_data->remote_mr_key[rail_id], req);
+	} else {
+		struct iovec iov;
+		struct fi_rma_iov rma_iov;
+		struct fi_msg_rma msg;
+
+		iov.iov_base = src;
+		iov.iov_len = len;
+
+		rma_iov.addr = dest;
+		rma_iov.len = len;
+		rma_iov.key = send_data->remote_mr_key[rail_id];
+
+		msg.msg_iov = &iov;
+		msg.desc = &desc;
+		msg.iov_count = 1;
+		msg.addr = comm_rail->remote_addr;
+		msg.rma_iov = &rma_iov;
+		msg.rma_iov_count = 1;
+		msg.context = req;
+		msg.data = 0;
+
+		rc = fi_writemsg(comm_rail->local_ep, &msg, FI_COMPLETION | FI_DELIVERY_COMPLETE);
+	}
+
+ posted:
+	{
+		nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_rail(rdma_req_get_ep(req), rail_id);
+		rail_stats_post(rail, &rail->stats.bytes_written, len, rc);
+	}
 
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
-		NCCL_OFI_WARN("fi_writedata failed; RC: %zd, Error: %s",
+		NCCL_OFI_WARN("%s failed; RC: %zd, Error: %s",
+			      inject ? "fi_inject_writedata" : (last ? "fi_writedata" : "fi_writemsg"),
 			      rc, fi_strerror(-rc));
-	} else if (rc == 0) {
-		NCCL_OFI_TRACE_SEND_WRITE_SEG_START(req->dev_id, rail_id, xfer_info->msg_size, req->comm, req->msg_seq_num, req);
 	}
 
 	return rc;
 }
 
+/*
+ * @brief	Post chunks of a stripe of a send request until the stripe
+ *		is fully posted or its window of chunks in flight is full
+ *
+ * A stripe that fits the inline write size is posted as a whole with
+ * an inject operation. It generates no completion, so the caller
+ * accounts for it once req_lock is released.
+ *
+ * Caller must hold req_lock.
+ *
+ * @param	stripe
+ *		Index of the stripe in the request's schedule
+ * @param	injected
+ *		Set to true if the stripe was injected. NULL, if the
+ *		stripe may not be injected.
+ * @return	0, on success
+ *		-FI_EAGAIN, if the network is busy; chunks posted so far
+ *		are kept and posting resumes from the failed chunk
+ *		error, on others; the stripe is then reported complete
+ *		to the scheduler
+ */
+static int post_rdma_write_chunks(nccl_net_ofi_rdma_req_t *req, size_t stripe, bool *injected)
+{
+	nccl_net_ofi_rdma_send_comm_t *s_comm = (nccl_net_ofi_rdma_send_comm_t *)req->comm;
+	rdma_req_send_data_t *send_data = get_send_data(req);
+	nccl_net_ofi_xfer_info_t *xfer_info = &send_data->schedule->rail_xfer_infos[stripe];
+	nccl_net_ofi_rdma_send_comm_rail_t *comm_rail =
+		rdma_send_comm_get_rail(s_comm, xfer_info->rail_id);
+	int ret = 0;
+
+	while (!send_data->stripe_last_posted[stripe] &&
+	       send_data->stripe_inflight[stripe] < write_chunk_window) {
+		size_t offset = send_data->stripe_posted[stripe];
+		size_t remaining = xfer_info->msg_size - offset;
+		bool last = remaining <= write_chunk_size;
+
+		if (last && send_data->stripe_inflight[stripe] > 0) {
+			/* Immediate data must not overtake the data of
+			   previous chunks */
+			break;
+		}
+
+		size_t len = last ? remaining : write_chunk_size;
+		bool inject = injected != NULL && last && offset == 0 &&
+			send_can_inject(send_data, len, max_write_inline_size);
+		ret = post_rdma_write(req, comm_rail, xfer_info, offset, len, last, inject);
+		if (ret == -FI_EAGAIN) {
+			break;
+		} else if (OFI_UNLIKELY(ret != 0)) {
+			if (offset != 0) {
+				/* The stripe will never complete, return
+				   the bytes charged when its first chunk
+				   was posted */
+				nccl_net_ofi_scheduler_xfer_completed(rdma_req_get_device(req)->scheduler,
+								      xfer_info, send_data->xfer_start_ns,
+								      nccl_ofi_stats_now_ns());
+			}
+			break;
+		}
+
+		if (offset == 0) {
+			nccl_net_ofi_scheduler_xfer_posted(rdma_req_get_device(req)->scheduler, xfer_info);
+			NCCL_OFI_TRACE_SEND_WRITE_SEG_START(req->dev_id, xfer_info->rail_id, xfer_info->msg_size,
+							    req->comm, req->msg_seq_num, req);
+		}
+
+		send_data->stripe_posted[stripe] += len;
+		send_data->stripe_last_posted[stripe] = last;
+		if (inject) {
+			*injected = true;
+		} else {
+			send_data->stripe_inflight[stripe]++;
+		}
+	}
+
+	return ret;
+}
+
 static int post_rdma_eager_send(nccl_net_ofi_rdma_req_t *req,
 				nccl_net_ofi_rdma_send_comm_rail_t *comm_rail,
 				nccl_net_ofi_xfer_info_t *xfer_info)
@@ -5374,23 +7634,104 @@ static int post_rdma_eager_send(nccl_net_ofi_rdma_req_t *req,
 	rdma_req_send_data_t *send_data = get_send_data(req);
 	assert(xfer_info->rail_id < send_data->buff_mr_handle->num_rails);
 	int rail_id = xfer_info->rail_id;
-	struct fid_mr *rail_mr_handle = send_data->buff_mr_handle->mr[rail_id];
-	void *desc = fi_mr_desc(rail_mr_handle);
+	void *buff = (void *)((uintptr_t)send_data->buff + xfer_info->offset);
+	bool inject = send_can_inject(send_data, xfer_info->msg_size, max_send_inject_size);
+	nccl_net_ofi_rdma_device_t *device = rdma_req_get_device(req);
 
 	ssize_t rc;
 	/* Post eager send */
-	rc = fi_senddata(comm_rail->local_ep, (void*)(((uintptr_t)send_data->buff) + xfer_info->offset), xfer_info->msg_size, desc,
-			 send_data->wdata, comm_rail->remote_addr, req);
+	if (inject) {
+		rc = fi_injectdata(comm_rail->local_ep, buff, xfer_info->msg_size,
+				   send_data->wdata, comm_rail->remote_addr);
+	} else {
+		void *desc = fi_mr_desc(send_data->buff_mr_handle->mr[rail_id]);
+		rc = fi_senddata(comm_rail->local_ep, buff, xfer_info->msg_size, desc,
+				 send_data->wdata, comm_rail->remote_addr, req);
+	}
+
+	nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_rail(rdma_req_get_ep(req), rail_id);
+	rail_stats_post(rail, &rail->stats.bytes_sent, xfer_info->msg_size, rc);
 
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
-		NCCL_OFI_WARN("fi_senddata failed; RC: %zd, Error: %s", rc, fi_strerror(-rc));
+		NCCL_OFI_WARN("%s failed; RC: %zd, Error: %s",
+			      inject ? "fi_injectdata" : "fi_senddata", rc, fi_strerror(-rc));
 	} else if (rc == 0) {
+		nccl_net_ofi_scheduler_xfer_posted(device->scheduler, xfer_info);
 		NCCL_OFI_TRACE_EAGER_SEND_START(req->dev_id, rail_id, xfer_info->msg_size, req->comm, req->msg_seq_num, req);
+
+		if (inject) {
+			/* No send completion follows an inject */
+			NCCL_OFI_TRACE_EAGER_SEND_COMPLETE(req->dev_id, rail_id, req->comm, req->msg_seq_num, req);
+			schedule_xfer_completed(device, rail_id, send_data->schedule,
+						send_data->xfer_start_ns);
+			rc = inc_req_completion(req, 0, send_data->total_num_compls);
+		}
 	}
 
 	return rc;
 }
 
+/*
+ * @brief	Post the RTS message of a pulled send request
+ *
+ * Nothing is posted if the receiver's ctrl message arrived in the
+ * meantime. If the network is busy, the request falls back to waiting
+ * for the ctrl message rather than being queued, so that the RTS
+ * message is never outstanding once the data is written.
+ *
+ * @return	0, on success or fallback
+ *		error, on others
+ */
+static int post_rdma_rts(nccl_net_ofi_rdma_req_t *req)
+{
+	nccl_net_ofi_rdma_send_comm_t *s_comm = (nccl_net_ofi_rdma_send_comm_t *)req->comm;
+	nccl_net_ofi_rdma_ep_t *ep = (nccl_net_ofi_rdma_ep_t *)s_comm->base.base.ep;
+	rdma_req_send_data_t *send_data = get_send_data(req);
+	nccl_net_ofi_rdma_ctrl_fl_item_t *rts_fl_item = send_data->rts_fl_item;
+	ssize_t rc = 0;
+
+	/* Spread RTS messages over control rails */
+	int rail_id = req->msg_seq_num % s_comm->num_control_rails;
+	nccl_net_ofi_rdma_send_comm_rail_t *comm_rail = rdma_send_comm_get_control_rail(s_comm, rail_id);
+
+	/* Unpack mr_handle */
+	freelist_regmr_fn_handle_t *fl_handle =
+		(freelist_regmr_fn_handle_t *)rts_fl_item->fl_reginfo.mr_handle;
+	nccl_net_ofi_rdma_mr_handle_t *mr_handle = fl_handle->mr_handle;
+	assert(rail_id < mr_handle->num_control_rails);
+	void *desc = fi_mr_desc(mr_handle->control_mr[rail_id]);
+
+	size_t rts_msg_len = nccl_net_ofi_rdma_ctrl_msg_size(ep->num_rails, ep->use_long_rkeys);
+	nccl_net_ofi_ep_rail_t *ep_rail = rdma_endpoint_get_control_rail(ep, rail_id);
+
+	nccl_net_ofi_mutex_lock(&req->req_lock);
+
+	if (!send_data->pull) {
+		/* Ctrl message arrived, data is written instead */
+		goto unlock;
+	}
+
+	rc = fi_send(comm_rail->local_ep, &rts_fl_item->ctrl_msg, rts_msg_len, desc,
+		     comm_rail->remote_addr, req);
+
+	rail_stats_post(ep_rail, &ep_rail->stats.bytes_sent, rts_msg_len, rc);
+
+	if (rc == 0) {
+		send_data->rts_posted = true;
+	} else if (rc == -FI_EAGAIN) {
+		send_data->pull = false;
+		rc = 0;
+	} else {
+		NCCL_OFI_WARN("Error posting RTS message. RC: %zd, Error: %s",
+			      rc, fi_strerror(-rc));
+	}
+
+ unlock:
+	nccl_net_ofi_mutex_unlock(&req->req_lock);
+
+	return (int)rc;
+}
+
 static int post_bounce_buffer(nccl_net_ofi_rdma_req_t *req,
 			      nccl_net_ofi_ep_rail_t *ep_rail,
 			      bool set_fi_more)
@@ -5407,12 +7748,14 @@ static int post_bounce_buffer(nccl_net_ofi_rdma_req_t *req,
 	if (set_fi_more) {
 		flags |= FI_MORE;
 	}
+	if (bounce_data->ep->use_multi_recv) {
+		flags |= FI_MULTI_RECV;
+	}
 
 	/* Reset memcheck guards of bounce buffer freelist entry to
 	 * accessible but undefined to cover cases where the buffer
 	 * gets re-posted */
- 	nccl_net_ofi_rdma_ep_t *ep = bounce_data->ep;
-	nccl_ofi_freelist_entry_set_undefined(ep->bounce_buff_fl,
+	nccl_ofi_freelist_entry_set_undefined(bounce_data->rail->bounce_buff_fl,
 					      bounce_fl_item);
 
 	iov.iov_base = &bounce_fl_item->bounce_msg;
@@ -5426,6 +7769,7 @@ static int post_bounce_buffer(nccl_net_ofi_rdma_req_t *req,
 
 	req->state = NCCL_OFI_RDMA_REQ_CREATED;
 	ssize_t rc = fi_recvmsg(ep_rail->ofi_ep, &msg, flags);
+	rail_stats_post(ep_rail, NULL, 0, rc);
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
 		NCCL_OFI_WARN("Error posting bounce buffer. RC: %zd, Error: %s",
 			      rc, fi_strerror(-rc));
@@ -5439,7 +7783,8 @@ static int post_bounce_buffer(nccl_net_ofi_rdma_req_t *req,
  *		to the network. This can be invoked when submitting a new request
  *		or processing pending requests list.
  *
- * @return	0, if successfully sent
+ * @return	0, if successfully sent, or if the request waits for the
+ *		remote keys of its receive buffer
  *              -EINVAL   Invalid request
  * 		-FI_EAGAIN, if need to retry the xfer
  * 		-1, error
@@ -5474,20 +7819,48 @@ static int send_progress(nccl_net_ofi_rdma_req_t *req)
 				rdma_send_comm_get_rail(s_comm, xfer_info->rail_id);
 
 			ret = post_rdma_eager_send(req, comm_rail, xfer_info);
+		} else if (!resolve_remote_rkeys(s_comm, req)) {
+			/* The keys of the receive buffer have not arrived
+			 * yet. The request waits for them on the
+			 * communicator and is posted once they do. */
+			ret = 0;
 		} else {
-			for (size_t rail_it = send_data->xferred_rail_id; rail_it < schedule->num_xfer_infos; rail_it++) {
-				/* Get xfer information from the schedule */
-				nccl_net_ofi_xfer_info_t *xfer_info = &xfers[rail_it];
-				/* Get communicator rail information to xfer the req */
-				nccl_net_ofi_rdma_send_comm_rail_t *comm_rail =
-					rdma_send_comm_get_rail(s_comm, xfer_info->rail_id);
-
-				ret = post_rdma_write(req, comm_rail, xfer_info);
-
-				if (ret == 0) // Successfully sent the xfer with this rail
-					send_data->xferred_rail_id++;
-				else
+			bool injected[MAX_NUM_RAILS] = { false };
+			int num_injected = 0;
+
+			nccl_net_ofi_mutex_lock(&req->req_lock);
+			send_data->write_pending = false;
+			for (size_t stripe = 0; stripe < schedule->num_xfer_infos; stripe++) {
+				ret = post_rdma_write_chunks(req, stripe, &injected[stripe]);
+				num_injected += injected[stripe] ? 1 : 0;
+				if (ret != 0) {
 					break;
+				}
+			}
+			/* Caller queues the request on EAGAIN */
+			send_data->write_pending = (ret == -FI_EAGAIN);
+			nccl_net_ofi_mutex_unlock(&req->req_lock);
+
+			/* Account injected stripes, which have no
+			   completion. Report them all to the scheduler
+			   first, since the request may be released once
+			   its last completion is accounted. */
+			for (size_t stripe = 0; stripe < schedule->num_xfer_infos; stripe++) {
+				if (injected[stripe]) {
+					NCCL_OFI_TRACE_SEND_WRITE_SEG_COMPLETE(req->dev_id,
+									       xfers[stripe].rail_id,
+									       req->comm, req->msg_seq_num,
+									       req);
+					schedule_xfer_completed(rdma_req_get_device(req), xfers[stripe].rail_id,
+								schedule, send_data->xfer_start_ns);
+				}
+			}
+			int total_num_compls = send_data->total_num_compls;
+			for (int i = 0; i < num_injected; i++) {
+				int rc = inc_req_completion(req, 0, total_num_compls);
+				if (OFI_UNLIKELY(rc != 0)) {
+					return rc;
+				}
 			}
 		}
 	} else if (req->type == NCCL_OFI_RDMA_WRITE) { // Post RMA write
@@ -5544,13 +7917,24 @@ static int post_rdma_ctrl(nccl_net_ofi_rdma_req_t *req)
 	desc = fi_mr_desc(mr_handle->control_mr[rail_id]);
 	NCCL_OFI_TRACE_SEND_CTRL_START(req->dev_id, rail_id, req->comm, req, req->msg_seq_num);
 
-	size_t ctrl_msg_len = nccl_net_ofi_rdma_ctrl_msg_size(ep->num_rails, ep->use_long_rkeys);
+	size_t ctrl_msg_len = nccl_net_ofi_rdma_ctrl_msg_len(&ctrl_fl_item->ctrl_msg, ep->num_rails,
+							     ep->use_long_rkeys);
+	if (send_ctrl_data->group) {
+		ctrl_msg_len = nccl_net_ofi_rdma_ctrl_group_msg_size(send_ctrl_data->batch_count,
+								     ep->num_rails, ep->use_long_rkeys);
+	} else if (send_ctrl_data->batch_count > 1) {
+		ctrl_msg_len = send_ctrl_data->batch_count *
+			nccl_net_ofi_rdma_ctrl_batch_stride(ep->num_rails, ep->use_long_rkeys);
+	}
 
 	ssize_t rc = fi_send(comm_rail->local_ep, &ctrl_fl_item->ctrl_msg,
 			     ctrl_msg_len,
 			     desc,
 			     comm_rail->remote_addr, req);
 
+	nccl_net_ofi_ep_rail_t *ep_rail = rdma_endpoint_get_control_rail(ep, rail_id);
+	rail_stats_post(ep_rail, &ep_rail->stats.bytes_sent, ctrl_msg_len, rc);
+
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
 		NCCL_OFI_WARN("Error posting RDMA ctrl request. RC: %zd, Error: %s",
 			      rc, fi_strerror(-rc));
@@ -5591,6 +7975,11 @@ static int post_close_msg(nccl_net_ofi_rdma_req_t *req)
 			     desc,
 			     comm_rail->remote_addr, req);
 
+	nccl_net_ofi_ep_rail_t *ep_rail = rdma_endpoint_get_rail(rdma_recv_comm_get_ep(r_comm),
+								 xfer_info->rail_id);
+	rail_stats_post(ep_rail, &ep_rail->stats.bytes_sent,
+			sizeof(nccl_net_ofi_rdma_close_msg_t), rc);
+
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
 		NCCL_OFI_WARN("Error posting RDMA close request. RC: %zd, Error: %s",
 			      rc, fi_strerror(-rc));
@@ -5628,7 +8017,7 @@ static int post_eager_copy(nccl_net_ofi_rdma_req_t *req)
 	assert(bounce_rail_id < dest_mr_handle->num_rails);
 	void *desc = fi_mr_desc(dest_mr_handle->mr[bounce_rail_id]);
 
-	void *bounce_buff = &bounce_data->bounce_fl_item->bounce_msg;
+	void *bounce_buff = bounce_data->msg;
 	uint64_t bounce_key = fi_mr_key(bounce_mr_handle->mr[bounce_rail_id]);
 	if (bounce_key == FI_KEY_NOTAVAIL) {
 		NCCL_OFI_WARN("Failed to get bounce_key");
@@ -5639,6 +8028,10 @@ static int post_eager_copy(nccl_net_ofi_rdma_req_t *req)
 			     bounce_data->recv_len, desc, comm_rail->local_addr,
 			     (uint64_t)bounce_buff, bounce_key, req);
 
+	nccl_net_ofi_ep_rail_t *ep_rail = rdma_endpoint_get_rail(rdma_recv_comm_get_ep(r_comm),
+								 bounce_rail_id);
+	rail_stats_post(ep_rail, &ep_rail->stats.bytes_read, bounce_data->recv_len, rc);
+
 	if ((rc != 0) && (rc != -FI_EAGAIN)) {
 		NCCL_OFI_WARN("Error posting RDMA ctrl request. RC: %zd, Error: %s",
 			      rc, fi_strerror(-rc));
@@ -5683,6 +8076,8 @@ static int post_flush_req(nccl_net_ofi_rdma_req_t *req)
 			     f_buff->size, desc, comm_rail->local_addr,
 			     (uint64_t)(virt_addr_mr ? flush_data->data : 0),
 			     cuda_key, req);
+		nccl_net_ofi_ep_rail_t *ep_rail = rdma_endpoint_get_rail(ep, rail_id);
+		rail_stats_post(ep_rail, &ep_rail->stats.bytes_read, f_buff->size, rc);
 		if ((rc != 0) && (rc != -FI_EAGAIN)) {
 			NCCL_OFI_WARN("Error posting flush request. RC: %zd, Error: %s",
 				      rc, fi_strerror(-rc));
@@ -5702,6 +8097,10 @@ static inline int check_post_bounce_req(nccl_net_ofi_rdma_req_t *bounce_req)
 
 	nccl_net_ofi_ep_rail_t *rail = bounce_data->rail;
 
+	if (bounce_data->slab_req != NULL) {
+		return release_slab_msg(bounce_req);
+	}
+
 	nccl_net_ofi_mutex_lock(&rail->bounce_mutex);
 
 	bool need_post = false;
@@ -5741,6 +8140,69 @@ static inline int check_post_bounce_req(nccl_net_ofi_rdma_req_t *bounce_req)
 	return ret;
 }
 
+/*
+ * @brief	Match a send to a buffer of the receive at next_msg_seq_num,
+ *		a grouped receive or a receive of a single buffer
+ *
+ * The buffers of a grouped receive are matched by tag. A receive of a
+ * single buffer matches any tag.
+ *
+ * @param	msg_seq_num
+ *		Set to the message sequence number of the buffer
+ * @param	elem
+ *		Set to the bounce request of the control message of the
+ *		buffer
+ * @return	Index of the buffer in the group, on success
+ *		-EAGAIN, if the control messages did not arrive yet
+ *		error, on others
+ */
+static int match_recv_group(nccl_net_ofi_rdma_send_comm_t *s_comm, int tag,
+			    uint16_t *msg_seq_num, void **elem)
+{
+	nccl_ofi_msgbuff_elemtype_t type;
+	nccl_ofi_msgbuff_status_t msg_stat;
+	nccl_ofi_msgbuff_result_t mb_res;
+	bool missing = false;
+
+	if (s_comm->group_size == 0) {
+		mb_res = nccl_ofi_msgbuff_retrieve(s_comm->msgbuff, s_comm->next_msg_seq_num, elem,
+						   &type, &msg_stat);
+		if (mb_res != NCCL_OFI_MSGBUFF_SUCCESS || type != NCCL_OFI_MSGBUFF_BUFF) {
+			return -EAGAIN;
+		}
+		s_comm->group_size = get_bounce_data((nccl_net_ofi_rdma_req_t *)*elem)->ctrl_group_size;
+		s_comm->group_sent_mask = 0;
+	}
+
+	for (int i = 0; i < s_comm->group_size; i++) {
+		if (s_comm->group_sent_mask & (1U << i)) {
+			continue;
+		}
+
+		*msg_seq_num = (s_comm->next_msg_seq_num + i) & MSG_SEQ_NUM_MASK;
+		mb_res = nccl_ofi_msgbuff_retrieve(s_comm->msgbuff, *msg_seq_num, elem,
+						   &type, &msg_stat);
+		if (mb_res != NCCL_OFI_MSGBUFF_SUCCESS || type != NCCL_OFI_MSGBUFF_BUFF) {
+			/* Still being unpacked */
+			missing = true;
+			continue;
+		}
+
+		if (s_comm->group_size == 1 ||
+		    get_bounce_data((nccl_net_ofi_rdma_req_t *)*elem)->ctrl_tag == tag) {
+			return i;
+		}
+	}
+
+	if (missing) {
+		return -EAGAIN;
+	}
+
+	NCCL_OFI_WARN("No buffer of grouped receive at msg %hu matches tag %d",
+		      s_comm->next_msg_seq_num, tag);
+	return -EINVAL;
+}
+
 /**
  * @brief	Send a message. This "interface function" is called, indirectly, from
  *       	the application
@@ -5757,7 +8219,9 @@ static int send(nccl_net_ofi_send_comm_t *send_comm, void *data, int size, int t
 	bool polled_cq = false;
 	bool have_ctrl = false;
 	bool eager = false;
+	bool pull = false;
 	int dev_id = 0;
+	int group_index = -1;
 
 	assert(s_comm != NULL);
 
@@ -5767,11 +8231,13 @@ static int send(nccl_net_ofi_send_comm_t *send_comm, void *data, int size, int t
 		goto error;
 	}
 
-	/* Support only NCCL_OFI_MAX_REQUESTS inflight requests. */
-	if (OFI_UNLIKELY(s_comm->num_inflight_reqs == NCCL_OFI_MAX_SEND_REQUESTS)) {
+	/* Support only max_inflight_reqs inflight requests. Each send
+	   takes its own message sequence number, also the ones of a
+	   grouped receive. */
+	if (OFI_UNLIKELY(s_comm->num_inflight_reqs == max_inflight_reqs)) {
 		ret = -EINVAL;
-		NCCL_OFI_WARN("Can not support more than %d inflight requests",
-			      NCCL_OFI_MAX_SEND_REQUESTS);
+		NCCL_OFI_WARN("Can not support more than %" PRIu64 " inflight requests",
+			      max_inflight_reqs);
 		goto error;
 	}
 
@@ -5791,11 +8257,6 @@ static int send(nccl_net_ofi_send_comm_t *send_comm, void *data, int size, int t
 		goto error;
 	}
 
-	/*
-	 * TODO: Use NCCL provided tags when using grouped receives aka
-	 * props->maxRecvs > 1.
-	 */
-
 	have_ctrl = false;
 	msg_seq_num = s_comm->next_msg_seq_num;
 
@@ -5804,6 +8265,30 @@ static int send(nccl_net_ofi_send_comm_t *send_comm, void *data, int size, int t
 	nccl_ofi_msgbuff_status_t msg_stat;
 	nccl_ofi_msgbuff_result_t mb_res;
 
+	if (max_recvs > 1) {
+		/* With grouped receives, the send is matched by tag to
+		   a buffer of the receive, so wait for its ctrl message */
+		group_index = match_recv_group(s_comm, tag, &msg_seq_num, &elem);
+		if (group_index == -EAGAIN && !ep->progress_thread_running) {
+			ret = ofi_process_cq(ep);
+			if (OFI_UNLIKELY(ret != 0)) {
+				goto error;
+			}
+			group_index = match_recv_group(s_comm, tag, &msg_seq_num, &elem);
+		}
+		if (group_index == -EAGAIN) {
+			/* Return NULL to NCCL */
+			*base_req = NULL;
+			ret = 0;
+			goto error;
+		} else if (OFI_UNLIKELY(group_index < 0)) {
+			ret = group_index;
+			goto error;
+		}
+		have_ctrl = true;
+		goto matched;
+	}
+
 retry:
 	/* Retrive entry from message buffer for msg_seq_num index */
 	mb_res = nccl_ofi_msgbuff_retrieve(s_comm->msgbuff, msg_seq_num, &elem,
@@ -5843,11 +8328,13 @@ retry:
 
 	/* look for control messages and then retry the message search
 	   to avoid unnecessary polling / queueing. */
-	if (OFI_UNLIKELY(!polled_cq && !have_ctrl)) {
+	if (OFI_UNLIKELY(!polled_cq && !have_ctrl && !ep->progress_thread_running)) {
+		uint64_t num_processed = 0;
+
 		for (int rail_id = 0; rail_id != ep->num_control_rails; ++rail_id) {
 			nccl_net_ofi_ep_rail_t *rail = rdma_endpoint_get_control_rail(ep, rail_id);
 
-			ret = ofi_process_cq_rail(ep, rail);
+			ret = ofi_process_cq_rail(ep, rail, &num_processed);
 			if (OFI_UNLIKELY(ret != 0)) {
 				goto error;
 			}
@@ -5856,14 +8343,19 @@ retry:
 		goto retry;
 	}
 
+ matched:
 	/* Determine if this should be sent eagerly. */
 	eager = false;
 	if ((!have_ctrl && (size_t)size <= eager_max_size) || (size == 0)) {
 		eager = true;
 	}
 
+	/* The sender posted first: offer the buffer to the receiver
+	   instead of waiting for its ctrl message */
+	pull = !have_ctrl && !eager && s_comm->ctrl_buff_fl != NULL;
+
 	ret = alloc_rdma_send_req(s_comm, msg_seq_num, data,
-				  size, mr_handle, eager, &req);
+				  size, mr_handle, eager, pull, &req);
 	if (OFI_UNLIKELY(ret != 0)) {
 		goto error;
 	}
@@ -5898,6 +8390,7 @@ retry:
 	 */
 	(s_comm->num_inflight_reqs)++;
 
+	req->start_ns = nccl_ofi_stats_now_ns();
 	NCCL_OFI_TRACE_SEND(req->dev_id, size, s_comm, msg_seq_num, req, base_req);
 
 	/* Try posting RDMA write for received RDMA control messages */
@@ -5917,15 +8410,37 @@ retry:
 			ret = -ENOTSUP;
 			goto error;
 		}
+	} else if (pull) {
+		ret = post_rdma_rts(req);
+		if (OFI_UNLIKELY(ret != 0)) {
+			goto remove_req;
+		}
 	}
 
 	/* Return request to NCCL */
 	*base_req = &req->base;
-	/* Increment next_msg_seq_num for next call */
-	s_comm->next_msg_seq_num = (s_comm->next_msg_seq_num + 1) & MSG_SEQ_NUM_MASK;
+	if (group_index >= 0) {
+		/* Move to the next receive once all buffers of the
+		   group are matched */
+		s_comm->group_sent_mask |= 1U << group_index;
+		if (s_comm->group_sent_mask == (1U << s_comm->group_size) - 1) {
+			s_comm->next_msg_seq_num =
+				(s_comm->next_msg_seq_num + s_comm->group_size) & MSG_SEQ_NUM_MASK;
+			s_comm->group_size = 0;
+		}
+	} else {
+		/* Increment next_msg_seq_num for next call */
+		s_comm->next_msg_seq_num = (s_comm->next_msg_seq_num + 1) & MSG_SEQ_NUM_MASK;
+	}
 
 	goto exit;
 
+ remove_req:
+	if (nccl_ofi_msgbuff_remove(s_comm->msgbuff, msg_seq_num, &msg_stat) !=
+	    NCCL_OFI_MSGBUFF_SUCCESS) {
+		NCCL_OFI_WARN("Failed to remove msg %hu from message buffer", msg_seq_num);
+	}
+	(s_comm->num_inflight_reqs)--;
  free_req:
  error:
 	if (req)
@@ -6068,6 +8583,116 @@ error:
     return NULL;
 }
 
+/*
+ * @brief	Set up bounce buffer posting of a rail
+ *
+ * @param	min_posted, max_posted
+ *		Posting bounds shared among `num_rails' rails
+ */
+static void init_rail_bounce_buffers(nccl_net_ofi_ep_rail_t *rail,
+				     nccl_ofi_freelist_t *fl, size_t buff_size,
+				     size_t min_posted, size_t max_posted,
+				     int num_rails)
+{
+	/*
+	 * The *_bounce_posted limits are used in the progress engine to
+	 * determine if the receive queue is hydrated with sufficient buffers.
+	 * The parameters account for all the rails, so scale down bounds to
+	 * what a single rail would need.
+	 */
+	rail->min_bounce_posted = NCCL_OFI_DIV_CEIL(min_posted, num_rails);
+	rail->max_bounce_posted = NCCL_OFI_DIV_CEIL(max_posted, num_rails);
+	rail->num_bounce_posted = 0;
+	rail->bounce_buff_fl = fl;
+	rail->bounce_buff_size = buff_size;
+	rail->stats.bounce_low_water = rail->max_bounce_posted;
+	nccl_net_ofi_mutex_init(&rail->bounce_mutex, NULL);
+}
+
+/*
+ * @brief	Set the space left in a multi-receive slab of the rail
+ *		below which the provider releases the slab
+ */
+static int set_min_multi_recv(nccl_net_ofi_ep_rail_t *rail, size_t min_size)
+{
+	int ret = fi_setopt(&rail->ofi_ep->fid, FI_OPT_ENDPOINT, FI_OPT_MIN_MULTI_RECV,
+			    &min_size, sizeof(min_size));
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to set FI_OPT_MIN_MULTI_RECV. RC: %d, ERROR: %s",
+			      ret, fi_strerror(-ret));
+	}
+
+	return ret;
+}
+
+/*
+ * @brief	Initialize the multi-receive slabs of endpoint, which are
+ *		posted on all rails in place of control and eager bounce
+ *		buffers
+ */
+static int init_slab_bounce_buffers(nccl_net_ofi_rdma_ep_t *ep)
+{
+	int ret = 0;
+	nccl_net_ofi_ep_rail_t *rail;
+	size_t max_slabs = (size_t)ofi_nccl_rdma_multi_recv_slabs();
+	/* Leave room to post slabs in place of the ones whose messages
+	   are still in use */
+	size_t min_slabs = NCCL_OFI_DIV_CEIL(max_slabs, 2);
+
+	ep->ctrl_bounce_buff_fl = NULL;
+	ep->eager_bounce_buff_fl = NULL;
+
+	ret = nccl_ofi_freelist_init_mr(sizeof(nccl_net_ofi_rdma_bounce_fl_item_t) + ep->slab_bounce_buff_size,
+					max_slabs * (ep->num_rails + ep->num_control_rails),
+					max_slabs, 0,
+					freelist_regmr_host_fn, freelist_deregmr_host_fn,
+					ep, 0, BOUNCE_BUFFER_ALIGNMENT,
+					ofi_nccl_rdma_bounce_huge_pages() != 0,
+					rdma_endpoint_get_device(ep)->numa_node,
+					NCCL_OFI_FREELIST_MODE_DEFAULT, &ep->slab_bounce_buff_fl);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to init slab_bounce_buff_fl");
+		return ret;
+	}
+
+	/* A slab is released once it cannot hold the largest message
+	   of its rail */
+	for (int rail_id = 0; rail_id < ep->num_control_rails; ++rail_id) {
+		rail = rdma_endpoint_get_control_rail(ep, rail_id);
+		ret = set_min_multi_recv(rail, ep->ctrl_bounce_buff_size);
+		if (ret != 0) {
+			goto error;
+		}
+	}
+
+	for (int rail_id = 0; rail_id < ep->num_rails; ++rail_id) {
+		rail = rdma_endpoint_get_rail(ep, rail_id);
+		ret = set_min_multi_recv(rail, ep->eager_bounce_buff_size);
+		if (ret != 0) {
+			goto error;
+		}
+	}
+
+	for (int rail_id = 0; rail_id < ep->num_control_rails; ++rail_id) {
+		rail = rdma_endpoint_get_control_rail(ep, rail_id);
+		init_rail_bounce_buffers(rail, ep->slab_bounce_buff_fl, ep->slab_bounce_buff_size,
+					 min_slabs, max_slabs, 1);
+	}
+
+	for (int rail_id = 0; rail_id < ep->num_rails; ++rail_id) {
+		rail = rdma_endpoint_get_rail(ep, rail_id);
+		init_rail_bounce_buffers(rail, ep->slab_bounce_buff_fl, ep->slab_bounce_buff_size,
+					 min_slabs, max_slabs, 1);
+	}
+
+	return ret;
+
+ error:
+	if (nccl_ofi_freelist_fini(ep->slab_bounce_buff_fl))
+		NCCL_OFI_WARN("Also failed to freelist_fini slab_bounce_buff_fl");
+	return ret;
+}
+
 /*
  * @brief	Initialize bounce buffer data of endpoint
  *
@@ -6083,55 +8708,71 @@ static inline int init_bounce_buffers(nccl_net_ofi_rdma_ep_t *ep)
 	nccl_net_ofi_ep_rail_t *rail;
 
 	ret = nccl_ofi_freelist_init(sizeof(nccl_net_ofi_rdma_req_t),
-				     ofi_nccl_rdma_min_posted_bounce_buffers(), 16, 0,
-				     &ep->bounce_buff_reqs_fl);
+				     ofi_nccl_rdma_min_posted_bounce_buffers() +
+				     ofi_nccl_rdma_min_posted_control_buffers(), 16, 0,
+				     NCCL_OFI_FREELIST_MODE_DEFAULT, &ep->bounce_buff_reqs_fl);
 	if (ret != 0) {
 		NCCL_OFI_WARN("Failed to init bounce_buff_reqs_fl");
 		return ret;
 	}
 
-	ret = nccl_ofi_freelist_init_mr(sizeof(nccl_net_ofi_rdma_bounce_fl_item_t) + ep->bounce_buff_size,
+	if (ep->use_multi_recv) {
+		ret = init_slab_bounce_buffers(ep);
+		if (ret != 0) {
+			goto error_reqs;
+		}
+		return ret;
+	}
+
+	ret = nccl_ofi_freelist_init_mr(sizeof(nccl_net_ofi_rdma_bounce_fl_item_t) + ep->ctrl_bounce_buff_size,
+					ofi_nccl_rdma_min_posted_control_buffers(), 16, 0,
+					freelist_regmr_host_fn, freelist_deregmr_host_fn,
+					ep, 0, BOUNCE_BUFFER_ALIGNMENT,
+					ofi_nccl_rdma_bounce_huge_pages() != 0,
+					rdma_endpoint_get_device(ep)->numa_node,
+					NCCL_OFI_FREELIST_MODE_DEFAULT, &ep->ctrl_bounce_buff_fl);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to init ctrl_bounce_buff_fl");
+		goto error_reqs;
+	}
+
+	ret = nccl_ofi_freelist_init_mr(sizeof(nccl_net_ofi_rdma_bounce_fl_item_t) + ep->eager_bounce_buff_size,
 					ofi_nccl_rdma_min_posted_bounce_buffers(), 16, 0,
 					freelist_regmr_host_fn, freelist_deregmr_host_fn,
-					ep, 0, BOUNCE_BUFFER_ALIGNMENT, &ep->bounce_buff_fl);
+					ep, 0, BOUNCE_BUFFER_ALIGNMENT,
+					ofi_nccl_rdma_bounce_huge_pages() != 0,
+					rdma_endpoint_get_device(ep)->numa_node,
+					NCCL_OFI_FREELIST_MODE_DEFAULT, &ep->eager_bounce_buff_fl);
 	if (ret != 0) {
-		NCCL_OFI_WARN("Failed to init bounce_buff_fl");
-		if (nccl_ofi_freelist_fini(ep->bounce_buff_reqs_fl))
-			NCCL_OFI_WARN("Also failed to freelist_fini bounce_buff_reqs_fl");
-		return ret;
+		NCCL_OFI_WARN("Failed to init eager_bounce_buff_fl");
+		goto error_ctrl;
 	}
 
-	/*
-	 * The *_bounce_posted limits are used in the progress engine to
-	 * determine if the receive queue is hydrated with sufficient buffers.
-	 * The parameters account for all the rails, so scale down bounds to
-	 * what a single rail would need.
-	 */
 	for (int rail_id = 0; rail_id < ep->num_control_rails; ++rail_id) {
 		rail = rdma_endpoint_get_control_rail(ep, rail_id);
-		rail->min_bounce_posted = NCCL_OFI_DIV_CEIL(
-			ofi_nccl_rdma_min_posted_bounce_buffers(), ep->num_control_rails
-		);
-		rail->max_bounce_posted = NCCL_OFI_DIV_CEIL(
-			ofi_nccl_rdma_max_posted_bounce_buffers(), ep->num_control_rails
-		);
-		rail->num_bounce_posted = 0;
-		nccl_net_ofi_mutex_init(&rail->bounce_mutex, NULL);
+		init_rail_bounce_buffers(rail, ep->ctrl_bounce_buff_fl, ep->ctrl_bounce_buff_size,
+					 ofi_nccl_rdma_min_posted_control_buffers(),
+					 ofi_nccl_rdma_max_posted_control_buffers(),
+					 ep->num_control_rails);
 	}
 
 	for (int rail_id = 0; rail_id < ep->num_rails; ++rail_id) {
 		rail = rdma_endpoint_get_rail(ep, rail_id);
-		rail->min_bounce_posted = NCCL_OFI_DIV_CEIL(
-			ofi_nccl_rdma_min_posted_bounce_buffers(), ep->num_rails
-		);
-		rail->max_bounce_posted = NCCL_OFI_DIV_CEIL(
-			ofi_nccl_rdma_max_posted_bounce_buffers(), ep->num_rails
-		);
-		rail->num_bounce_posted = 0;
-		nccl_net_ofi_mutex_init(&rail->bounce_mutex, NULL);
+		init_rail_bounce_buffers(rail, ep->eager_bounce_buff_fl, ep->eager_bounce_buff_size,
+					 ofi_nccl_rdma_min_posted_bounce_buffers(),
+					 ofi_nccl_rdma_max_posted_bounce_buffers(),
+					 ep->num_rails);
 	}
 
 	return ret;
+
+ error_ctrl:
+	if (nccl_ofi_freelist_fini(ep->ctrl_bounce_buff_fl))
+		NCCL_OFI_WARN("Also failed to freelist_fini ctrl_bounce_buff_fl");
+ error_reqs:
+	if (nccl_ofi_freelist_fini(ep->bounce_buff_reqs_fl))
+		NCCL_OFI_WARN("Also failed to freelist_fini bounce_buff_reqs_fl");
+	return ret;
 }
 
 /*
@@ -6148,10 +8789,24 @@ static inline int fini_bounce_buffers(nccl_net_ofi_rdma_ep_t *ep)
 	int ret = 0;
 	nccl_net_ofi_ep_rail_t *rail;
 
-	ret = nccl_ofi_freelist_fini(ep->bounce_buff_fl);
-	if (ret != 0) {
-		NCCL_OFI_WARN("Failed to fini bounce_buff_fl");
-		return ret;
+	if (ep->use_multi_recv) {
+		ret = nccl_ofi_freelist_fini(ep->slab_bounce_buff_fl);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to fini slab_bounce_buff_fl");
+			return ret;
+		}
+	} else {
+		ret = nccl_ofi_freelist_fini(ep->eager_bounce_buff_fl);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to fini eager_bounce_buff_fl");
+			return ret;
+		}
+
+		ret = nccl_ofi_freelist_fini(ep->ctrl_bounce_buff_fl);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to fini ctrl_bounce_buff_fl");
+			return ret;
+		}
 	}
 
 	ret = nccl_ofi_freelist_fini(ep->bounce_buff_reqs_fl);
@@ -6203,11 +8858,13 @@ static int rma_write_impl(nccl_net_ofi_send_comm_t *send_comm, void* src, size_t
 
 	assert(s_comm != NULL);
 
-	/* Support only NCCL_OFI_MAX_REQUESTS inflight requests. */
-	if (OFI_UNLIKELY(s_comm->num_inflight_reqs == NCCL_OFI_MAX_SEND_REQUESTS)) {
+	/* Support only max_inflight_reqs inflight requests. Each send
+	   takes its own message sequence number, also the ones of a
+	   grouped receive. */
+	if (OFI_UNLIKELY(s_comm->num_inflight_reqs == max_inflight_reqs)) {
 		ret = -EINVAL;
-		NCCL_OFI_WARN("Can not support more than %d inflight requests",
-			      NCCL_OFI_MAX_SEND_REQUESTS);
+		NCCL_OFI_WARN("Can not support more than %" PRIu64 " inflight requests",
+			      max_inflight_reqs);
 		goto error;
 	}
 
@@ -6363,11 +9020,15 @@ static inline int create_send_comm(nccl_net_ofi_conn_handle_t *handle,
 
 	ret_s_comm->comm_active = true;
 	ret_s_comm->next_msg_seq_num = 0;
+	ret_s_comm->group_size = 0;
+	ret_s_comm->group_sent_mask = 0;
 	memset(&ret_s_comm->cleanup_list_elem, 0, sizeof(ret_s_comm->cleanup_list_elem));
 
 	ret_s_comm->received_close_message = false;
 	ret_s_comm->n_ctrl_received = 0;
 	ret_s_comm->n_ctrl_expected = 0;
+	memset(ret_s_comm->remote_rkeys, 0, sizeof(ret_s_comm->remote_rkeys));
+	ret_s_comm->rkey_waiters = NULL;
 
 	/* Store communicator ID from handle in communicator */
 	if (OFI_UNLIKELY(handle->comm_id >= device->num_comm_ids)) {
@@ -6388,7 +9049,10 @@ static inline int create_send_comm(nccl_net_ofi_conn_handle_t *handle,
 	ret_s_comm->local_comm_id = (uint32_t)comm_id;
 
 	/* Add ourselves to ep's lookup array */
-	rdma_device_set_comm(device, ret_s_comm->local_comm_id, &ret_s_comm->base.base);
+	ret = rdma_device_set_comm(device, ret_s_comm->local_comm_id, &ret_s_comm->base.base);
+	if (OFI_UNLIKELY(ret != 0)) {
+		goto error;
+	}
 
 	/* Allocate communicator rails array */
 	ret_s_comm->num_rails = num_rails;
@@ -6414,20 +9078,29 @@ static inline int create_send_comm(nccl_net_ofi_conn_handle_t *handle,
 	ret_s_comm->num_init_control_rails = 1;
 
 	/* Allocate request free list */
-	ret = nccl_ofi_freelist_init(sizeof(nccl_net_ofi_rdma_req_t), 16, 16,
-				     NCCL_OFI_MAX_SEND_REQUESTS, &ret_s_comm->nccl_ofi_reqs_fl);
+	ret = comm_reqs_fl_init(ep, max_inflight_reqs, &ret_s_comm->nccl_ofi_reqs_fl);
 	if (OFI_UNLIKELY(ret != 0)) {
 		NCCL_OFI_WARN("Could not allocate NCCL OFI request free list for dev %d rail %d",
 			      dev_id, rail_id);
 		goto error;
 	}
 
+	/* Allocate RTS message free list of the pull rendezvous */
+	if (pull_rendezvous) {
+		ret = comm_ctrl_buff_fl_init(ep, sizeof(nccl_net_ofi_rdma_ctrl_fl_item_t),
+					     max_inflight_reqs, &ret_s_comm->ctrl_buff_fl);
+		if (OFI_UNLIKELY(ret != 0)) {
+			NCCL_OFI_WARN("Call to freelist_init_mr failed: %d", ret);
+			goto error;
+		}
+	}
+
 	/* Allocate and initialize connect message */
 	prepare_send_connect_message(ep, dev_id, ret_s_comm->local_comm_id, ret_s_comm->remote_comm_id, handle,
 				     &ret_s_comm->conn_msg);
 
 	/* Allocate message buffer */
-	ret_s_comm->msgbuff = nccl_ofi_msgbuff_init(NCCL_OFI_RDMA_MSGBUFF_SIZE, NCCL_OFI_RDMA_SEQ_BITS);
+	ret_s_comm->msgbuff = nccl_ofi_msgbuff_init((uint16_t)(2 * max_inflight_reqs), NCCL_OFI_RDMA_SEQ_BITS);
 	if (!ret_s_comm->msgbuff) {
 		NCCL_OFI_WARN("Failed to allocate and initialize message buffer");
 		ret = -ENOMEM;
@@ -6443,13 +9116,20 @@ static inline int create_send_comm(nccl_net_ofi_conn_handle_t *handle,
 		ret_s_comm->nvtx_domain[i] = nvtxDomainCreateA(name);
 	}
 #endif
+
+	nccl_ofi_stats_register(&ret_s_comm->stats.entry, rdma_comm_stats_dump,
+				"send_comm %u dev %d ep %p", ret_s_comm->local_comm_id, dev_id, ep);
 	*s_comm = ret_s_comm;
 	return ret;
 
 
  error:
 	if (ret_s_comm) {
+		if (ret_s_comm->ctrl_buff_fl) {
+			nccl_ofi_freelist_fini(ret_s_comm->ctrl_buff_fl);
+		}
 		if (COMM_ID_INVALID != ret_s_comm->local_comm_id) {
+			rdma_device_set_comm(device, ret_s_comm->local_comm_id, NULL);
 			if (0 != nccl_ofi_idpool_free_id(device->comm_idpool, ret_s_comm->local_comm_id)) {
 				NCCL_OFI_WARN("Error freeing communicator ID %" PRIu32, ret_s_comm->local_comm_id);
 			}
@@ -6864,6 +9544,7 @@ static int ep_rail_init(nccl_net_ofi_rdma_ep_t *ep,
 	}
 
 	ep_rail->rail_id = rail_id;
+	ep_rail->cq_read_batch = cq_read_count;
 
 	ret = set_local_address(ep_rail->ofi_ep, ep_rail);
 	if (ret != 0) {
@@ -6976,6 +9657,82 @@ static int nccl_net_ofi_rdma_endpoint_release(nccl_net_ofi_ep_t *base_ep)
 }
 
 
+/*
+ * @brief	Initialize the free lists of requests and control buffers
+ *		shared by the communicators of an endpoint
+ *
+ * Communicators draw from these free lists with a quota each, so that
+ * memory and memory registrations grow with the number of requests in
+ * use rather than with the number of communicators.
+ *
+ * @return	0, on success
+ *		non-zero, on error
+ */
+static int init_comm_pools(nccl_net_ofi_rdma_ep_t *ep)
+{
+	int ret;
+
+	ep->comm_reqs_fl = NULL;
+	ep->comm_ctrl_buff_fl = NULL;
+
+	if (!shared_comm_pools) {
+		return 0;
+	}
+
+	ret = nccl_ofi_freelist_init(sizeof(nccl_net_ofi_rdma_req_t), 16, 64, 0,
+				     NCCL_OFI_FREELIST_MODE_DEFAULT, &ep->comm_reqs_fl);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to init comm_reqs_fl");
+		return ret;
+	}
+
+	ret = nccl_ofi_freelist_init_mr(comm_ctrl_buff_size(), 8, 64, 0,
+					freelist_regmr_host_fn, freelist_deregmr_host_fn,
+					ep, 0, 1, false, rdma_endpoint_get_device(ep)->numa_node,
+					NCCL_OFI_FREELIST_MODE_DEFAULT, &ep->comm_ctrl_buff_fl);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Failed to init comm_ctrl_buff_fl");
+		if (nccl_ofi_freelist_fini(ep->comm_reqs_fl))
+			NCCL_OFI_WARN("Also failed to freelist_fini comm_reqs_fl");
+		ep->comm_reqs_fl = NULL;
+		return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * @brief	Finalize the free lists shared by the communicators of an
+ *		endpoint. All communicators of the endpoint must be closed.
+ *
+ * @return	0, on success
+ *		non-zero, on error
+ */
+static int fini_comm_pools(nccl_net_ofi_rdma_ep_t *ep)
+{
+	int ret;
+
+	if (ep->comm_ctrl_buff_fl) {
+		ret = nccl_ofi_freelist_fini(ep->comm_ctrl_buff_fl);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to fini comm_ctrl_buff_fl");
+			return ret;
+		}
+		ep->comm_ctrl_buff_fl = NULL;
+	}
+
+	if (ep->comm_reqs_fl) {
+		ret = nccl_ofi_freelist_fini(ep->comm_reqs_fl);
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to fini comm_reqs_fl");
+			return ret;
+		}
+		ep->comm_reqs_fl = NULL;
+	}
+
+	return 0;
+}
+
 static int nccl_net_ofi_rdma_endpoint_free(nccl_net_ofi_ep_t *base_ep)
 {
 	int ret = 0;
@@ -6991,6 +9748,10 @@ static int nccl_net_ofi_rdma_endpoint_free(nccl_net_ofi_ep_t *base_ep)
 
 	device = (nccl_net_ofi_rdma_device_t *)ep->base.device;
 
+	progress_thread_stop(ep);
+
+	nccl_ofi_stats_unregister(&ep->stats_entry);
+
 	/* Ideally we would "un-post" the bounce buffers, but this
 	   should be accomplished by closing the endpoint. */
 	release_rdma_ep_resources(ep, device->base.dev_id);
@@ -7000,6 +9761,11 @@ static int nccl_net_ofi_rdma_endpoint_free(nccl_net_ofi_ep_t *base_ep)
 		return ret;
 	}
 
+	ret = fini_comm_pools(ep);
+	if (ret != 0) {
+		return ret;
+	}
+
 	ret = nccl_ofi_deque_finalize(ep->pending_reqs_queue);
 	if (ret != 0) {
 		NCCL_OFI_WARN("Failed to finalize pending_reqs_queue: %d", ret);
@@ -7032,6 +9798,7 @@ static inline int init_max_write_inline_size_if_not_initialized(nccl_net_ofi_rdm
 		} else {
 			NCCL_OFI_WARN("Failed to retrieve maximum write inline size");
 		}
+		max_send_inject_size = device->device_rails[0].info->tx_attr->inject_size;
 	}
 	return ret;
 }
@@ -7102,14 +9869,18 @@ static int nccl_net_ofi_rdma_device_create_endpoint(nccl_net_ofi_device_t *base_
 		goto error;
 	}
 
-	ret = nccl_ofi_deque_init(&ep->pending_reqs_queue);
+	ret = nccl_ofi_deque_init_mode(&ep->pending_reqs_queue, pending_queue_mode);
 	if (ret != 0) {
 		NCCL_OFI_WARN("Failed to init pending_reqs_queue: %d", ret);
 		goto error;
 	}
 
-	ep->bounce_buff_size = NCCL_OFI_MAX(NCCL_OFI_MAX(sizeof(nccl_net_ofi_rdma_ctrl_msg_t), eager_max_size),
-						sizeof(nccl_ofi_rdma_connection_info_t));
+	ep->ctrl_bounce_buff_size = NCCL_OFI_MAX(NCCL_OFI_MAX(ctrl_send_max_size(),
+							      sizeof(nccl_net_ofi_rdma_close_msg_t)),
+						 sizeof(nccl_ofi_rdma_connection_info_t));
+	ep->eager_bounce_buff_size = eager_max_size;
+	ep->use_multi_recv = multi_recv;
+	ep->slab_bounce_buff_size = multi_recv_slab_size;
 
 	ep->is_endpoint_per_communicator_ep = false;
 
@@ -7124,6 +9895,12 @@ static int nccl_net_ofi_rdma_device_create_endpoint(nccl_net_ofi_device_t *base_
 		goto error;
 	}
 
+	ret = init_comm_pools(ep);
+	if (ret != 0) {
+		NCCL_OFI_WARN("Preparation of communicator pools failed");
+		goto error;
+	}
+
 	/* Post all bounce buffers */
 	ret = post_bounce_buffs(ep);
 	if (ret != 0) {
@@ -7131,6 +9908,14 @@ static int nccl_net_ofi_rdma_device_create_endpoint(nccl_net_ofi_device_t *base_
 		goto error;
 	}
 
+	nccl_ofi_stats_register(&ep->stats_entry, rdma_ep_stats_dump,
+				"ep %p dev %d", ep, device->base.dev_id);
+
+	ret = progress_thread_start(ep);
+	if (ret != 0) {
+		goto error;
+	}
+
 	NCCL_OFI_TRACE(NCCL_NET, "RDMA endpoint %p for dev #%d is created",
 			ep,
 			device->base.dev_id);
@@ -7343,6 +10128,13 @@ nccl_net_ofi_rdma_device_release(nccl_net_ofi_device_t *base_device)
 		NCCL_OFI_INFO(NCCL_NET, "%u endpoints still active at close", num_endpoints);
 	}
 
+	/* Retained registrations belong to the device domains */
+	if (device->base.mr_cache) {
+		nccl_net_ofi_mutex_lock(&device->base.mr_cache->lock);
+		nccl_ofi_mr_cache_flush(device->base.mr_cache);
+		nccl_net_ofi_mutex_unlock(&device->base.mr_cache->lock);
+	}
+
 	if (device->device_rails != NULL) {
 		release_device_ofi_resources(device);
 		free(device->device_rails);
@@ -7359,9 +10151,11 @@ nccl_net_ofi_rdma_device_release(nccl_net_ofi_device_t *base_device)
 		}
 	}
 
-	if (device->comms) {
-		free(device->comms);
-		device->comms = NULL;
+	for (int i = 0; i < NCCL_OFI_RDMA_NUM_COMM_PAGES; i++) {
+		if (device->comm_pages[i] != NULL && device->comm_pages[i] != rdma_comm_empty_page) {
+			free(device->comm_pages[i]);
+		}
+		device->comm_pages[i] = NULL;
 	}
 
 	if (device->comm_idpool) {
@@ -7394,6 +10188,34 @@ nccl_net_ofi_rdma_device_release(nccl_net_ofi_device_t *base_device)
 }
 
 
+/*
+ * @brief	Deregister an unused MR evicted from the MR cache
+ */
+static int rdma_mr_cache_dereg(void *opaque, void *handle)
+{
+	nccl_net_ofi_rdma_device_t *device = (nccl_net_ofi_rdma_device_t *)opaque;
+
+	return dereg_mr_ep((nccl_net_ofi_rdma_mr_handle_t *)handle,
+			   &device->base.mr_rkey_pool, NULL);
+}
+
+/**
+ * Identify the allocation backing a registered buffer for the MR cache.
+ * Only CUDA allocations carry an identity that changes when their memory
+ * is reallocated, so other buffers are never retained.
+ */
+static uint64_t rdma_mr_cache_alloc_id(void *opaque, uintptr_t addr)
+{
+#if HAVE_CUDA
+	uint64_t buffer_id;
+
+	if (nccl_net_ofi_cuda_get_buffer_id((const void *)addr, &buffer_id) == 0) {
+		return buffer_id;
+	}
+#endif
+	return 0;
+}
+
 /**
  * Create an rdma device object
  */
@@ -7424,6 +10246,40 @@ static nccl_net_ofi_rdma_device_t *nccl_net_ofi_rdma_device_create(
 	/* at this point, we can safely call the destructor to clean
 	 * up */
 
+	/* Bind registered buffer pools to the NUMA node of the leader NIC */
+	device->numa_node = -1;
+	if (ofi_nccl_rdma_numa_bind()) {
+		ret = nccl_ofi_topo_get_numa_node(topo, info_list, &device->numa_node);
+		if (ret != 0) {
+			/* Not fatal, buffer pools are allocated with the
+			 * default memory policy instead */
+			NCCL_OFI_WARN("Unable to find NUMA node of device %i. Buffer pools are not bound",
+				      dev_id);
+			device->numa_node = -1;
+			ret = 0;
+		} else {
+			NCCL_OFI_INFO(NCCL_INIT | NCCL_NET, "Device %i buffer pools bound to NUMA node %d",
+				      dev_id, device->numa_node);
+		}
+	}
+
+	/* Pin progress threads to the CPUs local to the leader NIC */
+	CPU_ZERO(&device->progress_cpuset);
+	if (ofi_nccl_progress_thread() && ofi_nccl_progress_thread_pin()) {
+		ret = nccl_ofi_topo_get_cpuset(topo, info_list, &device->progress_cpuset);
+		if (ret != 0) {
+			/* Not fatal, progress threads with an empty
+			 * cpuset keep the affinity they inherit */
+			NCCL_OFI_WARN("Unable to find CPUs local to device %i. Progress threads are not pinned",
+				      dev_id);
+			CPU_ZERO(&device->progress_cpuset);
+			ret = 0;
+		} else {
+			NCCL_OFI_INFO(NCCL_INIT | NCCL_NET, "Device %i progress threads pinned to %d CPUs",
+				      dev_id, CPU_COUNT(&device->progress_cpuset));
+		}
+	}
+
 	/* Ensure that number of rails are the same across devices */
 	length = ofi_info_list_length(info_list);
 	if (topo->max_group_size != length) {
@@ -7433,7 +10289,14 @@ static nccl_net_ofi_rdma_device_t *nccl_net_ofi_rdma_device_create(
 	}
 
 	/* Create scheduler */
-	ret = nccl_net_ofi_threshold_scheduler_init(length, min_strip_size, &device->scheduler);
+	if (0 == strcasecmp(ofi_nccl_scheduler(), "adaptive")) {
+		ret = nccl_net_ofi_adaptive_scheduler_init(length, min_strip_size, &device->scheduler);
+	} else if (0 == strcasecmp(ofi_nccl_scheduler(), "threshold")) {
+		ret = nccl_net_ofi_threshold_scheduler_init(length, min_strip_size, &device->scheduler);
+	} else {
+		NCCL_OFI_WARN("Invalid value for OFI_NCCL_SCHEDULER: %s", ofi_nccl_scheduler());
+		ret = -EINVAL;
+	}
 	if (ret != 0) {
 		goto error;
 	}
@@ -7474,14 +10337,10 @@ static nccl_net_ofi_rdma_device_t *nccl_net_ofi_rdma_device_create(
 		goto error;
 	}
 
-	/* Create array of comms. */
-	/* TODO make this array expandable */
-	device->comms = (nccl_net_ofi_comm_t**)calloc(NCCL_OFI_RDMA_MAX_COMMS,
-		sizeof(nccl_net_ofi_comm_t*));
-	if (!device->comms) {
-		NCCL_OFI_WARN("Failed to alloc comms array");
-		ret = -ENOMEM;
-		goto error;
+	/* Create table of comms. Pages are allocated as comm IDs get
+	   used. */
+	for (int i = 0; i < NCCL_OFI_RDMA_NUM_COMM_PAGES; i++) {
+		device->comm_pages[i] = rdma_comm_empty_page;
 	}
 
 	/* Initialize device ID pool */
@@ -7499,6 +10358,21 @@ static nccl_net_ofi_rdma_device_t *nccl_net_ofi_rdma_device_create(
 		goto error;
 	}
 
+	/*
+	 * Keep unused registrations in the MR cache. Only possible when
+	 * registrations are tied to the device domains, since retained
+	 * MRs outlive the endpoint that registered them.
+	 */
+	if (device->base.mr_cache && !plugin->domain_per_thread && !endpoint_mr &&
+	    (ofi_nccl_mr_cache_max_unused_entries() || ofi_nccl_mr_cache_max_unused_bytes())) {
+		nccl_ofi_mr_cache_set_retention(device->base.mr_cache,
+						ofi_nccl_mr_cache_max_unused_entries(),
+						ofi_nccl_mr_cache_max_unused_bytes(),
+						rdma_mr_cache_dereg, rdma_mr_cache_alloc_id, device);
+		NCCL_OFI_INFO(NCCL_INIT | NCCL_NET,
+			      "Retaining unused MR cache registrations of CUDA buffers");
+	}
+
 	/* NVTX domain */
 #if HAVE_NVTX_TRACING && NCCL_OFI_NVTX_TRACE_PER_DEV
 	for (int i = 0; i < device->num_rails; ++i) {
@@ -7759,6 +10633,103 @@ int nccl_net_ofi_rdma_init(const char *provider_filter,
 	}
 	eager_max_size = (size_t) ofi_nccl_eager_max_size();
 
+	pull_rendezvous = ofi_nccl_pull_rendezvous() != 0;
+	if (pull_rendezvous && !virt_addr_mr) {
+		NCCL_OFI_INFO(NCCL_INIT | NCCL_NET,
+			      "Pull rendezvous requires remote virtual addressing, disabling it");
+		pull_rendezvous = false;
+	}
+
+	if (ofi_nccl_write_chunk_window() < 1) {
+		NCCL_OFI_WARN("Invalid value for WRITE_CHUNK_WINDOW");
+		ret = -EINVAL;
+		goto error;
+	}
+	write_chunk_window = (int)ofi_nccl_write_chunk_window();
+	eager_cpu_copy = ofi_nccl_eager_cpu_copy() != 0;
+	cpu_copy_nt_threshold = (size_t)ofi_nccl_cpu_copy_nt_threshold();
+
+	if (ofi_nccl_ctrl_batch_max() < 1 || ofi_nccl_ctrl_batch_max() > NCCL_OFI_RDMA_CTRL_BATCH_MAX) {
+		NCCL_OFI_WARN("Invalid value for CTRL_BATCH_MAX");
+		ret = -EINVAL;
+		goto error;
+	}
+	ctrl_batch_max = (int)ofi_nccl_ctrl_batch_max();
+	ctrl_batch_timeout_ns = (uint64_t)ofi_nccl_ctrl_batch_timeout() * 1000;
+
+	if (ofi_nccl_rdma_rkey_cache_size() < 0 ||
+	    ofi_nccl_rdma_rkey_cache_size() > NCCL_OFI_RDMA_RKEY_CACHE_MAX) {
+		NCCL_OFI_WARN("Invalid value for RDMA_RKEY_CACHE_SIZE");
+		ret = -EINVAL;
+		goto error;
+	}
+	rkey_cache_size = (int)ofi_nccl_rdma_rkey_cache_size();
+
+	if (ofi_nccl_rdma_max_recvs() < 1 || ofi_nccl_rdma_max_recvs() > NCCL_OFI_MAX_RECVS) {
+		NCCL_OFI_WARN("Invalid value for RDMA_MAX_RECVS");
+		ret = -EINVAL;
+		goto error;
+	}
+	max_recvs = (int)ofi_nccl_rdma_max_recvs();
+
+	if (ofi_nccl_rdma_max_inflight_reqs() < NCCL_OFI_MAX_REQUESTS ||
+	    ofi_nccl_rdma_max_inflight_reqs() > NCCL_OFI_RDMA_MAX_INFLIGHT_REQUESTS) {
+		NCCL_OFI_WARN("Invalid value for RDMA_MAX_INFLIGHT_REQS, must be between %d and %d",
+			      NCCL_OFI_MAX_REQUESTS, NCCL_OFI_RDMA_MAX_INFLIGHT_REQUESTS);
+		ret = -EINVAL;
+		goto error;
+	}
+	max_inflight_reqs = (uint64_t)ofi_nccl_rdma_max_inflight_reqs();
+
+	rdma_inject = ofi_nccl_rdma_inject() != 0;
+
+	shared_comm_pools = ofi_nccl_rdma_shared_comm_pools() != 0;
+
+	flush_buff_idle_timeout_ns = (uint64_t)ofi_nccl_rdma_flush_buff_idle_timeout() * 1000000;
+
+	if (0 == strcasecmp(ofi_nccl_rdma_pending_queue_mode(), "mutex")) {
+		pending_queue_mode = NCCL_OFI_DEQUE_MODE_MUTEX;
+	} else if (0 == strcasecmp(ofi_nccl_rdma_pending_queue_mode(), "mpsc")) {
+		pending_queue_mode = NCCL_OFI_DEQUE_MODE_MPSC;
+	} else {
+		NCCL_OFI_WARN("Invalid value for RDMA_PENDING_QUEUE_MODE: %s",
+			      ofi_nccl_rdma_pending_queue_mode());
+		ret = -EINVAL;
+		goto error;
+	}
+
+	multi_recv = ofi_nccl_rdma_multi_recv() != 0;
+	for (struct fi_info *info = provider_list; multi_recv && info != NULL; info = info->next) {
+		if (!(info->caps & FI_MULTI_RECV)) {
+			NCCL_OFI_INFO(NCCL_INIT | NCCL_NET,
+				      "Provider does not support FI_MULTI_RECV, disabling multi-receive slabs");
+			multi_recv = false;
+		}
+	}
+	multi_recv_slab_size = (size_t)ofi_nccl_rdma_multi_recv_slab_size();
+	if (multi_recv && (ofi_nccl_rdma_multi_recv_slabs() < 1 ||
+			   multi_recv_slab_size < 2 * NCCL_OFI_MAX(NCCL_OFI_MAX(eager_max_size,
+									       ctrl_send_max_size()),
+								  sizeof(nccl_ofi_rdma_connection_info_t)))) {
+		NCCL_OFI_WARN("Invalid value for RDMA_MULTI_RECV_SLABS or RDMA_MULTI_RECV_SLAB_SIZE");
+		ret = -EINVAL;
+		goto error;
+	}
+	write_chunk_size = (ofi_nccl_write_chunk_size() > 0) ? (size_t)ofi_nccl_write_chunk_size() : SIZE_MAX;
+	for (struct fi_info *info = provider_list; info != NULL; info = info->next) {
+		if (info->ep_attr != NULL && info->ep_attr->max_msg_size > 0) {
+			write_chunk_size = NCCL_OFI_MIN(write_chunk_size, info->ep_attr->max_msg_size);
+		}
+	}
+
+	if (ofi_nccl_cq_read_count() < 1) {
+		NCCL_OFI_WARN("Invalid value for CQ_READ_COUNT");
+		ret = -EINVAL;
+		goto error;
+	}
+	cq_read_count_max = NCCL_OFI_MAX(cq_read_count, (size_t)NCCL_OFI_MAX(ofi_nccl_cq_read_count_max(), 0));
+	cq_poll_budget = (ofi_nccl_cq_poll_budget() > 0) ? (size_t)ofi_nccl_cq_poll_budget() : SIZE_MAX;
+
 	/* Create NCCL OFI topology */
 	topo = nccl_ofi_topo_create(provider_list);
 	if (!topo) {
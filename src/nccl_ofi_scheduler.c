@@ -8,6 +8,8 @@
 #include <errno.h>
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "nccl_ofi_scheduler.h"
 #include "nccl_ofi_math.h"
@@ -60,13 +62,54 @@ static int get_num_stripes(nccl_net_ofi_threshold_scheduler_t *scheduler_p, size
 }
 
 /*
- * Internal: Set schedule that multiplexes messages to all rails.
+ * Internal: Set stripes of a schedule that multiplexes messages to all rails.
  *
  * A mininal stripe size `max_stripe_size' is calculated (multiple of
  * `align') that is sufficient to assign the whole message. Rails are
- * filled from low id to large id. The last rail may get assigned less
- * data. The number of rails are calculated based on the ratio of
- * (`data_size` / `min_stripe_size`)
+ * filled from low id to large id, starting at rail `first_rail_id'. The
+ * last rail may get assigned less data.
+ */
+static inline void fill_schedule_by_threshold(size_t size,
+					      int num_rails,
+					      int num_stripes,
+					      int first_rail_id,
+					      size_t align,
+					      nccl_net_ofi_schedule_t *schedule)
+{
+	int curr_rail_id = first_rail_id;
+
+	/* Number of bytes left to assign */
+	size_t left = size;
+	/* Offset into message */
+	size_t offset = 0;
+
+	/* Calculate max stripe size as a multiple of 128 for alignment.
+	 * Split message size across stripes, ensuring each stripe is within max_stripe_size and LL128 aligned */
+	size_t max_stripe_size = NCCL_OFI_DIV_CEIL(NCCL_OFI_DIV_CEIL(size, num_stripes), align) * align;
+
+	schedule->num_xfer_infos = num_stripes;
+
+	/* Compute stripes and assign to rails */
+	for (int stripe_idx = 0; stripe_idx < num_stripes; ++stripe_idx) {
+		size_t stripe_size = NCCL_OFI_MIN(left, max_stripe_size);
+
+		schedule->rail_xfer_infos[stripe_idx].rail_id = curr_rail_id;
+		schedule->rail_xfer_infos[stripe_idx].offset = offset;
+		schedule->rail_xfer_infos[stripe_idx].msg_size = stripe_size;
+
+		offset += stripe_size;
+		left -= stripe_size;
+
+		curr_rail_id = (curr_rail_id + 1) % num_rails;
+	}
+}
+
+/*
+ * Internal: Set schedule that multiplexes messages to all rails.
+ *
+ * The number of rails are calculated based on the ratio of
+ * (`data_size` / `min_stripe_size`). Consecutive schedules start at
+ * the rail following the last rail of the previous schedule.
  */
 static inline int set_schedule_by_threshold(nccl_net_ofi_threshold_scheduler_t *scheduler,
 					    size_t size,
@@ -83,41 +126,186 @@ static inline int set_schedule_by_threshold(nccl_net_ofi_threshold_scheduler_t *
 
 	assert(num_stripes <= num_rails);
 
-	int curr_rail_id, next_rail_id;
-	nccl_net_ofi_mutex_lock(&scheduler->rr_lock);
+	/* Retieve and increment multiplex-round-robin counter */
+	unsigned int counter = __atomic_fetch_add(&scheduler->rr_counter, num_stripes, __ATOMIC_RELAXED);
+	int first_rail_id = (int)(counter % (unsigned int)num_rails);
+
+	fill_schedule_by_threshold(size, num_rails, num_stripes, first_rail_id, align, schedule);
+
+	return ret;
+}
+
+/*
+ * Internal: Set schedule of a power-of-two sized message from its
+ * template.
+ *
+ * Produces the same schedule as set_schedule_by_threshold() without
+ * computing the number of stripes and stripe sizes.
+ */
+static inline void set_schedule_from_template(nccl_net_ofi_threshold_scheduler_t *scheduler,
+					      const nccl_net_ofi_schedule_t *tmpl,
+					      nccl_net_ofi_schedule_t *schedule)
+{
+	int num_rails = scheduler->num_rails;
+	size_t num_stripes = tmpl->num_xfer_infos;
+
+	unsigned int counter = __atomic_fetch_add(&scheduler->rr_counter, num_stripes, __ATOMIC_RELAXED);
+	int first_rail_id = (int)(counter % (unsigned int)num_rails);
+
+	schedule->num_xfer_infos = num_stripes;
+	for (size_t stripe_idx = 0; stripe_idx < num_stripes; ++stripe_idx) {
+		int rail_id = first_rail_id + tmpl->rail_xfer_infos[stripe_idx].rail_id;
+		if (rail_id >= num_rails) {
+			rail_id -= num_rails;
+		}
+		schedule->rail_xfer_infos[stripe_idx].rail_id = rail_id;
+		schedule->rail_xfer_infos[stripe_idx].offset = tmpl->rail_xfer_infos[stripe_idx].offset;
+		schedule->rail_xfer_infos[stripe_idx].msg_size = tmpl->rail_xfer_infos[stripe_idx].msg_size;
+	}
+}
+
+/* Maximum number of rails of the adaptive scheduler */
+#define ADAPTIVE_MAX_RAILS (32)
+
+/* Transfer cost assumed for a rail before its first completion,
+ * corresponding to 100 Gbps */
+#define ADAPTIVE_INITIAL_COST_FS_PER_BYTE (80000)
 
-	/* Retieve and increment multiplex-round-robin counter; wrap around if required */
-	curr_rail_id = scheduler->rr_counter;
-	next_rail_id = (curr_rail_id + num_stripes) % num_rails;
-	scheduler->rr_counter = next_rail_id;
+/* Weight of a new sample in the moving average of the transfer cost,
+ * as a power of two */
+#define ADAPTIVE_COST_EWMA_SHIFT (3)
 
-	nccl_net_ofi_mutex_unlock(&scheduler->rr_lock);
+/* Maximum factor between a new cost sample and the moving average.
+ * Limits the impact of stalls, e.g., due to delayed progress */
+#define ADAPTIVE_COST_MAX_RATIO (8)
+
+/* Stripes smaller than this are dominated by latency rather than
+ * bandwidth and are not used to update the transfer cost */
+#define ADAPTIVE_MIN_SAMPLE_SIZE (64 * 1024)
+
+static inline uint64_t adaptive_rail_cost(nccl_net_ofi_adaptive_rail_t *rail)
+{
+	uint64_t cost = __atomic_load_n(&rail->cost_fs_per_byte, __ATOMIC_RELAXED);
+	return (cost != 0) ? cost : 1;
+}
+
+/*
+ * Internal: Set schedule that balances expected finish times of rails.
+ *
+ * Each rail r is modelled as a FIFO draining its outstanding bytes at
+ * its observed rate. The expected time until the rail drains its
+ * outstanding bytes is `drain_r'. A message of `size' bytes is split
+ * into shares x_r such that all used rails finish at the same time T:
+ *
+ *   drain_r + x_r / rate_r = T,  sum(x_r) = size
+ *
+ * Rails which are still busy at time T are not used. Messages which
+ * are too small to be multiplexed are assigned to the rail expected to
+ * finish them first. Equal rails are picked starting from a rotating
+ * rail.
+ */
+static inline int set_schedule_adaptive(nccl_net_ofi_adaptive_scheduler_t *scheduler,
+					size_t size,
+					int num_rails,
+					size_t align,
+					nccl_net_ofi_schedule_t *schedule)
+{
+	int order[ADAPTIVE_MAX_RAILS];
+	/* Rail rate in bytes per femtosecond */
+	double rate[ADAPTIVE_MAX_RAILS];
+	/* Time until the outstanding bytes of the rail are drained, in
+	 * femtoseconds */
+	double drain[ADAPTIVE_MAX_RAILS];
+	/* Time a minimal stripe would finish on the rail */
+	double key[ADAPTIVE_MAX_RAILS];
+
+	assert(num_rails > 0);
+	assert(num_rails <= scheduler->num_rails);
+
+	unsigned int first = __atomic_fetch_add(&scheduler->rr_counter, 1, __ATOMIC_RELAXED);
+	size_t min_stripe_size = NCCL_OFI_MAX(scheduler->min_stripe_size, 1);
+	double probe_size = (double)NCCL_OFI_MIN(size, min_stripe_size);
+
+	/* Order rails by the time a minimal stripe would finish */
+	for (int i = 0; i < num_rails; i++) {
+		int rail_id = (int)((first + (unsigned int)i) % (unsigned int)num_rails);
+		nccl_net_ofi_adaptive_rail_t *rail = &scheduler->rails[rail_id];
+		double cost = (double)adaptive_rail_cost(rail);
+
+		rate[rail_id] = 1.0 / cost;
+		drain[rail_id] = (double)__atomic_load_n(&rail->outstanding_bytes, __ATOMIC_RELAXED) * cost;
+		key[rail_id] = drain[rail_id] + probe_size * cost;
+
+		int j = i;
+		while (j > 0 && key[order[j - 1]] > key[rail_id]) {
+			order[j] = order[j - 1];
+			j--;
+		}
+		order[j] = rail_id;
+	}
+
+	int num_stripes =
+		(int)NCCL_OFI_MAX(1, NCCL_OFI_MIN(NCCL_OFI_DIV_CEIL(size, min_stripe_size), (unsigned)num_rails));
+	double finish = 0.0;
+
+	/* Drop rails which are busy past the common finish time */
+	while (num_stripes > 1) {
+		double sum_rate = 0.0;
+		double sum_drained = 0.0;
+		int latest = 0;
+
+		for (int i = 0; i < num_stripes; i++) {
+			int rail_id = order[i];
+			sum_rate += rate[rail_id];
+			sum_drained += drain[rail_id] * rate[rail_id];
+			if (drain[rail_id] >= drain[order[latest]]) {
+				latest = i;
+			}
+		}
+		finish = ((double)size + sum_drained) / sum_rate;
+		if (finish > drain[order[latest]]) {
+			break;
+		}
+
+		memmove(&order[latest], &order[latest + 1], (num_stripes - latest - 1) * sizeof(order[0]));
+		num_stripes--;
+	}
 
 	/* Number of bytes left to assign */
 	size_t left = size;
 	/* Offset into message */
 	size_t offset = 0;
+	size_t num_xfer_infos = 0;
+
+	for (int i = 0; i < num_stripes; ++i) {
+		int rail_id = order[i];
+		size_t stripe_size;
+
+		if (i == num_stripes - 1) {
+			stripe_size = left;
+		} else {
+			double share = (finish - drain[rail_id]) * rate[rail_id];
+			stripe_size = NCCL_OFI_DIV_CEIL((size_t)share, align) * align;
+			stripe_size = NCCL_OFI_MIN(left, stripe_size);
+		}
 
-	/* Calculate max stripe size as a multiple of 128 for alignment.
-	 * Split message size across stripes, ensuring each stripe is within max_stripe_size and LL128 aligned */
-	size_t max_stripe_size = NCCL_OFI_DIV_CEIL(NCCL_OFI_DIV_CEIL(size, num_stripes), align) * align;
-
-	schedule->num_xfer_infos = num_stripes;
-
-	/* Compute stripes and assign to rails */
-	for (int stripe_idx = 0; stripe_idx < num_stripes; ++stripe_idx) {
-		size_t stripe_size = NCCL_OFI_MIN(left, max_stripe_size);
+		/* Skip empty stripes unless the message is empty */
+		if (stripe_size == 0 && (left != 0 || num_xfer_infos != 0)) {
+			continue;
+		}
 
-		schedule->rail_xfer_infos[stripe_idx].rail_id = curr_rail_id;
-		schedule->rail_xfer_infos[stripe_idx].offset = offset;
-		schedule->rail_xfer_infos[stripe_idx].msg_size = stripe_size;
+		schedule->rail_xfer_infos[num_xfer_infos].rail_id = rail_id;
+		schedule->rail_xfer_infos[num_xfer_infos].offset = offset;
+		schedule->rail_xfer_infos[num_xfer_infos].msg_size = stripe_size;
+		num_xfer_infos++;
 
 		offset += stripe_size;
 		left -= stripe_size;
-
-		curr_rail_id = (curr_rail_id + 1) % num_rails;
 	}
-	return ret;
+
+	schedule->num_xfer_infos = num_xfer_infos;
+
+	return 0;
 }
 
 void nccl_net_ofi_release_schedule(nccl_net_ofi_scheduler_t *scheduler_p,
@@ -166,6 +354,17 @@ static nccl_net_ofi_schedule_t *get_threshold_schedule(nccl_net_ofi_scheduler_t
 		NCCL_OFI_WARN("Failed to allocate schedule");
 		return NULL;
 	}
+
+	/* Power-of-two sizes are served from templates. Schedules with
+	 * fewer rails, e.g., for control messages, are computed. */
+	if (OFI_LIKELY(NCCL_OFI_IS_POWER_OF_TWO(size) && num_rails == scheduler->num_rails)) {
+		int size_class = 63 - __builtin_clzll((unsigned long long)size);
+		if (size_class < NCCL_OFI_SCHEDULER_NUM_SIZE_CLASSES) {
+			set_schedule_from_template(scheduler, scheduler->templates[size_class], schedule);
+			return schedule;
+		}
+	}
+
 	ret = set_schedule_by_threshold(scheduler, size, num_rails, align,
 					schedule);
 	if (OFI_UNLIKELY(ret)) {
@@ -176,6 +375,99 @@ static nccl_net_ofi_schedule_t *get_threshold_schedule(nccl_net_ofi_scheduler_t
 	return schedule;
 }
 
+/*
+ * @brief	Create schedule for a message balancing the expected
+ *		finish time of rails
+ *
+ * @param	scheduler_p
+ *		Pointer to adaptive scheduler
+ * @param	size
+ *		Size of the message in bytes
+ * @param	num_rails
+ *		Number of rails. Must not exceed the number of rails
+ *		provided to the scheduler initialization routine.
+ *
+ * @return	schedule, on success
+ *		NULL, on others
+ */
+static nccl_net_ofi_schedule_t *get_adaptive_schedule(nccl_net_ofi_scheduler_t *scheduler_p,
+						      size_t size,
+						      int num_rails)
+{
+	nccl_net_ofi_schedule_t *schedule;
+	nccl_net_ofi_adaptive_scheduler_t *scheduler =
+		(nccl_net_ofi_adaptive_scheduler_t *)scheduler_p;
+	/* Align stripes to LL128 requirement */
+	size_t align = 128;
+	int ret;
+
+	assert(scheduler != NULL);
+
+	schedule =
+		(nccl_net_ofi_schedule_t *)nccl_ofi_freelist_entry_alloc(scheduler_p->schedule_fl);
+	if (OFI_UNLIKELY(!schedule)) {
+		NCCL_OFI_WARN("Failed to allocate schedule");
+		return NULL;
+	}
+	ret = set_schedule_adaptive(scheduler, size, num_rails, align, schedule);
+	if (OFI_UNLIKELY(ret)) {
+		nccl_net_ofi_release_schedule(scheduler_p, schedule);
+		schedule = NULL;
+	}
+
+	return schedule;
+}
+
+static void adaptive_xfer_posted(nccl_net_ofi_scheduler_t *scheduler_p,
+				 const nccl_net_ofi_xfer_info_t *xfer)
+{
+	nccl_net_ofi_adaptive_scheduler_t *scheduler =
+		(nccl_net_ofi_adaptive_scheduler_t *)scheduler_p;
+
+	assert(xfer->rail_id < scheduler->num_rails);
+	__atomic_fetch_add(&scheduler->rails[xfer->rail_id].outstanding_bytes,
+			   xfer->msg_size, __ATOMIC_RELAXED);
+}
+
+/*
+ * @brief	Account stripe completion and update the transfer cost of
+ *		its rail
+ *
+ * The stripe is assumed to have been serviced from the later of the
+ * time it was ready and the previous completion of the rail.
+ */
+static void adaptive_xfer_completed(nccl_net_ofi_scheduler_t *scheduler_p,
+				    const nccl_net_ofi_xfer_info_t *xfer,
+				    uint64_t start_ns, uint64_t end_ns)
+{
+	nccl_net_ofi_adaptive_scheduler_t *scheduler =
+		(nccl_net_ofi_adaptive_scheduler_t *)scheduler_p;
+
+	assert(xfer->rail_id < scheduler->num_rails);
+	nccl_net_ofi_adaptive_rail_t *rail = &scheduler->rails[xfer->rail_id];
+
+	__atomic_fetch_sub(&rail->outstanding_bytes, xfer->msg_size, __ATOMIC_RELAXED);
+
+	uint64_t prev_ns = __atomic_exchange_n(&rail->last_completion_ns, end_ns, __ATOMIC_RELAXED);
+	if (xfer->msg_size < ADAPTIVE_MIN_SAMPLE_SIZE) {
+		return;
+	}
+
+	uint64_t begin_ns = NCCL_OFI_MAX(start_ns, prev_ns);
+	if (end_ns <= begin_ns) {
+		/* Completions were processed out of order */
+		return;
+	}
+
+	uint64_t cost = adaptive_rail_cost(rail);
+	uint64_t sample = (end_ns - begin_ns) * 1000000 / xfer->msg_size;
+	sample = NCCL_OFI_MIN(NCCL_OFI_MAX(sample, cost / ADAPTIVE_COST_MAX_RATIO),
+			      cost * ADAPTIVE_COST_MAX_RATIO);
+
+	int64_t delta = ((int64_t)sample - (int64_t)cost) / (1 << ADAPTIVE_COST_EWMA_SHIFT);
+	__atomic_store_n(&rail->cost_fs_per_byte, (uint64_t)((int64_t)cost + delta), __ATOMIC_RELAXED);
+}
+
 /*
  * @brief	Release resources of base scheduler struct
  *
@@ -215,18 +507,40 @@ static int threshold_scheduler_fini(nccl_net_ofi_scheduler_t *scheduler_p)
 	assert(scheduler_p);
 	assert(scheduler_p->schedule_fl);
 
-	ret = nccl_net_ofi_mutex_destroy(&scheduler->rr_lock);
+	ret = scheduler_fini(scheduler_p);
 	if (ret) {
-		NCCL_OFI_WARN("Could not destroy threshold scheduler pthread mutex");
-		return -ret;
+		NCCL_OFI_WARN("Could not destroy threshold scheduler");
+		return ret;
 	}
 
+	free(scheduler->template_buf);
+	free(scheduler);
+
+	return ret;
+}
+
+/*
+ * brief	Release adaptive scheduler resources and free scheduler
+ *
+ * @return	0, on success
+ *		non-zero, on error
+ */
+static int adaptive_scheduler_fini(nccl_net_ofi_scheduler_t *scheduler_p)
+{
+	nccl_net_ofi_adaptive_scheduler_t *scheduler =
+		(nccl_net_ofi_adaptive_scheduler_t *)scheduler_p;
+	int ret = 0;
+
+	assert(scheduler_p);
+	assert(scheduler_p->schedule_fl);
+
 	ret = scheduler_fini(scheduler_p);
 	if (ret) {
-		NCCL_OFI_WARN("Could not destroy threshold scheduler");
+		NCCL_OFI_WARN("Could not destroy adaptive scheduler");
 		return ret;
 	}
 
+	free(scheduler->rails);
 	free(scheduler);
 
 	return ret;
@@ -248,7 +562,8 @@ static inline int scheduler_init(int num_rails, nccl_net_ofi_scheduler_t *schedu
 {
 	int ret = 0;
 
-	ret = nccl_ofi_freelist_init(sizeof_schedule(num_rails), 16, 16, 0, &scheduler->schedule_fl);
+	ret = nccl_ofi_freelist_init(sizeof_schedule(num_rails), 16, 16, 0,
+				     NCCL_OFI_FREELIST_MODE_DEFAULT, &scheduler->schedule_fl);
 	if (ret != 0) {
 		NCCL_OFI_WARN("Could not allocate freelist of schedules");
 		return ret;
@@ -277,18 +592,83 @@ int nccl_net_ofi_threshold_scheduler_init(int num_rails, size_t min_stripe_size,
 	}
 
 	scheduler->base.get_schedule = get_threshold_schedule;
+	scheduler->base.xfer_posted = NULL;
+	scheduler->base.xfer_completed = NULL;
 	scheduler->base.fini = threshold_scheduler_fini;
 	scheduler->rr_counter = 0;
 	scheduler->min_stripe_size = min_stripe_size;
+	scheduler->num_rails = num_rails;
 
-	ret = nccl_net_ofi_mutex_init(&scheduler->rr_lock, NULL);
-	if (ret) {
-		NCCL_OFI_WARN("Could not initialize mutex for round robin counter");
+	/* Precompute schedule templates of power-of-two message sizes */
+	scheduler->template_buf = calloc(NCCL_OFI_SCHEDULER_NUM_SIZE_CLASSES, sizeof_schedule(num_rails));
+	if (!scheduler->template_buf) {
+		NCCL_OFI_WARN("Could not allocate schedule templates");
 		scheduler_fini(&scheduler->base);
 		free(scheduler);
+		return -ENOMEM;
+	}
+	for (int size_class = 0; size_class < NCCL_OFI_SCHEDULER_NUM_SIZE_CLASSES; ++size_class) {
+		size_t size = (size_t)1 << size_class;
+		nccl_net_ofi_schedule_t *tmpl = (nccl_net_ofi_schedule_t *)
+			((char *)scheduler->template_buf + size_class * sizeof_schedule(num_rails));
+		/* Align stripes to LL128 requirement */
+		fill_schedule_by_threshold(size, num_rails, get_num_stripes(scheduler, size, num_rails),
+					   0, 128, tmpl);
+		scheduler->templates[size_class] = tmpl;
+	}
+
+	*scheduler_p = &scheduler->base;
+
+	return ret;
+}
+
+int nccl_net_ofi_adaptive_scheduler_init(int num_rails, size_t min_stripe_size, nccl_net_ofi_scheduler_t **scheduler_p)
+{
+	int ret = 0;
+	nccl_net_ofi_adaptive_scheduler_t *scheduler = NULL;
+	*scheduler_p = NULL;
+
+	if (num_rails < 1 || num_rails > ADAPTIVE_MAX_RAILS) {
+		NCCL_OFI_WARN("Invalid number of rails for adaptive scheduler: %d", num_rails);
+		return -EINVAL;
+	}
+
+	scheduler = (nccl_net_ofi_adaptive_scheduler_t *)malloc(
+		sizeof(nccl_net_ofi_adaptive_scheduler_t));
+	if (!scheduler) {
+		NCCL_OFI_WARN("Could not allocate adaptive scheduler");
+		return -ENOMEM;
+	}
+
+	ret = posix_memalign((void **)&scheduler->rails, sizeof(nccl_net_ofi_adaptive_rail_t),
+			     num_rails * sizeof(nccl_net_ofi_adaptive_rail_t));
+	if (ret) {
+		NCCL_OFI_WARN("Could not allocate rails of adaptive scheduler");
+		free(scheduler);
 		return -ret;
 	}
 
+	for (int rail_id = 0; rail_id < num_rails; ++rail_id) {
+		nccl_net_ofi_adaptive_rail_t *rail = &scheduler->rails[rail_id];
+		memset(rail, 0, sizeof(*rail));
+		rail->cost_fs_per_byte = ADAPTIVE_INITIAL_COST_FS_PER_BYTE;
+	}
+
+	ret = scheduler_init(num_rails, &scheduler->base);
+	if (ret) {
+		free(scheduler->rails);
+		free(scheduler);
+		return ret;
+	}
+
+	scheduler->base.get_schedule = get_adaptive_schedule;
+	scheduler->base.xfer_posted = adaptive_xfer_posted;
+	scheduler->base.xfer_completed = adaptive_xfer_completed;
+	scheduler->base.fini = adaptive_scheduler_fini;
+	scheduler->num_rails = num_rails;
+	scheduler->rr_counter = 0;
+	scheduler->min_stripe_size = min_stripe_size;
+
 	*scheduler_p = &scheduler->base;
 
 	return ret;
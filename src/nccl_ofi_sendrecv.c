@@ -803,6 +803,12 @@ static int sendrecv_comm_mr_base_reg(nccl_net_ofi_comm_t *base_comm,
 	}
 
 	if (mr_cache) {
+		/* Cache hits do not need the MR cache lock */
+		ret_handle = nccl_ofi_mr_cache_try_lookup_entry(mr_cache, ckey);
+		if (ret_handle) {
+			goto exit;
+		}
+
 		/*
 		 * MR cache is locked between lookup and insert, to be sure we
 		 * insert a missing entry
@@ -936,6 +942,13 @@ static int sendrecv_recv_comm_recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, v
 		goto exit;
 	}
 
+	/* Grouped receives are not supported */
+	if (OFI_UNLIKELY(n > 1)) {
+		ret = -EINVAL;
+		NCCL_OFI_WARN("Request for group recv size of %d, greater than maximum of 1", n);
+		goto error;
+	}
+
 	/* Support only NCCL_OFI_MAX_REQUESTS inflight reqs. */
 	if (OFI_UNLIKELY(r_comm->num_inflight_reqs == NCCL_OFI_MAX_REQUESTS)) {
 		ret = -EINVAL;
@@ -970,8 +983,6 @@ static int sendrecv_recv_comm_recv(nccl_net_ofi_recv_comm_t *recv_comm, int n, v
 		goto error;
 	}
 
-	/* Currently, plugin doesn't support grouped receives */
-	assert(n <= NCCL_OFI_MAX_RECVS);
 	for (int recv_n = 0; recv_n < n; recv_n++) {
 		void *desc = NULL;
 
@@ -1078,6 +1089,13 @@ static int sendrecv_recv_comm_flush(nccl_net_ofi_recv_comm_t *recv_comm, int n,
 	int flush_n = -1;
 	struct fid_mr **mr_handles = (struct fid_mr **)mhandles;
 
+	/* Grouped receives are not supported */
+	if (OFI_UNLIKELY(n > 1)) {
+		NCCL_OFI_WARN("Request for group flush size of %d, greater than maximum of 1", n);
+		ret = -EINVAL;
+		goto exit;
+	}
+
 	if (ofi_nccl_gdr_flush_disable() || support_gdr == GDR_UNSUPPORTED)
 		goto exit;
 
@@ -1091,9 +1109,6 @@ static int sendrecv_recv_comm_flush(nccl_net_ofi_recv_comm_t *recv_comm, int n,
 	}
 #endif
 
-	/* Plugin only supports one receive per request */
-	assert(n <= NCCL_OFI_MAX_RECVS);
-
 	/*
 	 * Find the non-zero request for which we will issue flush.
 	 * A single operation can flush all request at once.
@@ -1333,7 +1348,7 @@ static nccl_net_ofi_sendrecv_recv_comm_t *sendrecv_recv_comm_prepare(nccl_net_of
 	/* Pre-allocated buffers for data path */
 
 	ret = nccl_ofi_freelist_init(req_size, 16, 16, NCCL_OFI_MAX_REQUESTS,
-				     &r_comm->nccl_ofi_reqs_fl);
+				     NCCL_OFI_FREELIST_MODE_DEFAULT, &r_comm->nccl_ofi_reqs_fl);
 	if (OFI_UNLIKELY(ret != 0)) {
 		NCCL_OFI_WARN("Could not allocate NCCL OFI requests free list for dev %d",
 			      dev_id);
@@ -1920,7 +1935,7 @@ static inline int sendrecv_send_comm_create(nccl_net_ofi_conn_handle_t *handle,
 
 	/* Pre-allocated buffers for data path */
 	ret = nccl_ofi_freelist_init(req_size, 16, 16, NCCL_OFI_MAX_SEND_REQUESTS,
-				     &ret_s_comm->nccl_ofi_reqs_fl);
+				     NCCL_OFI_FREELIST_MODE_DEFAULT, &ret_s_comm->nccl_ofi_reqs_fl);
 	if (OFI_UNLIKELY(ret != 0)) {
 		NCCL_OFI_WARN("Could not allocate NCCL OFI requests free list for dev %d",
 			      device->base.dev_id);
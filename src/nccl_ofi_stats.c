@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#include "config.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <uthash/utlist.h>
+
+#include "nccl_ofi_stats.h"
+#include "nccl_ofi_log.h"
+#include "nccl_ofi_param.h"
+#include "nccl_ofi_pthread.h"
+
+int nccl_ofi_stats_dump_requested = 0;
+
+/* Registered entries, protected by stats_lock */
+static nccl_ofi_stats_entry_t *stats_entries = NULL;
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Set once the final dump has been written */
+static bool stats_finalized = false;
+
+uint64_t nccl_ofi_stats_hist_percentile(const nccl_ofi_stats_hist_t *hist, double pct)
+{
+	uint64_t count = nccl_ofi_stats_read(&hist->count);
+	uint64_t max = nccl_ofi_stats_read(&hist->max);
+	uint64_t seen = 0;
+
+	if (count == 0) {
+		return 0;
+	}
+
+	/* Rank of the percentile value, 1-based */
+	uint64_t rank = (uint64_t)((pct / 100.0) * (double)count + 0.5);
+	if (rank == 0) {
+		rank = 1;
+	}
+
+	for (int i = 0; i < NCCL_OFI_STATS_HIST_BUCKETS; i++) {
+		seen += nccl_ofi_stats_read(&hist->buckets[i]);
+		if (seen >= rank) {
+			if (i == 0) {
+				return 0;
+			}
+			uint64_t upper = (i == 64) ? UINT64_MAX : (1ULL << i);
+			return (upper < max) ? upper : max;
+		}
+	}
+
+	/* Concurrent updates may leave the buckets behind count */
+	return max;
+}
+
+void nccl_ofi_stats_hist_print(FILE *out, const char *label, const nccl_ofi_stats_hist_t *hist)
+{
+	uint64_t count = nccl_ofi_stats_read(&hist->count);
+	uint64_t sum = nccl_ofi_stats_read(&hist->sum);
+
+	fprintf(out, "    %s: count %" PRIu64 " mean %.1f p50 %" PRIu64 " p99 %" PRIu64 " max %" PRIu64 " |",
+		label, count, count ? (double)sum / (double)count : 0.0,
+		nccl_ofi_stats_hist_percentile(hist, 50.0),
+		nccl_ofi_stats_hist_percentile(hist, 99.0),
+		nccl_ofi_stats_read(&hist->max));
+
+	for (int i = 0; i < NCCL_OFI_STATS_HIST_BUCKETS; i++) {
+		uint64_t bucket = nccl_ofi_stats_read(&hist->buckets[i]);
+		if (bucket == 0) {
+			continue;
+		}
+		if (i == 0) {
+			fprintf(out, " 0:%" PRIu64, bucket);
+		} else {
+			fprintf(out, " 2^%d:%" PRIu64, i - 1, bucket);
+		}
+	}
+	fprintf(out, "\n");
+}
+
+void nccl_ofi_stats_register(nccl_ofi_stats_entry_t *entry,
+			     nccl_ofi_stats_dump_fn_t dump_fn,
+			     const char *fmt, ...)
+{
+	va_list args;
+
+	assert(entry != NULL);
+	assert(dump_fn != NULL);
+
+	va_start(args, fmt);
+	vsnprintf(entry->name, sizeof(entry->name), fmt, args);
+	va_end(args);
+
+	entry->dump_fn = dump_fn;
+
+	nccl_net_ofi_mutex_lock(&stats_lock);
+	DL_APPEND(stats_entries, entry);
+	nccl_net_ofi_mutex_unlock(&stats_lock);
+}
+
+static void stats_dump_entry(FILE *out, nccl_ofi_stats_entry_t *entry)
+{
+	fprintf(out, "  %s\n", entry->name);
+	entry->dump_fn(out, entry);
+}
+
+/*
+ * @brief	Write a dump to the configured output
+ *
+ * Caller must hold stats_lock.
+ *
+ * @param	entry
+ *		Entry to dump, or NULL to dump all registered entries
+ */
+static void stats_write(const char *reason, nccl_ofi_stats_entry_t *entry)
+{
+	const char *path = ofi_nccl_stats_file();
+	char hostname[64] = "unknown";
+	FILE *file = NULL;
+	FILE *out = stderr;
+
+	if (path != NULL && path[0] != '\0') {
+		file = fopen(path, "a");
+		if (file == NULL) {
+			NCCL_OFI_WARN("Unable to open stats file %s: %s, using stderr",
+				      path, strerror(errno));
+		} else {
+			out = file;
+		}
+	}
+
+	gethostname(hostname, sizeof(hostname) - 1);
+	fprintf(out, "NET/OFI stats %s pid %d (%s)\n", hostname, (int)getpid(), reason);
+
+	if (entry != NULL) {
+		stats_dump_entry(out, entry);
+	} else {
+		DL_FOREACH(stats_entries, entry) {
+			stats_dump_entry(out, entry);
+		}
+	}
+
+	if (file != NULL) {
+		fclose(file);
+	} else {
+		fflush(stderr);
+	}
+}
+
+void nccl_ofi_stats_unregister(nccl_ofi_stats_entry_t *entry)
+{
+	nccl_net_ofi_mutex_lock(&stats_lock);
+
+	if (entry->dump_fn == NULL) {
+		goto unlock;
+	}
+
+	if (ofi_nccl_stats_dump_at_fini() && !stats_finalized) {
+		stats_write("close", entry);
+	}
+
+	DL_DELETE(stats_entries, entry);
+	entry->dump_fn = NULL;
+
+ unlock:
+	nccl_net_ofi_mutex_unlock(&stats_lock);
+}
+
+void nccl_ofi_stats_dump(const char *reason)
+{
+	nccl_net_ofi_mutex_lock(&stats_lock);
+	stats_write(reason, NULL);
+	nccl_net_ofi_mutex_unlock(&stats_lock);
+}
+
+static void stats_signal_handler(int signum)
+{
+	(void)signum;
+	__atomic_store_n(&nccl_ofi_stats_dump_requested, 1, __ATOMIC_RELAXED);
+}
+
+int nccl_ofi_stats_init(void)
+{
+	struct sigaction sa;
+	int signum = (int)ofi_nccl_stats_signal();
+
+	if (signum == 0) {
+		return 0;
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = stats_signal_handler;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+
+	if (sigaction(signum, &sa, NULL) != 0) {
+		int ret = -errno;
+		NCCL_OFI_WARN("Unable to install stats dump handler for signal %d: %s",
+			      signum, strerror(-ret));
+		return ret;
+	}
+
+	NCCL_OFI_INFO(NCCL_INIT | NCCL_NET, "Dumping statistics on signal %d", signum);
+
+	return 0;
+}
+
+void nccl_ofi_stats_fini(void)
+{
+	if (ofi_nccl_stats_dump_at_fini()) {
+		nccl_ofi_stats_dump("fini");
+	}
+
+	nccl_net_ofi_mutex_lock(&stats_lock);
+	stats_finalized = true;
+	nccl_net_ofi_mutex_unlock(&stats_lock);
+}
@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include <hwloc.h>
+#include <hwloc/glibc-sched.h>
 #include <rdma/fabric.h>
 #include <errno.h>
 #include <stdlib.h>
@@ -1657,3 +1658,56 @@ struct fi_info *nccl_ofi_topo_next_info_list(nccl_ofi_topo_data_iterator_t *iter
 
 	return info_list;
 }
+
+int nccl_ofi_topo_get_numa_node(nccl_ofi_topo_t *topo, struct fi_info *info, int *numa_node)
+{
+	int ret;
+	hwloc_obj_t obj = NULL;
+	hwloc_obj_t ancestor = NULL;
+
+	*numa_node = -1;
+
+	ret = get_hwloc_pcidev_by_fi_info(topo->topo, info, &obj);
+	if (ret != 0 || !obj) {
+		return ret;
+	}
+
+	/* The nodeset of the closest non-I/O ancestor holds the NUMA
+	 * nodes local to the device. Only report a node if there is a
+	 * single one. */
+	ancestor = hwloc_get_non_io_ancestor_obj(topo->topo, obj);
+	if (ancestor && ancestor->nodeset &&
+	    hwloc_bitmap_weight(ancestor->nodeset) == 1) {
+		*numa_node = hwloc_bitmap_first(ancestor->nodeset);
+	}
+
+	return 0;
+}
+
+int nccl_ofi_topo_get_cpuset(nccl_ofi_topo_t *topo, struct fi_info *info, cpu_set_t *cpuset)
+{
+	int ret;
+	hwloc_obj_t obj = NULL;
+	hwloc_obj_t ancestor = NULL;
+
+	CPU_ZERO(cpuset);
+
+	ret = get_hwloc_pcidev_by_fi_info(topo->topo, info, &obj);
+	if (ret != 0 || !obj) {
+		return ret;
+	}
+
+	/* The cpuset of the closest non-I/O ancestor holds the CPUs
+	 * local to the device */
+	ancestor = hwloc_get_non_io_ancestor_obj(topo->topo, obj);
+	if (ancestor && ancestor->cpuset) {
+		ret = hwloc_cpuset_to_glibc_sched_affinity(topo->topo, ancestor->cpuset,
+							   cpuset, sizeof(*cpuset));
+		if (ret != 0) {
+			NCCL_OFI_WARN("Unable to convert hwloc cpuset of NIC");
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+/*
+ * This test validates grouped receives. The receiver posts receives of
+ * NUM_GROUP_RECVS buffers with distinct tags, and the sender sends the
+ * buffers of each group in reverse tag order, so that every send is
+ * matched to its buffer by tag rather than by order.
+ */
+
+#include "config.h"
+
+#include "test-common.hpp"
+
+#define NUM_GROUP_RECVS	(4)
+#define NUM_GROUPS	(16)
+
+int main(int argc, char* argv[])
+{
+	ncclResult_t res = ncclSuccess;
+	int rank, num_ranks = 0, peer_rank = 0;
+	int dev = 0, ndev = 0;
+	test_nccl_properties_t props = {};
+	nccl_net_ofi_send_comm_t *sComm = NULL;
+	nccl_net_ofi_listen_comm_t *lComm = NULL;
+	nccl_net_ofi_recv_comm_t *rComm = NULL;
+	test_nccl_net_t *extNet = NULL;
+	ncclNetDeviceHandle_v8_t *s_ignore, *r_ignore;
+	char handle[NCCL_NET_HANDLE_MAXSIZE] = {};
+	char src_handle[NCCL_NET_HANDLE_MAXSIZE] = {};
+
+	nccl_net_ofi_req_t *req[NUM_GROUP_RECVS] = {NULL};
+	void *mhandle[NUM_GROUP_RECVS] = {NULL};
+	char *buf[NUM_GROUP_RECVS] = {NULL};
+	char *expected_buf = NULL;
+	int sizes[NUM_GROUP_RECVS];
+	int tags[NUM_GROUP_RECVS];
+	int received_sizes[NUM_GROUP_RECVS];
+	int done = 0;
+
+	ofi_log_function = logger;
+
+	/* Grouped receives are opt-in */
+	setenv("OFI_NCCL_RDMA_MAX_RECVS", STR(NUM_GROUP_RECVS), 0);
+
+	MPI_Init(&argc, &argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+	if (num_ranks != 2) {
+		NCCL_OFI_WARN("Expected two ranks but got %d. "
+			"The grouped_recv functional test should be run with exactly two ranks.",
+			num_ranks);
+		res = ncclInvalidArgument;
+		goto exit;
+	}
+	peer_rank = (rank + 1) % num_ranks;
+
+	extNet = get_extNet();
+	if (extNet == NULL) {
+		res = ncclInternalError;
+		goto exit;
+	}
+
+	OFINCCLCHECKGOTO(extNet->init(&logger), res, exit);
+	OFINCCLCHECKGOTO(extNet->devices(&ndev), res, exit);
+	OFINCCLCHECKGOTO(extNet->getProperties(dev, &props), res, exit);
+	print_dev_props(dev, &props);
+
+	if (props.maxRecvs < NUM_GROUP_RECVS) {
+		NCCL_OFI_INFO(NCCL_NET, "Device supports %d grouped receives, skipping test",
+			      props.maxRecvs);
+		MPI_Finalize();
+		goto exit;
+	}
+
+	for (int i = 0; i < NUM_GROUP_RECVS; i++) {
+		sizes[i] = RECV_SIZE;
+		tags[i] = i + 1;
+	}
+
+	OFINCCLCHECKGOTO(allocate_buff((void **)&expected_buf, RECV_SIZE, NCCL_PTR_HOST), res, exit);
+
+	/* Exchange handles and connect in both directions */
+	OFINCCLCHECKGOTO(extNet->listen(dev, (void *)&handle, (void **)&lComm), res, exit);
+	MPI_Sendrecv(&handle, NCCL_NET_HANDLE_MAXSIZE, MPI_CHAR, peer_rank, 0,
+		     &src_handle, NCCL_NET_HANDLE_MAXSIZE, MPI_CHAR, peer_rank, 0,
+		     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+	while (sComm == NULL || rComm == NULL) {
+		if (sComm == NULL) {
+			OFINCCLCHECKGOTO(extNet->connect(dev, (void *)src_handle, (void **)&sComm,
+							 &s_ignore),
+					 res, exit);
+		}
+		if (rComm == NULL) {
+			OFINCCLCHECKGOTO(extNet->accept((void *)lComm, (void **)&rComm, &r_ignore),
+					 res, exit);
+		}
+	}
+
+	for (int i = 0; i < NUM_GROUP_RECVS; i++) {
+		OFINCCLCHECKGOTO(allocate_buff((void **)&buf[i], RECV_SIZE, NCCL_PTR_HOST), res, exit);
+		if (rank == 0) {
+			OFINCCLCHECKGOTO(extNet->regMr((void *)sComm, (void *)buf[i], RECV_SIZE,
+						       NCCL_PTR_HOST, &mhandle[i]),
+					 res, exit);
+		} else {
+			OFINCCLCHECKGOTO(extNet->regMr((void *)rComm, (void *)buf[i], RECV_SIZE,
+						       NCCL_PTR_HOST, &mhandle[i]),
+					 res, exit);
+		}
+	}
+
+	for (int group = 0; group < NUM_GROUPS; group++) {
+		if (rank == 0) {
+			/* Send the buffers in reverse tag order. Each buffer
+			 * holds its tag so the receiver can check the match. */
+			for (int i = NUM_GROUP_RECVS - 1; i >= 0; i--) {
+				memset(buf[i], 'a' + tags[i], RECV_SIZE);
+				while (req[i] == NULL) {
+					OFINCCLCHECKGOTO(extNet->isend((void *)sComm, (void *)buf[i], SEND_SIZE,
+								       tags[i], mhandle[i], (void **)&req[i]),
+							 res, exit);
+				}
+			}
+
+			for (int i = 0; i < NUM_GROUP_RECVS; i++) {
+				done = 0;
+				while (!done) {
+					OFINCCLCHECKGOTO(extNet->test((void *)req[i], &done, NULL), res, exit);
+				}
+				req[i] = NULL;
+			}
+		} else {
+			for (int i = 0; i < NUM_GROUP_RECVS; i++) {
+				memset(buf[i], 0, RECV_SIZE);
+			}
+			while (req[0] == NULL) {
+				OFINCCLCHECKGOTO(extNet->irecv((void *)rComm, NUM_GROUP_RECVS, (void **)buf,
+							       sizes, tags, mhandle, (void **)&req[0]),
+						 res, exit);
+			}
+
+			done = 0;
+			while (!done) {
+				OFINCCLCHECKGOTO(extNet->test((void *)req[0], &done, received_sizes), res, exit);
+			}
+			req[0] = NULL;
+
+			for (int i = 0; i < NUM_GROUP_RECVS; i++) {
+				if (received_sizes[i] != SEND_SIZE) {
+					NCCL_OFI_WARN("Wrong received size %d for tag %d (send size: %d)",
+						      received_sizes[i], tags[i], SEND_SIZE);
+					res = ncclInternalError;
+					goto exit;
+				}
+				memset(expected_buf, 'a' + tags[i], SEND_SIZE);
+				OFINCCLCHECKGOTO(validate_data(buf[i], expected_buf, SEND_SIZE, NCCL_PTR_HOST),
+						 res, exit);
+			}
+		}
+
+		MPI_Barrier(MPI_COMM_WORLD);
+	}
+
+	for (int i = 0; i < NUM_GROUP_RECVS; i++) {
+		if (rank == 0) {
+			OFINCCLCHECKGOTO(extNet->deregMr((void *)sComm, mhandle[i]), res, exit);
+		} else {
+			OFINCCLCHECKGOTO(extNet->deregMr((void *)rComm, mhandle[i]), res, exit);
+		}
+	}
+
+	OFINCCLCHECKGOTO(extNet->closeListen((void *)lComm), res, exit);
+	lComm = NULL;
+	OFINCCLCHECKGOTO(extNet->closeSend((void *)sComm), res, exit);
+	sComm = NULL;
+	OFINCCLCHECKGOTO(extNet->closeRecv((void *)rComm), res, exit);
+	rComm = NULL;
+
+	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Finalize();
+	NCCL_OFI_INFO(NCCL_NET, "Test completed successfully for rank %d", rank);
+
+exit:
+	for (int i = 0; i < NUM_GROUP_RECVS; i++) {
+		if (buf[i]) {
+			deallocate_buffer(buf[i], NCCL_PTR_HOST);
+			buf[i] = NULL;
+		}
+	}
+
+	if (expected_buf) {
+		deallocate_buffer(expected_buf, NCCL_PTR_HOST);
+		expected_buf = NULL;
+	}
+
+	return res;
+}
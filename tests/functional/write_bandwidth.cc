@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+/*
+ * Measures unidirectional bandwidth of large host-memory transfers
+ * between two ranks. Rank 0 sends, rank 1 receives, with up to
+ * NUM_REQUESTS transfers in flight.
+ *
+ * The chunk size and window of RDMA writes are read once by the
+ * plugin, so bandwidth versus chunk size is obtained by running the
+ * benchmark once per setting, e.g. in loopback over the tcp provider:
+ *
+ *   for chunk in 0 65536 262144 1048576 4194304; do
+ *     mpirun -n 2 -x FI_PROVIDER=tcp -x OFI_NCCL_PROTOCOL=RDMA \
+ *       -x OFI_NCCL_WRITE_CHUNK_SIZE=$chunk ./write_bandwidth
+ *   done
+ */
+
+#include "config.h"
+
+#include <time.h>
+
+#include "test-common.hpp"
+
+/* Bytes transferred per message size */
+#define BYTES_PER_SIZE (1024UL * 1024 * 1024)
+#define MIN_ITERATIONS (16)
+
+static const size_t msg_sizes[] = {1UL << 20, 4UL << 20, 16UL << 20, 64UL << 20, 256UL << 20};
+static const size_t num_msg_sizes = sizeof(msg_sizes) / sizeof(msg_sizes[0]);
+
+static inline double elapsed_s(const struct timespec *start, const struct timespec *end)
+{
+	return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+/*
+ * @brief	Transfer `iters' messages of `size' bytes, keeping up to
+ *		NUM_REQUESTS of them in flight
+ */
+static ncclResult_t run_size(test_nccl_net_t *extNet, int rank, void *comm, char *buf,
+			     void *mhandle, size_t size, size_t iters)
+{
+	nccl_net_ofi_req_t *req[NUM_REQUESTS] = {NULL};
+	size_t posted = 0, completed = 0;
+	int tag = 1;
+	int recv_size = (int)size;
+	int done, received_size;
+
+	while (completed < iters) {
+		for (int idx = 0; idx < NUM_REQUESTS; idx++) {
+			if (req[idx] == NULL && posted < iters) {
+				if (rank == 0) {
+					OFINCCLCHECK(extNet->isend(comm, buf, size, tag, mhandle,
+								   (void **)&req[idx]));
+				} else {
+					OFINCCLCHECK(extNet->irecv(comm, 1, (void **)&buf, &recv_size, &tag,
+								   &mhandle, (void **)&req[idx]));
+				}
+				if (req[idx] != NULL) {
+					posted++;
+				}
+			}
+
+			if (req[idx] == NULL) {
+				continue;
+			}
+
+			OFINCCLCHECK(extNet->test(req[idx], &done, &received_size));
+			if (done) {
+				if ((size_t)received_size != size) {
+					NCCL_OFI_WARN("Wrong received size %d (expected %zu)",
+						      received_size, size);
+					return ncclInternalError;
+				}
+				req[idx] = NULL;
+				completed++;
+			}
+		}
+	}
+
+	return ncclSuccess;
+}
+
+int main(int argc, char *argv[])
+{
+	ncclResult_t res = ncclSuccess;
+	int rank, num_ranks = 0, peer_rank = 0;
+	int ndev, dev = 0;
+	nccl_net_ofi_send_comm_t *sComm = NULL;
+	nccl_net_ofi_listen_comm_t *lComm = NULL;
+	nccl_net_ofi_recv_comm_t *rComm = NULL;
+	test_nccl_net_t *extNet = NULL;
+	ncclNetDeviceHandle_v8_t *s_ignore, *r_ignore;
+	char handle[NCCL_NET_HANDLE_MAXSIZE] = {};
+	char src_handle[NCCL_NET_HANDLE_MAXSIZE] = {};
+	size_t max_size = msg_sizes[num_msg_sizes - 1];
+	char *buf = NULL;
+	void *mhandle = NULL;
+	void *comm = NULL;
+	const char *chunk_size = getenv("OFI_NCCL_WRITE_CHUNK_SIZE");
+	const char *chunk_window = getenv("OFI_NCCL_WRITE_CHUNK_WINDOW");
+
+	ofi_log_function = logger;
+
+	MPI_Init(&argc, &argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+	if (num_ranks != 2) {
+		NCCL_OFI_WARN("Expected two ranks but got %d. "
+			"The write_bandwidth benchmark should be run with exactly two ranks.",
+			num_ranks);
+		res = ncclInvalidArgument;
+		goto exit;
+	}
+	peer_rank = 1 - rank;
+
+	/* Get external Network from NCCL-OFI library */
+	extNet = get_extNet();
+	if (extNet == NULL) {
+		res = ncclInternalError;
+		goto exit;
+	}
+
+	OFINCCLCHECKGOTO(extNet->init(&logger), res, exit);
+	OFINCCLCHECKGOTO(extNet->devices(&ndev), res, exit);
+	if (ndev < 1) {
+		NCCL_OFI_WARN("No network devices");
+		res = ncclInternalError;
+		goto exit;
+	}
+
+	/* Rank 0 only sends and rank 1 only receives, but both sides
+	   of the connection are established as in the other tests */
+	OFINCCLCHECKGOTO(extNet->listen(dev, (void *)&handle, (void **)&lComm), res, exit);
+	MPI_Sendrecv(handle, NCCL_NET_HANDLE_MAXSIZE, MPI_CHAR, peer_rank, 0,
+		     src_handle, NCCL_NET_HANDLE_MAXSIZE, MPI_CHAR, peer_rank, 0,
+		     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+	while (sComm == NULL || rComm == NULL) {
+		if (sComm == NULL) {
+			OFINCCLCHECKGOTO(extNet->connect(dev, (void *)src_handle, (void **)&sComm,
+							 &s_ignore),
+					 res, exit);
+		}
+		if (rComm == NULL) {
+			OFINCCLCHECKGOTO(extNet->accept((void *)lComm, (void **)&rComm, &r_ignore),
+					 res, exit);
+		}
+	}
+
+	comm = (rank == 0) ? (void *)sComm : (void *)rComm;
+
+	OFINCCLCHECKGOTO(allocate_buff((void **)&buf, max_size, NCCL_PTR_HOST), res, exit);
+	OFINCCLCHECKGOTO(initialize_buff((void *)buf, max_size, NCCL_PTR_HOST), res, exit);
+	OFINCCLCHECKGOTO(extNet->regMr(comm, (void *)buf, max_size, NCCL_PTR_HOST, &mhandle),
+			 res, exit);
+
+	if (rank == 0) {
+		printf("# Chunk size: %s, chunk window: %s\n",
+		       chunk_size ? chunk_size : "default",
+		       chunk_window ? chunk_window : "default");
+		printf("# %12s %10s %12s\n", "Size (B)", "Iters", "BW (GB/s)");
+	}
+
+	for (size_t szidx = 0; szidx < num_msg_sizes; szidx++) {
+		size_t size = msg_sizes[szidx];
+		size_t iters = NCCL_OFI_MAX(BYTES_PER_SIZE / size, (size_t)MIN_ITERATIONS);
+		struct timespec start, end;
+
+		MPI_Barrier(MPI_COMM_WORLD);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		OFINCCLCHECKGOTO(run_size(extNet, rank, comm, buf, mhandle, size, iters), res, exit);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		if (rank == 0) {
+			printf("  %12zu %10zu %12.3f\n", size, iters,
+			       (double)(size * iters) / elapsed_s(&start, &end) * 1e-9);
+		}
+	}
+
+	MPI_Barrier(MPI_COMM_WORLD);
+
+	OFINCCLCHECKGOTO(extNet->deregMr(comm, mhandle), res, exit);
+	mhandle = NULL;
+	OFINCCLCHECKGOTO(extNet->closeListen((void *)lComm), res, exit);
+	lComm = NULL;
+	OFINCCLCHECKGOTO(extNet->closeSend((void *)sComm), res, exit);
+	sComm = NULL;
+	OFINCCLCHECKGOTO(extNet->closeRecv((void *)rComm), res, exit);
+	rComm = NULL;
+
+	MPI_Finalize();
+	NCCL_OFI_INFO(NCCL_NET, "Benchmark completed successfully for rank %d", rank);
+
+exit:
+	if (buf) {
+		ncclResult_t close_res = deallocate_buffer(buf, NCCL_PTR_HOST);
+		if (close_res != ncclSuccess) {
+			NCCL_OFI_WARN("Buffer deallocation failure: %d", close_res);
+			res = res ? res : close_res;
+		}
+		buf = NULL;
+	}
+
+	return res;
+}
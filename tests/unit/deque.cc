@@ -4,11 +4,16 @@
 
 #include "config.h"
 
+#include <pthread.h>
 #include <stdio.h>
+#include <time.h>
 
 #include "test-common.hpp"
 #include "nccl_ofi_deque.h"
 
+#define BENCH_ELEMS_PER_PRODUCER (200000)
+#define BENCH_MAX_PRODUCERS (4)
+
 #define test_get_front(deque, expected) \
 { \
 	nccl_ofi_deque_elem_t *elem = nccl_ofi_deque_get_front(deque); \
@@ -30,6 +35,184 @@
 	} \
 }
 
+struct bench_elem_t {
+	nccl_ofi_deque_elem_t de;
+	int producer;
+	int seq;
+	bool retried;
+};
+
+struct bench_producer_t {
+	nccl_ofi_deque_t *deque;
+	struct bench_elem_t *elems;
+	int id;
+};
+
+static void *bench_produce(void *arg)
+{
+	struct bench_producer_t *producer = (struct bench_producer_t *)arg;
+
+	for (int i = 0; i < BENCH_ELEMS_PER_PRODUCER; i++) {
+		producer->elems[i].producer = producer->id;
+		producer->elems[i].seq = i;
+		producer->elems[i].retried = false;
+		if (nccl_ofi_deque_insert_back(producer->deque, &producer->elems[i].de) != 0) {
+			NCCL_OFI_WARN("insert_back unexpectedly failed");
+			exit(1);
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Producers insert at the back while the main thread consumes from
+ * the front. Every fourth removed element is put back at the front
+ * and removed again, like a pending request retried after EAGAIN.
+ * Elements of each producer must be removed in insertion order.
+ */
+static void bench_mpsc(nccl_ofi_deque_mode_t mode, const char *name, int num_producers)
+{
+	static struct bench_elem_t elems[BENCH_MAX_PRODUCERS][BENCH_ELEMS_PER_PRODUCER];
+	struct bench_producer_t producers[BENCH_MAX_PRODUCERS];
+	pthread_t threads[BENCH_MAX_PRODUCERS];
+	int next_seq[BENCH_MAX_PRODUCERS] = {0};
+	size_t total = (size_t)num_producers * BENCH_ELEMS_PER_PRODUCER;
+	size_t removed = 0, retried = 0;
+	nccl_ofi_deque_elem_t *deque_elem;
+	nccl_ofi_deque_t *deque;
+	struct timespec start, end;
+
+	if (nccl_ofi_deque_init_mode(&deque, mode) != 0) {
+		NCCL_OFI_WARN("deque_init failed");
+		exit(1);
+	}
+	if (!nccl_ofi_deque_consumer_begin(deque)) {
+		NCCL_OFI_WARN("consumer_begin unexpectedly failed");
+		exit(1);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int p = 0; p < num_producers; p++) {
+		producers[p].deque = deque;
+		producers[p].elems = elems[p];
+		producers[p].id = p;
+		if (pthread_create(&threads[p], NULL, bench_produce, &producers[p]) != 0) {
+			NCCL_OFI_WARN("pthread_create failed");
+			exit(1);
+		}
+	}
+
+	while (removed < total) {
+		if (nccl_ofi_deque_remove_front(deque, &deque_elem) != 0) {
+			NCCL_OFI_WARN("remove_front unexpectedly failed");
+			exit(1);
+		}
+		if (deque_elem == NULL) {
+			continue;
+		}
+		struct bench_elem_t *elem = container_of(deque_elem, struct bench_elem_t, de);
+		if (elem->seq != next_seq[elem->producer]) {
+			NCCL_OFI_WARN("%s: producer %d element %d removed, expected %d", name,
+				      elem->producer, elem->seq, next_seq[elem->producer]);
+			exit(1);
+		}
+		if ((elem->seq & 3) == 0 && !elem->retried) {
+			elem->retried = true;
+			retried++;
+			if (nccl_ofi_deque_insert_front(deque, deque_elem) != 0) {
+				NCCL_OFI_WARN("insert_front unexpectedly failed");
+				exit(1);
+			}
+			continue;
+		}
+		next_seq[elem->producer]++;
+		removed++;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	for (int p = 0; p < num_producers; p++) {
+		pthread_join(threads[p], NULL);
+	}
+
+	if (!nccl_ofi_deque_isempty(deque) || nccl_ofi_deque_size(deque) != 0) {
+		NCCL_OFI_WARN("%s: deque not empty after removing all elements", name);
+		exit(1);
+	}
+	nccl_ofi_deque_consumer_end(deque);
+	if (nccl_ofi_deque_finalize(deque) != 0) {
+		NCCL_OFI_WARN("deque_finalize failed");
+		exit(1);
+	}
+
+	double secs = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+	printf("%-5s %d producers: %8.2f Mops/s\n", name, num_producers,
+	       (double)(total + retried) / secs * 1e-6);
+}
+
+/*
+ * Single-threaded ordering of a MPSC deque, with elements put back at
+ * the front
+ */
+static void test_mpsc(void)
+{
+	const int num_elem = 8;
+	struct bench_elem_t elems[num_elem];
+	nccl_ofi_deque_elem_t *deque_elem;
+	nccl_ofi_deque_t *deque;
+	/* Elements 0 and 1 are removed, put back and removed again */
+	const int expected[] = {0, 1, 1, 0, 2, 3, 4, 5, 6, 7};
+
+	if (nccl_ofi_deque_init_mode(&deque, NCCL_OFI_DEQUE_MODE_MPSC) != 0 ||
+	    !nccl_ofi_deque_consumer_begin(deque)) {
+		NCCL_OFI_WARN("MPSC deque_init failed");
+		exit(1);
+	}
+
+	if (!nccl_ofi_deque_isempty(deque)) {
+		NCCL_OFI_WARN("New MPSC deque is not empty");
+		exit(1);
+	}
+
+	for (int i = 0; i < num_elem; i++) {
+		elems[i].seq = i;
+		nccl_ofi_deque_insert_back(deque, &elems[i].de);
+	}
+
+	for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+		nccl_ofi_deque_remove_front(deque, &deque_elem);
+		if (deque_elem == NULL ||
+		    container_of(deque_elem, struct bench_elem_t, de)->seq != expected[i]) {
+			NCCL_OFI_WARN("MPSC remove_front bad result at %zu", i);
+			exit(1);
+		}
+		if (i == 1) {
+			/* Put back 0 and 1, 1 ends up in front */
+			nccl_ofi_deque_insert_front(deque, &elems[0].de);
+			nccl_ofi_deque_insert_front(deque, &elems[1].de);
+		}
+	}
+
+	nccl_ofi_deque_remove_front(deque, &deque_elem);
+	if (deque_elem != NULL || !nccl_ofi_deque_isempty(deque)) {
+		NCCL_OFI_WARN("remove_front from empty MPSC deque unexpectedly succeeded");
+		exit(1);
+	}
+
+	/* The queue is reusable after running empty */
+	nccl_ofi_deque_insert_back(deque, &elems[3].de);
+	nccl_ofi_deque_remove_front(deque, &deque_elem);
+	if (deque_elem != &elems[3].de) {
+		NCCL_OFI_WARN("MPSC remove_front after reuse failed");
+		exit(1);
+	}
+
+	nccl_ofi_deque_consumer_end(deque);
+	if (nccl_ofi_deque_finalize(deque) != 0) {
+		NCCL_OFI_WARN("deque_finalize failed");
+		exit(1);
+	}
+}
+
 int main(int argc, char *argv[])
 {
 	const size_t num_elem = 11;
@@ -67,6 +250,10 @@ int main(int argc, char *argv[])
 		NCCL_OFI_WARN("insert_front unexpectedly failed");
 		exit(1);
 	}
+	if (nccl_ofi_deque_size(deque) != num_elem) {
+		NCCL_OFI_WARN("Unexpected deque size %zu after inserts", nccl_ofi_deque_size(deque));
+		exit(1);
+	}
 
 	/* Test remove_front */
 	for (i = 0; i < num_elem; ++i) {
@@ -102,6 +289,11 @@ int main(int argc, char *argv[])
 	nccl_ofi_deque_remove(deque, &elems[num_elem/2].de);
 	nccl_ofi_deque_remove(deque, &elems[num_elem-1].de);
 
+	if (nccl_ofi_deque_size(deque) != num_elem - 3) {
+		NCCL_OFI_WARN("Unexpected deque size %zu after removes", nccl_ofi_deque_size(deque));
+		exit(1);
+	}
+
 	/** Test expected ordering after removes **/
 	int exp_next = -2; /* -2 means uninitialized */
 	for (i = 0 ; i < num_elem; i++) {
@@ -143,6 +335,11 @@ int main(int argc, char *argv[])
 
 	test_get_front(deque, -1);
 
+	if (nccl_ofi_deque_size(deque) != 0) {
+		NCCL_OFI_WARN("Unexpected size %zu of empty deque", nccl_ofi_deque_size(deque));
+		exit(1);
+	}
+
 	if (exp_next != -1) {
 		NCCL_OFI_WARN("get_next was unexpectedly fruitful");
 		exit(1);
@@ -160,6 +357,13 @@ int main(int argc, char *argv[])
 		exit(1);
 	}
 
+	test_mpsc();
+
+	for (int num_producers = 1; num_producers <= BENCH_MAX_PRODUCERS; num_producers *= 2) {
+		bench_mpsc(NCCL_OFI_DEQUE_MODE_MUTEX, "mutex", num_producers);
+		bench_mpsc(NCCL_OFI_DEQUE_MODE_MPSC, "mpsc", num_producers);
+	}
+
 	printf("Test completed successfully!\n");
 
 	return 0;
@@ -4,7 +4,9 @@
 
 #include "config.h"
 
+#include <pthread.h>
 #include <stdio.h>
+#include <time.h>
 
 #include "test-common.hpp"
 #include "nccl_ofi_freelist.h"
@@ -44,21 +46,19 @@ struct random_freelisted_item {
 	char buf[419];
 };
 
-int main(int argc, char *argv[])
+static void test_functional(nccl_ofi_freelist_mode_t mode)
 {
 	struct nccl_ofi_freelist_t *freelist;
 	void *entry;
 	int ret;
 	size_t i;
 
-	system_page_size = 4096;
-	ofi_log_function = logger;
-
 	/* initial size larger than max size */
 	ret = nccl_ofi_freelist_init(1,
 				     16,
 				     0,
 				     8,
+				     mode,
 				     &freelist);
 	if (ret != ncclSuccess) {
 		NCCL_OFI_WARN("freelist_init failed: %d", ret);
@@ -78,11 +78,30 @@ int main(int argc, char *argv[])
 	}
 	nccl_ofi_freelist_fini(freelist);
 
+	/* no initial entries, memory allocated by the first allocation */
+	ret = nccl_ofi_freelist_init(1, 0, 8, 8, mode, &freelist);
+	if (ret != ncclSuccess) {
+		NCCL_OFI_WARN("freelist_init failed: %d", ret);
+		exit(1);
+	}
+	if (freelist->blocks != NULL) {
+		NCCL_OFI_WARN("freelist without initial entries allocated memory");
+		exit(1);
+	}
+	entry = nccl_ofi_freelist_entry_alloc(freelist);
+	if (!entry || freelist->blocks == NULL) {
+		NCCL_OFI_WARN("first allocation did not grow the freelist");
+		exit(1);
+	}
+	nccl_ofi_freelist_entry_free(freelist, entry);
+	nccl_ofi_freelist_fini(freelist);
+
 	/* require addition to reach full size */
 	ret = nccl_ofi_freelist_init(1,
 				     8,
 				     8,
 				     16,
+				     mode,
 				     &freelist);
 	if (ret != ncclSuccess) {
 		NCCL_OFI_WARN("freelist_init failed: %d", ret);
@@ -107,6 +126,7 @@ int main(int argc, char *argv[])
 				     8,
 				     8,
 				     0,
+				     mode,
 				     &freelist);
 	if (ret != ncclSuccess) {
 		NCCL_OFI_WARN("freelist_init failed: %d", ret);
@@ -127,6 +147,7 @@ int main(int argc, char *argv[])
 				     8,
 				     8,
 				     16,
+				     mode,
 				     &freelist);
 	if (ret != ncclSuccess) {
 		NCCL_OFI_WARN("freelist_init failed: %d", ret);
@@ -147,6 +168,7 @@ int main(int argc, char *argv[])
 				     16,
 				     0,
 				     16,
+				     mode,
 				     &freelist);
 	if (ret != ncclSuccess) {
 		NCCL_OFI_WARN("freelist_init failed: %d", ret);
@@ -185,6 +207,9 @@ int main(int argc, char *argv[])
 					(void *)0xdeadbeaf,
 					offsetof(struct random_freelisted_item, reginfo),
 					1,
+					false,
+					-1,
+					mode,
 					&freelist);
 	if (ret != ncclSuccess) {
 		NCCL_OFI_WARN("freelist_init failed: %d", ret);
@@ -219,6 +244,198 @@ int main(int argc, char *argv[])
 		NCCL_OFI_WARN("looks like deregistration not called");
 		exit(1);
 	}
+}
+
+/*
+ * Blocks backed by huge pages cover full huge pages, with or without
+ * huge pages reserved on the system
+ */
+static void test_huge_pages(void)
+{
+	struct nccl_ofi_freelist_t *freelist;
+	int ret;
+
+	simple_base = NULL;
+	ret = nccl_ofi_freelist_init_mr(1024,
+					32,
+					0,
+					0,
+					regmr_simple,
+					deregmr_simple,
+					(void *)0xdeadbeaf,
+					offsetof(struct random_freelisted_item, reginfo),
+					1,
+					true,
+					0,
+					NCCL_OFI_FREELIST_MODE_MUTEX,
+					&freelist);
+	if (ret != ncclSuccess) {
+		NCCL_OFI_WARN("freelist_init failed: %d", ret);
+		exit(1);
+	}
+	if (simple_size % NCCL_OFI_HUGE_PAGE_SIZE != 0 ||
+	    (uintptr_t)simple_base % NCCL_OFI_HUGE_PAGE_SIZE != 0) {
+		NCCL_OFI_WARN("block %p size %zu does not cover full huge pages",
+			      simple_base, simple_size);
+		exit(1);
+	}
+	/* The block is padded with entries up to the huge page size */
+	for (size_t i = 0 ; i < 1024 ; i++) {
+		if (!nccl_ofi_freelist_entry_alloc(freelist)) {
+			NCCL_OFI_WARN("allocation unexpectedly failed");
+			exit(1);
+		}
+	}
+	if (freelist->blocks->next != NULL) {
+		NCCL_OFI_WARN("freelist grew although the first block has room");
+		exit(1);
+	}
+	nccl_ofi_freelist_fini(freelist);
+}
+
+/*
+ * Entries cached by a thread are returned to the freelist when the
+ * thread exits
+ */
+static void *magazine_thread(void *arg)
+{
+	struct nccl_ofi_freelist_t *freelist = (struct nccl_ofi_freelist_t *)arg;
+	void *entries[8];
+
+	for (size_t i = 0 ; i < 8 ; i++) {
+		entries[i] = nccl_ofi_freelist_entry_alloc(freelist);
+		if (!entries[i]) {
+			NCCL_OFI_WARN("allocation unexpectedly failed");
+			exit(1);
+		}
+	}
+	for (size_t i = 0 ; i < 8 ; i++) {
+		nccl_ofi_freelist_entry_free(freelist, entries[i]);
+	}
+
+	return NULL;
+}
+
+static void test_magazine_thread_exit(void)
+{
+	struct nccl_ofi_freelist_t *freelist;
+	pthread_t thread;
+	int ret;
+
+	ret = nccl_ofi_freelist_init(1, 8, 0, 8, NCCL_OFI_FREELIST_MODE_CACHE, &freelist);
+	if (ret != ncclSuccess) {
+		NCCL_OFI_WARN("freelist_init failed: %d", ret);
+		exit(1);
+	}
+
+	pthread_create(&thread, NULL, magazine_thread, freelist);
+	pthread_join(thread, NULL);
+
+	for (size_t i = 0 ; i < 8 ; i++) {
+		if (!nccl_ofi_freelist_entry_alloc(freelist)) {
+			NCCL_OFI_WARN("allocation of entry cached by exited thread failed");
+			exit(1);
+		}
+	}
+	nccl_ofi_freelist_fini(freelist);
+}
+
+/*
+ * Contention benchmark: threads allocate and release bursts of
+ * entries from a shared freelist
+ */
+static const size_t bench_burst = 8;
+static const size_t bench_iters = 200000;
+static const size_t bench_max_threads = 16;
+
+struct bench_item {
+	size_t owner;
+	char buf[120];
+};
+
+struct bench_args {
+	struct nccl_ofi_freelist_t *freelist;
+	size_t id;
+};
+
+static void *bench_thread(void *arg)
+{
+	struct bench_args *args = (struct bench_args *)arg;
+	struct bench_item *items[bench_burst];
+
+	for (size_t iter = 0 ; iter < bench_iters / bench_burst ; iter++) {
+		for (size_t i = 0 ; i < bench_burst ; i++) {
+			items[i] = (struct bench_item *)nccl_ofi_freelist_entry_alloc(args->freelist);
+			if (!items[i]) {
+				NCCL_OFI_WARN("allocation unexpectedly failed");
+				exit(1);
+			}
+			items[i]->owner = args->id;
+		}
+		for (size_t i = 0 ; i < bench_burst ; i++) {
+			if (items[i]->owner != args->id) {
+				NCCL_OFI_WARN("entry handed out twice");
+				exit(1);
+			}
+			nccl_ofi_freelist_entry_free(args->freelist, items[i]);
+		}
+	}
+
+	return NULL;
+}
+
+static void run_bench(nccl_ofi_freelist_mode_t mode, const char *name, size_t num_threads)
+{
+	struct nccl_ofi_freelist_t *freelist;
+	pthread_t threads[bench_max_threads];
+	struct bench_args args[bench_max_threads];
+	struct timespec start, end;
+	int ret;
+
+	assert(num_threads <= bench_max_threads);
+
+	ret = nccl_ofi_freelist_init(sizeof(struct bench_item), 64, 64, 0, mode, &freelist);
+	if (ret != ncclSuccess) {
+		NCCL_OFI_WARN("freelist_init failed: %d", ret);
+		exit(1);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0 ; i < num_threads ; i++) {
+		args[i].freelist = freelist;
+		args[i].id = i;
+		pthread_create(&threads[i], NULL, bench_thread, &args[i]);
+	}
+	for (size_t i = 0 ; i < num_threads ; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double elapsed = (double)(end.tv_sec - start.tv_sec) * 1e9 + (double)(end.tv_nsec - start.tv_nsec);
+	printf("%-8s %2zu threads: %6.1f ns per alloc/free pair per thread, %zu entries allocated\n",
+	       name, num_threads, elapsed / bench_iters, freelist->num_allocated_entries);
+
+	nccl_ofi_freelist_fini(freelist);
+}
+
+int main(int argc, char *argv[])
+{
+	system_page_size = 4096;
+	ofi_log_function = logger;
+
+	test_functional(NCCL_OFI_FREELIST_MODE_MUTEX);
+	test_functional(NCCL_OFI_FREELIST_MODE_CACHE);
+	test_functional(NCCL_OFI_FREELIST_MODE_LOCKFREE);
+
+	test_huge_pages();
+
+	test_magazine_thread_exit();
+
+	for (size_t num_threads = 1 ; num_threads <= bench_max_threads ; num_threads *= 4) {
+		run_bench(NCCL_OFI_FREELIST_MODE_MUTEX, "mutex", num_threads);
+		run_bench(NCCL_OFI_FREELIST_MODE_CACHE, "cache", num_threads);
+		run_bench(NCCL_OFI_FREELIST_MODE_LOCKFREE, "lockfree", num_threads);
+	}
 
 	printf("Test completed successfully\n");
 
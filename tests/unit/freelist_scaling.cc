@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+/*
+ * Memory and memory registration footprint of the request and control
+ * buffer free lists of RDMA communicators, as a function of the number
+ * of communicators. Compares free lists allocated per communicator
+ * with quotas of free lists shared by the endpoint (see
+ * OFI_NCCL_RDMA_SHARED_COMM_POOLS), while every communicator keeps a
+ * few requests and a control buffer in use.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test-common.hpp"
+#include "nccl_ofi_freelist.h"
+#include "nccl_ofi_rdma.h"
+
+/* Requests and control buffers in use per communicator */
+#define REQS_IN_USE (2)
+#define CTRL_IN_USE (1)
+
+static size_t num_mrs = 0;
+static size_t max_mrs = 0;
+
+static int regmr_count(void *opaque, void *data, size_t size, void **handle)
+{
+	*handle = data;
+	num_mrs++;
+	max_mrs = NCCL_OFI_MAX(max_mrs, num_mrs);
+	return 0;
+}
+
+static int deregmr_count(void *handle)
+{
+	num_mrs--;
+	return 0;
+}
+
+/*
+ * @brief	Bytes of the blocks of a freelist and of the freelist itself
+ */
+static size_t freelist_bytes(nccl_ofi_freelist_t *freelist)
+{
+	size_t bytes = sizeof(*freelist);
+
+	for (struct nccl_ofi_freelist_block_t *block = freelist->blocks; block; block = block->next) {
+		bytes += block->memory_size;
+	}
+	return bytes;
+}
+
+struct comm {
+	nccl_ofi_freelist_t *reqs_fl;
+	nccl_ofi_freelist_t *ctrl_fl;
+	void *reqs[REQS_IN_USE];
+	void *ctrl[CTRL_IN_USE];
+};
+
+/*
+ * @brief	Allocate the requests and control buffers a communicator
+ *		keeps in use
+ */
+static void comm_use(struct comm *comm)
+{
+	for (int i = 0; i < REQS_IN_USE; i++) {
+		comm->reqs[i] = nccl_ofi_freelist_entry_alloc(comm->reqs_fl);
+		if (!comm->reqs[i]) {
+			NCCL_OFI_WARN("Failed to allocate request");
+			exit(1);
+		}
+	}
+	for (int i = 0; i < CTRL_IN_USE; i++) {
+		comm->ctrl[i] = nccl_ofi_freelist_entry_alloc(comm->ctrl_fl);
+		if (!comm->ctrl[i]) {
+			NCCL_OFI_WARN("Failed to allocate control buffer");
+			exit(1);
+		}
+	}
+}
+
+static void comm_release(struct comm *comm)
+{
+	for (int i = 0; i < REQS_IN_USE; i++) {
+		nccl_ofi_freelist_entry_free(comm->reqs_fl, comm->reqs[i]);
+	}
+	for (int i = 0; i < CTRL_IN_USE; i++) {
+		nccl_ofi_freelist_entry_free(comm->ctrl_fl, comm->ctrl[i]);
+	}
+	if (nccl_ofi_freelist_fini(comm->reqs_fl) || nccl_ofi_freelist_fini(comm->ctrl_fl)) {
+		NCCL_OFI_WARN("Failed to finalize freelists of communicator");
+		exit(1);
+	}
+}
+
+static void run_scaling(size_t num_comms, bool shared)
+{
+	nccl_ofi_freelist_t *ep_reqs_fl = NULL, *ep_ctrl_fl = NULL;
+	size_t bytes = 0;
+	int ret;
+
+	struct comm *comms = (struct comm *)calloc(num_comms, sizeof(struct comm));
+	if (!comms) {
+		NCCL_OFI_WARN("Failed to allocate communicators");
+		exit(1);
+	}
+
+	if (shared) {
+		ret = nccl_ofi_freelist_init(sizeof(nccl_net_ofi_rdma_req_t), 16, 64, 0,
+					     NCCL_OFI_FREELIST_MODE_MUTEX, &ep_reqs_fl);
+		if (ret == 0) {
+			ret = nccl_ofi_freelist_init_mr(sizeof(nccl_net_ofi_rdma_ctrl_fl_item_t), 8, 64, 0,
+							regmr_count, deregmr_count, NULL, 0, 1,
+							false, -1, NCCL_OFI_FREELIST_MODE_MUTEX,
+							&ep_ctrl_fl);
+		}
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to initialize endpoint freelists");
+			exit(1);
+		}
+	}
+
+	for (size_t c = 0; c < num_comms; c++) {
+		if (shared) {
+			ret = nccl_ofi_freelist_init_quota(ep_reqs_fl, 4 * NCCL_OFI_MAX_REQUESTS,
+							   &comms[c].reqs_fl);
+			if (ret == 0) {
+				ret = nccl_ofi_freelist_init_quota(ep_ctrl_fl, NCCL_OFI_MAX_REQUESTS,
+								   &comms[c].ctrl_fl);
+			}
+		} else {
+			ret = nccl_ofi_freelist_init(sizeof(nccl_net_ofi_rdma_req_t), 16, 16,
+						     4 * NCCL_OFI_MAX_REQUESTS,
+						     NCCL_OFI_FREELIST_MODE_MUTEX, &comms[c].reqs_fl);
+			if (ret == 0) {
+				ret = nccl_ofi_freelist_init_mr(sizeof(nccl_net_ofi_rdma_ctrl_fl_item_t), 8, 8,
+								NCCL_OFI_MAX_REQUESTS, regmr_count,
+								deregmr_count, NULL, 0, 1, false, -1,
+								NCCL_OFI_FREELIST_MODE_MUTEX,
+								&comms[c].ctrl_fl);
+			}
+		}
+		if (ret != 0) {
+			NCCL_OFI_WARN("Failed to initialize freelists of communicator %zu", c);
+			exit(1);
+		}
+		comm_use(&comms[c]);
+	}
+
+	if (shared) {
+		bytes = freelist_bytes(ep_reqs_fl) + freelist_bytes(ep_ctrl_fl) +
+			num_comms * 2 * sizeof(nccl_ofi_freelist_t);
+	} else {
+		for (size_t c = 0; c < num_comms; c++) {
+			bytes += freelist_bytes(comms[c].reqs_fl) + freelist_bytes(comms[c].ctrl_fl);
+		}
+	}
+
+	printf("%-8s %6zu comms: %10.2f MiB, %6zu MRs\n", shared ? "shared" : "per-comm",
+	       num_comms, (double)bytes / (1024.0 * 1024.0), num_mrs);
+
+	for (size_t c = 0; c < num_comms; c++) {
+		comm_release(&comms[c]);
+	}
+	if (shared) {
+		if (nccl_ofi_freelist_fini(ep_reqs_fl) || nccl_ofi_freelist_fini(ep_ctrl_fl)) {
+			NCCL_OFI_WARN("Failed to finalize endpoint freelists");
+			exit(1);
+		}
+	}
+	if (num_mrs != 0) {
+		NCCL_OFI_WARN("%zu memory registrations leaked", num_mrs);
+		exit(1);
+	}
+
+	free(comms);
+}
+
+/*
+ * @brief	Check that a quota bounds the entries in use without
+ *		limiting other quotas of the same freelist
+ */
+static void test_quota(void)
+{
+	nccl_ofi_freelist_t *parent, *quota_a, *quota_b;
+	static void *entries[NCCL_OFI_MAX_REQUESTS];
+	void *entry;
+
+	if (nccl_ofi_freelist_init(64, 8, 8, 0, NCCL_OFI_FREELIST_MODE_DEFAULT, &parent) ||
+	    nccl_ofi_freelist_init_quota(parent, NCCL_OFI_MAX_REQUESTS, &quota_a) ||
+	    nccl_ofi_freelist_init_quota(parent, NCCL_OFI_MAX_REQUESTS, &quota_b)) {
+		NCCL_OFI_WARN("Failed to initialize quotas");
+		exit(1);
+	}
+
+	if (nccl_ofi_freelist_init_quota(parent, 0, &quota_b) != -EINVAL) {
+		NCCL_OFI_WARN("Empty quota was not rejected");
+		exit(1);
+	}
+
+	for (int i = 0; i < NCCL_OFI_MAX_REQUESTS; i++) {
+		entries[i] = nccl_ofi_freelist_entry_alloc(quota_a);
+		if (!entries[i]) {
+			NCCL_OFI_WARN("Allocation %d within quota failed", i);
+			exit(1);
+		}
+	}
+	if (nccl_ofi_freelist_entry_alloc(quota_a) != NULL) {
+		NCCL_OFI_WARN("Allocation beyond quota succeeded");
+		exit(1);
+	}
+
+	entry = nccl_ofi_freelist_entry_alloc(quota_b);
+	if (!entry) {
+		NCCL_OFI_WARN("Allocation of second quota failed");
+		exit(1);
+	}
+	nccl_ofi_freelist_entry_free(quota_b, entry);
+
+	nccl_ofi_freelist_entry_free(quota_a, entries[0]);
+	entries[0] = nccl_ofi_freelist_entry_alloc(quota_a);
+	if (!entries[0]) {
+		NCCL_OFI_WARN("Allocation after release failed");
+		exit(1);
+	}
+
+	for (int i = 0; i < NCCL_OFI_MAX_REQUESTS; i++) {
+		nccl_ofi_freelist_entry_free(quota_a, entries[i]);
+	}
+	if (quota_a->num_allocated_entries != 0 || quota_b->num_allocated_entries != 0) {
+		NCCL_OFI_WARN("Quotas still account entries in use");
+		exit(1);
+	}
+
+	if (nccl_ofi_freelist_fini(quota_a) || nccl_ofi_freelist_fini(quota_b) ||
+	    nccl_ofi_freelist_fini(parent)) {
+		NCCL_OFI_WARN("Failed to finalize quotas");
+		exit(1);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static const size_t num_comms[] = {1, 100, 10000};
+
+	system_page_size = 4096;
+	ofi_log_function = logger;
+
+	test_quota();
+
+	printf("Freelists of communicators with %d requests and %d control buffers in use\n",
+	       REQS_IN_USE, CTRL_IN_USE);
+	for (size_t i = 0; i < sizeof(num_comms) / sizeof(num_comms[0]); i++) {
+		run_scaling(num_comms[i], false);
+		run_scaling(num_comms[i], true);
+	}
+
+	printf("Test completed successfully!\n");
+
+	return 0;
+}
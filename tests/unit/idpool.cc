@@ -4,18 +4,159 @@
 
 #include "config.h"
 
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 
 #include "test-common.hpp"
 #include "nccl_ofi_idpool.h"
 #include "nccl_ofi_math.h"
 
-int main(int argc, char *argv[]) {
+/* Size of the pool of communicator IDs of the RDMA protocol */
+#define BENCH_POOL_SIZE (1 << 18)
+#define BENCH_ITERATIONS (1000000)
+#define MAX_THREADS (4)
+/* Pool of two levels for churn with all IDs held */
+#define FULL_POOL_SIZE (4096)
 
-	ofi_log_function = logger;
+static inline double elapsed_ns(const struct timespec *start, const struct timespec *end)
+{
+	return (double)(end->tv_sec - start->tv_sec) * 1e9 + (double)(end->tv_nsec - start->tv_nsec);
+}
+
+struct churn_args {
+	nccl_ofi_idpool_t *idpool;
+	/* Owner flag of each ID, to detect IDs handed out twice */
+	char *owned;
+	/* IDs held by this thread */
+	int *held;
+	size_t num_held;
+	unsigned int seed;
+};
+
+/*
+ * @brief	Repeatedly release a random held ID and allocate a new one
+ */
+static void *churn_thread(void *arg)
+{
+	struct churn_args *args = (struct churn_args *)arg;
+
+	for (size_t i = 0; i < BENCH_ITERATIONS; i++) {
+		size_t slot = (size_t)rand_r(&args->seed) % args->num_held;
+
+		__atomic_store_n(&args->owned[args->held[slot]], 0, __ATOMIC_RELAXED);
+		if (nccl_ofi_idpool_free_id(args->idpool, args->held[slot]) != 0) {
+			NCCL_OFI_WARN("Failed to free ID %d", args->held[slot]);
+			exit(1);
+		}
+
+		int id = nccl_ofi_idpool_allocate_id(args->idpool);
+		if (id < 0) {
+			NCCL_OFI_WARN("Failed to allocate ID");
+			exit(1);
+		}
+		if (__atomic_exchange_n(&args->owned[id], 1, __ATOMIC_RELAXED) != 0) {
+			NCCL_OFI_WARN("ID %d allocated twice", id);
+			exit(1);
+		}
+		args->held[slot] = id;
+	}
+
+	return NULL;
+}
+
+/*
+ * @brief	Benchmark allocate/free churn on a pool of `pool_size' IDs
+ *		with about `num_free' IDs not held, and check that no ID is
+ *		handed out twice
+ *
+ * Each thread releases an ID before allocating one, so allocations
+ * must not fail even if all IDs are held.
+ */
+static void run_churn_bench(const char *name, nccl_ofi_idpool_mode_t mode, int num_threads,
+			    size_t pool_size, size_t num_free)
+{
+	nccl_ofi_idpool_t idpool{};
+	pthread_t threads[MAX_THREADS];
+	struct churn_args args[MAX_THREADS];
+	struct timespec start, end;
+	size_t num_held = (pool_size - num_free) / num_threads;
+
+	if (nccl_ofi_idpool_init_mode(&idpool, pool_size, mode) != 0) {
+		NCCL_OFI_WARN("Failed to initialize %s ID pool", name);
+		exit(1);
+	}
+
+	char *owned = (char *)calloc(pool_size, 1);
+	if (!owned) {
+		NCCL_OFI_WARN("Allocation failed");
+		exit(1);
+	}
+
+	for (int t = 0; t < num_threads; t++) {
+		args[t].idpool = &idpool;
+		args[t].owned = owned;
+		args[t].num_held = num_held;
+		args[t].seed = (unsigned int)t + 1;
+		args[t].held = (int *)malloc(sizeof(int) * num_held);
+		if (!args[t].held) {
+			NCCL_OFI_WARN("Allocation failed");
+			exit(1);
+		}
+		for (size_t i = 0; i < num_held; i++) {
+			args[t].held[i] = nccl_ofi_idpool_allocate_id(&idpool);
+			if (args[t].held[i] < 0) {
+				NCCL_OFI_WARN("Failed to allocate ID");
+				exit(1);
+			}
+			owned[args[t].held[i]] = 1;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int t = 0; t < num_threads; t++) {
+		if (pthread_create(&threads[t], NULL, churn_thread, &args[t])) {
+			NCCL_OFI_WARN("pthread_create failed");
+			exit(1);
+		}
+	}
+	for (int t = 0; t < num_threads; t++) {
+		pthread_join(threads[t], NULL);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double total_ns = elapsed_ns(&start, &end);
+	printf("%-8s idpool of %6zu IDs, %zu not held, %d threads: %7.1f ns per free and allocate per thread\n",
+	       name, pool_size, num_free, num_threads, total_ns / BENCH_ITERATIONS);
+
+	/* All IDs not held must be allocatable again */
+	num_free = pool_size - num_held * num_threads;
+	for (size_t i = 0; i < num_free; i++) {
+		int id = nccl_ofi_idpool_allocate_id(&idpool);
+		if (id < 0 || owned[id]) {
+			NCCL_OFI_WARN("Pool lost track of free IDs");
+			exit(1);
+		}
+		owned[id] = 1;
+	}
+	if (nccl_ofi_idpool_allocate_id(&idpool) != -ENOMEM) {
+		NCCL_OFI_WARN("Pool handed out more IDs than its size");
+		exit(1);
+	}
+
+	for (int t = 0; t < num_threads; t++) {
+		free(args[t].held);
+	}
+	free(owned);
+	nccl_ofi_idpool_fini(&idpool);
+}
+
+static void test_mode(nccl_ofi_idpool_mode_t mode)
+{
 	int ret = 0;
 	(void) ret; // Avoid unused-variable warning
-	size_t sizes[] = {0, 5, 63, 64, 65, 127, 128, 129, 255};
+	size_t sizes[] = {0, 5, 63, 64, 65, 127, 128, 129, 255, 4096, 4097, 262144, 262145};
 
 	for (long unsigned int t = 0; t < sizeof(sizes) / sizeof(size_t); t++) {
 		size_t size = sizes[t];
@@ -26,7 +167,7 @@ int main(int argc, char *argv[]) {
 		nccl_ofi_idpool_t idpool{};
 
 		/* Test nccl_ofi_idpool_init */
-		ret = nccl_ofi_idpool_init(&idpool, size);
+		ret = nccl_ofi_idpool_init_mode(&idpool, size, mode);
 		assert(0 == ret);
 		assert(idpool.size == size);
 
@@ -44,7 +185,10 @@ int main(int argc, char *argv[]) {
 		(void) id; // Avoid unused-variable warning
 		for (uint64_t i = 0; i < size; i++) {
 			id = nccl_ofi_idpool_allocate_id(&idpool);
-			assert((uint64_t)id == i);
+			if ((uint64_t)id != i) {
+				NCCL_OFI_WARN("Allocated ID %d instead of %lu", id, i);
+				exit(1);
+			}
 		}
 		id = nccl_ofi_idpool_allocate_id(&idpool);
 		assert(-ENOMEM == id);
@@ -87,7 +231,7 @@ int main(int argc, char *argv[]) {
 			if (i == num_long_elements - 1 && size % (sizeof(uint64_t) * 8)) {
 				assert((1ULL << (size % (sizeof(uint64_t) * 8))) - 1 == idpool.ids[i]);
 			} else {
-				assert(0xffffffffffffffff == idpool->ids[i]);
+				assert(0xffffffffffffffff == idpool.ids[i]);
 			}
 		}
 
@@ -99,6 +243,30 @@ int main(int argc, char *argv[]) {
 		ret = nccl_ofi_idpool_fini(&idpool);
 		assert(0 == ret);
 	}
+}
+
+int main(int argc, char *argv[]) {
+
+	ofi_log_function = logger;
+
+	test_mode(NCCL_OFI_IDPOOL_MODE_MUTEX);
+	test_mode(NCCL_OFI_IDPOOL_MODE_LOCKFREE);
+
+	for (int num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2) {
+		run_churn_bench("mutex", NCCL_OFI_IDPOOL_MODE_MUTEX, num_threads,
+				BENCH_POOL_SIZE, BENCH_POOL_SIZE / 10);
+		run_churn_bench("lockfree", NCCL_OFI_IDPOOL_MODE_LOCKFREE, num_threads,
+				BENCH_POOL_SIZE, BENCH_POOL_SIZE / 10);
+	}
+
+	/* Churn on a full pool, where allocations contend for the few
+	 * IDs being released */
+	for (int num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2) {
+		run_churn_bench("mutex", NCCL_OFI_IDPOOL_MODE_MUTEX, num_threads,
+				FULL_POOL_SIZE, 0);
+		run_churn_bench("lockfree", NCCL_OFI_IDPOOL_MODE_LOCKFREE, num_threads,
+				FULL_POOL_SIZE, 0);
+	}
 
 	printf("Test completed successfully!\n");
 
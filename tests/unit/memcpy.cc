@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test-common.hpp"
+#include "nccl_ofi_memcpy.h"
+
+#define MAX_LEN (256 * 1024)
+#define GUARD (128)
+#define MAX_MISALIGN (64)
+
+static char src[MAX_LEN + MAX_MISALIGN];
+static char dst[GUARD + MAX_LEN + MAX_MISALIGN + GUARD];
+
+static const size_t lens[] = {0, 1, 7, 31, 32, 33, 63, 64, 65, 127, 128, 129, 255, 256, 257,
+			      1000, 4096, 4099, 65536, 65536 + 17, MAX_LEN};
+static const size_t num_lens = sizeof(lens) / sizeof(lens[0]);
+
+static const size_t misaligns[] = {0, 1, 8, 31, 32, 63};
+static const size_t num_misaligns = sizeof(misaligns) / sizeof(misaligns[0]);
+
+/*
+ * @brief	Copy with the given instruction set and check the
+ *		destination range and the bytes surrounding it
+ */
+static void check_copy(const char *name, nccl_ofi_memcpy_isa_t isa, size_t len,
+		       size_t src_off, size_t dst_off)
+{
+	char *d = dst + GUARD + dst_off;
+	const char *s = src + src_off;
+
+	memset(dst, 0xa5, sizeof(dst));
+	nccl_ofi_memcpy_nt_isa_copy(isa, d, s, len);
+
+	if (memcmp(d, s, len) != 0) {
+		NCCL_OFI_WARN("%s: wrong data for len %zu src offset %zu dst offset %zu",
+			      name, len, src_off, dst_off);
+		exit(1);
+	}
+	for (char *p = dst; p < d; p++) {
+		if ((unsigned char)*p != 0xa5) {
+			NCCL_OFI_WARN("%s: write before destination for len %zu", name, len);
+			exit(1);
+		}
+	}
+	for (char *p = d + len; p < dst + sizeof(dst); p++) {
+		if ((unsigned char)*p != 0xa5) {
+			NCCL_OFI_WARN("%s: write past destination for len %zu", name, len);
+			exit(1);
+		}
+	}
+}
+
+static void test_isa(const char *name, nccl_ofi_memcpy_isa_t isa)
+{
+	for (size_t i = 0; i < num_lens; i++) {
+		for (size_t s = 0; s < num_misaligns; s++) {
+			for (size_t d = 0; d < num_misaligns; d++) {
+				check_copy(name, isa, lens[i], misaligns[s], misaligns[d]);
+			}
+		}
+	}
+	printf("%s copy verified\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+	ofi_log_function = logger;
+
+	for (size_t i = 0; i < sizeof(src); i++) {
+		src[i] = (char)(i * 7 + 3);
+	}
+
+	nccl_ofi_memcpy_isa_t isa = nccl_ofi_memcpy_nt_isa();
+
+	test_isa("memcpy", NCCL_OFI_MEMCPY_ISA_NONE);
+	if (isa >= NCCL_OFI_MEMCPY_ISA_AVX2) {
+		test_isa("avx2", NCCL_OFI_MEMCPY_ISA_AVX2);
+	}
+	if (isa >= NCCL_OFI_MEMCPY_ISA_AVX512) {
+		test_isa("avx512", NCCL_OFI_MEMCPY_ISA_AVX512);
+	}
+
+	/* Both sides of the non-temporal threshold */
+	memset(dst, 0, sizeof(dst));
+	nccl_ofi_memcpy(dst, src, 4096, 4096);
+	nccl_ofi_memcpy(dst + 4096, src + 4096, 4095, 4096);
+	if (memcmp(dst, src, 4096 + 4095) != 0) {
+		NCCL_OFI_WARN("Wrong data of threshold copies");
+		exit(1);
+	}
+
+	printf("Test completed successfully!\n");
+
+	return 0;
+}
@@ -4,10 +4,13 @@
 
 #include "config.h"
 
+#include <pthread.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "test-common.hpp"
 #include "nccl_ofi_mr.h"
+#include "nccl_ofi_pthread.h"
 
 static inline bool test_lookup_impl(nccl_ofi_mr_cache_t *cache, void *addr, size_t size,
 		 void *expected_val)
@@ -61,6 +64,315 @@ static inline bool test_delete_impl(nccl_ofi_mr_cache_t *cache, void *handle, in
 		exit(1);                                      \
 	}
 
+/*
+ * Multi-threaded stress test of the lock-free hit path. Reader threads
+ * look up a fixed set of registrations while a writer thread inserts
+ * and deletes registrations interleaved with them, so readers walk the
+ * tree while it is being rebalanced.
+ */
+static const size_t stress_page_size = 4096;
+static const size_t stress_num_stable = 64;
+static const size_t stress_iters = 100000;
+
+struct stress_args {
+	nccl_ofi_mr_cache_t *cache;
+	pthread_barrier_t *barrier;
+	unsigned int seed;
+	size_t fallbacks;
+	bool failed;
+};
+
+static bool stress_stop;
+
+static inline void *stress_stable_addr(size_t i)
+{
+	return (void *)((4 * i + 4) * stress_page_size);
+}
+
+static inline void *stress_churn_addr(size_t i)
+{
+	return (void *)((4 * i + 6) * stress_page_size);
+}
+
+static void *stress_reader(void *arg)
+{
+	struct stress_args *args = (struct stress_args *)arg;
+	nccl_ofi_mr_cache_t *cache = args->cache;
+
+	pthread_barrier_wait(args->barrier);
+
+	for (size_t i = 0; i < stress_iters; i++) {
+		size_t idx = (size_t)rand_r(&args->seed) % stress_num_stable;
+		nccl_ofi_mr_ckey_t ckey = nccl_ofi_mr_ckey_mk_vec(stress_stable_addr(idx), 8);
+		void *handle = nccl_ofi_mr_cache_try_lookup_entry(cache, &ckey);
+		if (!handle) {
+			/* Spurious miss, retry like the plugin does */
+			nccl_net_ofi_mutex_lock(&cache->lock);
+			handle = nccl_ofi_mr_cache_lookup_entry(cache, &ckey);
+			nccl_net_ofi_mutex_unlock(&cache->lock);
+			args->fallbacks++;
+		}
+		if (handle != (void *)(idx + 1)) {
+			args->failed = true;
+		}
+	}
+
+	return NULL;
+}
+
+static void *stress_writer(void *arg)
+{
+	nccl_ofi_mr_cache_t *cache = (nccl_ofi_mr_cache_t *)arg;
+
+	while (!__atomic_load_n(&stress_stop, __ATOMIC_RELAXED)) {
+		for (size_t i = 0; i < stress_num_stable; i++) {
+			nccl_ofi_mr_ckey_t ckey = nccl_ofi_mr_ckey_mk_vec(stress_churn_addr(i), 8);
+			void *handle = (void *)(stress_num_stable + i + 1);
+
+			nccl_net_ofi_mutex_lock(&cache->lock);
+			test_insert(cache, stress_churn_addr(i), 8, handle, 0);
+			nccl_net_ofi_mutex_unlock(&cache->lock);
+
+			if (nccl_ofi_mr_cache_try_lookup_entry(cache, &ckey) != handle) {
+				NCCL_OFI_WARN("Lookup of churn entry %zu failed", i);
+				exit(1);
+			}
+
+			nccl_net_ofi_mutex_lock(&cache->lock);
+			test_delete(cache, handle, 0);
+			test_delete(cache, handle, 1);
+			nccl_net_ofi_mutex_unlock(&cache->lock);
+		}
+	}
+
+	return NULL;
+}
+
+static void test_stress(size_t num_threads)
+{
+	struct timespec start, end;
+	pthread_barrier_t barrier;
+	pthread_t writer;
+	pthread_t *readers = (pthread_t *)calloc(num_threads, sizeof(*readers));
+	struct stress_args *args = (struct stress_args *)calloc(num_threads, sizeof(*args));
+	size_t fallbacks = 0;
+	size_t releases = 0;
+
+	if (!readers || !args) {
+		NCCL_OFI_WARN("Allocation failed");
+		exit(1);
+	}
+
+	nccl_ofi_mr_cache_t *cache = nccl_ofi_mr_cache_init(16, stress_page_size);
+	if (!cache) {
+		NCCL_OFI_WARN("nccl_ofi_mr_cache_init failed");
+		exit(1);
+	}
+
+	for (size_t i = 0; i < stress_num_stable; i++) {
+		test_insert(cache, stress_stable_addr(i), stress_page_size, (void *)(i + 1), 0);
+	}
+
+	pthread_barrier_init(&barrier, NULL, num_threads + 1);
+	__atomic_store_n(&stress_stop, false, __ATOMIC_RELAXED);
+	pthread_create(&writer, NULL, stress_writer, cache);
+	for (size_t t = 0; t < num_threads; t++) {
+		args[t].cache = cache;
+		args[t].barrier = &barrier;
+		args[t].seed = (unsigned int)t;
+		pthread_create(&readers[t], NULL, stress_reader, &args[t]);
+	}
+
+	pthread_barrier_wait(&barrier);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t t = 0; t < num_threads; t++) {
+		pthread_join(readers[t], NULL);
+		if (args[t].failed) {
+			NCCL_OFI_WARN("Reader %zu found an unexpected handle", t);
+			exit(1);
+		}
+		fallbacks += args[t].fallbacks;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	__atomic_store_n(&stress_stop, true, __ATOMIC_RELAXED);
+	pthread_join(writer, NULL);
+	pthread_barrier_destroy(&barrier);
+
+	double secs = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("%2zu threads: %8.2f Mhits/s, %zu locked retries\n",
+	       num_threads, (double)(num_threads * stress_iters) / secs / 1e6, fallbacks);
+
+	/* Every lookup took exactly one reference */
+	for (size_t i = 0; i < stress_num_stable; i++) {
+		int ret;
+		do {
+			ret = nccl_ofi_mr_cache_del_entry(cache, (void *)(i + 1));
+			releases++;
+		} while (ret == 0);
+		if (ret != 1) {
+			NCCL_OFI_WARN("Unexpected delete result %d", ret);
+			exit(1);
+		}
+	}
+	if (releases != stress_num_stable + num_threads * stress_iters) {
+		NCCL_OFI_WARN("Reference count mismatch: %zu releases for %zu references",
+			      releases, stress_num_stable + num_threads * stress_iters);
+		exit(1);
+	}
+
+	nccl_ofi_mr_cache_finalize(cache);
+	free(args);
+	free(readers);
+}
+
+/*
+ * Retention of unused registrations. The dereg callback records the
+ * handles evicted from the cache, and all memory belongs to the
+ * allocation alloc_id, which changes when the test "reallocates" it.
+ */
+struct retention_state {
+	void *evicted[8];
+	size_t num_evicted;
+	uint64_t alloc_id;
+};
+
+static int record_dereg(void *opaque, void *handle)
+{
+	struct retention_state *state = (struct retention_state *)opaque;
+
+	if (state->num_evicted == sizeof(state->evicted) / sizeof(state->evicted[0])) {
+		return -ENOSPC;
+	}
+	state->evicted[state->num_evicted++] = handle;
+	return 0;
+}
+
+static uint64_t record_alloc_id(void *opaque, uintptr_t addr)
+{
+	return ((struct retention_state *)opaque)->alloc_id;
+}
+
+#define check(cond)                                           \
+	if (!(cond)) {                                        \
+		NCCL_OFI_WARN("Check failed: %s", #cond);     \
+		exit(1);                                      \
+	}
+
+static void test_retention(size_t page_size)
+{
+	struct retention_state state = {};
+	nccl_ofi_mr_cache_t *cache;
+
+	state.alloc_id = 1;
+	nccl_ofi_mr_ckey_t ckey;
+
+	/* Entry budget */
+	cache = nccl_ofi_mr_cache_init(4, page_size);
+	if (!cache) {
+		NCCL_OFI_WARN("nccl_ofi_mr_cache_init failed");
+		exit(1);
+	}
+	nccl_ofi_mr_cache_set_retention(cache, 2, 0, record_dereg, record_alloc_id, &state);
+
+	for (size_t i = 1; i <= 3; i++) {
+		test_insert(cache, (void *)(2 * i * page_size), 1, (void *)i, 0);
+	}
+	/* Unused entries are retained, the least recently used one is
+	   evicted once the budget is exceeded */
+	test_delete(cache, (void *)1, 0);
+	test_delete(cache, (void *)2, 0);
+	check(state.num_evicted == 0);
+	test_delete(cache, (void *)3, 0);
+	check(state.num_evicted == 1 && state.evicted[0] == (void *)1);
+	check(cache->eviction_count == 1 && cache->unused_entries == 2 && cache->used == 2);
+	test_lookup(cache, (void *)(2 * page_size), 1, NULL);
+
+	/* Retained entries are not revived by lock-free lookups */
+	ckey = nccl_ofi_mr_ckey_mk_vec((void *)(4 * page_size), 1);
+	check(nccl_ofi_mr_cache_try_lookup_entry(cache, &ckey) == NULL);
+	/* But are by locked lookups, and are then in use again */
+	test_lookup(cache, (void *)(4 * page_size), 1, (void *)2);
+	check(cache->unused_entries == 1);
+	check(nccl_ofi_mr_cache_try_lookup_entry(cache, &ckey) == (void *)2);
+	test_delete(cache, (void *)2, 0);
+	test_delete(cache, (void *)2, 0);
+	check(cache->unused_entries == 2);
+	/* Retained entries hold no reference that can be dropped */
+	test_delete(cache, (void *)3, -ENOENT);
+
+	/* Entry 2 was used last, so entry 3 goes first */
+	test_insert(cache, (void *)(8 * page_size), 1, (void *)4, 0);
+	test_delete(cache, (void *)4, 0);
+	check(state.num_evicted == 2 && state.evicted[1] == (void *)3);
+
+	nccl_ofi_mr_cache_flush(cache);
+	check(state.num_evicted == 4 && cache->used == 0 && cache->unused_entries == 0);
+	check(cache->unused_bytes == 0 && cache->eviction_count == 4);
+	nccl_ofi_mr_cache_finalize(cache);
+
+	/* Byte budget */
+	state.num_evicted = 0;
+	cache = nccl_ofi_mr_cache_init(4, page_size);
+	if (!cache) {
+		NCCL_OFI_WARN("nccl_ofi_mr_cache_init failed");
+		exit(1);
+	}
+	nccl_ofi_mr_cache_set_retention(cache, 0, 4 * page_size, record_dereg, record_alloc_id, &state);
+
+	/* Larger than the whole budget, deregistered by the caller */
+	test_insert(cache, (void *)(16 * page_size), 8 * page_size, (void *)1, 0);
+	test_delete(cache, (void *)1, 1);
+	test_insert(cache, (void *)(32 * page_size), 2 * page_size, (void *)2, 0);
+	test_insert(cache, (void *)(36 * page_size), 2 * page_size, (void *)3, 0);
+	test_insert(cache, (void *)(40 * page_size), 1, (void *)4, 0);
+	test_delete(cache, (void *)2, 0);
+	test_delete(cache, (void *)3, 0);
+	check(state.num_evicted == 0 && cache->unused_bytes == 4 * page_size);
+	test_delete(cache, (void *)4, 0);
+	check(state.num_evicted == 1 && state.evicted[0] == (void *)2);
+	check(cache->unused_bytes == 3 * page_size);
+
+	nccl_ofi_mr_cache_flush(cache);
+	check(state.num_evicted == 3 && cache->used == 0);
+	nccl_ofi_mr_cache_finalize(cache);
+
+	/* Allocation identity */
+	state.num_evicted = 0;
+	cache = nccl_ofi_mr_cache_init(4, page_size);
+	if (!cache) {
+		NCCL_OFI_WARN("nccl_ofi_mr_cache_init failed");
+		exit(1);
+	}
+	nccl_ofi_mr_cache_set_retention(cache, 0, 0, record_dereg, record_alloc_id, &state);
+
+	/* Registrations of unidentified memory are not retained */
+	state.alloc_id = 0;
+	test_insert(cache, (void *)(2 * page_size), 1, (void *)1, 0);
+	state.alloc_id = 1;
+	test_delete(cache, (void *)1, 1);
+	check(cache->unused_entries == 0 && cache->used == 0);
+
+	/* A retained registration is revived while its memory is the same
+	   allocation */
+	test_insert(cache, (void *)(2 * page_size), 1, (void *)2, 0);
+	test_delete(cache, (void *)2, 0);
+	test_lookup(cache, (void *)(2 * page_size), 1, (void *)2);
+	test_delete(cache, (void *)2, 0);
+	check(cache->unused_entries == 1);
+
+	/* But evicted once the memory was freed and reallocated */
+	state.alloc_id = 2;
+	test_lookup(cache, (void *)(2 * page_size), 1, NULL);
+	check(state.num_evicted == 1 && state.evicted[0] == (void *)2);
+	check(cache->unused_entries == 0 && cache->used == 0 && cache->eviction_count == 1);
+	test_insert(cache, (void *)(2 * page_size), 1, (void *)3, 0);
+	test_delete(cache, (void *)3, 0);
+
+	nccl_ofi_mr_cache_flush(cache);
+	check(state.num_evicted == 2 && cache->used == 0);
+	nccl_ofi_mr_cache_finalize(cache);
+}
+
 int main(int argc, char *argv[])
 {
 	ofi_log_function = logger;
@@ -131,5 +443,11 @@ int main(int argc, char *argv[])
 
 	nccl_ofi_mr_cache_finalize(cache);
 
+	test_retention(fake_page_size);
+
+	test_stress(1);
+	test_stress(8);
+	test_stress(32);
+
 	printf("Test completed successfully!\n");
 }
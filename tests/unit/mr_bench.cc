@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+/*
+ * Microbenchmark of MR cache lookup, insert and delete cost as a
+ * function of the number of cached registrations.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "test-common.hpp"
+#include "nccl_ofi_mr.h"
+
+static const size_t fake_page_size = 4096;
+
+static inline double elapsed_ns(const struct timespec *start, const struct timespec *end)
+{
+	return (double)(end->tv_sec - start->tv_sec) * 1e9 + (double)(end->tv_nsec - start->tv_nsec);
+}
+
+/* Buffer i spans two pages, with a one-page gap between buffers */
+static inline void *buffer_addr(size_t i)
+{
+	return (void *)((i + 1) * 4 * fake_page_size);
+}
+
+static inline void *buffer_handle(size_t i)
+{
+	return (void *)(i + 1);
+}
+
+static void run_bench(size_t num_entries)
+{
+	struct timespec start, end;
+	size_t *order;
+	double insert_ns, lookup_ns, delete_ns;
+
+	nccl_ofi_mr_cache_t *cache = nccl_ofi_mr_cache_init(NCCL_OFI_MR_CACHE_INIT_SIZE, fake_page_size);
+	if (!cache) {
+		NCCL_OFI_WARN("nccl_ofi_mr_cache_init failed");
+		exit(1);
+	}
+
+	/* Shuffle operation order so that the tree does not only see
+	 * monotonically increasing addresses */
+	order = (size_t *)malloc(num_entries * sizeof(*order));
+	if (!order) {
+		NCCL_OFI_WARN("Allocation failed");
+		exit(1);
+	}
+	for (size_t i = 0; i < num_entries; i++) {
+		order[i] = i;
+	}
+	unsigned int seed = 42;
+	for (size_t i = num_entries - 1; i > 0; i--) {
+		size_t j = (size_t)rand_r(&seed) % (i + 1);
+		size_t tmp = order[i];
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < num_entries; i++) {
+		nccl_ofi_mr_ckey_t ckey = nccl_ofi_mr_ckey_mk_vec(buffer_addr(order[i]), 2 * fake_page_size);
+		if (nccl_ofi_mr_cache_insert_entry(cache, &ckey, buffer_handle(order[i])) != 0) {
+			NCCL_OFI_WARN("Insert of entry %zu failed", order[i]);
+			exit(1);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	insert_ns = elapsed_ns(&start, &end) / num_entries;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < num_entries; i++) {
+		size_t idx = order[num_entries - 1 - i];
+		nccl_ofi_mr_ckey_t ckey = nccl_ofi_mr_ckey_mk_vec((char *)buffer_addr(idx) + 64, 128);
+		if (nccl_ofi_mr_cache_lookup_entry(cache, &ckey) != buffer_handle(idx)) {
+			NCCL_OFI_WARN("Lookup of entry %zu failed", idx);
+			exit(1);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	lookup_ns = elapsed_ns(&start, &end) / num_entries;
+
+	/* Every entry now has a refcnt of two; drop the lookup
+	 * reference first so the timed loop performs the removal */
+	for (size_t i = 0; i < num_entries; i++) {
+		if (nccl_ofi_mr_cache_del_entry(cache, buffer_handle(i)) != 0) {
+			NCCL_OFI_WARN("Release of entry %zu failed", i);
+			exit(1);
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < num_entries; i++) {
+		if (nccl_ofi_mr_cache_del_entry(cache, buffer_handle(order[i])) != 1) {
+			NCCL_OFI_WARN("Delete of entry %zu failed", order[i]);
+			exit(1);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	delete_ns = elapsed_ns(&start, &end) / num_entries;
+
+	if (cache->used != 0) {
+		NCCL_OFI_WARN("Cache not empty after deleting all entries: %zu", cache->used);
+		exit(1);
+	}
+
+	printf("%8zu entries: insert %8.1f ns/op, lookup %8.1f ns/op, delete %8.1f ns/op\n",
+	       num_entries, insert_ns, lookup_ns, delete_ns);
+
+	free(order);
+	nccl_ofi_mr_cache_finalize(cache);
+}
+
+int main(int argc, char *argv[])
+{
+	ofi_log_function = logger;
+
+	run_bench(10);
+	run_bench(1000);
+	run_bench(100000);
+
+	printf("Test completed successfully!\n");
+
+	return 0;
+}
@@ -116,6 +116,65 @@ int main(int argc, char *argv[])
 		msg_seq_num = (msg_seq_num + max_inprogress) % field_size;
 	}
 
+	/** Test remove **/
+	for (uint16_t i = 0; i < 2; ++i) {
+		if (nccl_ofi_msgbuff_insert(msgbuff, (msg_seq_num + i) % field_size, &buff_store[i], type,
+					    &stat) != NCCL_OFI_MSGBUFF_SUCCESS) {
+			NCCL_OFI_WARN("nccl_ofi_msgbuff_insert failed when non-full");
+			return 1;
+		}
+	}
+
+	if (nccl_ofi_msgbuff_remove(msgbuff, msg_seq_num, &stat) != NCCL_OFI_MSGBUFF_SUCCESS) {
+		NCCL_OFI_WARN("nccl_ofi_msgbuff_remove failed on valid index");
+		return 1;
+	}
+
+	if (nccl_ofi_msgbuff_remove(msgbuff, msg_seq_num, &stat) != NCCL_OFI_MSGBUFF_INVALID_IDX ||
+	    stat != NCCL_OFI_MSGBUFF_NOTSTARTED) {
+		NCCL_OFI_WARN("nccl_ofi_msgbuff_remove did not return notstarted on removed index");
+		return 1;
+	}
+
+	if (nccl_ofi_msgbuff_retrieve(msgbuff, msg_seq_num, (void **)&result, &type, &stat) !=
+		    NCCL_OFI_MSGBUFF_INVALID_IDX ||
+	    stat != NCCL_OFI_MSGBUFF_NOTSTARTED) {
+		NCCL_OFI_WARN("nccl_ofi_msgbuff_retrieve did not return notstarted on removed index");
+		return 1;
+	}
+
+	/* Completing the other message must not complete the removed one */
+	if (nccl_ofi_msgbuff_complete(msgbuff, (msg_seq_num + 1) % field_size, &stat) !=
+	    NCCL_OFI_MSGBUFF_SUCCESS) {
+		NCCL_OFI_WARN("nccl_ofi_msgbuff_complete failed");
+		return 1;
+	}
+
+	if (nccl_ofi_msgbuff_insert(msgbuff, msg_seq_num, &buff_store[2], type, &stat) !=
+	    NCCL_OFI_MSGBUFF_SUCCESS) {
+		NCCL_OFI_WARN("nccl_ofi_msgbuff_insert failed on removed index");
+		return 1;
+	}
+
+	if (nccl_ofi_msgbuff_retrieve(msgbuff, msg_seq_num, (void **)&result, &type, &stat) !=
+		    NCCL_OFI_MSGBUFF_SUCCESS ||
+	    *result != buff_store[2]) {
+		NCCL_OFI_WARN("nccl_ofi_msgbuff_retrieve returned incorrect value after reinsert");
+		return 1;
+	}
+
+	if (nccl_ofi_msgbuff_complete(msgbuff, msg_seq_num, &stat) != NCCL_OFI_MSGBUFF_SUCCESS) {
+		NCCL_OFI_WARN("nccl_ofi_msgbuff_complete failed on reinserted index");
+		return 1;
+	}
+
+	if (nccl_ofi_msgbuff_retrieve(msgbuff, (msg_seq_num + 1) % field_size, (void **)&result, &type,
+				      &stat) != NCCL_OFI_MSGBUFF_INVALID_IDX ||
+	    stat != NCCL_OFI_MSGBUFF_COMPLETED) {
+		NCCL_OFI_WARN("nccl_ofi_msgbuff_retrieve did not return completed after reinsert");
+		return 1;
+	}
+
 	if (!nccl_ofi_msgbuff_destroy(msgbuff)) {
 		NCCL_OFI_WARN("nccl_ofi_msgbuff_destroy failed");
 		return 1;
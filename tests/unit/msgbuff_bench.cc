@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+/*
+ * Model of message rate as a function of the window of inflight
+ * messages of a communicator. Each message is tracked in a message
+ * buffer sized like the ones of the RDMA protocol and completes a fixed
+ * latency after it was posted, modelling a high latency path. No
+ * network or isend/irecv path is involved: the rate follows from
+ * Little's law (window / latency) until the message buffer itself
+ * becomes the bottleneck, which is what this measures.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "test-common.hpp"
+#include "nccl_ofi_msgbuff.h"
+
+#define LATENCY_NS (20000)
+#define ITERATIONS (100000)
+#define MAX_WINDOW (1024)
+
+static uint64_t post_ns[MAX_WINDOW];
+
+static inline uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * @brief	Smallest number of bits of sequence numbers supporting
+ *		`window' inflight messages, see NCCL_OFI_RDMA_MAX_INFLIGHT_REQUESTS
+ */
+static uint16_t seq_bits(int window)
+{
+	uint16_t bits = 10;
+	while ((1 << (bits - 3)) < window) {
+		bits++;
+	}
+	return bits;
+}
+
+static void run_bench(int window)
+{
+	nccl_ofi_msgbuff_status_t stat;
+	nccl_ofi_msgbuff_elemtype_t type;
+	void *elem;
+	uint16_t bits = seq_bits(window);
+	uint16_t mask = (uint16_t)((1 << bits) - 1);
+	uint16_t next = 0, oldest = 0;
+	int inflight = 0;
+	size_t posted = 0, completed = 0;
+
+	nccl_ofi_msgbuff_t *msgbuff = nccl_ofi_msgbuff_init((uint16_t)(2 * window), bits);
+	if (!msgbuff) {
+		NCCL_OFI_WARN("Failed to initialize msgbuff of window %d", window);
+		exit(1);
+	}
+
+	uint64_t start = now_ns();
+	while (completed < ITERATIONS) {
+		/* Post while the window has room */
+		while (inflight < window && posted < ITERATIONS) {
+			if (nccl_ofi_msgbuff_insert(msgbuff, next, &post_ns[posted % window],
+						    NCCL_OFI_MSGBUFF_REQ, &stat) != NCCL_OFI_MSGBUFF_SUCCESS) {
+				NCCL_OFI_WARN("Failed to insert message %hu", next);
+				exit(1);
+			}
+			post_ns[posted % window] = now_ns();
+			next = (next + 1) & mask;
+			inflight++;
+			posted++;
+		}
+
+		/* Complete the messages whose latency elapsed */
+		uint64_t now = now_ns();
+		while (inflight > 0 && now - post_ns[completed % window] >= LATENCY_NS) {
+			if (nccl_ofi_msgbuff_retrieve(msgbuff, oldest, &elem, &type, &stat) !=
+				    NCCL_OFI_MSGBUFF_SUCCESS ||
+			    elem != &post_ns[completed % window] ||
+			    nccl_ofi_msgbuff_complete(msgbuff, oldest, &stat) != NCCL_OFI_MSGBUFF_SUCCESS) {
+				NCCL_OFI_WARN("Failed to complete message %hu", oldest);
+				exit(1);
+			}
+			oldest = (oldest + 1) & mask;
+			inflight--;
+			completed++;
+		}
+	}
+	uint64_t total_ns = now_ns() - start;
+
+	printf("window %4d, %2hu sequence bits: %8.3f Mmsgs/s\n",
+	       window, bits, (double)ITERATIONS / (double)total_ns * 1e3);
+
+	if (!nccl_ofi_msgbuff_destroy(msgbuff)) {
+		NCCL_OFI_WARN("Failed to destroy msgbuff");
+		exit(1);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	ofi_log_function = logger;
+
+	printf("Modelled message rate over a path of %d us latency\n", LATENCY_NS / 1000);
+	for (int window = 16; window <= MAX_WINDOW; window *= 2) {
+		run_bench(window);
+	}
+
+	printf("Test completed successfully!\n");
+
+	return 0;
+}
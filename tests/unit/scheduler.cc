@@ -5,6 +5,7 @@
 #include "config.h"
 
 #include <stdint.h>
+#include <stdio.h>
 
 #include <nccl/err.h>
 #include <nccl/net.h>
@@ -309,6 +310,225 @@ static inline int test_threshold_scheduler()
 	return 0;
 }
 
+/* Maximum number of rails of the simulation */
+#define SIM_MAX_RAILS (4)
+
+/* Number of messages in flight in the simulation */
+#define SIM_WINDOW (8)
+
+/* Fixed latency added to each stripe completion in the simulation, in ns */
+#define SIM_LATENCY_NS (2000)
+
+struct sim_completion {
+	/* Virtual time of the completion in ns */
+	uint64_t time_ns;
+	/* Index of the message in the window */
+	int msg;
+	/* Index of the stripe in the schedule of the message */
+	size_t xfer;
+};
+
+struct sim_msg {
+	nccl_net_ofi_schedule_t *schedule;
+	uint64_t start_ns;
+	size_t pending;
+};
+
+/*
+ * @brief	Check that a schedule covers a message of `size' bytes with
+ *		contiguous stripes on distinct rails
+ */
+static int verify_coverage(nccl_net_ofi_schedule_t *schedule, size_t size, int num_rails)
+{
+	size_t offset = 0;
+	bool used[SIM_MAX_RAILS] = {false};
+
+	if (!schedule || schedule->num_xfer_infos == 0) {
+		NCCL_OFI_WARN("Empty schedule for message of size %zu", size);
+		return 1;
+	}
+
+	for (size_t i = 0; i < schedule->num_xfer_infos; i++) {
+		nccl_net_ofi_xfer_info_t *xfer = &schedule->rail_xfer_infos[i];
+		if (xfer->rail_id < 0 || xfer->rail_id >= num_rails || used[xfer->rail_id]) {
+			NCCL_OFI_WARN("Invalid or duplicate rail %d in schedule", xfer->rail_id);
+			return 1;
+		}
+		used[xfer->rail_id] = true;
+		if (xfer->offset != offset) {
+			NCCL_OFI_WARN("Expected stripe offset %zu, but got %zu", offset, xfer->offset);
+			return 1;
+		}
+		offset += xfer->msg_size;
+	}
+
+	if (offset != size) {
+		NCCL_OFI_WARN("Schedule covers %zu bytes of message of size %zu", offset, size);
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * @brief	Simulate transfer of messages over rails of given speeds
+ *
+ * Each rail serves posted stripes in FIFO order at its speed. A window
+ * of messages is kept in flight; a new message is scheduled as soon as
+ * all stripes of a message completed.
+ *
+ * @param	speeds
+ *		Speed of each rail in bytes per ns
+ * @return	Virtual time in ns at which the last message completed,
+ *		0 on error
+ */
+static uint64_t simulate(nccl_net_ofi_scheduler_t *scheduler, const double *speeds, int num_rails,
+			 size_t msg_size, int num_msgs)
+{
+	double busy_until[SIM_MAX_RAILS] = {0.0};
+	struct sim_msg msgs[SIM_WINDOW];
+	struct sim_completion compls[SIM_WINDOW * SIM_MAX_RAILS];
+	int num_compls = 0;
+	int posted = 0;
+	uint64_t now = 0;
+
+	for (int m = 0; m < SIM_WINDOW; m++) {
+		msgs[m].schedule = NULL;
+		msgs[m].pending = 0;
+	}
+
+	while (true) {
+		/* Schedule and post new messages in free window slots */
+		for (int m = 0; m < SIM_WINDOW && posted < num_msgs; m++) {
+			if (msgs[m].pending != 0) {
+				continue;
+			}
+			nccl_net_ofi_schedule_t *schedule = scheduler->get_schedule(scheduler, msg_size, num_rails);
+			if (verify_coverage(schedule, msg_size, num_rails)) {
+				return 0;
+			}
+			msgs[m].schedule = schedule;
+			msgs[m].start_ns = now;
+			msgs[m].pending = schedule->num_xfer_infos;
+			for (size_t i = 0; i < schedule->num_xfer_infos; i++) {
+				nccl_net_ofi_xfer_info_t *xfer = &schedule->rail_xfer_infos[i];
+				double begin = NCCL_OFI_MAX(busy_until[xfer->rail_id], (double)now);
+				busy_until[xfer->rail_id] = begin + (double)xfer->msg_size / speeds[xfer->rail_id];
+				compls[num_compls].time_ns = (uint64_t)busy_until[xfer->rail_id] + SIM_LATENCY_NS;
+				compls[num_compls].msg = m;
+				compls[num_compls].xfer = i;
+				num_compls++;
+				nccl_net_ofi_scheduler_xfer_posted(scheduler, xfer);
+			}
+			posted++;
+		}
+
+		if (num_compls == 0) {
+			break;
+		}
+
+		/* Process the earliest completion */
+		int next = 0;
+		for (int c = 1; c < num_compls; c++) {
+			if (compls[c].time_ns < compls[next].time_ns) {
+				next = c;
+			}
+		}
+		struct sim_completion compl_entry = compls[next];
+		compls[next] = compls[--num_compls];
+		now = compl_entry.time_ns;
+
+		struct sim_msg *msg = &msgs[compl_entry.msg];
+		nccl_net_ofi_scheduler_xfer_completed(scheduler,
+						      &msg->schedule->rail_xfer_infos[compl_entry.xfer],
+						      msg->start_ns, now);
+		if (--msg->pending == 0) {
+			nccl_net_ofi_release_schedule(scheduler, msg->schedule);
+			msg->schedule = NULL;
+		}
+	}
+
+	return now;
+}
+
+static inline int test_adaptive_scheduler()
+{
+	size_t min_stripe_size = 128 * 1024;
+	size_t msg_size = 1024 * 1024;
+	int num_msgs = 512;
+	int num_rails = 4;
+	/* 100 Gbps rails, one of them degraded to a quarter of its speed */
+	const double skewed[SIM_MAX_RAILS] = {12.5, 12.5, 12.5, 3.125};
+	const double uniform[SIM_MAX_RAILS] = {12.5, 12.5, 12.5, 12.5};
+	nccl_net_ofi_scheduler_t *threshold, *adaptive;
+	int ret = 0;
+
+	/* Messages not larger than the minimum stripe size use a single
+	 * rail; larger ones are covered by contiguous stripes */
+	if (nccl_net_ofi_adaptive_scheduler_init(num_rails, min_stripe_size, &adaptive)) {
+		NCCL_OFI_WARN("Failed to initialize adaptive scheduler");
+		return 1;
+	}
+	size_t sizes[5] = {0, 1, min_stripe_size, min_stripe_size + 1, 10 * min_stripe_size + 3};
+	size_t expected_stripes[5] = {1, 1, 1, 2, 4};
+	for (int i = 0; i < 5; i++) {
+		nccl_net_ofi_schedule_t *schedule = adaptive->get_schedule(adaptive, sizes[i], num_rails);
+		if (verify_coverage(schedule, sizes[i], num_rails)) {
+			return 1;
+		}
+		if (schedule->num_xfer_infos != expected_stripes[i]) {
+			NCCL_OFI_WARN("Expected %zu stripes for message of size %zu, but got %zu",
+				      expected_stripes[i], sizes[i], schedule->num_xfer_infos);
+			return 1;
+		}
+		nccl_net_ofi_release_schedule(adaptive, schedule);
+	}
+	/* Fewer rails than the scheduler was created for, as used for
+	 * control messages */
+	nccl_net_ofi_schedule_t *schedule = adaptive->get_schedule(adaptive, 10 * min_stripe_size, 1);
+	if (verify_coverage(schedule, 10 * min_stripe_size, 1)) {
+		return 1;
+	}
+	nccl_net_ofi_release_schedule(adaptive, schedule);
+	adaptive->fini(adaptive);
+
+	const double *speeds[2] = {skewed, uniform};
+	const char *names[2] = {"skewed", "uniform"};
+	uint64_t makespan[2][2];
+	for (int s = 0; s < 2; s++) {
+		if (nccl_net_ofi_threshold_scheduler_init(num_rails, min_stripe_size, &threshold) ||
+		    nccl_net_ofi_adaptive_scheduler_init(num_rails, min_stripe_size, &adaptive)) {
+			NCCL_OFI_WARN("Failed to initialize schedulers");
+			return 1;
+		}
+		makespan[s][0] = simulate(threshold, speeds[s], num_rails, msg_size, num_msgs);
+		makespan[s][1] = simulate(adaptive, speeds[s], num_rails, msg_size, num_msgs);
+		threshold->fini(threshold);
+		adaptive->fini(adaptive);
+		if (makespan[s][0] == 0 || makespan[s][1] == 0) {
+			return 1;
+		}
+		printf("%s rails: threshold makespan %lu ns, adaptive makespan %lu ns\n",
+		       names[s], makespan[s][0], makespan[s][1]);
+	}
+
+	/* With a degraded rail, the threshold scheduler is limited by
+	 * four times the speed of the slow rail while the adaptive
+	 * scheduler approaches the aggregate speed of all rails */
+	if (makespan[0][1] * 10 > makespan[0][0] * 6) {
+		NCCL_OFI_WARN("Adaptive scheduler did not improve makespan on skewed rails");
+		ret = 1;
+	}
+	/* On uniform rails, the adaptive scheduler must not be
+	 * noticeably worse */
+	if (makespan[1][1] * 10 > makespan[1][0] * 11) {
+		NCCL_OFI_WARN("Adaptive scheduler regressed makespan on uniform rails");
+		ret = 1;
+	}
+
+	return ret;
+}
+
 int main(int argc, char *argv[])
 {
 	int ret = 0;
@@ -316,6 +536,9 @@ int main(int argc, char *argv[])
 	system_page_size = 4096;
 
 	ret = test_threshold_scheduler();
+	if (ret == 0) {
+		ret = test_adaptive_scheduler();
+	}
 
 	/** Success!? **/
 	return ret;
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+/*
+ * Microbenchmark of schedule creation throughput as a function of the
+ * number of threads sharing a scheduler.
+ */
+
+#include "config.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "test-common.hpp"
+#include "nccl_ofi_scheduler.h"
+
+#define NUM_RAILS (4)
+#define MIN_STRIPE_SIZE (128 * 1024)
+#define ITERATIONS (200000)
+#define MAX_THREADS (8)
+
+/* Mix of power-of-two sizes served from templates and other sizes */
+static const size_t msg_sizes[] = {4096, 65536, 100000, 524288, 1048576, 1000000};
+static const size_t num_msg_sizes = sizeof(msg_sizes) / sizeof(msg_sizes[0]);
+
+static inline double elapsed_ns(const struct timespec *start, const struct timespec *end)
+{
+	return (double)(end->tv_sec - start->tv_sec) * 1e9 + (double)(end->tv_nsec - start->tv_nsec);
+}
+
+static void *bench_thread(void *arg)
+{
+	nccl_net_ofi_scheduler_t *scheduler = (nccl_net_ofi_scheduler_t *)arg;
+
+	for (size_t i = 0; i < ITERATIONS; i++) {
+		nccl_net_ofi_schedule_t *schedule =
+			scheduler->get_schedule(scheduler, msg_sizes[i % num_msg_sizes], NUM_RAILS);
+		if (!schedule) {
+			NCCL_OFI_WARN("get_schedule failed");
+			exit(1);
+		}
+		nccl_net_ofi_release_schedule(scheduler, schedule);
+	}
+
+	return NULL;
+}
+
+static void run_bench(const char *name,
+		      int (*init)(int, size_t, nccl_net_ofi_scheduler_t **),
+		      int num_threads)
+{
+	pthread_t threads[MAX_THREADS];
+	struct timespec start, end;
+	nccl_net_ofi_scheduler_t *scheduler;
+
+	if (init(NUM_RAILS, MIN_STRIPE_SIZE, &scheduler)) {
+		NCCL_OFI_WARN("Failed to initialize %s scheduler", name);
+		exit(1);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int t = 0; t < num_threads; t++) {
+		if (pthread_create(&threads[t], NULL, bench_thread, scheduler)) {
+			NCCL_OFI_WARN("pthread_create failed");
+			exit(1);
+		}
+	}
+	for (int t = 0; t < num_threads; t++) {
+		pthread_join(threads[t], NULL);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double total_ns = elapsed_ns(&start, &end);
+	double num_schedules = (double)ITERATIONS * num_threads;
+	printf("%-9s scheduler, %d threads: %8.2f Mschedules/s, %6.1f ns/schedule/thread\n",
+	       name, num_threads, num_schedules / total_ns * 1e3, total_ns / ITERATIONS);
+
+	if (scheduler->fini(scheduler)) {
+		NCCL_OFI_WARN("Failed to destroy %s scheduler", name);
+		exit(1);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	ofi_log_function = logger;
+	system_page_size = 4096;
+
+	for (int num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2) {
+		run_bench("threshold", nccl_net_ofi_threshold_scheduler_init, num_threads);
+		run_bench("adaptive", nccl_net_ofi_adaptive_scheduler_init, num_threads);
+	}
+
+	printf("Test completed successfully!\n");
+
+	return 0;
+}
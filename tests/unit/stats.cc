@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2024 Amazon.com, Inc. or its affiliates. All rights reserved.
+ */
+
+#include "config.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test-common.hpp"
+#include "nccl_ofi_stats.h"
+
+#define check(cond, ...)					\
+	do {							\
+		if (!(cond)) {					\
+			NCCL_OFI_WARN(__VA_ARGS__);		\
+			exit(1);				\
+		}						\
+	} while (0)
+
+struct counters {
+	nccl_ofi_stats_entry_t entry;
+	uint64_t events;
+	nccl_ofi_stats_hist_t hist;
+};
+
+static void counters_dump(FILE *out, nccl_ofi_stats_entry_t *entry)
+{
+	struct counters *c = container_of(entry, struct counters, entry);
+
+	fprintf(out, "    events %lu\n", nccl_ofi_stats_read(&c->events));
+	nccl_ofi_stats_hist_print(out, "hist", &c->hist);
+}
+
+static void test_hist(void)
+{
+	nccl_ofi_stats_hist_t hist;
+
+	check(nccl_ofi_stats_hist_bucket(0) == 0, "Bad bucket of 0");
+	check(nccl_ofi_stats_hist_bucket(1) == 1, "Bad bucket of 1");
+	check(nccl_ofi_stats_hist_bucket(3) == 2, "Bad bucket of 3");
+	check(nccl_ofi_stats_hist_bucket(4) == 3, "Bad bucket of 4");
+	check(nccl_ofi_stats_hist_bucket(UINT64_MAX) == 64, "Bad bucket of UINT64_MAX");
+
+	memset(&hist, 0, sizeof(hist));
+	check(nccl_ofi_stats_hist_percentile(&hist, 50.0) == 0, "Empty histogram percentile not 0");
+
+	/* 90 values of 100, 10 values of 5000 */
+	for (int i = 0; i < 90; i++) {
+		nccl_ofi_stats_hist_add(&hist, 100);
+	}
+	for (int i = 0; i < 10; i++) {
+		nccl_ofi_stats_hist_add(&hist, 5000);
+	}
+
+	check(hist.count == 100, "Unexpected count %lu", hist.count);
+	check(hist.sum == 90 * 100 + 10 * 5000, "Unexpected sum %lu", hist.sum);
+	check(hist.max == 5000, "Unexpected max %lu", hist.max);
+	check(hist.buckets[nccl_ofi_stats_hist_bucket(100)] == 90, "Unexpected bucket count");
+
+	uint64_t p50 = nccl_ofi_stats_hist_percentile(&hist, 50.0);
+	check(p50 >= 100 && p50 <= 128, "Unexpected p50 %lu", p50);
+	uint64_t p99 = nccl_ofi_stats_hist_percentile(&hist, 99.0);
+	check(p99 == 5000, "Unexpected p99 %lu", p99);
+}
+
+static size_t count_lines(const char *path, const char *pattern)
+{
+	char line[1024];
+	size_t n = 0;
+
+	FILE *f = fopen(path, "r");
+	check(f != NULL, "Unable to open %s", path);
+	while (fgets(line, sizeof(line), f)) {
+		if (strstr(line, pattern)) {
+			n++;
+		}
+	}
+	fclose(f);
+
+	return n;
+}
+
+static void test_dump(const char *path)
+{
+	struct counters a, b;
+
+	memset(&a, 0, sizeof(a));
+	memset(&b, 0, sizeof(b));
+
+	/* Unregistering an entry that was never registered is a no-op */
+	nccl_ofi_stats_unregister(&a.entry);
+
+	nccl_ofi_stats_register(&a.entry, counters_dump, "entry %c", 'a');
+	nccl_ofi_stats_register(&b.entry, counters_dump, "entry %c", 'b');
+	nccl_ofi_stats_add(&a.events, 3);
+	nccl_ofi_stats_hist_add(&a.hist, 7);
+
+	nccl_ofi_stats_dump("test");
+	check(count_lines(path, "(test)") == 1, "Missing dump header");
+	check(count_lines(path, "entry a") == 1, "Missing entry a");
+	check(count_lines(path, "entry b") == 1, "Missing entry b");
+	check(count_lines(path, "events 3") == 1, "Missing counter of entry a");
+	check(count_lines(path, "2^2:1") == 1, "Missing histogram bucket of entry a");
+
+	/* With dump at fini enabled, closing an entry dumps it */
+	nccl_ofi_stats_unregister(&b.entry);
+	check(count_lines(path, "(close)") == 1, "Missing close dump");
+	check(count_lines(path, "entry b") == 2, "Entry b not dumped on close");
+
+	/* The signal handler only requests a dump, polling writes it */
+	raise(SIGUSR2);
+	check(count_lines(path, "(signal)") == 0, "Dump written from signal handler");
+	nccl_ofi_stats_poll();
+	check(count_lines(path, "(signal)") == 1, "Missing signal dump");
+	check(count_lines(path, "entry b") == 2, "Unregistered entry dumped");
+
+	/* Entries closed after the final dump are not dumped again */
+	nccl_ofi_stats_fini();
+	check(count_lines(path, "(fini)") == 1, "Missing fini dump");
+	nccl_ofi_stats_unregister(&a.entry);
+	check(count_lines(path, "(close)") == 1, "Entry dumped after fini");
+	check(count_lines(path, "entry a") == 3, "Unexpected number of entry a dumps");
+}
+
+int main(int argc, char *argv[])
+{
+	char path[] = "/tmp/nccl_ofi_stats_XXXXXX";
+
+	ofi_log_function = logger;
+
+	int fd = mkstemp(path);
+	check(fd >= 0, "mkstemp failed");
+	close(fd);
+
+	setenv("OFI_NCCL_STATS_FILE", path, 1);
+	setenv("OFI_NCCL_STATS_DUMP_AT_FINI", "1", 1);
+	setenv("OFI_NCCL_STATS_SIGNAL", "12", 1);
+
+	check(nccl_ofi_stats_init() == 0, "nccl_ofi_stats_init failed");
+
+	test_hist();
+	test_dump(path);
+
+	unlink(path);
+
+	printf("Test completed successfully!\n");
+
+	return 0;
+}